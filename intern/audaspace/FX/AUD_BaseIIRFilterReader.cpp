@@ -31,14 +31,12 @@
 
 #include <cstring>
 
-#define CC m_specs.channels + m_channel
-
 AUD_BaseIIRFilterReader::AUD_BaseIIRFilterReader(boost::shared_ptr<AUD_IReader> reader, int in,
 												 int out) :
 		AUD_EffectReader(reader),
 		m_specs(reader->getSpecs()),
 		m_xlen(in), m_ylen(out),
-		m_xpos(0), m_ypos(0), m_channel(0)
+		m_xcur(NULL), m_ycur(NULL)
 {
 	m_x = new sample_t[m_xlen * m_specs.channels];
 	m_y = new sample_t[m_ylen * m_specs.channels];
@@ -60,17 +58,13 @@ void AUD_BaseIIRFilterReader::setLengths(int in, int out)
 		sample_t* xn = new sample_t[in * m_specs.channels];
 		memset(xn, 0, sizeof(sample_t) * in * m_specs.channels);
 
-		for(m_channel = 0; m_channel < m_specs.channels; m_channel++)
-		{
-			for(int i = 1; i <= in && i <= m_xlen; i++)
-			{
-				xn[(in - i) * CC] = x(-i);
-			}
-		}
+		int len = AUD_MIN(in, m_xlen);
+
+		for(int channel = 0; channel < m_specs.channels; channel++)
+			memcpy(xn + (channel + 1) * in - len, m_x + (channel + 1) * m_xlen - len, len * sizeof(sample_t));
 
 		delete[] m_x;
 		m_x = xn;
-		m_xpos = 0;
 		m_xlen = in;
 	}
 
@@ -79,21 +73,27 @@ void AUD_BaseIIRFilterReader::setLengths(int in, int out)
 		sample_t* yn = new sample_t[out * m_specs.channels];
 		memset(yn, 0, sizeof(sample_t) * out * m_specs.channels);
 
-		for(m_channel = 0; m_channel < m_specs.channels; m_channel++)
-		{
-			for(int i = 1; i <= out && i <= m_ylen; i++)
-			{
-				yn[(out - i) * CC] = y(-i);
-			}
-		}
+		int len = AUD_MIN(out, m_ylen);
+
+		for(int channel = 0; channel < m_specs.channels; channel++)
+			memcpy(yn + (channel + 1) * out - len, m_y + (channel + 1) * m_ylen - len, len * sizeof(sample_t));
 
 		delete[] m_y;
 		m_y = yn;
-		m_ypos = 0;
 		m_ylen = out;
 	}
 }
 
+void AUD_BaseIIRFilterReader::filterBlock(const sample_t* in, sample_t* out, int length)
+{
+	for(int i = 0; i < length; i++)
+	{
+		m_xcur = in + i;
+		m_ycur = out + i;
+		out[i] = filter();
+	}
+}
+
 void AUD_BaseIIRFilterReader::read(int& length, bool& eos, sample_t* buffer)
 {
 	AUD_Specs specs = m_reader->getSpecs();
@@ -119,16 +119,35 @@ void AUD_BaseIIRFilterReader::read(int& length, bool& eos, sample_t* buffer)
 
 	m_reader->read(length, eos, buffer);
 
-	for(m_channel = 0; m_channel < m_specs.channels; m_channel++)
+	int channels = m_specs.channels;
+
+	m_xbuffer.assureSize((m_xlen + length) * sizeof(sample_t));
+	m_ybuffer.assureSize((m_ylen + length) * sizeof(sample_t));
+
+	sample_t* xbuf = m_xbuffer.getBuffer();
+	sample_t* ybuf = m_ybuffer.getBuffer();
+	sample_t* in = xbuf + m_xlen;
+	sample_t* out = ybuf + m_ylen;
+
+	// the channels are filtered separately with their last samples in front
+	for(int channel = 0; channel < channels; channel++)
 	{
+		sample_t* xlast = m_x + channel * m_xlen;
+		sample_t* ylast = m_y + channel * m_ylen;
+
+		memcpy(xbuf, xlast, m_xlen * sizeof(sample_t));
+		memcpy(ybuf, ylast, m_ylen * sizeof(sample_t));
+
+		for(int i = 0; i < length; i++)
+			in[i] = buffer[i * channels + channel];
+
+		filterBlock(in, out, length);
+
 		for(int i = 0; i < length; i++)
-		{
-			m_x[m_xpos * CC] = buffer[i * CC];
-			m_y[m_ypos * CC] = buffer[i * CC] = filter();
+			buffer[i * channels + channel] = out[i];
 
-			m_xpos = (m_xpos + 1) % m_xlen;
-			m_ypos = (m_ypos + 1) % m_ylen;
-		}
+		memcpy(xlast, xbuf + length, m_xlen * sizeof(sample_t));
+		memcpy(ylast, ybuf + length, m_ylen * sizeof(sample_t));
 	}
 }
 
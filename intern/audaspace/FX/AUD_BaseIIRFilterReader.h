@@ -35,6 +35,7 @@
 
 /**
  * This class is a base class for infinite impulse response filters.
+ * The channels are filtered one after the other, a whole buffer at a time.
  */
 class AUD_BaseIIRFilterReader : public AUD_EffectReader
 {
@@ -55,29 +56,34 @@ private:
 	int m_ylen;
 
 	/**
-	 * The last in samples array.
+	 * The last in samples, m_xlen per channel.
 	 */
 	sample_t* m_x;
 
 	/**
-	 * The last out samples array.
+	 * The last out samples, m_ylen per channel.
 	 */
 	sample_t* m_y;
 
 	/**
-	 * Position of the current input sample in the input array.
+	 * The last and the current in samples of the channel being filtered.
 	 */
-	int m_xpos;
+	AUD_Buffer m_xbuffer;
 
 	/**
-	 * Position of the current output sample in the output array.
+	 * The last and the current out samples of the channel being filtered.
 	 */
-	int m_ypos;
+	AUD_Buffer m_ybuffer;
 
 	/**
-	 * Current channel.
+	 * The current input sample in m_xbuffer.
 	 */
-	int m_channel;
+	const sample_t* m_xcur;
+
+	/**
+	 * The current output sample in m_ybuffer.
+	 */
+	sample_t* m_ycur;
 
 	// hide copy constructor and operator=
 	AUD_BaseIIRFilterReader(const AUD_BaseIIRFilterReader&);
@@ -94,6 +100,16 @@ protected:
 
 	void setLengths(int in, int out);
 
+	/**
+	 * Filters the samples of one channel, the default implementation calls
+	 * filter() for every sample.
+	 * \param in The input samples, preceded by the last input samples.
+	 * \param out The output samples to write, preceded by the last output
+	 *            samples.
+	 * \param length The count of samples.
+	 */
+	virtual void filterBlock(const sample_t* in, sample_t* out, int length);
+
 public:
 	/**
 	 * Retrieves the last input samples.
@@ -102,7 +118,7 @@ public:
 	 */
 	inline sample_t x(int pos)
 	{
-		return m_x[(m_xpos + pos + m_xlen) % m_xlen * m_specs.channels + m_channel];
+		return m_xcur[pos];
 	}
 
 	/**
@@ -112,7 +128,7 @@ public:
 	 */
 	inline sample_t y(int pos)
 	{
-		return m_y[(m_ypos + pos + m_ylen) % m_ylen * m_specs.channels + m_channel];
+		return m_ycur[pos];
 	}
 
 	virtual ~AUD_BaseIIRFilterReader();
@@ -0,0 +1,68 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_ConvolverFactory.cpp
+ *  \ingroup audfx
+ */
+
+
+#include "AUD_ConvolverFactory.h"
+#include "AUD_ConvolverReader.h"
+#include "AUD_JOSResampleFactory.h"
+#include "AUD_StreamBufferFactory.h"
+
+AUD_ConvolverFactory::AUD_ConvolverFactory(boost::shared_ptr<AUD_IFactory> factory,
+										   boost::shared_ptr<AUD_IFactory> impulse, int block) :
+		AUD_EffectFactory(factory),
+		m_impulse(impulse),
+		m_block(4)
+{
+	if(block > AUD_CONVOLVER_MAX_BLOCK)
+		block = AUD_CONVOLVER_MAX_BLOCK;
+
+	while(m_block < block)
+		m_block *= 2;
+}
+
+boost::shared_ptr<AUD_IReader> AUD_ConvolverFactory::createReader()
+{
+	boost::shared_ptr<AUD_IReader> reader = getReader();
+	AUD_Specs specs = reader->getSpecs();
+	AUD_Specs ir_specs = m_impulse->createReader()->getSpecs();
+	boost::shared_ptr<AUD_IFactory> impulse = m_impulse;
+
+	if(ir_specs.rate != specs.rate)
+	{
+		AUD_DeviceSpecs device_specs;
+		device_specs.rate = specs.rate;
+		device_specs.channels = ir_specs.channels;
+		device_specs.format = AUD_FORMAT_FLOAT32;
+
+		impulse = boost::shared_ptr<AUD_IFactory>(new AUD_JOSResampleFactory(m_impulse, device_specs));
+	}
+
+	boost::shared_ptr<AUD_Buffer> buffer = AUD_StreamBufferFactory::decode(impulse, ir_specs);
+
+	return boost::shared_ptr<AUD_IReader>(new AUD_ConvolverReader(reader, buffer, ir_specs, m_block));
+}
@@ -0,0 +1,77 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_ConvolverFactory.h
+ *  \ingroup audfx
+ */
+
+
+#ifndef __AUD_CONVOLVERFACTORY_H__
+#define __AUD_CONVOLVERFACTORY_H__
+
+#include "AUD_EffectFactory.h"
+
+/// The maximum block size of a convolver.
+#define AUD_CONVOLVER_MAX_BLOCK 65536
+
+/**
+ * This factory convolves another factory with an impulse response, for
+ * reverbs or long FIR filters.
+ */
+class AUD_ConvolverFactory : public AUD_EffectFactory
+{
+private:
+	/**
+	 * The impulse response.
+	 */
+	boost::shared_ptr<AUD_IFactory> m_impulse;
+
+	/**
+	 * The block size.
+	 */
+	int m_block;
+
+	// hide copy constructor and operator=
+	AUD_ConvolverFactory(const AUD_ConvolverFactory&);
+	AUD_ConvolverFactory& operator=(const AUD_ConvolverFactory&);
+
+public:
+	/**
+	 * Creates a new convolver factory.
+	 * \param factory The input factory.
+	 * \param impulse The impulse response, it's decoded for every reader, so
+	 *                it should be buffered if many readers are created. It's
+	 *                resampled if its sample rate differs from the input.
+	 * \param block The block size, the latency and the work per sample are
+	 *              lower with smaller blocks for short and larger blocks for
+	 *              long impulse responses. Rounded up to a power of two and
+	 *              clamped to AUD_CONVOLVER_MAX_BLOCK.
+	 */
+	AUD_ConvolverFactory(boost::shared_ptr<AUD_IFactory> factory,
+						 boost::shared_ptr<AUD_IFactory> impulse, int block = 512);
+
+	virtual boost::shared_ptr<AUD_IReader> createReader();
+};
+
+#endif //__AUD_CONVOLVERFACTORY_H__
@@ -0,0 +1,215 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_ConvolverReader.cpp
+ *  \ingroup audfx
+ */
+
+
+#include "AUD_ConvolverReader.h"
+#include "AUD_SIMD.h"
+
+#include <cstring>
+
+AUD_ConvolverReader::AUD_ConvolverReader(boost::shared_ptr<AUD_IReader> reader,
+										 boost::shared_ptr<AUD_Buffer> impulse, AUD_Specs specs,
+										 int block) :
+		AUD_EffectReader(reader),
+		m_block(block), m_fft(2 * block), m_bins(block + 1),
+		m_ir_channels(specs.channels), m_position(0)
+{
+	int length = impulse->getSize() / AUD_SAMPLE_SIZE(specs);
+	m_length = AUD_MAX(length, 1);
+	m_partitions = (m_length + m_block - 1) / m_block;
+
+	m_ir.resize(m_ir_channels * m_partitions * 2 * m_bins * sizeof(float));
+	m_work.resize(2 * (m_bins + m_block) * sizeof(float));
+
+	const sample_t* samples = impulse->getBuffer();
+	sample_t* time = m_work.getBuffer();
+
+	// every partition is zero padded to two blocks for the overlap-save method
+	for(int channel = 0; channel < m_ir_channels; channel++)
+	{
+		for(int partition = 0; partition < m_partitions; partition++)
+		{
+			memset(time, 0, 2 * m_block * sizeof(sample_t));
+
+			for(int i = 0; i < m_block && partition * m_block + i < length; i++)
+				time[i] = samples[(partition * m_block + i) * m_ir_channels + channel];
+
+			float* spectrum = m_ir.getBuffer() + (channel * m_partitions + partition) * 2 * m_bins;
+			m_fft.forward(time, spectrum, spectrum + m_bins);
+		}
+	}
+
+	m_channels = reader->getSpecs().channels;
+	reset();
+	m_left = -1;
+}
+
+void AUD_ConvolverReader::reset()
+{
+	m_spectra.assureSize(m_channels * m_partitions * 2 * m_bins * sizeof(float));
+	m_input.assureSize(m_channels * 2 * m_block * sizeof(sample_t));
+	m_output.assureSize(m_channels * m_block * sizeof(sample_t));
+
+	memset(m_spectra.getBuffer(), 0, m_channels * m_partitions * 2 * m_bins * sizeof(float));
+	memset(m_input.getBuffer(), 0, m_channels * 2 * m_block * sizeof(sample_t));
+
+	m_spectrum = 0;
+	m_output_read = m_output_length = 0;
+}
+
+void AUD_ConvolverReader::process()
+{
+	AUD_Specs specs = m_reader->getSpecs();
+
+	if(specs.channels != m_channels)
+	{
+		m_channels = specs.channels;
+		reset();
+	}
+
+	sample_t* output = m_output.getBuffer();
+	int length = 0;
+	bool eos = false;
+
+	// after the end of the source only the tail of the impulse response is left
+	if(m_left < 0)
+	{
+		length = m_block;
+		m_reader->read(length, eos, output);
+
+		if(eos)
+			m_left = length + m_length - 1;
+	}
+
+	memset(output + length * m_channels, 0, (m_block - length) * m_channels * sizeof(sample_t));
+
+	for(int channel = 0; channel < m_channels; channel++)
+	{
+		sample_t* input = m_input.getBuffer() + channel * 2 * m_block;
+
+		memmove(input, input + m_block, m_block * sizeof(sample_t));
+
+		for(int i = 0; i < m_block; i++)
+			input[m_block + i] = output[i * m_channels + channel];
+	}
+
+	float* re = m_work.getBuffer();
+	float* im = re + m_bins;
+	sample_t* time = im + m_bins;
+
+	for(int channel = 0; channel < m_channels; channel++)
+	{
+		float* spectra = m_spectra.getBuffer() + channel * m_partitions * 2 * m_bins;
+		float* ir = m_ir.getBuffer() + AUD_MIN(channel, m_ir_channels - 1) * m_partitions * 2 * m_bins;
+
+		m_fft.forward(m_input.getBuffer() + channel * 2 * m_block,
+					  spectra + m_spectrum * 2 * m_bins, spectra + m_spectrum * 2 * m_bins + m_bins);
+
+		memset(re, 0, 2 * m_bins * sizeof(float));
+
+		// the latest input block with the first partition, the one before
+		// with the second and so on
+		for(int partition = 0; partition < m_partitions; partition++)
+		{
+			int index = (m_spectrum - partition + m_partitions) % m_partitions;
+			const float* x = spectra + index * 2 * m_bins;
+			const float* h = ir + partition * 2 * m_bins;
+
+			AUD_multiply_add_spectra(re, im, x, x + m_bins, h, h + m_bins, m_bins);
+		}
+
+		m_fft.inverse(re, im, time);
+
+		// the first block is wrapped around, the second is the result
+		for(int i = 0; i < m_block; i++)
+			output[i * m_channels + channel] = time[m_block + i];
+	}
+
+	m_spectrum = (m_spectrum + 1) % m_partitions;
+
+	m_output_read = 0;
+	m_output_length = m_block;
+
+	if(m_left >= 0)
+	{
+		m_output_length = AUD_MIN(m_block, m_left);
+		m_left -= m_output_length;
+	}
+}
+
+void AUD_ConvolverReader::seek(int position)
+{
+	m_reader->seek(position);
+
+	reset();
+	m_left = -1;
+	m_position = position;
+}
+
+int AUD_ConvolverReader::getLength() const
+{
+	int len = m_reader->getLength();
+	if(len < 0)
+		return len;
+	return len + m_length - 1;
+}
+
+int AUD_ConvolverReader::getPosition() const
+{
+	return m_position;
+}
+
+void AUD_ConvolverReader::read(int& length, bool& eos, sample_t* buffer)
+{
+	int len = 0;
+
+	while(len < length)
+	{
+		if(m_output_read == m_output_length)
+		{
+			if(m_left == 0)
+				break;
+
+			process();
+			continue;
+		}
+
+		int count = AUD_MIN(length - len, m_output_length - m_output_read);
+
+		memcpy(buffer + len * m_channels, m_output.getBuffer() + m_output_read * m_channels,
+			   count * m_channels * sizeof(sample_t));
+
+		len += count;
+		m_output_read += count;
+	}
+
+	length = len;
+	m_position += len;
+
+	eos = m_left == 0 && m_output_read == m_output_length;
+}
@@ -0,0 +1,170 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_ConvolverReader.h
+ *  \ingroup audfx
+ */
+
+
+#ifndef __AUD_CONVOLVERREADER_H__
+#define __AUD_CONVOLVERREADER_H__
+
+#include "AUD_EffectReader.h"
+#include "AUD_Buffer.h"
+#include "AUD_FFT.h"
+
+/**
+ * This class convolves a reader with an impulse response of any length.
+ * The impulse response is split into partitions of the block size which are
+ * applied in the frequency domain (uniformly partitioned overlap-save
+ * convolution), so the cost per sample only grows with the count of
+ * partitions and the source is never read more than one block ahead.
+ */
+class AUD_ConvolverReader : public AUD_EffectReader
+{
+private:
+	/**
+	 * The block size, the length of the partitions.
+	 */
+	const int m_block;
+
+	/**
+	 * The transform of two blocks.
+	 */
+	AUD_FFT m_fft;
+
+	/**
+	 * The count of frequency bins of a partition.
+	 */
+	const int m_bins;
+
+	/**
+	 * The count of partitions.
+	 */
+	int m_partitions;
+
+	/**
+	 * The length of the impulse response in samples.
+	 */
+	int m_length;
+
+	/**
+	 * The channel count of the impulse response.
+	 */
+	int m_ir_channels;
+
+	/**
+	 * The spectra of the impulse response partitions, for every channel of
+	 * the impulse response the real and imaginary parts of every partition.
+	 */
+	AUD_Buffer m_ir;
+
+	/**
+	 * The spectra of the last input blocks, same layout as m_ir.
+	 */
+	AUD_Buffer m_spectra;
+
+	/**
+	 * The partition in m_spectra of the latest input block.
+	 */
+	int m_spectrum;
+
+	/**
+	 * The last two input blocks of every channel.
+	 */
+	AUD_Buffer m_input;
+
+	/**
+	 * The interleaved output of the last block.
+	 */
+	AUD_Buffer m_output;
+
+	/**
+	 * The real and imaginary parts of the spectrum being accumulated and the
+	 * samples transformed back.
+	 */
+	AUD_Buffer m_work;
+
+	/**
+	 * The channel count of the buffers.
+	 */
+	int m_channels;
+
+	/**
+	 * The count of samples in m_output already read.
+	 */
+	int m_output_read;
+
+	/**
+	 * The count of samples in m_output.
+	 */
+	int m_output_length;
+
+	/**
+	 * The count of samples left until the end, negative while the end of the
+	 * source isn't reached.
+	 */
+	int m_left;
+
+	/**
+	 * The position of the next sample read().
+	 */
+	int m_position;
+
+	/**
+	 * Clears the state of the last input blocks.
+	 */
+	void reset();
+
+	/**
+	 * Reads the next block of the source and convolves it into m_output.
+	 */
+	void process();
+
+	// hide copy constructor and operator=
+	AUD_ConvolverReader(const AUD_ConvolverReader&);
+	AUD_ConvolverReader& operator=(const AUD_ConvolverReader&);
+
+public:
+	/**
+	 * Creates a new convolver reader.
+	 * \param reader The reader to read from.
+	 * \param impulse The interleaved samples of the impulse response, with the
+	 *                sample rate of the reader.
+	 * \param specs The specification of the impulse response, if it has less
+	 *              channels than the reader, its last channel is used for
+	 *              the remaining ones.
+	 * \param block The block size, a power of two.
+	 */
+	AUD_ConvolverReader(boost::shared_ptr<AUD_IReader> reader,
+						boost::shared_ptr<AUD_Buffer> impulse, AUD_Specs specs,
+						int block);
+
+	virtual void seek(int position);
+	virtual int getLength() const;
+	virtual int getPosition() const;
+	virtual void read(int& length, bool& eos, sample_t* buffer);
+};
+
+#endif //__AUD_CONVOLVERREADER_H__
@@ -0,0 +1,204 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_FFT.cpp
+ *  \ingroup audfx
+ */
+
+
+#include "AUD_FFT.h"
+
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+AUD_FFT::AUD_FFT(int size) :
+	m_size(size)
+{
+	// the real transform is calculated with a complex one of half the size
+	int half = m_size / 2;
+	int bits = 0;
+
+	while((1 << bits) < half)
+		bits++;
+
+	m_reverse.resize(half);
+
+	for(int i = 0; i < half; i++)
+	{
+		int reverse = 0;
+
+		for(int bit = 0; bit < bits; bit++)
+			if(i & (1 << bit))
+				reverse |= 1 << (bits - 1 - bit);
+
+		m_reverse[i] = reverse;
+	}
+
+	m_cos.resize(half / 2);
+	m_sin.resize(half / 2);
+
+	for(int i = 0; i < half / 2; i++)
+	{
+		m_cos[i] = std::cos(2.0 * M_PI * i / half);
+		m_sin[i] = std::sin(2.0 * M_PI * i / half);
+	}
+
+	m_split_cos.resize(half + 1);
+	m_split_sin.resize(half + 1);
+
+	for(int i = 0; i <= half; i++)
+	{
+		m_split_cos[i] = std::cos(2.0 * M_PI * i / m_size);
+		m_split_sin[i] = std::sin(2.0 * M_PI * i / m_size);
+	}
+
+	m_re.resize(half);
+	m_im.resize(half);
+}
+
+int AUD_FFT::getSize() const
+{
+	return m_size;
+}
+
+int AUD_FFT::getBins() const
+{
+	return m_size / 2 + 1;
+}
+
+void AUD_FFT::transform(bool inverse)
+{
+	int size = m_size / 2;
+	float* re = &m_re[0];
+	float* im = &m_im[0];
+	float sign = inverse ? 1.0f : -1.0f;
+
+	for(int i = 0; i < size; i++)
+	{
+		int j = m_reverse[i];
+
+		if(i < j)
+		{
+			float t = re[i];
+			re[i] = re[j];
+			re[j] = t;
+			t = im[i];
+			im[i] = im[j];
+			im[j] = t;
+		}
+	}
+
+	for(int length = 2; length <= size; length *= 2)
+	{
+		int half = length / 2;
+		int step = size / length;
+
+		for(int j = 0; j < half; j++)
+		{
+			float wr = m_cos[j * step];
+			float wi = sign * m_sin[j * step];
+
+			for(int a = j; a < size; a += length)
+			{
+				int b = a + half;
+				float tr = re[b] * wr - im[b] * wi;
+				float ti = re[b] * wi + im[b] * wr;
+
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+void AUD_FFT::forward(const sample_t* in, float* re, float* im)
+{
+	int half = m_size / 2;
+
+	// the even samples are the real parts, the odd ones the imaginary parts
+	for(int i = 0; i < half; i++)
+	{
+		m_re[i] = in[2 * i];
+		m_im[i] = in[2 * i + 1];
+	}
+
+	transform(false);
+
+	for(int k = 0; k <= half; k++)
+	{
+		int j = (half - k) % half;
+		int i = k % half;
+
+		// spectra of the even and odd samples
+		float er = 0.5f * (m_re[i] + m_re[j]);
+		float ei = 0.5f * (m_im[i] - m_im[j]);
+		float orr = 0.5f * (m_im[i] + m_im[j]);
+		float oi = -0.5f * (m_re[i] - m_re[j]);
+
+		float wr = m_split_cos[k];
+		float wi = -m_split_sin[k];
+
+		re[k] = er + wr * orr - wi * oi;
+		im[k] = ei + wr * oi + wi * orr;
+	}
+}
+
+void AUD_FFT::inverse(const float* re, const float* im, sample_t* out)
+{
+	int half = m_size / 2;
+
+	for(int k = 0; k < half; k++)
+	{
+		int j = half - k;
+
+		float er = 0.5f * (re[k] + re[j]);
+		float ei = 0.5f * (im[k] - im[j]);
+		float dr = 0.5f * (re[k] - re[j]);
+		float di = 0.5f * (im[k] + im[j]);
+
+		float wr = m_split_cos[k];
+		float wi = m_split_sin[k];
+
+		float orr = dr * wr - di * wi;
+		float oi = dr * wi + di * wr;
+
+		m_re[k] = er - oi;
+		m_im[k] = ei + orr;
+	}
+
+	transform(true);
+
+	float scale = 1.0f / half;
+
+	for(int i = 0; i < half; i++)
+	{
+		out[2 * i] = m_re[i] * scale;
+		out[2 * i + 1] = m_im[i] * scale;
+	}
+}
@@ -0,0 +1,118 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/FX/AUD_FFT.h
+ *  \ingroup audfx
+ */
+
+
+#ifndef __AUD_FFT_H__
+#define __AUD_FFT_H__
+
+#include "AUD_Space.h"
+
+#include <vector>
+
+/**
+ * This class calculates the fast fourier transform of real signals.
+ * The spectra are stored as separate real and imaginary parts, so the loops
+ * working on them can be vectorized by the compiler.
+ */
+class AUD_FFT
+{
+private:
+	/**
+	 * The count of real samples, a power of two.
+	 */
+	const int m_size;
+
+	/**
+	 * The bit reversed indices of the complex transform of half the size.
+	 */
+	std::vector<int> m_reverse;
+
+	/**
+	 * The twiddle factors of the complex transform.
+	 */
+	std::vector<float> m_cos;
+	std::vector<float> m_sin;
+
+	/**
+	 * The twiddle factors to split the complex transform into the real one.
+	 */
+	std::vector<float> m_split_cos;
+	std::vector<float> m_split_sin;
+
+	/**
+	 * The complex samples being transformed.
+	 */
+	std::vector<float> m_re;
+	std::vector<float> m_im;
+
+	/**
+	 * Transforms m_re and m_im in place.
+	 * \param inverse Whether to calculate the inverse transform, not scaled.
+	 */
+	void transform(bool inverse);
+
+	// hide copy constructor and operator=
+	AUD_FFT(const AUD_FFT&);
+	AUD_FFT& operator=(const AUD_FFT&);
+
+public:
+	/**
+	 * Creates a new fast fourier transform.
+	 * \param size The count of real samples, has to be a power of two and
+	 *             at least 4.
+	 */
+	AUD_FFT(int size);
+
+	/**
+	 * Returns the count of real samples.
+	 */
+	int getSize() const;
+
+	/**
+	 * Returns the count of complex frequency bins, half the size plus one.
+	 */
+	int getBins() const;
+
+	/**
+	 * Transforms real samples to their spectrum.
+	 * \param in The getSize() samples.
+	 * \param[out] re The real parts of the getBins() bins.
+	 * \param[out] im The imaginary parts of the getBins() bins.
+	 */
+	void forward(const sample_t* in, float* re, float* im);
+
+	/**
+	 * Transforms a spectrum back to real samples.
+	 * \param re The real parts of the getBins() bins.
+	 * \param im The imaginary parts of the getBins() bins.
+	 * \param[out] out The getSize() samples.
+	 */
+	void inverse(const float* re, const float* im, sample_t* out);
+};
+
+#endif //__AUD_FFT_H__
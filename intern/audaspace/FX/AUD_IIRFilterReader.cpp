@@ -56,6 +56,27 @@ sample_t AUD_IIRFilterReader::filter()
 	return out;
 }
 
+void AUD_IIRFilterReader::filterBlock(const sample_t* in, sample_t* out, int length)
+{
+	// same as filter() for every sample, without the virtual calls
+	const float* a = m_a.empty() ? NULL : &m_a[0];
+	const float* b = m_b.empty() ? NULL : &m_b[0];
+	int alen = m_a.size();
+	int blen = m_b.size();
+
+	for(int i = 0; i < length; i++)
+	{
+		sample_t value = 0;
+
+		for(int j = 1; j < alen; j++)
+			value -= out[i - j] * a[j];
+		for(int j = 0; j < blen; j++)
+			value += in[i - j] * b[j];
+
+		out[i] = value;
+	}
+}
+
 void AUD_IIRFilterReader::setCoefficients(const std::vector<float>& b,
 										  const std::vector<float>& a)
 {
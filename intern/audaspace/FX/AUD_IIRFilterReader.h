@@ -54,6 +54,9 @@ private:
 	AUD_IIRFilterReader(const AUD_IIRFilterReader&);
 	AUD_IIRFilterReader& operator=(const AUD_IIRFilterReader&);
 
+protected:
+	virtual void filterBlock(const sample_t* in, sample_t* out, int length);
+
 public:
 	/**
 	 * Creates a new IIR filter reader.
@@ -50,6 +50,7 @@
 #include "AUD_SuperposeFactory.h"
 #include "AUD_VolumeFactory.h"
 #include "AUD_IIRFilterFactory.h"
+#include "AUD_ConvolverFactory.h"
 
 #ifdef WITH_SDL
 #include "AUD_SDLDevice.h"
@@ -928,6 +929,76 @@ Factory_filter(Factory* self, PyObject *args)
 	return (PyObject *)parent;
 }
 
+PyDoc_STRVAR(M_aud_Factory_convolve_doc,
+			 "convolve(impulse, block_size=512)\n\n"
+			 "Convolves a factory with an impulse response, for example to "
+			 "add the reverb of a room or to apply a long FIR filter.\n\n"
+			 ":arg impulse: The impulse response, if it has less channels "
+			 "than the factory, its last channel is used for the remaining "
+			 "ones.\n"
+			 ":type impulse: :class:`Factory`\n"
+			 ":arg block_size: The count of samples processed at once, "
+			 "rounded up to a power of two, at most 65536. Larger blocks are "
+			 "faster for long impulse responses but read further ahead of the "
+			 "playback.\n"
+			 ":type block_size: int\n"
+			 ":return: The created :class:`Factory` object.\n"
+			 ":rtype: :class:`Factory`\n\n"
+			 ".. note:: The impulse response is decoded whenever the factory "
+			 "is played, buffer it if it's read from a file.");
+
+static PyObject *
+Factory_convolve(Factory* self, PyObject *args)
+{
+	PyObject *object;
+	int block_size = 512;
+
+	if(!PyArg_ParseTuple(args, "O|i:convolve", &object, &block_size))
+		return NULL;
+
+	PyTypeObject* type = Py_TYPE(self);
+
+	if(!PyObject_TypeCheck(object, type))
+	{
+		PyErr_SetString(PyExc_TypeError, "Object has to be of type Factory!");
+		return NULL;
+	}
+
+	if(block_size <= 0)
+	{
+		PyErr_SetString(PyExc_ValueError, "The block size has to be positive!");
+		return NULL;
+	}
+
+	if(block_size > AUD_CONVOLVER_MAX_BLOCK)
+	{
+		PyErr_SetString(PyExc_ValueError, "The block size can't be larger than 65536!");
+		return NULL;
+	}
+
+	Factory *parent;
+	Factory *impulse = (Factory*)object;
+
+	parent = (Factory*)type->tp_alloc(type, 0);
+	if(parent != NULL)
+	{
+		parent->child_list = Py_BuildValue("(OO)", self, object);
+
+		try
+		{
+			parent->factory = new boost::shared_ptr<AUD_IFactory>(new AUD_ConvolverFactory(*reinterpret_cast<boost::shared_ptr<AUD_IFactory>*>(self->factory), *reinterpret_cast<boost::shared_ptr<AUD_IFactory>*>(impulse->factory), block_size));
+		}
+		catch(AUD_Exception& e)
+		{
+			Py_DECREF(parent);
+			PyErr_SetString(AUDError, e.str);
+			return NULL;
+		}
+	}
+
+	return (PyObject *)parent;
+}
+
 static PyMethodDef Factory_methods[] = {
 	{"sine", (PyCFunction)Factory_sine, METH_VARARGS | METH_CLASS,
 	 M_aud_Factory_sine_doc
@@ -983,6 +1054,9 @@ static PyMethodDef Factory_methods[] = {
 	{"filter", (PyCFunction)Factory_filter, METH_VARARGS,
 	 M_aud_Factory_filter_doc
 	},
+	{"convolve", (PyCFunction)Factory_convolve, METH_VARARGS,
+	 M_aud_Factory_convolve_doc
+	},
 	{NULL}  /* Sentinel */
 };
 
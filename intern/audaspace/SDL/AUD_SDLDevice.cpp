@@ -80,6 +80,9 @@ AUD_SDLDevice::AUD_SDLDevice(AUD_DeviceSpecs specs, int buffersize)
 	}
 
 	create();
+
+	// the SDL callback runs on the audio thread, decode there as little as possible
+	setPrefetch(true);
 }
 
 AUD_SDLDevice::~AUD_SDLDevice()
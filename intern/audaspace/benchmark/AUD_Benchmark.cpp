@@ -0,0 +1,255 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/benchmark/AUD_Benchmark.cpp
+ *  \ingroup audaspace
+ */
+
+/* Times the sample loops for every instruction set the CPU supports and
+ * checks that the results are byte for byte the same as the scalar ones.
+ *
+ * ./audaspace_benchmark [seconds] [sounds]
+ */
+
+#include "AUD_ChannelMapperFactory.h"
+#include "AUD_ConverterFunctions.h"
+#include "AUD_IHandle.h"
+#include "AUD_ReadDevice.h"
+#include "AUD_SIMD.h"
+#include "AUD_SinusFactory.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#define AUD_BENCHMARK_SAMPLES (AUD_DEFAULT_BUFFER_SIZE * 2)
+
+static const char *level_names[] = {"none", "sse2", "avx"};
+
+typedef void (*kernel_function)(std::vector<unsigned char>& target, const std::vector<unsigned char>& source);
+
+static void kernel_s16_float(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	/* in place like the converter reader */
+	std::memcpy(&target[0], &source[0], AUD_BENCHMARK_SAMPLES * sizeof(int16_t));
+	AUD_convert_s16_float(&target[0], &target[0], AUD_BENCHMARK_SAMPLES);
+}
+
+static void kernel_s32_float(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	AUD_convert_s32_float(&target[0], (data_t*)&source[0], AUD_BENCHMARK_SAMPLES);
+}
+
+static void kernel_float_s16(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	AUD_convert_float_s16(&target[0], (data_t*)&source[0], AUD_BENCHMARK_SAMPLES);
+}
+
+static void kernel_float_s32(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	AUD_convert_float_s32(&target[0], (data_t*)&source[0], AUD_BENCHMARK_SAMPLES);
+}
+
+static void kernel_mix(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	/* odd length for the scalar rest */
+	std::memset(&target[0], 0, AUD_BENCHMARK_SAMPLES * sizeof(sample_t));
+	AUD_mix_samples((sample_t*)&target[0], (const sample_t*)&source[0], AUD_BENCHMARK_SAMPLES - 3, 0.7f);
+	AUD_mix_samples((sample_t*)&target[0], (const sample_t*)&source[0] + 1, AUD_BENCHMARK_SAMPLES - 3, 0.3f);
+}
+
+static void kernel_volume(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	std::memcpy(&target[0], &source[0], AUD_BENCHMARK_SAMPLES * sizeof(sample_t));
+	AUD_volume_samples((sample_t*)&target[0], AUD_BENCHMARK_SAMPLES - 5, 0.9f);
+}
+
+static void kernel_spectra(std::vector<unsigned char>& target, const std::vector<unsigned char>& source)
+{
+	/* four spectra of odd length in the source, two in the target */
+	const int bins = AUD_BENCHMARK_SAMPLES / 4 - 1;
+	const float* s = (const float*)&source[0];
+	float* t = (float*)&target[0];
+
+	std::memset(t, 0, AUD_BENCHMARK_SAMPLES * sizeof(float));
+	AUD_multiply_add_spectra(t, t + bins, s, s + bins, s + 2 * bins, s + 3 * bins, bins);
+	AUD_multiply_add_spectra(t, t + bins, s + 3 * bins, s + 2 * bins, s + bins, s, bins);
+}
+
+static const struct {
+	const char *name;
+	kernel_function function;
+} kernels[] = {
+	{"convert s16 float", kernel_s16_float},
+	{"convert s32 float", kernel_s32_float},
+	{"convert float s16", kernel_float_s16},
+	{"convert float s32", kernel_float_s32},
+	{"mix", kernel_mix},
+	{"volume", kernel_volume},
+	{"spectra", kernel_spectra},
+};
+
+static double seconds_since(clock_t start)
+{
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* floats between -1.25 and 1.25 so the converters clamp too, the integer
+ * converters read the same bytes as integer samples */
+static void fill_source(std::vector<unsigned char>& source)
+{
+	float* f = (float*)&source[0];
+	int count = source.size() / sizeof(float);
+
+	srand(0);
+
+	for(int i = 0; i < count; i++)
+		f[i] = (rand() / float(RAND_MAX)) * 2.5f - 1.25f;
+
+	f[0] = -1.0f;
+	f[1] = 1.0f;
+	f[2] = 0.0f;
+}
+
+static bool benchmark_kernels(int iterations, int levels)
+{
+	std::vector<unsigned char> source(AUD_BENCHMARK_SAMPLES * sizeof(sample_t));
+	std::vector<unsigned char> reference(source.size());
+	std::vector<unsigned char> target(source.size());
+	bool identical = true;
+
+	fill_source(source);
+
+	printf("%-20s", "kernel");
+	for(int level = 0; level <= levels; level++)
+		printf("%12s", level_names[level]);
+	printf("\n");
+
+	for(unsigned int k = 0; k < sizeof(kernels) / sizeof(*kernels); k++)
+	{
+		printf("%-20s", kernels[k].name);
+
+		for(int level = 0; level <= levels; level++)
+		{
+			AUD_setSIMDLevel((AUD_SIMDLevel)level);
+
+			clock_t start = clock();
+			for(int i = 0; i < iterations; i++)
+				kernels[k].function(target, source);
+			double time = seconds_since(start);
+
+			if(level == AUD_SIMD_NONE)
+				reference = target;
+
+			bool same = target == reference;
+			identical = identical && same;
+
+			printf("%11.3fs%s", time, same ? "" : "!");
+		}
+
+		printf("\n");
+	}
+
+	return identical;
+}
+
+static bool benchmark_device(float seconds, int sounds, int levels)
+{
+	AUD_DeviceSpecs specs;
+	specs.rate = AUD_RATE_48000;
+	specs.channels = AUD_CHANNELS_STEREO;
+	specs.format = AUD_FORMAT_S16;
+
+	AUD_DeviceSpecs stereo;
+	stereo.rate = AUD_RATE_44100;
+	stereo.channels = AUD_CHANNELS_STEREO;
+	stereo.format = AUD_FORMAT_FLOAT32;
+
+	int length = seconds * specs.rate;
+	std::vector<unsigned char> reference;
+	bool identical = true;
+
+	printf("\nmixing %d sounds, %.0f seconds, 44.1 kHz to 48 kHz\n", sounds, seconds);
+
+	for(int level = 0; level <= levels; level++)
+	{
+		AUD_setSIMDLevel((AUD_SIMDLevel)level);
+
+		AUD_ReadDevice device(specs);
+		device.setQuality(true);
+
+		for(int i = 0; i < sounds; i++)
+		{
+			boost::shared_ptr<AUD_IFactory> sinus(new AUD_SinusFactory(110.0f + 20.0f * i, AUD_RATE_44100));
+
+			/* the stereo sounds take the stereo resampling path */
+			if(i % 4)
+				sinus = boost::shared_ptr<AUD_IFactory>(new AUD_ChannelMapperFactory(sinus, stereo));
+
+			boost::shared_ptr<AUD_IHandle> handle = device.play(sinus);
+			handle->setVolume(1.0f / sounds);
+			handle->setPitch(1.0f + (i % 3) * 0.05f);
+		}
+
+		std::vector<unsigned char> output(length * AUD_DEVICE_SAMPLE_SIZE(specs));
+
+		clock_t start = clock();
+		for(int position = 0; position < length; position += AUD_DEFAULT_BUFFER_SIZE)
+		{
+			int len = AUD_MIN(AUD_DEFAULT_BUFFER_SIZE, length - position);
+			device.read(&output[position * AUD_DEVICE_SAMPLE_SIZE(specs)], len);
+		}
+		double time = seconds_since(start);
+
+		if(level == AUD_SIMD_NONE)
+			reference = output;
+
+		bool same = output == reference;
+		identical = identical && same;
+
+		printf("%-20s%11.3fs %8.1fx realtime%s\n", level_names[level], time, seconds / time, same ? "" : ", differs!");
+	}
+
+	return identical;
+}
+
+int main(int argc, const char **argv)
+{
+	float seconds = argc > 1 ? atof(argv[1]) : 60.0f;
+	int sounds = argc > 2 ? atoi(argv[2]) : 32;
+	int levels = AUD_getSIMDLevel();
+
+	bool identical = benchmark_kernels(100000, levels);
+	identical = benchmark_device(seconds, sounds, levels) && identical;
+
+	if(!identical)
+	{
+		printf("\nresults differ from the scalar loops\n");
+		return 1;
+	}
+
+	return 0;
+}
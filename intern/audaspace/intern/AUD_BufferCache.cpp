@@ -0,0 +1,432 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_BufferCache.cpp
+ *  \ingroup audaspaceintern
+ */
+
+
+#include "AUD_BufferCache.h"
+#include "AUD_Buffer.h"
+#include "AUD_BufferReader.h"
+#include "AUD_ChannelMapperFactory.h"
+#include "AUD_FileFactory.h"
+#include "AUD_MappedBuffer.h"
+#include "AUD_MutexLock.h"
+#include "AUD_StreamBufferFactory.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#define AUD_HASH_BLOCK_SIZE 65536
+
+/* 64 bit FNV-1a */
+static uint64_t AUD_hash(uint64_t hash, const data_t* data, size_t size)
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+static std::string AUD_hash_key(uint64_t hash, uint64_t size)
+{
+	char key[40];
+	sprintf(key, "%016llx%08llx", (unsigned long long)hash, (unsigned long long)size);
+	return key;
+}
+
+AUD_BufferCache::AUD_BufferCache() :
+	m_limit(0)
+{
+	std::memset(&m_statistics, 0, sizeof(m_statistics));
+
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+	pthread_mutex_init(&m_mutex, &attr);
+
+	pthread_mutexattr_destroy(&attr);
+}
+
+AUD_BufferCache::~AUD_BufferCache()
+{
+	while(!m_entries.empty())
+		remove(m_entries.begin()->first);
+
+	pthread_mutex_destroy(&m_mutex);
+}
+
+AUD_BufferCache& AUD_BufferCache::getInstance()
+{
+	// never destroyed, factories may still release sounds at exit
+	static AUD_BufferCache* cache = new AUD_BufferCache();
+	return *cache;
+}
+
+std::string AUD_BufferCache::getKey(boost::shared_ptr<AUD_IFactory> factory)
+{
+	AUD_FileFactory* file = dynamic_cast<AUD_FileFactory*>(factory.get());
+
+	if(file)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		boost::shared_ptr<AUD_Buffer> buffer = file->getBuffer();
+
+		if(buffer.get())
+		{
+			hash = AUD_hash(hash, (data_t*)buffer->getBuffer(), buffer->getSize());
+			return AUD_hash_key(hash, buffer->getSize());
+		}
+
+		FILE* f = fopen(file->getFilename().c_str(), "rb");
+
+		if(!f)
+			return "";
+
+		AUD_Buffer block(AUD_HASH_BLOCK_SIZE);
+		uint64_t size = 0;
+		size_t len;
+
+		while((len = fread(block.getBuffer(), 1, AUD_HASH_BLOCK_SIZE, f)) > 0)
+		{
+			hash = AUD_hash(hash, (data_t*)block.getBuffer(), len);
+			size += len;
+		}
+
+		bool error = ferror(f) != 0;
+		fclose(f);
+
+		if(error)
+			return "";
+
+		return AUD_hash_key(hash, size);
+	}
+
+	AUD_ChannelMapperFactory* mapper = dynamic_cast<AUD_ChannelMapperFactory*>(factory.get());
+
+	if(mapper)
+	{
+		std::string key = getKey(mapper->getFactory());
+
+		if(key.empty())
+			return "";
+
+		char channels[16];
+		sprintf(channels, "c%d", mapper->getSpecs().channels);
+		return key + channels;
+	}
+
+	return "";
+}
+
+void AUD_BufferCache::touch(const std::string& key)
+{
+	m_recent.remove(key);
+	m_recent.push_front(key);
+}
+
+void AUD_BufferCache::evict(const std::string& keep)
+{
+	if(m_limit == 0)
+		return;
+
+	std::list<std::string>::iterator it = m_recent.end();
+
+	while(m_statistics.memory > m_limit && it != m_recent.begin())
+	{
+		--it;
+
+		if(*it == keep)
+			continue;
+
+		std::string key = *it;
+		Entry& entry = m_entries[key];
+
+		// sounds in use can only be removed if spilled, decoding them
+		// again would block the thread creating the next reader
+		if(entry.users > 0 && m_spillPath.empty())
+			continue;
+
+		if(!m_spillPath.empty() && !entry.spilled)
+		{
+			FILE* f = fopen(getSpillFilename(key).c_str(), "wb");
+
+			if(f)
+			{
+				entry.spilled = fwrite(entry.buffer->getBuffer(), 1, entry.size, f) == (size_t)entry.size;
+
+				if(fclose(f) != 0)
+					entry.spilled = false;
+
+				if(entry.spilled)
+					m_statistics.spilled += entry.size;
+				else
+					std::remove(getSpillFilename(key).c_str());
+			}
+
+			if(entry.users > 0 && !entry.spilled)
+				continue;
+		}
+
+		entry.buffer.reset();
+		m_statistics.memory -= entry.size;
+		m_statistics.evictions++;
+
+		it = m_recent.erase(it);
+
+		if(entry.users == 0 && !entry.spilled)
+			remove(key);
+	}
+}
+
+void AUD_BufferCache::remove(const std::string& key)
+{
+	std::map<std::string, Entry>::iterator it = m_entries.find(key);
+
+	if(it == m_entries.end())
+		return;
+
+	Entry& entry = it->second;
+
+	if(entry.buffer.get())
+	{
+		m_statistics.memory -= entry.size;
+		m_recent.remove(key);
+	}
+
+	if(entry.spilled)
+	{
+		entry.mapped.reset();
+		std::remove(getSpillFilename(key).c_str());
+		m_statistics.spilled -= entry.size;
+	}
+
+	m_entries.erase(it);
+	m_statistics.sounds--;
+}
+
+std::string AUD_BufferCache::getSpillFilename(const std::string& key) const
+{
+	char name[32];
+	sprintf(name, "aud_%d_", (int)getpid());
+
+	return m_spillPath + "/" + name + key + ".pcm";
+}
+
+void AUD_BufferCache::setLimit(size_t limit)
+{
+	AUD_MutexLock lock(*this);
+
+	m_limit = limit;
+
+	if(m_limit == 0)
+		clear();
+	else
+		evict("");
+}
+
+void AUD_BufferCache::setSpillPath(const std::string& path)
+{
+	AUD_MutexLock lock(*this);
+
+	if(path == m_spillPath)
+		return;
+
+	// the spill files are named after the old path
+	std::map<std::string, Entry>::iterator it = m_entries.begin();
+
+	while(it != m_entries.end())
+	{
+		std::string key = (it++)->first;
+		Entry& entry = m_entries[key];
+
+		if(!entry.spilled)
+			continue;
+
+		if(entry.users == 0)
+			remove(key);
+		else
+		{
+			entry.mapped.reset();
+			std::remove(getSpillFilename(key).c_str());
+			m_statistics.spilled -= entry.size;
+			entry.spilled = false;
+		}
+	}
+
+	m_spillPath = path;
+}
+
+AUD_Specs AUD_BufferCache::acquire(const std::string& key, boost::shared_ptr<AUD_IFactory> factory)
+{
+	{
+		AUD_MutexLock lock(*this);
+
+		std::map<std::string, Entry>::iterator it = m_entries.find(key);
+
+		if(it != m_entries.end())
+		{
+			it->second.users++;
+			m_statistics.hits++;
+
+			if(it->second.buffer.get())
+				touch(key);
+
+			return it->second.specs;
+		}
+	}
+
+	// decode without the lock, other sounds can be played meanwhile
+	AUD_Specs specs;
+	boost::shared_ptr<AUD_Buffer> buffer = AUD_StreamBufferFactory::decode(factory, specs);
+
+	AUD_MutexLock lock(*this);
+
+	m_statistics.misses++;
+
+	std::map<std::string, Entry>::iterator it = m_entries.find(key);
+
+	// decoded by another thread meanwhile
+	if(it != m_entries.end())
+	{
+		it->second.users++;
+		return it->second.specs;
+	}
+
+	Entry& entry = m_entries[key];
+	entry.specs = specs;
+	entry.size = buffer->getSize();
+	entry.buffer = buffer;
+	entry.spilled = false;
+	entry.users = 1;
+
+	m_statistics.sounds++;
+	m_statistics.memory += entry.size;
+	m_recent.push_front(key);
+
+	evict(key);
+
+	return specs;
+}
+
+void AUD_BufferCache::release(const std::string& key)
+{
+	AUD_MutexLock lock(*this);
+
+	std::map<std::string, Entry>::iterator it = m_entries.find(key);
+
+	if(it == m_entries.end())
+		return;
+
+	it->second.users--;
+
+	// without a limit unused sounds aren't kept
+	if(it->second.users <= 0 && m_limit == 0)
+		remove(key);
+}
+
+boost::shared_ptr<AUD_IReader> AUD_BufferCache::createReader(const std::string& key, boost::shared_ptr<AUD_IFactory> factory)
+{
+	AUD_MutexLock lock(*this);
+
+	std::map<std::string, Entry>::iterator it = m_entries.find(key);
+
+	if(it == m_entries.end())
+		AUD_THROW(AUD_ERROR_PROPS, "AUD_BufferCache: The sound isn't cached.");
+
+	Entry& entry = it->second;
+
+	if(entry.buffer.get())
+	{
+		touch(key);
+		return boost::shared_ptr<AUD_IReader>(new AUD_BufferReader(entry.buffer, entry.specs));
+	}
+
+	if(entry.spilled)
+	{
+		if(!entry.mapped.get())
+		{
+			try
+			{
+				entry.mapped = boost::shared_ptr<AUD_MappedBuffer>(new AUD_MappedBuffer(getSpillFilename(key)));
+				m_statistics.spill_reads++;
+			}
+			catch(AUD_Exception&)
+			{
+			}
+		}
+
+		if(entry.mapped.get() && entry.mapped->getSize() == entry.size)
+			return boost::shared_ptr<AUD_IReader>(new AUD_BufferReader(entry.mapped, entry.specs));
+	}
+
+	// the spill file can't be read, the sound is streamed, as decoding it
+	// here would block the cache and the thread playing it
+	return factory->createReader();
+}
+
+void AUD_BufferCache::clear()
+{
+	AUD_MutexLock lock(*this);
+
+	std::map<std::string, Entry>::iterator it = m_entries.begin();
+
+	while(it != m_entries.end())
+	{
+		std::string key = (it++)->first;
+
+		if(m_entries[key].users <= 0)
+			remove(key);
+	}
+}
+
+AUD_BufferCacheStatistics AUD_BufferCache::getStatistics()
+{
+	AUD_MutexLock lock(*this);
+
+	return m_statistics;
+}
+
+void AUD_BufferCache::lock()
+{
+	pthread_mutex_lock(&m_mutex);
+}
+
+void AUD_BufferCache::unlock()
+{
+	pthread_mutex_unlock(&m_mutex);
+}
@@ -0,0 +1,197 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_BufferCache.h
+ *  \ingroup audaspaceintern
+ */
+
+
+#ifndef __AUD_BUFFERCACHE_H__
+#define __AUD_BUFFERCACHE_H__
+
+#include "AUD_IFactory.h"
+#include "AUD_ILockable.h"
+
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <pthread.h>
+#include <string>
+
+class AUD_Buffer;
+class AUD_MappedBuffer;
+
+/**
+ * This class caches decoded sounds for the whole process, so every stream
+ * buffer factory of the same content shares one buffer. The buffers are kept
+ * within a memory limit, the least recently used ones are removed first.
+ * Removed buffers can be written to spill files, which are memory mapped when
+ * the sound is read again. Without spill files only unused sounds are removed,
+ * they are decoded again when used again.
+ * \warning The memory of a removed buffer is only freed after the readers
+ *          currently reading it are destroyed.
+ */
+class AUD_BufferCache : public AUD_ILockable
+{
+private:
+	/// A cached sound.
+	struct Entry
+	{
+		/// The specification of the samples.
+		AUD_Specs specs;
+
+		/// The size of the samples in bytes.
+		int size;
+
+		/// The samples, NULL if removed from memory.
+		boost::shared_ptr<AUD_Buffer> buffer;
+
+		/// The mapped spill file, NULL if not mapped.
+		boost::shared_ptr<AUD_MappedBuffer> mapped;
+
+		/// Whether the samples were written to the spill file.
+		bool spilled;
+
+		/// The count of stream buffer factories using the sound.
+		int users;
+	};
+
+	/// The cached sounds by their key.
+	std::map<std::string, Entry> m_entries;
+
+	/// The keys of the sounds in memory, the most recently used first.
+	std::list<std::string> m_recent;
+
+	/// The memory limit in bytes, 0 for no limit.
+	size_t m_limit;
+
+	/// The directory for spill files, empty if sounds aren't spilled.
+	std::string m_spillPath;
+
+	/// The statistics, the sizes are the current ones.
+	AUD_BufferCacheStatistics m_statistics;
+
+	/// The mutex for locking.
+	pthread_mutex_t m_mutex;
+
+	/**
+	 * Marks a sound in memory as the most recently used.
+	 * \param key The key of the sound.
+	 */
+	void touch(const std::string& key);
+
+	/**
+	 * Removes sounds from memory until the memory is within the limit.
+	 * \param keep The key of a sound not to remove.
+	 */
+	void evict(const std::string& keep);
+
+	/**
+	 * Removes a sound from the cache and deletes its spill file.
+	 * \param key The key of the sound.
+	 */
+	void remove(const std::string& key);
+
+	/**
+	 * Returns the path of the spill file of a sound.
+	 * \param key The key of the sound.
+	 */
+	std::string getSpillFilename(const std::string& key) const;
+
+	AUD_BufferCache();
+
+	// hide copy constructor and operator=
+	AUD_BufferCache(const AUD_BufferCache&);
+	AUD_BufferCache& operator=(const AUD_BufferCache&);
+
+public:
+	virtual ~AUD_BufferCache();
+
+	/**
+	 * Returns the cache of the process.
+	 */
+	static AUD_BufferCache& getInstance();
+
+	/**
+	 * Returns the key of the content a factory creates.
+	 * Only file factories and channel mappers of them have a key, the content
+	 * of the file is hashed, so the same sound packed and unpacked has the
+	 * same key.
+	 * \param factory The factory.
+	 * \return The key, empty if the content can't be identified.
+	 */
+	static std::string getKey(boost::shared_ptr<AUD_IFactory> factory);
+
+	/**
+	 * Sets the memory limit.
+	 * \param limit The limit in bytes, 0 for no limit, then sounds are only
+	 *        kept while they are used and the unused ones are removed.
+	 */
+	void setLimit(size_t limit);
+
+	/**
+	 * Sets the directory for spill files.
+	 * \param path The directory, empty to decode removed sounds again.
+	 */
+	void setSpillPath(const std::string& path);
+
+	/**
+	 * Adds a user of a sound, decoding it if it's not cached.
+	 * \param key The key of the sound.
+	 * \param factory The factory creating the sound.
+	 * \return The specification of the decoded samples.
+	 * \exception AUD_Exception Thrown if the reader cannot be created.
+	 */
+	AUD_Specs acquire(const std::string& key, boost::shared_ptr<AUD_IFactory> factory);
+
+	/**
+	 * Removes a user of a sound.
+	 * \param key The key of the sound.
+	 */
+	void release(const std::string& key);
+
+	/**
+	 * Creates a reader of a cached sound.
+	 * \param key The key of the sound, it has to be acquired.
+	 * \param factory The factory creating the sound, which is streamed if
+	 *        the spill file can't be read.
+	 * \return The reader.
+	 */
+	boost::shared_ptr<AUD_IReader> createReader(const std::string& key, boost::shared_ptr<AUD_IFactory> factory);
+
+	/**
+	 * Removes the sounds nobody uses and their spill files.
+	 */
+	void clear();
+
+	/**
+	 * Returns the statistics of the cache.
+	 */
+	AUD_BufferCacheStatistics getStatistics();
+
+	virtual void lock();
+	virtual void unlock();
+};
+
+#endif //__AUD_BUFFERCACHE_H__
@@ -29,6 +29,7 @@
 
 #include "AUD_BufferReader.h"
 #include "AUD_Buffer.h"
+#include "AUD_MappedBuffer.h"
 #include "AUD_Space.h"
 
 #include <cstring>
@@ -39,6 +40,26 @@ AUD_BufferReader::AUD_BufferReader(boost::shared_ptr<AUD_Buffer> buffer,
 {
 }
 
+AUD_BufferReader::AUD_BufferReader(boost::shared_ptr<AUD_MappedBuffer> buffer,
+								   AUD_Specs specs) :
+	m_position(0), m_mapped(buffer), m_specs(specs)
+{
+}
+
+sample_t* AUD_BufferReader::getSamples() const
+{
+	if(m_buffer.get())
+		return m_buffer->getBuffer();
+	return m_mapped->getBuffer();
+}
+
+int AUD_BufferReader::getSize() const
+{
+	if(m_buffer.get())
+		return m_buffer->getSize();
+	return m_mapped->getSize();
+}
+
 bool AUD_BufferReader::isSeekable() const
 {
 	return true;
@@ -51,7 +72,7 @@ void AUD_BufferReader::seek(int position)
 
 int AUD_BufferReader::getLength() const
 {
-	return m_buffer->getSize() / AUD_SAMPLE_SIZE(m_specs);
+	return getSize() / AUD_SAMPLE_SIZE(m_specs);
 }
 
 int AUD_BufferReader::getPosition() const
@@ -70,12 +91,12 @@ void AUD_BufferReader::read(int& length, bool& eos, sample_t* buffer)
 
 	int sample_size = AUD_SAMPLE_SIZE(m_specs);
 
-	sample_t* buf = m_buffer->getBuffer() + m_position * m_specs.channels;
+	sample_t* buf = getSamples() + m_position * m_specs.channels;
 
 	// in case the end of the buffer is reached
-	if(m_buffer->getSize() < (m_position + length) * sample_size)
+	if(getSize() < (m_position + length) * sample_size)
 	{
-		length = m_buffer->getSize() / sample_size - m_position;
+		length = getSize() / sample_size - m_position;
 		eos = true;
 	}
 
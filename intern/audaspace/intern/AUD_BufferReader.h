@@ -32,6 +32,7 @@
 
 #include "AUD_IReader.h"
 class AUD_Buffer;
+class AUD_MappedBuffer;
 
 #include <boost/shared_ptr.hpp>
 
@@ -53,6 +54,11 @@ private:
 	 */
 	boost::shared_ptr<AUD_Buffer> m_buffer;
 
+	/**
+	 * The mapped file that is read instead of a buffer.
+	 */
+	boost::shared_ptr<AUD_MappedBuffer> m_mapped;
+
 	/**
 	 * The specification of the sample data in the buffer.
 	 */
@@ -62,6 +68,16 @@ private:
 	AUD_BufferReader(const AUD_BufferReader&);
 	AUD_BufferReader& operator=(const AUD_BufferReader&);
 
+	/**
+	 * Returns the samples that are read.
+	 */
+	sample_t* getSamples() const;
+
+	/**
+	 * Returns the size of the samples that are read in bytes.
+	 */
+	int getSize() const;
+
 public:
 	/**
 	 * Creates a new buffer reader.
@@ -70,6 +86,13 @@ public:
 	 */
 	AUD_BufferReader(boost::shared_ptr<AUD_Buffer> buffer, AUD_Specs specs);
 
+	/**
+	 * Creates a new buffer reader.
+	 * \param buffer The mapped file to read from.
+	 * \param specs The specification of the sample data in the file.
+	 */
+	AUD_BufferReader(boost::shared_ptr<AUD_MappedBuffer> buffer, AUD_Specs specs);
+
 	virtual bool isSeekable() const;
 	virtual void seek(int position);
 	virtual int getLength() const;
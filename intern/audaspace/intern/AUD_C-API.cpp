@@ -48,6 +48,7 @@
 #include "AUD_FileFactory.h"
 #include "AUD_FileWriter.h"
 #include "AUD_StreamBufferFactory.h"
+#include "AUD_BufferCache.h"
 #include "AUD_DelayFactory.h"
 #include "AUD_LimiterFactory.h"
 #include "AUD_PingPongFactory.h"
@@ -66,6 +67,7 @@
 #include "AUD_IReader.h"
 #include "AUD_SequencerFactory.h"
 #include "AUD_SequencerEntry.h"
+#include "AUD_SequencerReader.h"
 #include "AUD_SilenceFactory.h"
 #include "AUD_MutexLock.h"
 
@@ -118,6 +120,9 @@ void AUD_initOnce()
 
 void AUD_exitOnce()
 {
+	// removes the spill files
+	AUD_BufferCache::getInstance().clear();
+
 #ifdef WITH_JACK
 	AUD_jack_exit();
 #endif
@@ -288,6 +293,16 @@ void AUD_unlock()
 	AUD_device->unlock();
 }
 
+void AUD_getUnderruns(int *underruns, int *dropouts)
+{
+	AUD_SoftwareDevice *device = dynamic_cast<AUD_SoftwareDevice *>(AUD_device.get());
+
+	*underruns = *dropouts = 0;
+
+	if (device)
+		device->getUnderruns(*underruns, *dropouts);
+}
+
 AUD_SoundInfo AUD_getInfo(AUD_Sound *sound)
 {
 	assert(sound);
@@ -329,7 +344,7 @@ AUD_Sound *AUD_bufferSound(AUD_Sound *sound)
 	assert(sound);
 
 	try {
-		return new AUD_Sound(new AUD_StreamBufferFactory(*sound));
+		return new AUD_Sound(new AUD_StreamBufferFactory(*sound, AUD_BufferCache::getKey(*sound)));
 	}
 	catch(AUD_Exception&)
 	{
@@ -337,6 +352,19 @@ AUD_Sound *AUD_bufferSound(AUD_Sound *sound)
 	}
 }
 
+void AUD_setBufferCacheLimit(int megabytes, const char *spill_path)
+{
+	AUD_BufferCache& cache = AUD_BufferCache::getInstance();
+
+	cache.setSpillPath(spill_path ? spill_path : "");
+	cache.setLimit(((size_t)AUD_MAX(megabytes, 0)) * 1024 * 1024);
+}
+
+void AUD_getBufferCacheStatistics(AUD_BufferCacheStatistics *statistics)
+{
+	*statistics = AUD_BufferCache::getInstance().getStatistics();
+}
+
 AUD_Sound *AUD_monoSound(AUD_Sound *sound)
 {
 	assert(sound);
@@ -1182,13 +1210,14 @@ void *AUD_getSet(void *set)
 	return NULL;
 }
 
-const char *AUD_mixdown(AUD_Sound *sound, unsigned int start, unsigned int length, unsigned int buffersize, const char *filename, AUD_DeviceSpecs specs, AUD_Container format, AUD_Codec codec, unsigned int bitrate)
+const char *AUD_mixdown(AUD_Sound *sound, unsigned int start, unsigned int length, unsigned int buffersize, const char *filename, AUD_DeviceSpecs specs, AUD_Container format, AUD_Codec codec, unsigned int bitrate, unsigned int threads)
 {
 	try {
 		AUD_SequencerFactory *f = dynamic_cast<AUD_SequencerFactory *>(sound->get());
 
 		f->setSpecs(specs.specs);
 		boost::shared_ptr<AUD_IReader> reader = f->createQualityReader();
+		dynamic_cast<AUD_SequencerReader *>(reader.get())->setThreadCount(threads);
 		reader->seek(start);
 		boost::shared_ptr<AUD_IWriter> writer = AUD_FileWriter::createWriter(filename, specs, format, codec, bitrate);
 		AUD_FileWriter::writeReader(reader, writer, length, buffersize);
@@ -1201,7 +1230,7 @@ const char *AUD_mixdown(AUD_Sound *sound, unsigned int start, unsigned int lengt
 	}
 }
 
-const char *AUD_mixdown_per_channel(AUD_Sound *sound, unsigned int start, unsigned int length, unsigned int buffersize, const char *filename, AUD_DeviceSpecs specs, AUD_Container format, AUD_Codec codec, unsigned int bitrate)
+const char *AUD_mixdown_per_channel(AUD_Sound *sound, unsigned int start, unsigned int length, unsigned int buffersize, const char *filename, AUD_DeviceSpecs specs, AUD_Container format, AUD_Codec codec, unsigned int bitrate, unsigned int threads)
 {
 	try {
 		AUD_SequencerFactory *f = dynamic_cast<AUD_SequencerFactory *>(sound->get());
@@ -1233,6 +1262,7 @@ const char *AUD_mixdown_per_channel(AUD_Sound *sound, unsigned int start, unsign
 		}
 
 		boost::shared_ptr<AUD_IReader> reader = f->createQualityReader();
+		dynamic_cast<AUD_SequencerReader *>(reader.get())->setThreadCount(threads);
 		reader->seek(start);
 		AUD_FileWriter::writeReader(reader, writers, length, buffersize);
 
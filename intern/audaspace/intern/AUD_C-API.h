@@ -94,6 +94,13 @@ extern void AUD_lock(void);
  */
 extern void AUD_unlock(void);
 
+/**
+ * Returns how often sounds weren't decoded ahead far enough for the playback device.
+ * \param underruns How often a sound had to be decoded in the audio callback.
+ * \param dropouts How often a sound was played as silence instead.
+ */
+extern void AUD_getUnderruns(int *underruns, int *dropouts);
+
 /**
  * Returns information about a sound.
  * \param sound The sound to get the info about.
@@ -123,6 +130,21 @@ extern AUD_Sound *AUD_loadBuffer(unsigned char *buffer, int size);
  */
 extern AUD_Sound *AUD_bufferSound(AUD_Sound *sound);
 
+/**
+ * Sets the limits of the cache that buffered sounds of the same content share.
+ * \param megabytes The memory limit, 0 for no limit, then sounds are only
+ *        kept while they are used.
+ * \param spill_path The directory to write sounds removed from memory to,
+ *        NULL to decode them again when needed.
+ */
+extern void AUD_setBufferCacheLimit(int megabytes, const char *spill_path);
+
+/**
+ * Returns the statistics of the buffered sound cache.
+ * \param statistics The statistics to fill in.
+ */
+extern void AUD_getBufferCacheStatistics(AUD_BufferCacheStatistics *statistics);
+
 /**
  * Rechannels the sound to be mono.
  * \param sound The sound to rechannel.
@@ -706,12 +728,13 @@ extern void *AUD_getSet(void *set);
  * \param format The file's container format.
  * \param codec The codec used for encoding the audio data.
  * \param bitrate The bitrate for encoding.
+ * \param threads How many threads read the sounds of the scene.
  * \return An error message or NULL in case of success.
  */
 extern const char *AUD_mixdown(AUD_Sound *sound, unsigned int start, unsigned int length,
                                unsigned int buffersize, const char *filename,
                                AUD_DeviceSpecs specs, AUD_Container format,
-                               AUD_Codec codec, unsigned int bitrate);
+                               AUD_Codec codec, unsigned int bitrate, unsigned int threads);
 
 /**
  * Mixes a sound down into multiple files.
@@ -724,12 +747,13 @@ extern const char *AUD_mixdown(AUD_Sound *sound, unsigned int start, unsigned in
  * \param format The file's container format.
  * \param codec The codec used for encoding the audio data.
  * \param bitrate The bitrate for encoding.
+ * \param threads How many threads read the sounds of the scene.
  * \return An error message or NULL in case of success.
  */
 extern const char *AUD_mixdown_per_channel(AUD_Sound *sound, unsigned int start, unsigned int length,
                                            unsigned int buffersize, const char *filename,
                                            AUD_DeviceSpecs specs, AUD_Container format,
-                                           AUD_Codec codec, unsigned int bitrate);
+                                           AUD_Codec codec, unsigned int bitrate, unsigned int threads);
 
 /**
  * Opens a read device and prepares it for mixdown of the sound scene.
@@ -29,6 +29,7 @@
 
 #include "AUD_ConverterFunctions.h"
 #include "AUD_Buffer.h"
+#include "AUD_SIMD.h"
 
 #define AUD_U8_0		0x80
 #define AUD_S16_MAX		((int16_t)0x7FFF)
@@ -131,6 +132,8 @@ void AUD_convert_s16_s32(data_t* target, data_t* source, int length)
 
 void AUD_convert_s16_float(data_t* target, data_t* source, int length)
 {
+	AUD_SIMD_DISPATCH(AUD_convert_s16_float, (target, source, length))
+
 	int16_t* s = (int16_t*) source;
 	float* t = (float*) target;
 	for(int i = length - 1; i >= 0; i--)
@@ -277,6 +280,8 @@ void AUD_convert_s32_s24_le(data_t* target, data_t* source, int length)
 
 void AUD_convert_s32_float(data_t* target, data_t* source, int length)
 {
+	AUD_SIMD_DISPATCH(AUD_convert_s32_float, (target, source, length))
+
 	int32_t* s = (int32_t*) source;
 	float* t = (float*) target;
 	for(int i = 0; i < length; i++)
@@ -309,6 +314,8 @@ void AUD_convert_float_u8(data_t* target, data_t* source, int length)
 
 void AUD_convert_float_s16(data_t* target, data_t* source, int length)
 {
+	AUD_SIMD_DISPATCH(AUD_convert_float_s16, (target, source, length))
+
 	int16_t* t = (int16_t*) target;
 	float* s = (float*) source;
 	for(int i = 0; i < length; i++)
@@ -360,6 +367,8 @@ void AUD_convert_float_s24_le(data_t* target, data_t* source, int length)
 
 void AUD_convert_float_s32(data_t* target, data_t* source, int length)
 {
+	AUD_SIMD_DISPATCH(AUD_convert_float_s32, (target, source, length))
+
 	int32_t* t = (int32_t*) target;
 	float* s = (float*) source;
 	for(int i = 0; i < length; i++)
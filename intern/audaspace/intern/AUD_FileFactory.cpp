@@ -54,6 +54,16 @@ AUD_FileFactory::AUD_FileFactory(const data_t* buffer, int size) :
 	memcpy(m_buffer->getBuffer(), buffer, size);
 }
 
+std::string AUD_FileFactory::getFilename() const
+{
+	return m_filename;
+}
+
+boost::shared_ptr<AUD_Buffer> AUD_FileFactory::getBuffer() const
+{
+	return m_buffer;
+}
+
 static const char* read_error = "AUD_FileFactory: File couldn't be read.";
 
 boost::shared_ptr<AUD_IReader> AUD_FileFactory::createReader()
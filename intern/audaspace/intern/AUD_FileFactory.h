@@ -70,6 +70,16 @@ public:
 	 */
 	AUD_FileFactory(const data_t* buffer, int size);
 
+	/**
+	 * Returns the sound file path, empty if the factory reads from a buffer.
+	 */
+	std::string getFilename() const;
+
+	/**
+	 * Returns the buffer to read from, NULL if the factory reads a file.
+	 */
+	boost::shared_ptr<AUD_Buffer> getBuffer() const;
+
 	virtual boost::shared_ptr<AUD_IReader> createReader();
 };
 
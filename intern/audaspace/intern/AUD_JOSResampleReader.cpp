@@ -27,6 +27,7 @@
  */
 
 #include "AUD_JOSResampleReader.h"
+#include "AUD_SIMD.h"
 
 #include "AUD_JOSResampleReaderCoeff.cpp"
 
@@ -113,7 +114,7 @@ void AUD_JOSResampleReader::updateBuffer(int size, double factor, int samplesize
 	m_buffer.assureSize((m_cache_valid + size) * samplesize, true);
 }
 
-#define RESAMPLE_METHOD(name, left, right) void AUD_JOSResampleReader::name(double target_factor, int length, sample_t* buffer)\
+#define RESAMPLE_METHOD(name, left, right, stereo) void AUD_JOSResampleReader::name(double target_factor, int length, sample_t* buffer)\
 {\
 	sample_t* buf = m_buffer.getBuffer();\
 \
@@ -147,11 +148,16 @@ void AUD_JOSResampleReader::updateBuffer(int size, double factor, int samplesize
 			eta = fp_rest_to_double(P);\
 			l += m_L * end;\
 \
-			for(i = 0; i <= end; i++)\
+			if(stereo)\
+				AUD_sinc_stereo(sums, data, 2, coeff, l, m_L, eta, end + 1);\
+			else\
 			{\
-				v = coeff[l] + eta * (coeff[l+1] - coeff[l]);\
-				l -= m_L;\
-				left\
+				for(i = 0; i <= end; i++)\
+				{\
+					v = coeff[l] + eta * (coeff[l+1] - coeff[l]);\
+					l -= m_L;\
+					left\
+				}\
 			}\
 \
 			P = int_to_fp(m_L) - P;\
@@ -165,11 +171,16 @@ void AUD_JOSResampleReader::updateBuffer(int size, double factor, int samplesize
 			eta = fp_rest_to_double(P);\
 			l += m_L * end;\
 \
-			for(i = 0; i <= end; i++)\
+			if(stereo)\
+				AUD_sinc_stereo(sums, data - 1, -2, coeff, l, m_L, eta, end + 1);\
+			else\
 			{\
-				v = coeff[l] + eta * (coeff[l+1] - coeff[l]);\
-				l -= m_L;\
-				right\
+				for(i = 0; i <= end; i++)\
+				{\
+					v = coeff[l] + eta * (coeff[l+1] - coeff[l]);\
+					l -= m_L;\
+					right\
+				}\
 			}\
 \
 			for(channel = 0; channel < m_channels; channel++)\
@@ -256,7 +267,7 @@ RESAMPLE_METHOD(resample, {
 					data--;
 				}
 				while(channel);
-})
+}, false)
 
 RESAMPLE_METHOD(resample_mono, {
 				*sums += *data * v;
@@ -264,7 +275,7 @@ RESAMPLE_METHOD(resample_mono, {
 }, {
 				*sums += *data * v;
 				data--;
-})
+}, false)
 
 RESAMPLE_METHOD(resample_stereo, {
 				sums[0] += data[0] * v;
@@ -274,7 +285,7 @@ RESAMPLE_METHOD(resample_stereo, {
 				data-=2;
 				sums[0] += data[1] * v;
 				sums[1] += data[2] * v;
-})
+}, true)
 
 void AUD_JOSResampleReader::seek(int position)
 {
@@ -0,0 +1,122 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_MappedBuffer.cpp
+ *  \ingroup audaspaceintern
+ */
+
+
+#include "AUD_MappedBuffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char* map_error = "AUD_MappedBuffer: File couldn't be mapped.";
+
+#ifdef _WIN32
+
+AUD_MappedBuffer::AUD_MappedBuffer(std::string filename) :
+	m_mapping(NULL), m_size(0), m_handle(NULL)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if(file == INVALID_HANDLE_VALUE)
+		AUD_THROW(AUD_ERROR_FILE, map_error);
+
+	m_size = GetFileSize(file, NULL);
+
+	if(m_size > 0)
+	{
+		m_handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(m_handle)
+			m_mapping = MapViewOfFile(m_handle, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	// the mapping keeps the file open
+	CloseHandle(file);
+
+	if(!m_mapping)
+	{
+		if(m_handle)
+			CloseHandle(m_handle);
+		AUD_THROW(AUD_ERROR_FILE, map_error);
+	}
+}
+
+AUD_MappedBuffer::~AUD_MappedBuffer()
+{
+	UnmapViewOfFile(m_mapping);
+	CloseHandle(m_handle);
+}
+
+#else
+
+AUD_MappedBuffer::AUD_MappedBuffer(std::string filename) :
+	m_mapping(NULL), m_size(0)
+{
+	int file = open(filename.c_str(), O_RDONLY);
+
+	if(file < 0)
+		AUD_THROW(AUD_ERROR_FILE, map_error);
+
+	struct stat info;
+
+	if(fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		m_size = info.st_size;
+		m_mapping = mmap(NULL, m_size, PROT_READ, MAP_SHARED, file, 0);
+		if(m_mapping == MAP_FAILED)
+			m_mapping = NULL;
+	}
+
+	// the mapping keeps the file open
+	close(file);
+
+	if(!m_mapping)
+		AUD_THROW(AUD_ERROR_FILE, map_error);
+}
+
+AUD_MappedBuffer::~AUD_MappedBuffer()
+{
+	munmap(m_mapping, m_size);
+}
+
+#endif
+
+sample_t* AUD_MappedBuffer::getBuffer() const
+{
+	return (sample_t*) m_mapping;
+}
+
+int AUD_MappedBuffer::getSize() const
+{
+	return m_size;
+}
@@ -0,0 +1,83 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_MappedBuffer.h
+ *  \ingroup audaspaceintern
+ */
+
+
+#ifndef __AUD_MAPPEDBUFFER_H__
+#define __AUD_MAPPEDBUFFER_H__
+
+#include "AUD_Space.h"
+
+#include <string>
+
+/**
+ * This class maps a file of samples into memory read only, the operating
+ * system pages it in and out as needed.
+ */
+class AUD_MappedBuffer
+{
+private:
+	/// The mapped memory.
+	void* m_mapping;
+
+	/// The size of the file in bytes.
+	int m_size;
+
+#ifdef _WIN32
+	/// The file mapping object.
+	void* m_handle;
+#endif
+
+	// hide copy constructor and operator=
+	AUD_MappedBuffer(const AUD_MappedBuffer&);
+	AUD_MappedBuffer& operator=(const AUD_MappedBuffer&);
+
+public:
+	/**
+	 * Maps a file.
+	 * \param filename The path of the file.
+	 * \exception AUD_Exception Thrown if the file cannot be mapped.
+	 */
+	AUD_MappedBuffer(std::string filename);
+
+	/**
+	 * Unmaps the file.
+	 */
+	~AUD_MappedBuffer();
+
+	/**
+	 * Returns a pointer to the mapped samples, it's page aligned.
+	 */
+	sample_t* getBuffer() const;
+
+	/**
+	 * Returns the size of the file in bytes.
+	 */
+	int getSize() const;
+};
+
+#endif //__AUD_MAPPEDBUFFER_H__
@@ -29,6 +29,7 @@
 
 #include "AUD_Mixer.h"
 #include "AUD_IReader.h"
+#include "AUD_SIMD.h"
 
 #include <cstring>
 
@@ -91,16 +92,14 @@ void AUD_Mixer::mix(sample_t* buffer, int start, int length, float volume)
 	length = (AUD_MIN(m_length, length + start) - start) * m_specs.channels;
 	start *= m_specs.channels;
 
-	for(int i = 0; i < length; i++)
-		out[i + start] += buffer[i] * volume;
+	AUD_mix_samples(out + start, buffer, length, volume);
 }
 
 void AUD_Mixer::read(data_t* buffer, float volume)
 {
 	sample_t* out = m_buffer.getBuffer();
 
-	for(int i = 0; i < m_length * m_specs.channels; i++)
-		out[i] *= volume;
+	AUD_volume_samples(out, m_length * m_specs.channels, volume);
 
 	m_convert(buffer, (data_t*) out, m_length * m_specs.channels);
 }
@@ -0,0 +1,275 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_PrefetchReader.cpp
+ *  \ingroup audaspaceintern
+ */
+
+
+#include "AUD_PrefetchReader.h"
+#include "AUD_MutexLock.h"
+
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define AUD_MEMORY_BARRIER() MemoryBarrier()
+#else
+#define AUD_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+AUD_PrefetchReader::AUD_PrefetchReader(boost::shared_ptr<AUD_IReader> reader, int size) :
+	m_reader(reader), m_size(size + 1), m_read(0), m_write(0), m_eos(false),
+	m_loopStart(-1), m_loopcount(0), m_position(reader->getPosition()), m_underruns(0), m_dropouts(0)
+{
+	m_channels = m_reader->getSpecs().channels;
+	m_ring.assureSize(m_size * m_channels * sizeof(sample_t));
+
+	pthread_mutex_init(&m_mutex, NULL);
+}
+
+AUD_PrefetchReader::~AUD_PrefetchReader()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+int AUD_PrefetchReader::readRing(int length, bool& eos, sample_t* buffer)
+{
+	// eos and the loop start have to be read before m_write, prefetch() sets
+	// them after m_write
+	bool end = m_eos;
+	int loop = m_loopStart;
+
+	AUD_MEMORY_BARRIER();
+
+	int read = m_read;
+	int available = m_write - read;
+	if(available < 0)
+		available += m_size;
+
+	// stop at the end of the current loop
+	if(loop >= 0)
+	{
+		available = loop - read;
+		if(available < 0)
+			available += m_size;
+		end = true;
+	}
+
+	int len = AUD_MIN(length, available);
+	int first = AUD_MIN(len, m_size - read);
+	sample_t* ring = m_ring.getBuffer();
+
+	std::memcpy(buffer, ring + read * m_channels, first * m_channels * sizeof(sample_t));
+	std::memcpy(buffer + first * m_channels, ring, (len - first) * m_channels * sizeof(sample_t));
+
+	// the samples have to be copied before prefetch() may overwrite them
+	AUD_MEMORY_BARRIER();
+
+	m_read = (read + len) % m_size;
+
+	eos = end && len == available;
+
+	return len;
+}
+
+void AUD_PrefetchReader::loop()
+{
+	m_reader->seek(0);
+
+	if(m_loopcount > 0)
+		m_loopcount--;
+
+	AUD_MEMORY_BARRIER();
+
+	m_loopStart = m_write;
+}
+
+bool AUD_PrefetchReader::prefetch()
+{
+	AUD_MutexLock lock(*this);
+
+	if(m_eos || m_reader->getSpecs().channels != m_channels)
+		return false;
+
+	int write = m_write;
+	int space = m_read - write - 1;
+	if(space < 0)
+		space += m_size;
+
+	int len = AUD_MIN(AUD_MIN(space, m_size - write), AUD_DEFAULT_BUFFER_SIZE);
+
+	if(len <= 0)
+		return false;
+
+	bool eos;
+	m_reader->read(len, eos, m_ring.getBuffer() + write * m_channels);
+
+	// the samples have to be written before read() may copy them
+	AUD_MEMORY_BARRIER();
+
+	m_write = (write + len) % m_size;
+
+	if(eos)
+	{
+		if(m_loopcount)
+		{
+			// decode the next loop ahead, once the current one is played
+			if(m_loopStart >= 0)
+				return false;
+
+			loop();
+			return true;
+		}
+
+		AUD_MEMORY_BARRIER();
+		m_eos = true;
+	}
+
+	return !eos;
+}
+
+void AUD_PrefetchReader::setLoopCount(int count)
+{
+	m_loopcount = count;
+}
+
+int AUD_PrefetchReader::getUnderruns() const
+{
+	return m_underruns;
+}
+
+int AUD_PrefetchReader::getDropouts() const
+{
+	return m_dropouts;
+}
+
+bool AUD_PrefetchReader::isSeekable() const
+{
+	return m_reader->isSeekable();
+}
+
+void AUD_PrefetchReader::seek(int position)
+{
+	// the next loop is decoded already, this is called while mixing
+	if(position == 0 && m_loopStart == m_read)
+	{
+		m_loopStart = -1;
+		m_position = 0;
+		return;
+	}
+
+	AUD_MutexLock lock(*this);
+
+	m_reader->seek(position);
+
+	m_read = m_write = 0;
+	m_loopStart = -1;
+	m_eos = false;
+	m_position = m_reader->getPosition();
+}
+
+int AUD_PrefetchReader::getLength() const
+{
+	return m_reader->getLength();
+}
+
+int AUD_PrefetchReader::getPosition() const
+{
+	return m_position;
+}
+
+AUD_Specs AUD_PrefetchReader::getSpecs() const
+{
+	return m_reader->getSpecs();
+}
+
+void AUD_PrefetchReader::read(int& length, bool& eos, sample_t* buffer)
+{
+	AUD_Specs specs = m_reader->getSpecs();
+	int len = 0;
+
+	eos = false;
+
+	if(specs.channels == m_channels)
+		len = readRing(length, eos, buffer);
+
+	if(len < length && !eos)
+	{
+		m_underruns++;
+
+		if(pthread_mutex_trylock(&m_mutex) == 0)
+		{
+			if(specs.channels != m_channels)
+			{
+				// the source changed its channels, drop what is decoded already
+				m_channels = specs.channels;
+				m_ring.assureSize(m_size * m_channels * sizeof(sample_t));
+				m_read = m_write = 0;
+				m_loopStart = -1;
+				m_eos = false;
+			}
+			else
+				len += readRing(length - len, eos, buffer + len * m_channels);
+
+			// prefetch() can't run now, so decode the rest here
+			if(len < length && !eos)
+			{
+				int rest = length - len;
+				m_reader->read(rest, eos, buffer + len * m_channels);
+				len += rest;
+
+				// the ring buffer is empty, the next loop starts right here
+				if(eos && m_loopcount)
+					loop();
+				else
+					m_eos = eos;
+			}
+
+			pthread_mutex_unlock(&m_mutex);
+
+			length = len;
+		}
+		else
+		{
+			// prefetch() is decoding, don't wait for it
+			m_dropouts++;
+			std::memset(buffer + len * specs.channels, 0, (length - len) * AUD_SAMPLE_SIZE(specs));
+		}
+	}
+	else
+		length = len;
+
+	m_position += len;
+}
+
+void AUD_PrefetchReader::lock()
+{
+	pthread_mutex_lock(&m_mutex);
+}
+
+void AUD_PrefetchReader::unlock()
+{
+	pthread_mutex_unlock(&m_mutex);
+}
@@ -0,0 +1,183 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_PrefetchReader.h
+ *  \ingroup audaspaceintern
+ */
+
+
+#ifndef __AUD_PREFETCHREADER_H__
+#define __AUD_PREFETCHREADER_H__
+
+#include "AUD_IReader.h"
+#include "AUD_ILockable.h"
+#include "AUD_Buffer.h"
+
+#include <boost/shared_ptr.hpp>
+#include <pthread.h>
+
+/**
+ * This reader decodes its source ahead of the playback position into a ring
+ * buffer. The ring buffer is filled by one thread calling prefetch() and
+ * emptied by one thread calling read(), read() never waits for prefetch().
+ * Loops are decoded ahead as well, so seeking to the start at the end of a
+ * loop doesn't wait for prefetch() either.
+ * \warning seek() and read() must not be called at the same time, the
+ *          software device guarantees this with its own lock.
+ */
+class AUD_PrefetchReader : public AUD_IReader, public AUD_ILockable
+{
+private:
+	/**
+	 * The source reader.
+	 */
+	boost::shared_ptr<AUD_IReader> m_reader;
+
+	/**
+	 * The ring buffer with the decoded samples.
+	 */
+	AUD_Buffer m_ring;
+
+	/**
+	 * The size of the ring buffer in samples, one sample is always left free.
+	 */
+	int m_size;
+
+	/**
+	 * The channel count of the samples in the ring buffer.
+	 */
+	int m_channels;
+
+	/**
+	 * The ring buffer position of the next sample read(), only written by read().
+	 */
+	volatile int m_read;
+
+	/**
+	 * The ring buffer position of the next sample prefetch(), only written by
+	 * prefetch().
+	 */
+	volatile int m_write;
+
+	/**
+	 * Whether the source reached its end at m_write.
+	 */
+	volatile bool m_eos;
+
+	/**
+	 * The ring buffer position where the next loop starts, -1 if the next loop
+	 * isn't decoded yet. Set by prefetch(), cleared by seek().
+	 */
+	volatile int m_loopStart;
+
+	/**
+	 * How many loops are still to be decoded ahead, negative for infinite.
+	 */
+	volatile int m_loopcount;
+
+	/**
+	 * The position of the next sample read() returns.
+	 */
+	int m_position;
+
+	/**
+	 * How often read() found less samples in the ring buffer than requested.
+	 */
+	int m_underruns;
+
+	/**
+	 * How often read() returned silence because prefetch() was decoding.
+	 */
+	int m_dropouts;
+
+	/**
+	 * The mutex held while the source reader is used.
+	 */
+	pthread_mutex_t m_mutex;
+
+	/**
+	 * Copies samples from the ring buffer.
+	 * \param length The maximum count of samples to copy.
+	 * \param[out] eos Whether all samples until the end of the source are read.
+	 * \param buffer The buffer to copy to.
+	 * \return The count of samples copied.
+	 */
+	int readRing(int length, bool& eos, sample_t* buffer);
+
+	/**
+	 * Seeks the source to its start and marks the start of the next loop at
+	 * the current ring buffer position, the mutex has to be locked.
+	 */
+	void loop();
+
+	// hide copy constructor and operator=
+	AUD_PrefetchReader(const AUD_PrefetchReader&);
+	AUD_PrefetchReader& operator=(const AUD_PrefetchReader&);
+
+public:
+	/**
+	 * Creates a new prefetch reader.
+	 * \param reader The reader to decode ahead.
+	 * \param size How many samples to decode ahead at most.
+	 */
+	AUD_PrefetchReader(boost::shared_ptr<AUD_IReader> reader, int size);
+
+	virtual ~AUD_PrefetchReader();
+
+	/**
+	 * Decodes the next samples of the source into the ring buffer.
+	 * \return Whether there may be more samples to decode.
+	 */
+	bool prefetch();
+
+	/**
+	 * Sets how often the source is looped, read() returns the end of the
+	 * stream at the end of every loop and seek(0) starts the next one.
+	 * \param count The loop count, negative for infinite.
+	 */
+	void setLoopCount(int count);
+
+	/**
+	 * Returns how often read() found less samples decoded than requested and
+	 * had to decode the rest itself.
+	 */
+	int getUnderruns() const;
+
+	/**
+	 * Returns how often read() played silence instead of waiting for prefetch().
+	 */
+	int getDropouts() const;
+
+	virtual bool isSeekable() const;
+	virtual void seek(int position);
+	virtual int getLength() const;
+	virtual int getPosition() const;
+	virtual AUD_Specs getSpecs() const;
+	virtual void read(int& length, bool& eos, sample_t* buffer);
+
+	virtual void lock();
+	virtual void unlock();
+};
+
+#endif //__AUD_PREFETCHREADER_H__
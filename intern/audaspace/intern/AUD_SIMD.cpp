@@ -0,0 +1,175 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_SIMD.cpp
+ *  \ingroup audaspaceintern
+ */
+
+
+#include "AUD_SIMD.h"
+
+#if defined(WITH_AUDASPACE_SSE2) || defined(WITH_AUDASPACE_AVX)
+
+#if defined(_WIN32) && !defined(FREE_WINDOWS)
+#include <intrin.h>
+#endif
+
+#include <stdint.h>
+
+#if !defined(_WIN32) || defined(FREE_WINDOWS)
+static void __cpuid(int data[4], int selector)
+{
+#ifdef __x86_64__
+	asm("cpuid" : "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(0));
+#else
+#ifdef __i386__
+	asm("pushl %%ebx    \n\t"
+		"cpuid          \n\t"
+		"movl %%ebx, %1 \n\t"
+		"popl %%ebx     \n\t" : "=a" (data[0]), "=r" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(0));
+#else
+	data[0] = data[1] = data[2] = data[3] = 0;
+#endif
+#endif
+}
+#endif
+
+/* register state the OS saves on context switches, needed for AVX */
+static uint64_t AUD_xgetbv()
+{
+#if defined(_WIN32) && !defined(FREE_WINDOWS)
+#if defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219)
+	return _xgetbv(0);
+#else
+	return 0;
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+	uint32_t eax, edx;
+	asm(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t)edx << 32) | eax;
+#else
+	return 0;
+#endif
+}
+
+static AUD_SIMDLevel AUD_getCPUSIMDLevel()
+{
+	int result[4];
+
+	__cpuid(result, 0);
+
+	if(result[0] < 1)
+		return AUD_SIMD_NONE;
+
+	__cpuid(result, 1);
+
+	bool sse2 = (result[3] & ((int)1 << 25)) != 0 && (result[3] & ((int)1 << 26)) != 0;
+
+	/* AVX also needs the OS to save the YMM registers */
+	bool os_avx = false;
+	if((result[2] & ((int)1 << 27)) != 0)
+		os_avx = (AUD_xgetbv() & 6) == 6;
+
+	bool avx = os_avx && (result[2] & ((int)1 << 28)) != 0;
+
+	if(sse2 && avx)
+		return AUD_SIMD_AVX;
+	if(sse2)
+		return AUD_SIMD_SSE2;
+	return AUD_SIMD_NONE;
+}
+
+#else
+
+static AUD_SIMDLevel AUD_getCPUSIMDLevel()
+{
+	return AUD_SIMD_NONE;
+}
+
+#endif
+
+/* -1 until the CPU is checked, set once before any sound is played */
+static int AUD_simd_level = -1;
+
+AUD_SIMDLevel AUD_getSIMDLevel()
+{
+	if(AUD_simd_level < 0)
+		AUD_simd_level = AUD_getCPUSIMDLevel();
+
+	return (AUD_SIMDLevel)AUD_simd_level;
+}
+
+void AUD_setSIMDLevel(AUD_SIMDLevel level)
+{
+	AUD_SIMDLevel supported = AUD_getCPUSIMDLevel();
+
+	AUD_simd_level = level < supported ? level : supported;
+}
+
+void AUD_mix_samples(sample_t* target, const sample_t* source, int length, float volume)
+{
+	AUD_SIMD_DISPATCH(AUD_mix_samples, (target, source, length, volume))
+
+	for(int i = 0; i < length; i++)
+		target[i] += source[i] * volume;
+}
+
+void AUD_volume_samples(sample_t* buffer, int length, float volume)
+{
+	AUD_SIMD_DISPATCH(AUD_volume_samples, (buffer, length, volume))
+
+	for(int i = 0; i < length; i++)
+		buffer[i] *= volume;
+}
+
+void AUD_multiply_add_spectra(float* re, float* im, const float* xr, const float* xi,
+							  const float* hr, const float* hi, int length)
+{
+	AUD_SIMD_DISPATCH(AUD_multiply_add_spectra, (re, im, xr, xi, hr, hi, length))
+
+	for(int i = 0; i < length; i++)
+	{
+		re[i] += xr[i] * hr[i] - xi[i] * hi[i];
+		im[i] += xr[i] * hi[i] + xi[i] * hr[i];
+	}
+}
+
+void AUD_sinc_stereo(double* sums, const sample_t* data, int stride, const float* coeff,
+					 unsigned int l, unsigned int L, double eta, int count)
+{
+	/* with AVX the two channels of four taps would be summed at once, changing
+	 * the order of the additions, so SSE2 is the best here */
+	AUD_SIMD_DISPATCH_SSE2(AUD_sinc_stereo, (sums, data, stride, coeff, l, L, eta, count))
+
+	double v;
+
+	for(int i = 0; i < count; i++)
+	{
+		v = coeff[l] + eta * (coeff[l + 1] - coeff[l]);
+		l -= L;
+		sums[0] += data[0] * v;
+		sums[1] += data[1] * v;
+		data += stride;
+	}
+}
@@ -0,0 +1,149 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_SIMD.h
+ *  \ingroup audaspaceintern
+ */
+
+
+#ifndef __AUD_SIMD_H__
+#define __AUD_SIMD_H__
+
+#include "AUD_Space.h"
+
+/**
+ * Vector instruction sets the sample loops can use.
+ * The kernels of an instruction set are compiled in their own file with the
+ * compiler flags for it (AUD_SIMD_sse2.cpp, AUD_SIMD_avx.cpp) and are only
+ * called if the CPU supports them. Every kernel gives exactly the same result
+ * as the scalar loop, so the output doesn't depend on the CPU.
+ * \warning The kernel files must not include headers with inline functions
+ *          that other files use too, the linker could pick the vectorized
+ *          version for all of them.
+ */
+typedef enum
+{
+	AUD_SIMD_NONE = 0,
+	AUD_SIMD_SSE2,
+	AUD_SIMD_AVX
+} AUD_SIMDLevel;
+
+/**
+ * Returns the instruction set the sample loops use, the best one the CPU
+ * supports unless it was limited with AUD_setSIMDLevel.
+ */
+AUD_SIMDLevel AUD_getSIMDLevel();
+
+/**
+ * Limits the instruction set the sample loops use, for benchmarking.
+ * \param level The best instruction set to use, the CPU support is still checked.
+ */
+void AUD_setSIMDLevel(AUD_SIMDLevel level);
+
+/**
+ * Adds samples multiplied with a volume: target[i] += source[i] * volume.
+ * \param target The samples to add to.
+ * \param source The samples to add.
+ * \param length The count of single samples, not multichannel samples.
+ * \param volume The volume of the source samples.
+ */
+void AUD_mix_samples(sample_t* target, const sample_t* source, int length, float volume);
+
+/**
+ * Multiplies samples with a volume.
+ * \param buffer The samples.
+ * \param length The count of single samples.
+ * \param volume The volume.
+ */
+void AUD_volume_samples(sample_t* buffer, int length, float volume);
+
+/**
+ * Sums the stereo samples of one side of the windowed sinc filter of the JOS
+ * resampler when upsampling, see AUD_JOSResampleReader.
+ * \param sums The sums of the two channels, added to.
+ * \param data The first stereo sample.
+ * \param stride The distance to the next stereo sample in single samples.
+ * \param coeff The filter coefficients.
+ * \param l The coefficient index of the first sample.
+ * \param L The coefficient index distance of two samples.
+ * \param eta The interpolation factor between two coefficients.
+ * \param count The count of stereo samples.
+ */
+void AUD_sinc_stereo(double* sums, const sample_t* data, int stride, const float* coeff,
+					 unsigned int l, unsigned int L, double eta, int count);
+
+/**
+ * Multiplies two spectra and adds the product to a third one, stored as
+ * separate real and imaginary parts, see AUD_ConvolverReader.
+ * \param re The real parts to add to.
+ * \param im The imaginary parts to add to.
+ * \param xr The real parts of the first spectrum.
+ * \param xi The imaginary parts of the first spectrum.
+ * \param hr The real parts of the second spectrum.
+ * \param hi The imaginary parts of the second spectrum.
+ * \param length The count of frequency bins.
+ */
+void AUD_multiply_add_spectra(float* re, float* im, const float* xr, const float* xi,
+							  const float* hr, const float* hi, int length);
+
+/// Calls the kernel of the best instruction set for function and returns.
+#ifdef WITH_AUDASPACE_AVX
+#define AUD_SIMD_DISPATCH_AVX(function, args) if(AUD_getSIMDLevel() >= AUD_SIMD_AVX) { function##_avx args; return; }
+#else
+#define AUD_SIMD_DISPATCH_AVX(function, args)
+#endif
+
+#ifdef WITH_AUDASPACE_SSE2
+#define AUD_SIMD_DISPATCH_SSE2(function, args) if(AUD_getSIMDLevel() >= AUD_SIMD_SSE2) { function##_sse2 args; return; }
+#else
+#define AUD_SIMD_DISPATCH_SSE2(function, args)
+#endif
+
+#define AUD_SIMD_DISPATCH(function, args) AUD_SIMD_DISPATCH_AVX(function, args) AUD_SIMD_DISPATCH_SSE2(function, args)
+
+#ifdef WITH_AUDASPACE_SSE2
+void AUD_mix_samples_sse2(sample_t* target, const sample_t* source, int length, float volume);
+void AUD_volume_samples_sse2(sample_t* buffer, int length, float volume);
+void AUD_sinc_stereo_sse2(double* sums, const sample_t* data, int stride, const float* coeff,
+						  unsigned int l, unsigned int L, double eta, int count);
+void AUD_multiply_add_spectra_sse2(float* re, float* im, const float* xr, const float* xi,
+								   const float* hr, const float* hi, int length);
+void AUD_convert_s16_float_sse2(data_t* target, data_t* source, int length);
+void AUD_convert_s32_float_sse2(data_t* target, data_t* source, int length);
+void AUD_convert_float_s16_sse2(data_t* target, data_t* source, int length);
+void AUD_convert_float_s32_sse2(data_t* target, data_t* source, int length);
+#endif
+
+#ifdef WITH_AUDASPACE_AVX
+void AUD_mix_samples_avx(sample_t* target, const sample_t* source, int length, float volume);
+void AUD_volume_samples_avx(sample_t* buffer, int length, float volume);
+void AUD_multiply_add_spectra_avx(float* re, float* im, const float* xr, const float* xi,
+								  const float* hr, const float* hi, int length);
+void AUD_convert_s16_float_avx(data_t* target, data_t* source, int length);
+void AUD_convert_s32_float_avx(data_t* target, data_t* source, int length);
+void AUD_convert_float_s16_avx(data_t* target, data_t* source, int length);
+void AUD_convert_float_s32_avx(data_t* target, data_t* source, int length);
+#endif
+
+#endif //__AUD_SIMD_H__
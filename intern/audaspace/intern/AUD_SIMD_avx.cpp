@@ -0,0 +1,192 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_SIMD_avx.cpp
+ *  \ingroup audaspaceintern
+ */
+
+/* compiled with AVX enabled, see the warning in AUD_SIMD.h before adding includes */
+
+#include "AUD_SIMD.h"
+
+#ifdef WITH_AUDASPACE_AVX
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#define AUD_S16_MAX		((int16_t)0x7FFF)
+#define AUD_S16_MIN		((int16_t)0x8000)
+#define AUD_S16_FLT		32767.0f
+#define AUD_S32_MAX		((int32_t)0x7FFFFFFF)
+#define AUD_S32_MIN		((int32_t)0x80000000)
+#define AUD_S32_FLT		2147483647.0f
+
+/* mask ? a : b, on the float bits as AVX has no 256 bit integer instructions */
+static inline __m256 select_ps(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+}
+
+/* the clamping of AUD_convert_float_s16 and AUD_convert_float_s32, scale is the integer maximum */
+static inline __m256i float_to_int(__m256 s, __m256 scale, __m256 min, __m256 max)
+{
+	__m256 t = _mm256_castsi256_ps(_mm256_cvttps_epi32(_mm256_mul_ps(s, scale)));
+	t = select_ps(_mm256_cmp_ps(s, _mm256_set1_ps(-1.0f), _CMP_LE_OQ), min, t);
+	return _mm256_castps_si256(select_ps(_mm256_cmp_ps(s, _mm256_set1_ps(1.0f), _CMP_GE_OQ), max, t));
+}
+
+void AUD_mix_samples_avx(sample_t* target, const sample_t* source, int length, float volume)
+{
+	__m256 v = _mm256_set1_ps(volume);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+		_mm256_storeu_ps(target + i, _mm256_add_ps(_mm256_loadu_ps(target + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), v)));
+
+	for(; i < length; i++)
+		target[i] += source[i] * volume;
+}
+
+void AUD_volume_samples_avx(sample_t* buffer, int length, float volume)
+{
+	__m256 v = _mm256_set1_ps(volume);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+		_mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_loadu_ps(buffer + i), v));
+
+	for(; i < length; i++)
+		buffer[i] *= volume;
+}
+
+void AUD_multiply_add_spectra_avx(float* re, float* im, const float* xr, const float* xi,
+								  const float* hr, const float* hi, int length)
+{
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+	{
+		__m256 ar = _mm256_loadu_ps(xr + i);
+		__m256 ai = _mm256_loadu_ps(xi + i);
+		__m256 br = _mm256_loadu_ps(hr + i);
+		__m256 bi = _mm256_loadu_ps(hi + i);
+
+		_mm256_storeu_ps(re + i, _mm256_add_ps(_mm256_loadu_ps(re + i), _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi))));
+		_mm256_storeu_ps(im + i, _mm256_add_ps(_mm256_loadu_ps(im + i), _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br))));
+	}
+
+	for(; i < length; i++)
+	{
+		re[i] += xr[i] * hr[i] - xi[i] * hi[i];
+		im[i] += xr[i] * hi[i] + xi[i] * hr[i];
+	}
+}
+
+void AUD_convert_s16_float_avx(data_t* target, data_t* source, int length)
+{
+	int16_t* s = (int16_t*) source;
+	float* t = (float*) target;
+	__m256 scale = _mm256_set1_ps(AUD_S16_FLT);
+	int n = length & ~7;
+
+	/* backwards like the scalar loop, the target may be the source */
+	for(int i = length - 1; i >= n; i--)
+		t[i] = s[i] / AUD_S16_FLT;
+
+	for(int i = n - 8; i >= 0; i -= 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		__m256i y = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		_mm256_storeu_ps(t + i, _mm256_div_ps(_mm256_cvtepi32_ps(y), scale));
+	}
+}
+
+void AUD_convert_s32_float_avx(data_t* target, data_t* source, int length)
+{
+	int32_t* s = (int32_t*) source;
+	float* t = (float*) target;
+	__m256 scale = _mm256_set1_ps(AUD_S32_FLT);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+		_mm256_storeu_ps(t + i, _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(s + i))), scale));
+
+	for(; i < length; i++)
+		t[i] = s[i] / AUD_S32_FLT;
+}
+
+void AUD_convert_float_s16_avx(data_t* target, data_t* source, int length)
+{
+	int16_t* t = (int16_t*) target;
+	float* s = (float*) source;
+	__m256 scale = _mm256_set1_ps((float)AUD_S16_MAX);
+	__m256 min = _mm256_castsi256_ps(_mm256_set1_epi32(AUD_S16_MIN));
+	__m256 max = _mm256_castsi256_ps(_mm256_set1_epi32(AUD_S16_MAX));
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+	{
+		__m256i x = float_to_int(_mm256_loadu_ps(s + i), scale, min, max);
+		__m128i a = _mm256_castsi256_si128(x);
+		__m128i b = _mm256_extractf128_si256(x, 1);
+		_mm_storeu_si128((__m128i*)(t + i), _mm_packs_epi32(a, b));
+	}
+
+	for(; i < length; i++)
+	{
+		if(s[i] <= -1.0f)
+			t[i] = AUD_S16_MIN;
+		else if(s[i] >= 1.0f)
+			t[i] = AUD_S16_MAX;
+		else
+			t[i] = (int16_t)(s[i] * AUD_S16_MAX);
+	}
+}
+
+void AUD_convert_float_s32_avx(data_t* target, data_t* source, int length)
+{
+	int32_t* t = (int32_t*) target;
+	float* s = (float*) source;
+	__m256 scale = _mm256_set1_ps((float)AUD_S32_MAX);
+	__m256 min = _mm256_castsi256_ps(_mm256_set1_epi32(AUD_S32_MIN));
+	__m256 max = _mm256_castsi256_ps(_mm256_set1_epi32(AUD_S32_MAX));
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+		_mm256_storeu_si256((__m256i*)(t + i), float_to_int(_mm256_loadu_ps(s + i), scale, min, max));
+
+	for(; i < length; i++)
+	{
+		if(s[i] <= -1.0f)
+			t[i] = AUD_S32_MIN;
+		else if(s[i] >= 1.0f)
+			t[i] = AUD_S32_MAX;
+		else
+			t[i] = (int32_t)(s[i] * AUD_S32_MAX);
+	}
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * Copyright 2009-2011 Jörg Hermann Müller
+ *
+ * This file is part of AudaSpace.
+ *
+ * Audaspace is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * AudaSpace is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Audaspace; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file audaspace/intern/AUD_SIMD_sse2.cpp
+ *  \ingroup audaspaceintern
+ */
+
+/* compiled with SSE2 enabled, see the warning in AUD_SIMD.h before adding includes */
+
+#include "AUD_SIMD.h"
+
+#ifdef WITH_AUDASPACE_SSE2
+
+#include <emmintrin.h>
+#include <stdint.h>
+
+#define AUD_S16_MAX		((int16_t)0x7FFF)
+#define AUD_S16_MIN		((int16_t)0x8000)
+#define AUD_S16_FLT		32767.0f
+#define AUD_S32_MAX		((int32_t)0x7FFFFFFF)
+#define AUD_S32_MIN		((int32_t)0x80000000)
+#define AUD_S32_FLT		2147483647.0f
+
+/* two floats, the loads of __m128i may alias anything */
+#define load_stereo(data) _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(data))))
+
+/* mask ? a : b */
+static inline __m128i select_si128(__m128 mask, __m128i a, __m128i b)
+{
+	__m128i m = _mm_castps_si128(mask);
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+/* the clamping of AUD_convert_float_s16 and AUD_convert_float_s32, scale is the integer maximum */
+static inline __m128i float_to_int(__m128 s, __m128 scale, __m128i min, __m128i max)
+{
+	__m128i t = _mm_cvttps_epi32(_mm_mul_ps(s, scale));
+	t = select_si128(_mm_cmple_ps(s, _mm_set1_ps(-1.0f)), min, t);
+	return select_si128(_mm_cmpge_ps(s, _mm_set1_ps(1.0f)), max, t);
+}
+
+void AUD_mix_samples_sse2(sample_t* target, const sample_t* source, int length, float volume)
+{
+	__m128 v = _mm_set1_ps(volume);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+	{
+		__m128 a = _mm_add_ps(_mm_loadu_ps(target + i), _mm_mul_ps(_mm_loadu_ps(source + i), v));
+		__m128 b = _mm_add_ps(_mm_loadu_ps(target + i + 4), _mm_mul_ps(_mm_loadu_ps(source + i + 4), v));
+		_mm_storeu_ps(target + i, a);
+		_mm_storeu_ps(target + i + 4, b);
+	}
+
+	for(; i < length; i++)
+		target[i] += source[i] * volume;
+}
+
+void AUD_volume_samples_sse2(sample_t* buffer, int length, float volume)
+{
+	__m128 v = _mm_set1_ps(volume);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+	{
+		_mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), v));
+		_mm_storeu_ps(buffer + i + 4, _mm_mul_ps(_mm_loadu_ps(buffer + i + 4), v));
+	}
+
+	for(; i < length; i++)
+		buffer[i] *= volume;
+}
+
+void AUD_sinc_stereo_sse2(double* sums, const sample_t* data, int stride, const float* coeff,
+						  unsigned int l, unsigned int L, double eta, int count)
+{
+	/* both channels in one register, the taps are summed in the same order as
+	 * the scalar loop, only the coefficients of two taps are interpolated at once */
+	__m128d sum = _mm_loadu_pd(sums);
+	__m128d e = _mm_set1_pd(eta);
+	int i = 0;
+
+	for(; i + 2 <= count; i += 2)
+	{
+		__m128 c = _mm_setr_ps(coeff[l], coeff[l - L], 0.0f, 0.0f);
+		__m128 c1 = _mm_setr_ps(coeff[l + 1], coeff[l - L + 1], 0.0f, 0.0f);
+		__m128d v = _mm_add_pd(_mm_cvtps_pd(c), _mm_mul_pd(e, _mm_cvtps_pd(_mm_sub_ps(c1, c))));
+
+		__m128d d0 = load_stereo(data);
+		__m128d d1 = load_stereo(data + stride);
+
+		sum = _mm_add_pd(sum, _mm_mul_pd(d0, _mm_unpacklo_pd(v, v)));
+		sum = _mm_add_pd(sum, _mm_mul_pd(d1, _mm_unpackhi_pd(v, v)));
+
+		data += 2 * stride;
+		l -= 2 * L;
+	}
+
+	if(i < count)
+	{
+		double v = coeff[l] + eta * (coeff[l + 1] - coeff[l]);
+		__m128d d = load_stereo(data);
+
+		sum = _mm_add_pd(sum, _mm_mul_pd(d, _mm_set1_pd(v)));
+	}
+
+	_mm_storeu_pd(sums, sum);
+}
+
+void AUD_multiply_add_spectra_sse2(float* re, float* im, const float* xr, const float* xi,
+								   const float* hr, const float* hi, int length)
+{
+	int i = 0;
+
+	for(; i + 4 <= length; i += 4)
+	{
+		__m128 ar = _mm_loadu_ps(xr + i);
+		__m128 ai = _mm_loadu_ps(xi + i);
+		__m128 br = _mm_loadu_ps(hr + i);
+		__m128 bi = _mm_loadu_ps(hi + i);
+
+		_mm_storeu_ps(re + i, _mm_add_ps(_mm_loadu_ps(re + i), _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+		_mm_storeu_ps(im + i, _mm_add_ps(_mm_loadu_ps(im + i), _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+	}
+
+	for(; i < length; i++)
+	{
+		re[i] += xr[i] * hr[i] - xi[i] * hi[i];
+		im[i] += xr[i] * hi[i] + xi[i] * hr[i];
+	}
+}
+
+void AUD_convert_s16_float_sse2(data_t* target, data_t* source, int length)
+{
+	int16_t* s = (int16_t*) source;
+	float* t = (float*) target;
+	__m128 scale = _mm_set1_ps(AUD_S16_FLT);
+	int n = length & ~7;
+
+	/* backwards like the scalar loop, the target may be the source */
+	for(int i = length - 1; i >= n; i--)
+		t[i] = s[i] / AUD_S16_FLT;
+
+	for(int i = n - 8; i >= 0; i -= 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		_mm_storeu_ps(t + i, _mm_div_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(t + i + 4, _mm_div_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+}
+
+void AUD_convert_s32_float_sse2(data_t* target, data_t* source, int length)
+{
+	int32_t* s = (int32_t*) source;
+	float* t = (float*) target;
+	__m128 scale = _mm_set1_ps(AUD_S32_FLT);
+	int i = 0;
+
+	for(; i + 4 <= length; i += 4)
+		_mm_storeu_ps(t + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(s + i))), scale));
+
+	for(; i < length; i++)
+		t[i] = s[i] / AUD_S32_FLT;
+}
+
+void AUD_convert_float_s16_sse2(data_t* target, data_t* source, int length)
+{
+	int16_t* t = (int16_t*) target;
+	float* s = (float*) source;
+	__m128 scale = _mm_set1_ps((float)AUD_S16_MAX);
+	__m128i min = _mm_set1_epi32(AUD_S16_MIN);
+	__m128i max = _mm_set1_epi32(AUD_S16_MAX);
+	int i = 0;
+
+	for(; i + 8 <= length; i += 8)
+	{
+		__m128i a = float_to_int(_mm_loadu_ps(s + i), scale, min, max);
+		__m128i b = float_to_int(_mm_loadu_ps(s + i + 4), scale, min, max);
+		_mm_storeu_si128((__m128i*)(t + i), _mm_packs_epi32(a, b));
+	}
+
+	for(; i < length; i++)
+	{
+		if(s[i] <= -1.0f)
+			t[i] = AUD_S16_MIN;
+		else if(s[i] >= 1.0f)
+			t[i] = AUD_S16_MAX;
+		else
+			t[i] = (int16_t)(s[i] * AUD_S16_MAX);
+	}
+}
+
+void AUD_convert_float_s32_sse2(data_t* target, data_t* source, int length)
+{
+	int32_t* t = (int32_t*) target;
+	float* s = (float*) source;
+	__m128 scale = _mm_set1_ps((float)AUD_S32_MAX);
+	__m128i min = _mm_set1_epi32(AUD_S32_MIN);
+	__m128i max = _mm_set1_epi32(AUD_S32_MAX);
+	int i = 0;
+
+	for(; i + 4 <= length; i += 4)
+		_mm_storeu_si128((__m128i*)(t + i), float_to_int(_mm_loadu_ps(s + i), scale, min, max));
+
+	for(; i < length; i++)
+	{
+		if(s[i] <= -1.0f)
+			t[i] = AUD_S32_MIN;
+		else if(s[i] >= 1.0f)
+			t[i] = AUD_S32_MAX;
+		else
+			t[i] = (int32_t)(s[i] * AUD_S32_MAX);
+	}
+}
+
+#endif
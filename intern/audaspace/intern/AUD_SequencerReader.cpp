@@ -43,6 +43,11 @@ AUD_SequencerReader::~AUD_SequencerReader()
 {
 }
 
+void AUD_SequencerReader::setThreadCount(int count)
+{
+	m_device.setThreadCount(count);
+}
+
 bool AUD_SequencerReader::isSeekable() const
 {
 	return true;
@@ -88,6 +88,12 @@ public:
 	 */
 	~AUD_SequencerReader();
 
+	/**
+	 * Sets how many threads read the entries, for offline mixing.
+	 * \param count The thread count.
+	 */
+	void setThreadCount(int count);
+
 	virtual bool isSeekable() const;
 	virtual void seek(int position);
 	virtual int getLength() const;
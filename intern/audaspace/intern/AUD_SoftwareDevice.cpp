@@ -53,18 +53,49 @@ typedef enum
 
 #define AUD_PITCH_MAX 10
 
+/// How many seconds the prefetch thread decodes ahead of the playback.
+#define AUD_PREFETCH_TIME 0.25f
+
 /******************************************************************************/
 /********************** AUD_SoftwareHandle Handle Code ************************/
 /******************************************************************************/
 
-AUD_SoftwareDevice::AUD_SoftwareHandle::AUD_SoftwareHandle(AUD_SoftwareDevice* device, boost::shared_ptr<AUD_IReader> reader, boost::shared_ptr<AUD_PitchReader> pitch, boost::shared_ptr<AUD_ResampleReader> resampler, boost::shared_ptr<AUD_ChannelMapperReader> mapper, bool keep) :
-	m_reader(reader), m_pitch(pitch), m_resampler(resampler), m_mapper(mapper), m_keep(keep), m_user_pitch(1.0f), m_user_volume(1.0f), m_user_pan(0.0f), m_volume(1.0f), m_loopcount(0),
+AUD_SoftwareDevice::AUD_SoftwareHandle::AUD_SoftwareHandle(AUD_SoftwareDevice* device, boost::shared_ptr<AUD_IReader> reader, boost::shared_ptr<AUD_PrefetchReader> prefetch, boost::shared_ptr<AUD_PitchReader> pitch, boost::shared_ptr<AUD_ResampleReader> resampler, boost::shared_ptr<AUD_ChannelMapperReader> mapper, bool keep) :
+	m_reader(reader), m_prefetch(prefetch), m_pitch(pitch), m_resampler(resampler), m_mapper(mapper), m_keep(keep), m_user_pitch(1.0f), m_user_volume(1.0f), m_user_pan(0.0f), m_volume(1.0f), m_loopcount(0),
 	m_relative(true), m_volume_max(1.0f), m_volume_min(0), m_distance_max(std::numeric_limits<float>::max()),
 	m_distance_reference(1.0f), m_attenuation(1.0f), m_cone_angle_outer(M_PI), m_cone_angle_inner(M_PI), m_cone_volume_outer(0),
-	m_flags(AUD_RENDER_CONE), m_stop(NULL), m_stop_data(NULL), m_status(AUD_STATUS_PLAYING), m_device(device)
+	m_flags(AUD_RENDER_CONE), m_stop(NULL), m_stop_data(NULL), m_status(AUD_STATUS_PLAYING), m_device(device), m_length(0), m_eos(false)
 {
 }
 
+int AUD_SoftwareDevice::AUD_SoftwareHandle::read(sample_t* buffer, int length, bool& eos)
+{
+	int pos = 0;
+	int len = length;
+
+	m_reader->read(len, eos, buffer);
+
+	// in case of looping
+	while(pos + len < length && m_loopcount && eos)
+	{
+		pos += len;
+
+		if(m_loopcount > 0)
+			m_loopcount--;
+
+		m_reader->seek(0);
+
+		len = length - pos;
+		m_reader->read(len, eos, buffer + pos * m_device->m_specs.channels);
+
+		// prevent endless loop
+		if(!len)
+			break;
+	}
+
+	return pos + len;
+}
+
 void AUD_SoftwareDevice::AUD_SoftwareHandle::update()
 {
 	int flags = 0;
@@ -298,6 +329,16 @@ bool AUD_SoftwareDevice::AUD_SoftwareHandle::stop()
 
 	m_status = AUD_STATUS_INVALID;
 
+	if(m_prefetch.get())
+	{
+		pthread_mutex_lock(&m_device->m_prefetchLock);
+		m_device->m_prefetchReaders.remove(m_prefetch);
+		pthread_mutex_unlock(&m_device->m_prefetchLock);
+
+		m_device->m_underruns += m_prefetch->getUnderruns();
+		m_device->m_dropouts += m_prefetch->getDropouts();
+	}
+
 	for(AUD_HandleIterator it = m_device->m_playingSounds.begin(); it != m_device->m_playingSounds.end(); it++)
 	{
 		if(it->get() == this)
@@ -430,6 +471,8 @@ bool AUD_SoftwareDevice::AUD_SoftwareHandle::setLoopCount(int count)
 	if(!m_status)
 		return false;
 	m_loopcount = count;
+	if(m_prefetch.get())
+		m_prefetch->setLoopCount(count);
 	return true;
 }
 
@@ -695,6 +738,22 @@ void AUD_SoftwareDevice::create()
 	m_distance_model = AUD_DISTANCE_MODEL_INVERSE_CLAMPED;
 	m_flags = 0;
 	m_quality = false;
+	m_prefetch = false;
+	m_prefetchPending = false;
+	m_prefetchStop = false;
+	m_underruns = 0;
+	m_dropouts = 0;
+	m_jobNext = 0;
+	m_jobsDone = 0;
+	m_jobLength = 0;
+	m_threadsStop = false;
+
+	pthread_mutex_init(&m_threadLock, NULL);
+	pthread_cond_init(&m_threadCondition, NULL);
+	pthread_cond_init(&m_threadDoneCondition, NULL);
+
+	pthread_mutex_init(&m_prefetchLock, NULL);
+	pthread_cond_init(&m_prefetchCondition, NULL);
 
 	pthread_mutexattr_t attr;
 	pthread_mutexattr_init(&attr);
@@ -710,15 +769,144 @@ void AUD_SoftwareDevice::destroy()
 	if(m_playback)
 		playing(m_playback = false);
 
+	setPrefetch(false);
+	setThreadCount(1);
+
 	while(!m_playingSounds.empty())
 		m_playingSounds.front()->stop();
 
 	while(!m_pausedSounds.empty())
 		m_pausedSounds.front()->stop();
 
+	pthread_cond_destroy(&m_prefetchCondition);
+	pthread_mutex_destroy(&m_prefetchLock);
+
+	pthread_cond_destroy(&m_threadDoneCondition);
+	pthread_cond_destroy(&m_threadCondition);
+	pthread_mutex_destroy(&m_threadLock);
+
 	pthread_mutex_destroy(&m_mutex);
 }
 
+void AUD_SoftwareDevice::readJobs()
+{
+	AUD_SoftwareHandle* sound;
+
+	while(m_jobNext < (int)m_jobs.size())
+	{
+		sound = m_jobs[m_jobNext++];
+
+		pthread_mutex_unlock(&m_threadLock);
+
+		sound->m_buffer.assureSize(m_jobLength * AUD_SAMPLE_SIZE(m_specs));
+		sound->m_length = sound->read(sound->m_buffer.getBuffer(), m_jobLength, sound->m_eos);
+
+		pthread_mutex_lock(&m_threadLock);
+
+		if(++m_jobsDone == (int)m_jobs.size())
+			pthread_cond_signal(&m_threadDoneCondition);
+	}
+}
+
+void AUD_SoftwareDevice::readSounds(int length)
+{
+	pthread_mutex_lock(&m_threadLock);
+
+	for(AUD_HandleIterator it = m_playingSounds.begin(); it != m_playingSounds.end(); it++)
+	{
+		// update 3D Info
+		(*it)->update();
+
+		m_jobs.push_back(it->get());
+	}
+
+	m_jobNext = 0;
+	m_jobsDone = 0;
+	m_jobLength = length;
+
+	pthread_cond_broadcast(&m_threadCondition);
+
+	readJobs();
+
+	while(m_jobsDone < (int)m_jobs.size())
+		pthread_cond_wait(&m_threadDoneCondition, &m_threadLock);
+
+	m_jobs.clear();
+
+	pthread_mutex_unlock(&m_threadLock);
+}
+
+void AUD_SoftwareDevice::readThread()
+{
+	pthread_mutex_lock(&m_threadLock);
+
+	while(!m_threadsStop)
+	{
+		if(m_jobNext < (int)m_jobs.size())
+			readJobs();
+		else
+			pthread_cond_wait(&m_threadCondition, &m_threadLock);
+	}
+
+	pthread_mutex_unlock(&m_threadLock);
+}
+
+void* AUD_SoftwareDevice::runReadThread(void* device)
+{
+	((AUD_SoftwareDevice*)device)->readThread();
+	return NULL;
+}
+
+void AUD_SoftwareDevice::notifyPrefetch()
+{
+	m_prefetchPending = true;
+
+	// if the prefetch thread holds the lock it checks m_prefetchPending before waiting
+	if(pthread_mutex_trylock(&m_prefetchLock) == 0)
+	{
+		pthread_cond_signal(&m_prefetchCondition);
+		pthread_mutex_unlock(&m_prefetchLock);
+	}
+}
+
+void AUD_SoftwareDevice::prefetchThread()
+{
+	std::list<boost::shared_ptr<AUD_PrefetchReader> > readers;
+	bool decoding;
+
+	pthread_mutex_lock(&m_prefetchLock);
+
+	while(!m_prefetchStop)
+	{
+		readers = m_prefetchReaders;
+		m_prefetchPending = false;
+
+		pthread_mutex_unlock(&m_prefetchLock);
+
+		// one block per reader and round, so a slow decoder doesn't starve the others
+		decoding = false;
+
+		for(std::list<boost::shared_ptr<AUD_PrefetchReader> >::iterator it = readers.begin(); it != readers.end(); it++)
+			if((*it)->prefetch())
+				decoding = true;
+
+		readers.clear();
+
+		pthread_mutex_lock(&m_prefetchLock);
+
+		if(!decoding && !m_prefetchPending && !m_prefetchStop)
+			pthread_cond_wait(&m_prefetchCondition, &m_prefetchLock);
+	}
+
+	pthread_mutex_unlock(&m_prefetchLock);
+}
+
+void* AUD_SoftwareDevice::runPrefetchThread(void* device)
+{
+	((AUD_SoftwareDevice*)device)->prefetchThread();
+	return NULL;
+}
+
 void AUD_SoftwareDevice::mix(data_t* buffer, int length)
 {
 	m_buffer.assureSize(length * AUD_SAMPLE_SIZE(m_specs));
@@ -728,7 +916,6 @@ void AUD_SoftwareDevice::mix(data_t* buffer, int length)
 	{
 		boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> sound;
 		int len;
-		int pos;
 		bool eos;
 		std::list<boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> > stopSounds;
 		std::list<boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> > pauseSounds;
@@ -736,6 +923,9 @@ void AUD_SoftwareDevice::mix(data_t* buffer, int length)
 
 		m_mixer->clear(length);
 
+		if(!m_threads.empty())
+			readSounds(length);
+
 		// for all sounds
 		AUD_HandleIterator it = m_playingSounds.begin();
 		while(it != m_playingSounds.end())
@@ -746,35 +936,22 @@ void AUD_SoftwareDevice::mix(data_t* buffer, int length)
 			++it;
 
 			// get the buffer from the source
-			pos = 0;
-			len = length;
-
-			// update 3D Info
-			sound->update();
-
-			sound->m_reader->read(len, eos, buf);
-
-			// in case of looping
-			while(pos + len < length && sound->m_loopcount && eos)
+			if(m_threads.empty())
 			{
-				m_mixer->mix(buf, pos, len, sound->m_volume);
-
-				pos += len;
-
-				if(sound->m_loopcount > 0)
-					sound->m_loopcount--;
+				// update 3D Info
+				sound->update();
 
-				sound->m_reader->seek(0);
+				len = sound->read(buf, length, eos);
 
-				len = length - pos;
-				sound->m_reader->read(len, eos, buf);
-
-				// prevent endless loop
-				if(!len)
-					break;
+				m_mixer->mix(buf, 0, len, sound->m_volume);
 			}
+			else
+			{
+				// summed in the order of the playing sounds, independent of the threads
+				eos = sound->m_eos;
 
-			m_mixer->mix(buf, pos, len, sound->m_volume);
+				m_mixer->mix(sound->m_buffer.getBuffer(), 0, sound->m_length, sound->m_volume);
+			}
 
 			// in case the end of the sound is reached
 			if(eos && !sound->m_loopcount)
@@ -789,6 +966,9 @@ void AUD_SoftwareDevice::mix(data_t* buffer, int length)
 			}
 		}
 
+		if(m_prefetch)
+			notifyPrefetch();
+
 		// superpose
 		m_mixer->read(buffer, m_volume);
 
@@ -820,6 +1000,99 @@ void AUD_SoftwareDevice::setQuality(bool quality)
 	m_quality = quality;
 }
 
+void AUD_SoftwareDevice::setThreadCount(int count)
+{
+	count = AUD_MAX(count, 1) - 1;
+
+	if(count == (int)m_threads.size())
+		return;
+
+	if(!m_threads.empty())
+	{
+		pthread_mutex_lock(&m_threadLock);
+		m_threadsStop = true;
+		pthread_cond_broadcast(&m_threadCondition);
+		pthread_mutex_unlock(&m_threadLock);
+
+		for(int i = 0; i < (int)m_threads.size(); i++)
+			pthread_join(m_threads[i], NULL);
+
+		m_threads.clear();
+		m_threadsStop = false;
+	}
+
+	if(count)
+	{
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+		m_threads.resize(count);
+
+		for(int i = 0; i < count; i++)
+			pthread_create(&m_threads[i], &attr, runReadThread, this);
+
+		pthread_attr_destroy(&attr);
+	}
+}
+
+void AUD_SoftwareDevice::setPrefetch(bool prefetch)
+{
+	if(prefetch == m_prefetch)
+		return;
+
+	if(prefetch)
+	{
+		m_prefetchStop = false;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+		pthread_create(&m_prefetchThread, &attr, runPrefetchThread, this);
+
+		pthread_attr_destroy(&attr);
+	}
+	else
+	{
+		// sounds that were decoded ahead are decoded while mixing from now on
+		pthread_mutex_lock(&m_prefetchLock);
+		m_prefetchStop = true;
+		pthread_cond_signal(&m_prefetchCondition);
+		pthread_mutex_unlock(&m_prefetchLock);
+
+		pthread_join(m_prefetchThread, NULL);
+	}
+
+	m_prefetch = prefetch;
+}
+
+void AUD_SoftwareDevice::getUnderruns(int& underruns, int& dropouts)
+{
+	AUD_MutexLock lock(*this);
+
+	underruns = m_underruns;
+	dropouts = m_dropouts;
+
+	for(AUD_HandleIterator it = m_playingSounds.begin(); it != m_playingSounds.end(); it++)
+	{
+		if((*it)->m_prefetch.get())
+		{
+			underruns += (*it)->m_prefetch->getUnderruns();
+			dropouts += (*it)->m_prefetch->getDropouts();
+		}
+	}
+
+	for(AUD_HandleIterator it = m_pausedSounds.begin(); it != m_pausedSounds.end(); it++)
+	{
+		if((*it)->m_prefetch.get())
+		{
+			underruns += (*it)->m_prefetch->getUnderruns();
+			dropouts += (*it)->m_prefetch->getDropouts();
+		}
+	}
+}
+
 void AUD_SoftwareDevice::setSpecs(AUD_Specs specs)
 {
 	m_specs.specs = specs;
@@ -839,6 +1112,17 @@ AUD_DeviceSpecs AUD_SoftwareDevice::getSpecs() const
 boost::shared_ptr<AUD_IHandle> AUD_SoftwareDevice::play(boost::shared_ptr<AUD_IReader> reader, bool keep)
 {
 	// prepare the reader
+	// decode ahead
+
+	boost::shared_ptr<AUD_PrefetchReader> prefetch;
+
+	if(m_prefetch)
+	{
+		int size = AUD_PREFETCH_TIME * AUD_MAX(reader->getSpecs().rate, m_specs.rate);
+		prefetch = boost::shared_ptr<AUD_PrefetchReader>(new AUD_PrefetchReader(reader, size));
+		reader = boost::shared_ptr<AUD_IReader>(prefetch);
+	}
+
 	// pitch
 
 	boost::shared_ptr<AUD_PitchReader> pitch = boost::shared_ptr<AUD_PitchReader>(new AUD_PitchReader(reader, 1));
@@ -861,12 +1145,20 @@ boost::shared_ptr<AUD_IHandle> AUD_SoftwareDevice::play(boost::shared_ptr<AUD_IR
 		return boost::shared_ptr<AUD_IHandle>();
 
 	// play sound
-	boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> sound = boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle>(new AUD_SoftwareDevice::AUD_SoftwareHandle(this, reader, pitch, resampler, mapper, keep));
+	boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> sound = boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle>(new AUD_SoftwareDevice::AUD_SoftwareHandle(this, reader, prefetch, pitch, resampler, mapper, keep));
 
 	AUD_MutexLock lock(*this);
 
 	m_playingSounds.push_back(sound);
 
+	if(prefetch.get())
+	{
+		pthread_mutex_lock(&m_prefetchLock);
+		m_prefetchReaders.push_back(prefetch);
+		pthread_cond_signal(&m_prefetchCondition);
+		pthread_mutex_unlock(&m_prefetchLock);
+	}
+
 	if(!m_playback)
 		playing(m_playback = true);
 
@@ -36,11 +36,13 @@
 #include "AUD_I3DHandle.h"
 #include "AUD_Mixer.h"
 #include "AUD_Buffer.h"
+#include "AUD_PrefetchReader.h"
 #include "AUD_PitchReader.h"
 #include "AUD_ResampleReader.h"
 #include "AUD_ChannelMapperReader.h"
 
 #include <list>
+#include <vector>
 #include <pthread.h>
 
 /**
@@ -61,6 +63,9 @@ protected:
 		/// The reader source.
 		boost::shared_ptr<AUD_IReader> m_reader;
 
+		/// The prefetch reader in between, NULL if the source is read while mixing.
+		boost::shared_ptr<AUD_PrefetchReader> m_prefetch;
+
 		/// The pitch reader in between.
 		boost::shared_ptr<AUD_PitchReader> m_pitch;
 
@@ -139,18 +144,28 @@ protected:
 		/// Own device.
 		AUD_SoftwareDevice* m_device;
 
+		/// The buffer the sound is read into when the device reads on multiple threads.
+		AUD_Buffer m_buffer;
+
+		/// The count of samples in m_buffer.
+		int m_length;
+
+		/// Whether the end of the sound was read into m_buffer.
+		bool m_eos;
+
 	public:
 
 		/**
 		 * Creates a new software handle.
 		 * \param device The device this handle is from.
 		 * \param reader The reader to play.
+		 * \param prefetch The prefetch reader, may be NULL.
 		 * \param pitch The pitch reader.
 		 * \param resampler The resampling reader.
 		 * \param mapper The channel mapping reader.
 		 * \param keep Whether to keep the handle when the sound ends.
 		 */
-		AUD_SoftwareHandle(AUD_SoftwareDevice* device, boost::shared_ptr<AUD_IReader> reader, boost::shared_ptr<AUD_PitchReader> pitch, boost::shared_ptr<AUD_ResampleReader> resampler, boost::shared_ptr<AUD_ChannelMapperReader> mapper, bool keep);
+		AUD_SoftwareHandle(AUD_SoftwareDevice* device, boost::shared_ptr<AUD_IReader> reader, boost::shared_ptr<AUD_PrefetchReader> prefetch, boost::shared_ptr<AUD_PitchReader> pitch, boost::shared_ptr<AUD_ResampleReader> resampler, boost::shared_ptr<AUD_ChannelMapperReader> mapper, bool keep);
 
 		/**
 		 * Updates the handle's playback parameters.
@@ -163,6 +178,15 @@ protected:
 		 */
 		void setSpecs(AUD_Specs specs);
 
+		/**
+		 * Reads the next samples of the source, seeking back when looping.
+		 * \param buffer The buffer to read into.
+		 * \param length The count of samples to read.
+		 * \param[out] eos Whether the end of the sound was reached.
+		 * \return The count of samples read.
+		 */
+		int read(sample_t* buffer, int length, bool& eos);
+
 		virtual ~AUD_SoftwareHandle() {}
 		virtual bool pause();
 		virtual bool resume();
@@ -252,6 +276,13 @@ protected:
 	 */
 	void setSpecs(AUD_Specs specs);
 
+	/**
+	 * Sets whether sounds played from now on are decoded ahead in a separate
+	 * thread, so that mix() only copies their samples.
+	 * \param prefetch Whether to decode ahead.
+	 */
+	void setPrefetch(bool prefetch);
+
 private:
 	/**
 	 * The reading buffer.
@@ -304,6 +335,124 @@ private:
 	/// Rendering flags
 	int m_flags;
 
+	/**
+	 * Whether sounds are decoded ahead by the prefetch thread.
+	 */
+	bool m_prefetch;
+
+	/**
+	 * The prefetch readers of the playing and paused sounds.
+	 */
+	std::list<boost::shared_ptr<AUD_PrefetchReader> > m_prefetchReaders;
+
+	/**
+	 * The thread decoding the sounds ahead.
+	 */
+	pthread_t m_prefetchThread;
+
+	/**
+	 * The mutex for the prefetch reader list and the prefetch condition.
+	 */
+	pthread_mutex_t m_prefetchLock;
+
+	/**
+	 * The condition the prefetch thread waits on while all readers are full.
+	 */
+	pthread_cond_t m_prefetchCondition;
+
+	/**
+	 * Whether samples were read since the prefetch thread last decoded.
+	 */
+	volatile bool m_prefetchPending;
+
+	/**
+	 * Whether the prefetch thread should end.
+	 */
+	bool m_prefetchStop;
+
+	/// Underruns of the prefetch readers of stopped sounds.
+	int m_underruns;
+
+	/// Dropouts of the prefetch readers of stopped sounds.
+	int m_dropouts;
+
+	/**
+	 * The threads reading the playing sounds, in addition to the mixing thread.
+	 */
+	std::vector<pthread_t> m_threads;
+
+	/**
+	 * The mutex for the read jobs.
+	 */
+	pthread_mutex_t m_threadLock;
+
+	/**
+	 * The condition the read threads wait on for jobs.
+	 */
+	pthread_cond_t m_threadCondition;
+
+	/**
+	 * The condition the mixing thread waits on until all jobs are done.
+	 */
+	pthread_cond_t m_threadDoneCondition;
+
+	/**
+	 * The sounds to read.
+	 */
+	std::vector<AUD_SoftwareHandle*> m_jobs;
+
+	/// The index of the next sound to read.
+	int m_jobNext;
+
+	/// The count of sounds read.
+	int m_jobsDone;
+
+	/// The count of samples to read from every sound.
+	int m_jobLength;
+
+	/**
+	 * Whether the read threads should end.
+	 */
+	bool m_threadsStop;
+
+	/**
+	 * Reads sounds from m_jobs until none are left, m_threadLock has to be locked.
+	 */
+	void readJobs();
+
+	/**
+	 * Reads all playing sounds into their own buffers on all threads.
+	 * \param length The count of samples to read.
+	 */
+	void readSounds(int length);
+
+	/**
+	 * Reads sounds until the read threads are stopped.
+	 */
+	void readThread();
+
+	/**
+	 * Starts a read thread.
+	 * \param device The device.
+	 */
+	static void* runReadThread(void* device);
+
+	/**
+	 * Wakes up the prefetch thread, never blocks.
+	 */
+	void notifyPrefetch();
+
+	/**
+	 * Decodes the sounds ahead until the prefetch thread is stopped.
+	 */
+	void prefetchThread();
+
+	/**
+	 * Starts the prefetch thread.
+	 * \param device The device.
+	 */
+	static void* runPrefetchThread(void* device);
+
 public:
 
 	/**
@@ -319,6 +468,22 @@ public:
 	 */
 	void setQuality(bool quality);
 
+	/**
+	 * Sets how many threads read the playing sounds in mix(). The samples of
+	 * the sounds are still summed in order on the calling thread, so the
+	 * result is the same for any count.
+	 * \param count The thread count, 1 reads on the calling thread only.
+	 */
+	void setThreadCount(int count);
+
+	/**
+	 * Returns how often sounds weren't decoded ahead far enough.
+	 * \param[out] underruns How often a sound had to be decoded while mixing.
+	 * \param[out] dropouts How often a sound was mixed as silence, because the
+	 *             prefetch thread was decoding it at the same time.
+	 */
+	void getUnderruns(int& underruns, int& dropouts);
+
 	virtual AUD_DeviceSpecs getSpecs() const;
 	virtual boost::shared_ptr<AUD_IHandle> play(boost::shared_ptr<AUD_IReader> reader, bool keep = false);
 	virtual boost::shared_ptr<AUD_IHandle> play(boost::shared_ptr<AUD_IFactory> factory, bool keep = false);
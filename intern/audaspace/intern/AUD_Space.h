@@ -30,6 +30,8 @@
 #ifndef __AUD_SPACE_H__
 #define __AUD_SPACE_H__
 
+#include <stddef.h>
+
 /// The size of a format in bytes.
 #define AUD_FORMAT_SIZE(format) (format & 0x0F)
 /// The size of a sample in the specified device format in bytes.
@@ -236,6 +238,31 @@ typedef struct
 	};
 } AUD_DeviceSpecs;
 
+/// Statistics of the decoded sound cache.
+typedef struct
+{
+	/// The count of sounds in the cache.
+	int sounds;
+
+	/// How often a buffered sound was already decoded.
+	int hits;
+
+	/// How often a sound had to be decoded.
+	int misses;
+
+	/// How often a sound was removed from memory to stay within the limit.
+	int evictions;
+
+	/// How often a removed sound was read from its spill file again.
+	int spill_reads;
+
+	/// The size of the decoded sounds in memory in bytes.
+	size_t memory;
+
+	/// The size of the spill files in bytes.
+	size_t spilled;
+} AUD_BufferCacheStatistics;
+
 /// Exception structure.
 typedef struct
 {
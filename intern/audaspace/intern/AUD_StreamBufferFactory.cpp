@@ -28,19 +28,43 @@
 
 
 #include "AUD_StreamBufferFactory.h"
+#include "AUD_BufferCache.h"
 #include "AUD_BufferReader.h"
 #include "AUD_Buffer.h"
 
 #include <cstring>
 
-AUD_StreamBufferFactory::AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory> factory) :
-	m_buffer(new AUD_Buffer())
+AUD_StreamBufferFactory::AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory> factory)
 {
+	m_buffer = decode(factory, m_specs);
+}
+
+AUD_StreamBufferFactory::AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory> factory, const std::string& key) :
+	m_key(key)
+{
+	if(m_key.empty())
+		m_buffer = decode(factory, m_specs);
+	else
+	{
+		m_specs = AUD_BufferCache::getInstance().acquire(m_key, factory);
+		m_factory = factory;
+	}
+}
+
+AUD_StreamBufferFactory::~AUD_StreamBufferFactory()
+{
+	if(!m_key.empty())
+		AUD_BufferCache::getInstance().release(m_key);
+}
+
+boost::shared_ptr<AUD_Buffer> AUD_StreamBufferFactory::decode(boost::shared_ptr<AUD_IFactory> factory, AUD_Specs& specs)
+{
+	boost::shared_ptr<AUD_Buffer> buffer(new AUD_Buffer());
 	boost::shared_ptr<AUD_IReader> reader = factory->createReader();
 
-	m_specs = reader->getSpecs();
+	specs = reader->getSpecs();
 
-	int sample_size = AUD_SAMPLE_SIZE(m_specs);
+	int sample_size = AUD_SAMPLE_SIZE(specs);
 	int length;
 	int index = 0;
 	bool eos = false;
@@ -51,26 +75,31 @@ AUD_StreamBufferFactory::AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory>
 	if(size <= 0)
 		size = AUD_BUFFER_RESIZE_BYTES / sample_size;
 	else
-		size += m_specs.rate;
+		size += specs.rate;
 
 	// as long as the end of the stream is not reached
 	while(!eos)
 	{
 		// increase
-		m_buffer->resize(size*sample_size, true);
+		buffer->resize(size*sample_size, true);
 
 		// read more
 		length = size-index;
-		reader->read(length, eos, m_buffer->getBuffer() + index * m_specs.channels);
-		if(index == m_buffer->getSize() / sample_size)
+		reader->read(length, eos, buffer->getBuffer() + index * specs.channels);
+		if(index == buffer->getSize() / sample_size)
 			size += AUD_BUFFER_RESIZE_BYTES / sample_size;
 		index += length;
 	}
 
-	m_buffer->resize(index * sample_size, true);
+	buffer->resize(index * sample_size, true);
+
+	return buffer;
 }
 
 boost::shared_ptr<AUD_IReader> AUD_StreamBufferFactory::createReader()
 {
+	if(!m_key.empty())
+		return AUD_BufferCache::getInstance().createReader(m_key, m_factory);
+
 	return boost::shared_ptr<AUD_IReader>(new AUD_BufferReader(m_buffer, m_specs));
 }
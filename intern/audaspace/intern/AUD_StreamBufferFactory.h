@@ -34,6 +34,7 @@
 #include "AUD_Buffer.h"
 
 #include <boost/shared_ptr.hpp>
+#include <string>
 
 /**
  * This factory creates a buffer out of a reader. This way normally streamed
@@ -52,6 +53,17 @@ private:
 	 */
 	AUD_Specs m_specs;
 
+	/**
+	 * The factory that creates the reader for buffering, only kept if the
+	 * buffer is cached.
+	 */
+	boost::shared_ptr<AUD_IFactory> m_factory;
+
+	/**
+	 * The key of the sound in the buffer cache, empty if it isn't cached.
+	 */
+	std::string m_key;
+
 	// hide copy constructor and operator=
 	AUD_StreamBufferFactory(const AUD_StreamBufferFactory&);
 	AUD_StreamBufferFactory& operator=(const AUD_StreamBufferFactory&);
@@ -65,6 +77,28 @@ public:
 	 */
 	AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory> factory);
 
+	/**
+	 * Creates the factory and shares the buffer with all factories of the same
+	 * key through the buffer cache.
+	 * \param factory The factory that creates the reader for buffering.
+	 * \param key The key of the content the factory creates, if empty the
+	 *        buffer isn't cached.
+	 * \exception AUD_Exception Thrown if the reader cannot be created.
+	 * \see AUD_BufferCache::getKey
+	 */
+	AUD_StreamBufferFactory(boost::shared_ptr<AUD_IFactory> factory, const std::string& key);
+
+	virtual ~AUD_StreamBufferFactory();
+
+	/**
+	 * Reads the whole reader created by a factory into a buffer.
+	 * \param factory The factory that creates the reader.
+	 * \param[out] specs The specification of the samples.
+	 * \return The buffer.
+	 * \exception AUD_Exception Thrown if the reader cannot be created.
+	 */
+	static boost::shared_ptr<AUD_Buffer> decode(boost::shared_ptr<AUD_IFactory> factory, AUD_Specs& specs);
+
 	virtual boost::shared_ptr<AUD_IReader> createReader();
 };
 
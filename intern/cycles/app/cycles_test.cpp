@@ -21,15 +21,24 @@
 #include "buffers.h"
 #include "camera.h"
 #include "device.h"
+#include "integrator.h"
+#include "light.h"
 #include "scene.h"
 #include "session.h"
 
+#include "bvh.h"
+#include "bvh_params.h"
+
+#include "kernel_texture_cache.h"
+
 #include "util_args.h"
+#include "util_cache.h"
 #include "util_foreach.h"
 #include "util_function.h"
 #include "util_path.h"
 #include "util_progress.h"
 #include "util_string.h"
+#include "util_task.h"
 #include "util_time.h"
 #include "util_view.h"
 
@@ -45,6 +54,8 @@ struct Options {
 	SceneParams scene_params;
 	SessionParams session_params;
 	bool quiet;
+	bool bvh_benchmark;
+	bool use_light_tree;
 } options;
 
 static void session_print(const string& str)
@@ -114,6 +125,9 @@ static void scene_init(int width, int height)
 {
 	options.scene = new Scene(options.scene_params, options.session_params.device);
 	xml_read_file(options.scene, options.filepath.c_str());
+
+	if(options.use_light_tree)
+		options.scene->integrator->use_light_tree = true;
 	
 	if (width == 0 || height == 0) {
 		options.width = options.scene->camera->width;
@@ -121,9 +135,80 @@ static void scene_init(int width, int height)
 	}
 }
 
+static void session_print_idle_time()
+{
+	vector<double> idle_time;
+	options.session->progress.get_worker_idle_time(idle_time);
+
+	printf("Split tiles %d, stolen tiles %d\n",
+		options.session->tile_manager.state.num_split_tiles,
+		options.session->tile_manager.state.num_stolen_tiles);
+
+	for(int i = 0; i < idle_time.size(); i++)
+		printf("Worker %d idle %.3fs\n", i, idle_time[i]);
+}
+
+static void session_print_texture_cache_stats()
+{
+	TextureCache *texture_cache = options.session->device->texture_cache();
+
+	if(!options.scene_params.use_texture_cache || !texture_cache)
+		return;
+
+	TextureCache::Stats stats;
+	texture_cache->get_stats(stats);
+
+	uint64_t tile_lookups = stats.tile_hits + stats.tile_misses;
+	double hit_rate = (tile_lookups)? 100.0*stats.tile_hits/tile_lookups: 0.0;
+
+	printf("Texture cache: %d files, %llu tile hits, %llu tile misses (%.1f%% hit rate), %.2fM in memory, %.2fM read\n",
+		stats.num_files,
+		(unsigned long long)stats.tile_hits,
+		(unsigned long long)stats.tile_misses,
+		hit_rate,
+		stats.memory_used/(1024.0*1024.0),
+		stats.bytes_read/(1024.0*1024.0));
+}
+
+static void session_print_bvh_cache_stats()
+{
+	if(!options.scene_params.use_bvh_cache)
+		return;
+
+	CacheStats stats = Cache::global.get_stats();
+
+	printf("BVH cache: %llu hits, %llu misses, %llu evictions, %.2fM read, %.2fM written\n",
+		(unsigned long long)stats.hits,
+		(unsigned long long)stats.misses,
+		(unsigned long long)stats.evictions,
+		stats.bytes_read/(1024.0*1024.0),
+		stats.bytes_written/(1024.0*1024.0));
+}
+
+static void session_print_light_tree_stats()
+{
+	LightManager *light_manager = options.session->scene->light_manager;
+
+	if(!options.use_light_tree || light_manager->light_tree_num_nodes == 0)
+		return;
+
+	printf("Light tree: %d emitters, %d nodes, built in %.4fs\n",
+		light_manager->light_tree_num_emitters,
+		light_manager->light_tree_num_nodes,
+		light_manager->light_tree_build_time);
+}
+
 static void session_exit()
 {
 	if(options.session) {
+		if(options.session_params.background && !options.quiet) {
+			printf("\n");
+			session_print_idle_time();
+			session_print_texture_cache_stats();
+			session_print_bvh_cache_stats();
+			session_print_light_tree_stats();
+		}
+
 		delete options.session;
 		options.session = NULL;
 	}
@@ -138,6 +223,41 @@ static void session_exit()
 	}
 }
 
+static void bvh_benchmark()
+{
+	/* build a BVH over all scene objects with both split methods, reporting
+	 * build and refit time and SAH cost */
+	Progress progress;
+
+	TaskScheduler::init(options.session_params.threads);
+
+	for(int spatial_split = 0; spatial_split < 2; spatial_split++) {
+		BVHParams bparams;
+		bparams.use_spatial_split = spatial_split;
+		bparams.use_qbvh = options.scene_params.use_qbvh;
+
+		double start_time = time_dt();
+
+		BVH *bvh = BVH::create(bparams, options.scene->objects);
+		bvh->build(progress);
+
+		double build_time = time_dt() - start_time;
+
+		start_time = time_dt();
+		bvh->refit(progress);
+
+		double refit_time = time_dt() - start_time;
+
+		printf("%s split BVH: build time %.4fs, refit time %.4fs, SAH cost %.4f, primitives %d\n",
+			(spatial_split)? "Spatial": "Object", build_time, refit_time, bvh->pack.SAH,
+			(int)bvh->pack.prim_index.size());
+
+		delete bvh;
+	}
+
+	TaskScheduler::exit();
+}
+
 static void display_info(Progress& progress)
 {
 	static double latency = 0.0;
@@ -204,11 +324,15 @@ static void options_parse(int argc, const char **argv)
 	options.filepath = "";
 	options.session = NULL;
 	options.quiet = false;
+	options.bvh_benchmark = false;
+	options.use_light_tree = false;
 
 	/* device names */
 	string device_names = "";
 	string devicename = "cpu";
 	bool list = false;
+	int texture_cache_size = 0;
+	int bvh_cache_size = 0;
 
 	vector<DeviceType>& types = Device::available_types();
 
@@ -237,9 +361,14 @@ static void options_parse(int argc, const char **argv)
 		"--shadingsys %s", &ssname, "Shading system to use: svm, osl",
 		"--background", &options.session_params.background, "Render in background, without user interface",
 		"--quiet", &options.quiet, "In background mode, don't print progress messages",
+		"--bvh-benchmark", &options.bvh_benchmark, "Build the scene BVH with object and spatial splits, and report build time and SAH cost",
 		"--samples %d", &options.session_params.samples, "Number of samples to render",
+		"--texture-cache %d", &texture_cache_size, "Read image textures on demand on the CPU, with a cache of the given size in megabytes",
+		"--bvh-cache %d", &bvh_cache_size, "Cache built BVHs on disk, using at most the given size in megabytes",
 		"--output %s", &options.session_params.output_path, "File path to write output image",
 		"--threads %d", &options.session_params.threads, "CPU Rendering Threads",
+		"--ray-packets", &options.session_params.use_ray_packets, "Trace camera rays in packets on the CPU, to compare render time against single rays",
+		"--light-tree", &options.use_light_tree, "Sample mesh lights with a light tree on the CPU, to compare noise against render time",
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--list-devices", &list, "List information about all available devices",
@@ -272,6 +401,16 @@ static void options_parse(int argc, const char **argv)
 		options.scene_params.shadingsystem = SceneParams::OSL;
 	else if(ssname == "svm")
 		options.scene_params.shadingsystem = SceneParams::SVM;
+
+	if(texture_cache_size > 0) {
+		options.scene_params.use_texture_cache = true;
+		options.scene_params.texture_cache_size = texture_cache_size;
+	}
+
+	if(bvh_cache_size > 0) {
+		options.scene_params.use_bvh_cache = true;
+		options.scene_params.bvh_cache_size = bvh_cache_size;
+	}
 		
 	/* Progressive rendering */
 	options.session_params.progressive = true;
@@ -330,7 +469,11 @@ int main(int argc, const char **argv)
 
 	options_parse(argc, argv);
 
-	if(options.session_params.background) {
+	if(options.bvh_benchmark) {
+		bvh_benchmark();
+		delete options.scene;
+	}
+	else if(options.session_params.background) {
 		session_init();
 		options.session->wait();
 		session_exit();
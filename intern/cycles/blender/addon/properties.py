@@ -231,6 +231,33 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default='SOBOL',
                 )
 
+        cls.use_adaptive_sampling = BoolProperty(
+                name="Adaptive Sampling",
+                description="Stop sampling pixels once their noise is below the threshold, "
+                            "for final renders on the CPU",
+                default=False,
+                )
+        cls.adaptive_threshold = FloatProperty(
+                name="Adaptive Threshold",
+                description="Noise level at which a pixel stops receiving samples, "
+                            "lower values give less noise and longer render times",
+                min=0.0001, max=1.0,
+                default=0.01,
+                precision=4,
+                )
+        cls.adaptive_min_samples = IntProperty(
+                name="Adaptive Min Samples",
+                description="Minimum number of AA samples before pixels can stop sampling",
+                min=4, max=4096,
+                default=16,
+                )
+        cls.use_light_tree = BoolProperty(
+                name="Light Tree",
+                description="Sample mesh lights by their estimated contribution instead of their area, "
+                            "for scenes with many small emitters on the CPU",
+                default=False,
+                )
+
         cls.use_layer_samples = EnumProperty(
                 name="Layer Samples",
                 description="How to use per render layer sample settings",
@@ -392,11 +419,33 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.debug_use_ray_packets = BoolProperty(
+                name="Use Ray Packets",
+                description="Trace coherent camera rays in packets on the CPU: faster render for simple scenes without hair or motion blur",
+                default=False,
+                )
         cls.use_cache = BoolProperty(
                 name="Cache BVH",
                 description="Cache last built BVH to disk for faster re-render if no geometry changed",
                 default=False,
                 )
+        cls.bvh_cache_size = IntProperty(
+                name="Cache Size",
+                description="Maximum disk space used by cached BVHs, least recently used ones are removed first, in megabytes",
+                min=16, max=1048576,
+                default=2048,
+                )
+        cls.use_texture_cache = BoolProperty(
+                name="Texture Cache",
+                description="Read image textures on demand during CPU rendering, keeping only recently used tiles in memory",
+                default=False,
+                )
+        cls.texture_cache_size = IntProperty(
+                name="Cache Size",
+                description="Maximum memory used by the texture cache, in megabytes",
+                min=16, max=65536,
+                default=1024,
+                )
         cls.tile_order = EnumProperty(
                 name="Tile Order",
                 description="Tile order for rendering",
@@ -88,6 +88,21 @@ class CyclesRender_PT_sampling(CyclesButtonsPanel, Panel):
         if cscene.feature_set == 'EXPERIMENTAL':
             layout.row().prop(cscene, "sampling_pattern", text="Pattern")
 
+        split = layout.split()
+        split.active = (device_type == 'NONE' or cscene.device == 'CPU')
+
+        col = split.column()
+        col.prop(cscene, "use_adaptive_sampling", text="Adaptive")
+
+        col = split.column(align=True)
+        col.active = cscene.use_adaptive_sampling
+        col.prop(cscene, "adaptive_threshold", text="Threshold")
+        col.prop(cscene, "adaptive_min_samples", text="Min Samples")
+
+        row = layout.row()
+        row.active = (device_type == 'NONE' or cscene.device == 'CPU')
+        row.prop(cscene, "use_light_tree")
+
         for rl in scene.render.layers:
             if rl.samples > 0:
                 layout.separator()
@@ -219,7 +234,11 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
         sub.label(text="Acceleration structure:")
         sub.prop(cscene, "debug_bvh_type", text="")
         sub.prop(cscene, "debug_use_spatial_splits")
+        sub.prop(cscene, "debug_use_ray_packets")
         sub.prop(cscene, "use_cache")
+        subsub = sub.column()
+        subsub.active = cscene.use_cache
+        subsub.prop(cscene, "bvh_cache_size")
 
         sub = col.column(align=True)
         sub.label(text="Viewport:")
@@ -229,6 +248,13 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
         sub.label(text="Final Render:")
         sub.prop(rd, "use_persistent_data", text="Persistent Images")
 
+        sub = col.column(align=True)
+        sub.label(text="Images:")
+        sub.prop(cscene, "use_texture_cache")
+        subsub = sub.column()
+        subsub.active = cscene.use_texture_cache
+        subsub.prop(cscene, "texture_cache_size")
+
 
 class CyclesRender_PT_opengl(CyclesButtonsPanel, Panel):
     bl_label = "OpenGL Render"
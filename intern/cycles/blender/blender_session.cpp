@@ -371,6 +371,9 @@ void BlenderSession::render()
 		/* free result without merging */
 		end_render_result(b_engine, b_rr, true);
 
+		if(session_params.adaptive_sampling)
+			Pass::add(PASS_ADAPTIVE_AUX, passes);
+
 		buffer_params.passes = passes;
 		scene->film->tag_passes_update(scene, passes);
 		scene->film->tag_update(scene);
@@ -199,6 +199,19 @@ void BlenderSync::sync_integrator()
 	integrator->subsurface_samples = get_int(cscene, "subsurface_samples");
 	integrator->progressive = get_boolean(cscene, "progressive");
 
+	if(get_boolean(cscene, "use_adaptive_sampling"))
+		integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+	else
+		integrator->adaptive_threshold = 0.0f;
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
+	bool use_light_tree = get_boolean(cscene, "use_light_tree");
+
+	if(integrator->use_light_tree != use_light_tree) {
+		scene->light_manager->tag_update(scene);
+		integrator->use_light_tree = use_light_tree;
+	}
+
 	if(experimental)
 		integrator->sampling_pattern = (SamplingPattern)RNA_enum_get(&cscene, "sampling_pattern");
 
@@ -329,6 +342,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background)
 
 	params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
 	params.use_bvh_cache = (background)? RNA_boolean_get(&cscene, "use_cache"): false;
+	params.bvh_cache_size = RNA_int_get(&cscene, "bvh_cache_size");
+
+	params.use_texture_cache = RNA_boolean_get(&cscene, "use_texture_cache");
+	params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
 
 	if(background && params.shadingsystem != SceneParams::OSL)
 		params.persistent_data = r.use_persistent_data();
@@ -433,6 +450,9 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine b_engine, BL::Use
 	else
 		params.threads = 0;
 
+	params.use_ray_packets = get_boolean(cscene, "debug_use_ray_packets");
+	params.adaptive_sampling = get_boolean(cscene, "use_adaptive_sampling");
+
 	params.cancel_timeout = get_float(cscene, "debug_cancel_timeout");
 	params.reset_timeout = get_float(cscene, "debug_reset_timeout");
 	params.text_timeout = get_float(cscene, "debug_text_timeout");
@@ -450,6 +470,10 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine b_engine, BL::Use
 	else
 		params.progressive = true;
 
+	/* adaptive sampling works per tile on the CPU only */
+	if(params.progressive || params.device.type != DEVICE_CPU)
+		params.adaptive_sampling = false;
+
 	/* shading system - scene level needs full refresh */
 	int shadingsystem = RNA_boolean_get(&cscene, "shading_system");
 
@@ -31,6 +31,7 @@
 #include "util_map.h"
 #include "util_progress.h"
 #include "util_system.h"
+#include "util_task.h"
 #include "util_types.h"
 #include "util_math.h"
 
@@ -59,6 +60,14 @@ struct BVHStackEntry
 BVH::BVH(const BVHParams& params_, const vector<Object*>& objects_)
 : params(params_), objects(objects_)
 {
+	cache_data = NULL;
+}
+
+BVH::~BVH()
+{
+	/* packed arrays may reference the mapped cache file */
+	pack = PackedBVH();
+	delete cache_data;
 }
 
 BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
@@ -73,39 +82,43 @@ BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
 
 bool BVH::cache_read(CacheData& key)
 {
-	key.add(system_cpu_bits());
+	/* key buffers must stay valid until the filename is computed on lookup */
+	int cpu_bits = system_cpu_bits();
+
+	key.add(cpu_bits);
 	key.add(&params, sizeof(params));
 
+	/* mesh geometry is hashed once when it changes, see Mesh::compute_bvh */
 	foreach(Object *ob, objects) {
-		key.add(ob->mesh->verts);
-		key.add(ob->mesh->triangles);
-		key.add(ob->mesh->curve_keys);
-		key.add(ob->mesh->curves);
+		key.add(&ob->mesh->geometry_hash, sizeof(ob->mesh->geometry_hash));
 		key.add(&ob->bounds, sizeof(ob->bounds));
 		key.add(&ob->visibility, sizeof(ob->visibility));
 		key.add(&ob->mesh->transform_applied, sizeof(bool));
 	}
 
-	CacheData value;
+	CacheData *value = new CacheData();
 
-	if(Cache::global.lookup(key, value)) {
-		cache_filename = key.get_filename();
+	if(Cache::global.lookup(key, *value)) {
+		/* arrays reference the mapped file, no copies are made */
+		value->read(pack.root_index);
+		value->read(pack.SAH);
 
-		value.read(pack.root_index);
-		value.read(pack.SAH);
+		value->read(pack.nodes);
+		value->read(pack.object_node);
+		value->read(pack.tri_woop);
+		value->read(pack.prim_segment);
+		value->read(pack.prim_visibility);
+		value->read(pack.prim_index);
+		value->read(pack.prim_object);
+		value->read(pack.is_leaf);
 
-		value.read(pack.nodes);
-		value.read(pack.object_node);
-		value.read(pack.tri_woop);
-		value.read(pack.prim_segment);
-		value.read(pack.prim_visibility);
-		value.read(pack.prim_index);
-		value.read(pack.prim_object);
-		value.read(pack.is_leaf);
+		cache_data = value;
 
 		return true;
 	}
 
+	delete value;
+
 	return false;
 }
 
@@ -126,26 +139,15 @@ void BVH::cache_write(CacheData& key)
 	value.add(pack.is_leaf);
 
 	Cache::global.insert(key, value);
-
-	cache_filename = key.get_filename();
 }
 
-void BVH::clear_cache_except()
+void BVH::cache_free()
 {
-	set<string> except;
-
-	if(!cache_filename.empty())
-		except.insert(cache_filename);
-
-	foreach(Object *ob, objects) {
-		Mesh *mesh = ob->mesh;
-		BVH *bvh = mesh->bvh;
-
-		if(bvh && !bvh->cache_filename.empty())
-			except.insert(bvh->cache_filename);
+	if(cache_data) {
+		pack = PackedBVH();
+		delete cache_data;
+		cache_data = NULL;
 	}
-
-	Cache::global.clear_except("bvh", except);
 }
 
 /* Building */
@@ -154,6 +156,13 @@ void BVH::build(Progress& progress)
 {
 	progress.set_substatus("Building BVH");
 
+	/* node layout changes, refit mappings are created again when needed */
+	refit_parent.clear();
+	refit_object_leaves.clear();
+
+	/* release previously mapped cache file */
+	cache_free();
+
 	/* cache read */
 	CacheData key("bvh");
 
@@ -215,9 +224,9 @@ void BVH::build(Progress& progress)
 		progress.set_substatus("Writing BVH cache");
 		cache_write(key);
 
-		/* clear other bvh files from cache */
+		/* evict least recently used bvh files from cache */
 		if(params.top_level)
-			clear_cache_except();
+			Cache::global.evict("bvh");
 	}
 }
 
@@ -225,23 +234,234 @@ void BVH::build(Progress& progress)
 
 void BVH::refit(Progress& progress)
 {
-	progress.set_substatus("Packing BVH primitives");
-	pack_primitives();
+	progress.set_substatus("Refitting BVH nodes");
 
-	if(progress.get_cancel()) return;
+	/* refit all nodes */
+	refit_tag.clear();
+	refit_nodes();
+}
 
+void BVH::refit(Progress& progress, const vector<bool>& refit_objects)
+{
 	progress.set_substatus("Refitting BVH nodes");
+
+	/* refit only nodes containing primitives of the given objects */
+	refit_tag_objects(refit_objects);
 	refit_nodes();
 }
 
+void BVH::refit_init()
+{
+	/* map nodes to their parent, and objects to leaf nodes with their
+	 * primitives, so we can tag the nodes affected by changed objects */
+	size_t num_nodes = pack.is_leaf.size();
+
+	refit_parent.clear();
+	refit_parent.resize(num_nodes, -1);
+	refit_object_leaves.clear();
+	refit_object_leaves.resize(objects.size());
+
+	for(size_t idx = 0; idx < num_nodes; idx++) {
+		if(pack.is_leaf[idx]) {
+			int lo, hi;
+			get_leaf_range(idx, lo, hi);
+
+			for(int prim = lo; prim < hi; prim++) {
+				/* primitives of instanced BVH's merged into the top level are
+				 * refitted with the BVH of their mesh */
+				if(refit_instance_primitive(prim))
+					continue;
+
+				vector<int>& leaves = refit_object_leaves[pack.prim_object[prim]];
+
+				if(leaves.empty() || leaves.back() != (int)idx)
+					leaves.push_back(idx);
+			}
+		}
+		else {
+			int children[4];
+			int num = get_children(idx, children);
+
+			for(int i = 0; i < num; i++)
+				refit_parent[children[i]] = idx;
+		}
+	}
+}
+
+bool BVH::refit_instance_primitive(int prim) const
+{
+	/* in the top level only meshes with transform applied have triangles,
+	 * others are instanced with an object primitive */
+	if(!params.top_level || pack.prim_index[prim] == -1)
+		return false;
+
+	return !objects[pack.prim_object[prim]]->mesh->transform_applied;
+}
+
+void BVH::refit_tag_objects(const vector<bool>& refit_objects)
+{
+	if(refit_parent.size() != pack.is_leaf.size())
+		refit_init();
+
+	refit_tag.clear();
+	refit_tag.resize(pack.is_leaf.size(), false);
+
+	/* tag leaves and walk up to the root, stopping at already tagged nodes */
+	for(size_t ob = 0; ob < refit_objects.size() && ob < refit_object_leaves.size(); ob++) {
+		if(!refit_objects[ob])
+			continue;
+
+		foreach(int leaf, refit_object_leaves[ob])
+			for(int idx = leaf; idx != -1 && !refit_tag[idx]; idx = refit_parent[idx])
+				refit_tag[idx] = true;
+	}
+}
+
+void BVH::refit_nodes()
+{
+	if(pack.is_leaf.size() == 0 || !refit_tagged(0))
+		return;
+
+	/* collect subtrees to refit in parallel */
+	refit_tasks.clear();
+	refit_task_map.clear();
+	refit_collect_tasks(0, 0);
+
+	TaskPool pool;
+
+	for(size_t i = 0; i < refit_tasks.size(); i++) {
+		refit_task_map[refit_tasks[i].idx] = i;
+		pool.push(function_bind(&BVH::refit_task_run, this, &refit_tasks[i]));
+	}
+
+	pool.wait_work();
+
+	/* refit nodes above the subtrees */
+	BoundBox bbox = BoundBox::empty;
+	uint visibility = 0;
+
+	refit_child(0, 0, bbox, visibility);
+
+	refit_tasks.clear();
+	refit_task_map.clear();
+}
+
+void BVH::refit_collect_tasks(int idx, int depth)
+{
+	if(!refit_tagged(idx))
+		return;
+
+	if(depth == REFIT_TASK_DEPTH || pack.is_leaf[idx]) {
+		BVHRefitTask task;
+
+		task.idx = idx;
+		task.depth = depth;
+		task.bbox = BoundBox::empty;
+		task.visibility = 0;
+
+		refit_tasks.push_back(task);
+	}
+	else {
+		int children[4];
+		int num = get_children(idx, children);
+
+		for(int i = 0; i < num; i++)
+			refit_collect_tasks(children[i], depth + 1);
+	}
+}
+
+void BVH::refit_task_run(BVHRefitTask *task)
+{
+	refit_node(task->idx, task->depth, task->bbox, task->visibility);
+}
+
+void BVH::refit_child(int idx, int depth, BoundBox& bbox, uint& visibility)
+{
+	/* use result of subtree refitted in parallel */
+	if(depth <= REFIT_TASK_DEPTH) {
+		map<int, int>::iterator it = refit_task_map.find(idx);
+
+		if(it != refit_task_map.end()) {
+			BVHRefitTask& task = refit_tasks[it->second];
+
+			bbox.grow(task.bbox);
+			visibility |= task.visibility;
+			return;
+		}
+	}
+
+	refit_node(idx, depth, bbox, visibility);
+}
+
+void BVH::refit_primitives(int start, int end, BoundBox& bbox, uint& visibility)
+{
+	/* recompute bounds and repack intersection data of leaf primitives */
+	for(int prim = start; prim < end; prim++) {
+		int pidx = pack.prim_index[prim];
+		int tob = pack.prim_object[prim];
+		Object *ob = objects[tob];
+
+		if(pidx == -1) {
+			/* object instance */
+			bbox.grow(ob->bounds);
+		}
+		else {
+			/* primitives */
+			const Mesh *mesh = ob->mesh;
+			float4 woop[3];
+
+			if(pack.prim_segment[prim] != ~0) {
+				/* curves */
+				int str_offset = (params.top_level)? mesh->curve_offset: 0;
+				const Mesh::Curve& curve = mesh->curves[pidx - str_offset];
+				int k0 = curve.first_key + pack.prim_segment[prim]; // XXX!
+				int k1 = k0 + 1;
+
+				float3 p[4];
+				p[0] = mesh->curve_keys[max(k0 - 1, curve.first_key)].co;
+				p[1] = mesh->curve_keys[k0].co;
+				p[2] = mesh->curve_keys[k1].co;
+				p[3] = mesh->curve_keys[min(k1 + 1, curve.first_key + curve.num_keys - 1)].co;
+				float3 lower;
+				float3 upper;
+				curvebounds(&lower.x, &upper.x, p, 0);
+				curvebounds(&lower.y, &upper.y, p, 1);
+				curvebounds(&lower.z, &upper.z, p, 2);
+				float mr = max(mesh->curve_keys[k0].radius, mesh->curve_keys[k1].radius);
+				bbox.grow(lower, mr);
+				bbox.grow(upper, mr);
+
+				pack_curve_segment(mesh, pidx - str_offset, pack.prim_segment[prim], woop);
+				pack.prim_visibility[prim] = ob->visibility|PATH_RAY_CURVE;
+
+				visibility |= PATH_RAY_CURVE;
+			}
+			else {
+				/* triangles */
+				int tri_offset = (params.top_level)? mesh->tri_offset: 0;
+				const int *vidx = mesh->triangles[pidx - tri_offset].v;
+				const float3 *vpos = &mesh->verts[0];
+
+				bbox.grow(vpos[vidx[0]]);
+				bbox.grow(vpos[vidx[1]]);
+				bbox.grow(vpos[vidx[2]]);
+
+				pack_triangle(mesh, pidx - tri_offset, woop);
+				pack.prim_visibility[prim] = ob->visibility;
+			}
+
+			memcpy(&pack.tri_woop[prim * TRI_NODE_SIZE], woop, sizeof(float4)*3);
+		}
+
+		visibility |= ob->visibility;
+	}
+}
+
 /* Triangles */
 
-void BVH::pack_triangle(int idx, float4 woop[3])
+void BVH::pack_triangle(const Mesh *mesh, int tidx, float4 woop[3])
 {
 	/* create Woop triangle */
-	int tob = pack.prim_object[idx];
-	const Mesh *mesh = objects[tob]->mesh;
-	int tidx = pack.prim_index[idx];
 	const int *vidx = mesh->triangles[tidx].v;
 	const float3* vpos = &mesh->verts[0];
 	float3 v0 = vpos[vidx[0]];
@@ -275,14 +495,10 @@ void BVH::pack_triangle(int idx, float4 woop[3])
 
 /* Curves*/
 
-void BVH::pack_curve_segment(int idx, float4 woop[3])
+void BVH::pack_curve_segment(const Mesh *mesh, int cidx, int segment, float4 woop[3])
 {
-	int tob = pack.prim_object[idx];
-	const Mesh *mesh = objects[tob]->mesh;
-	int tidx = pack.prim_index[idx];
-	int segment = pack.prim_segment[idx];
-	int k0 = mesh->curves[tidx].first_key + segment;
-	int k1 = mesh->curves[tidx].first_key + segment + 1;
+	int k0 = mesh->curves[cidx].first_key + segment;
+	int k1 = mesh->curves[cidx].first_key + segment + 1;
 	float3 v0 = mesh->curve_keys[k0].co;
 	float3 v1 = mesh->curve_keys[k1].co;
 
@@ -331,16 +547,16 @@ void BVH::pack_primitives()
 	for(unsigned int i = 0; i < tidx_size; i++) {
 		if(pack.prim_index[i] != -1) {
 			float4 woop[3];
+			int tob = pack.prim_object[i];
+			Object *ob = objects[tob];
 
 			if(pack.prim_segment[i] != ~0)
-				pack_curve_segment(i, woop);
+				pack_curve_segment(ob->mesh, pack.prim_index[i], pack.prim_segment[i], woop);
 			else
-				pack_triangle(i, woop);
+				pack_triangle(ob->mesh, pack.prim_index[i], woop);
 			
 			memcpy(&pack.tri_woop[i * nsize], woop, sizeof(float4)*3);
 
-			int tob = pack.prim_object[i];
-			Object *ob = objects[tob];
 			pack.prim_visibility[i] = ob->visibility;
 
 			if(pack.prim_segment[i] != ~0)
@@ -473,7 +689,8 @@ void BVH::pack_instances(size_t nodes_size)
 
 				pack_prim_segment[pack_prim_index_offset] = bvh_prim_segment[i];
 				pack_prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
-				pack_prim_object[pack_prim_index_offset] = 0;  // unused for instances
+				/* unused for traversal of instances, the refit uses it to skip these */
+				pack_prim_object[pack_prim_index_offset] = object_offset - 1;
 				pack_prim_index_offset++;
 			}
 		}
@@ -606,89 +823,89 @@ void RegularBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 	pack.root_index = (pack.is_leaf[0])? -1: 0;
 }
 
-void RegularBVH::refit_nodes()
+int RegularBVH::get_children(int idx, int children[4]) const
 {
-	assert(!params.top_level);
+	const int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+	int c0 = data[3].x;
+	int c1 = data[3].y;
 
-	BoundBox bbox = BoundBox::empty;
-	uint visibility = 0;
-	refit_node(0, (pack.is_leaf[0])? true: false, bbox, visibility);
+	children[0] = (c0 < 0)? -c0-1: c0;
+	children[1] = (c1 < 0)? -c1-1: c1;
+
+	return 2;
+}
+
+void RegularBVH::get_leaf_range(int idx, int& lo, int& hi) const
+{
+	const int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+	int c0 = data[3].x;
+	int c1 = data[3].y;
+
+	if(c0 < 0) {
+		/* object */
+		lo = ~c0;
+		hi = lo + 1;
+	}
+	else {
+		/* triangles */
+		lo = c0;
+		hi = c1;
+	}
 }
 
-void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+void RegularBVH::refit_node(int idx, int depth, BoundBox& bbox, uint& visibility)
 {
-	int4 *data = &pack.nodes[idx*4];
+	int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
 
 	int c0 = data[3].x;
 	int c1 = data[3].y;
 
-	if(leaf) {
+	if(pack.is_leaf[idx]) {
 		/* refit leaf node */
-		for(int prim = c0; prim < c1; prim++) {
-			int pidx = pack.prim_index[prim];
-			int tob = pack.prim_object[prim];
-			Object *ob = objects[tob];
+		int lo, hi;
+		get_leaf_range(idx, lo, hi);
 
-			if(pidx == -1) {
-				/* object instance */
-				bbox.grow(ob->bounds);
-			}
-			else {
-				/* primitives */
-				const Mesh *mesh = ob->mesh;
-
-				if(pack.prim_segment[prim] != ~0) {
-					/* curves */
-					int str_offset = (params.top_level)? mesh->curve_offset: 0;
-					int k0 = mesh->curves[pidx - str_offset].first_key + pack.prim_segment[prim]; // XXX!
-					int k1 = k0 + 1;
-
-					float3 p[4];
-					p[0] = mesh->curve_keys[max(k0 - 1,mesh->curves[pidx - str_offset].first_key)].co;
-					p[1] = mesh->curve_keys[k0].co;
-					p[2] = mesh->curve_keys[k1].co;
-					p[3] = mesh->curve_keys[min(k1 + 1,mesh->curves[pidx - str_offset].first_key + mesh->curves[pidx - str_offset].num_keys - 1)].co;
-					float3 lower;
-					float3 upper;
-					curvebounds(&lower.x, &upper.x, p, 0);
-					curvebounds(&lower.y, &upper.y, p, 1);
-					curvebounds(&lower.z, &upper.z, p, 2);
-					float mr = max(mesh->curve_keys[k0].radius,mesh->curve_keys[k1].radius);
-					bbox.grow(lower, mr);
-					bbox.grow(upper, mr);
-
-					visibility |= PATH_RAY_CURVE;
-				}
-				else {
-					/* triangles */
-					int tri_offset = (params.top_level)? mesh->tri_offset: 0;
-					const int *vidx = mesh->triangles[pidx - tri_offset].v;
-					const float3 *vpos = &mesh->verts[0];
-
-					bbox.grow(vpos[vidx[0]]);
-					bbox.grow(vpos[vidx[1]]);
-					bbox.grow(vpos[vidx[2]]);
-				}
-			}
+		BoundBox leaf_bbox = BoundBox::empty;
+		uint leaf_visibility = 0;
 
-			visibility |= ob->visibility;
-		}
+		refit_primitives(lo, hi, leaf_bbox, leaf_visibility);
+		pack_node(idx, leaf_bbox, leaf_bbox, c0, c1, leaf_visibility, leaf_visibility);
 
-		pack_node(idx, bbox, bbox, c0, c1, visibility, visibility);
+		bbox.grow(leaf_bbox);
+		visibility |= leaf_visibility;
 	}
 	else {
 		/* refit inner node, set bbox from children */
 		BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
 		uint visibility0 = 0, visibility1 = 0;
+		int children[4];
+
+		get_children(idx, children);
 
-		refit_node((c0 < 0)? -c0-1: c0, (c0 < 0), bbox0, visibility0);
-		refit_node((c1 < 0)? -c1-1: c1, (c1 < 0), bbox1, visibility1);
+		if(refit_tagged(children[0])) {
+			refit_child(children[0], depth + 1, bbox0, visibility0);
+		}
+		else {
+			/* keep packed bounds of unchanged child */
+			bbox0.min = make_float3(__int_as_float(data[0].x), __int_as_float(data[1].x), __int_as_float(data[2].x));
+			bbox0.max = make_float3(__int_as_float(data[0].z), __int_as_float(data[1].z), __int_as_float(data[2].z));
+			visibility0 = data[3].z;
+		}
+
+		if(refit_tagged(children[1])) {
+			refit_child(children[1], depth + 1, bbox1, visibility1);
+		}
+		else {
+			bbox1.min = make_float3(__int_as_float(data[0].y), __int_as_float(data[1].y), __int_as_float(data[2].y));
+			bbox1.max = make_float3(__int_as_float(data[0].w), __int_as_float(data[1].w), __int_as_float(data[2].w));
+			visibility1 = data[3].w;
+		}
 
 		pack_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
 
 		bbox.grow(bbox0);
 		bbox.grow(bbox1);
-		visibility = visibility0|visibility1;
+		visibility |= visibility0|visibility1;
 	}
 }
 
@@ -699,7 +916,7 @@ QBVH::QBVH(const BVHParams& params_, const vector<Object*>& objects_)
 {
 	params.use_qbvh = true;
 
-	/* todo: use visibility */
+	/* todo: use visibility in traversal */
 }
 
 void QBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
@@ -738,7 +955,8 @@ void QBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num)
 		data[5][i] = bb_max.z;
 
 		data[6][i] = __int_as_float(en[i].encodeIdx());
-		data[7][i] = 0.0f;
+		/* not used for traversal, only read back by refit */
+		data[7][i] = __uint_as_float(en[i].node->m_visibility);
 	}
 
 	for(int i = num; i < 4; i++) {
@@ -830,9 +1048,85 @@ void QBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 	pack.root_index = (pack.is_leaf[0])? -1: 0;
 }
 
-void QBVH::refit_nodes()
+int QBVH::get_children(int idx, int children[4]) const
+{
+	const float4 *data = (const float4*)&pack.nodes[idx*BVH_QNODE_SIZE];
+	int num = 0;
+
+	/* unused child slots have index 0, which can only be the root */
+	for(int i = 0; i < 4; i++) {
+		int c = __float_as_int(data[6][i]);
+
+		if(c != 0)
+			children[num++] = (c < 0)? -c-1: c;
+	}
+
+	return num;
+}
+
+void QBVH::get_leaf_range(int idx, int& lo, int& hi) const
 {
-	assert(0); /* todo */
+	const float4 *data = (const float4*)&pack.nodes[idx*BVH_QNODE_SIZE];
+	int c0 = __float_as_int(data[6].x);
+	int c1 = __float_as_int(data[6].y);
+
+	if(c0 < 0) {
+		/* object */
+		lo = ~c0;
+		hi = lo + 1;
+	}
+	else {
+		/* triangles */
+		lo = c0;
+		hi = c1;
+	}
+}
+
+void QBVH::refit_node(int idx, int depth, BoundBox& bbox, uint& visibility)
+{
+	float4 *data = (float4*)&pack.nodes[idx*BVH_QNODE_SIZE];
+
+	if(pack.is_leaf[idx]) {
+		/* refit leaf node, bounds are stored in the parent only */
+		int lo, hi;
+		get_leaf_range(idx, lo, hi);
+
+		refit_primitives(lo, hi, bbox, visibility);
+	}
+	else {
+		/* refit inner node, set bbox from children */
+		for(int i = 0; i < 4; i++) {
+			int c = __float_as_int(data[6][i]);
+
+			if(c == 0)
+				continue;
+
+			int cidx = (c < 0)? -c-1: c;
+			BoundBox cbbox = BoundBox::empty;
+			uint cvisibility = 0;
+
+			if(refit_tagged(cidx)) {
+				refit_child(cidx, depth + 1, cbbox, cvisibility);
+
+				data[0][i] = cbbox.min.x;
+				data[1][i] = cbbox.max.x;
+				data[2][i] = cbbox.min.y;
+				data[3][i] = cbbox.max.y;
+				data[4][i] = cbbox.min.z;
+				data[5][i] = cbbox.max.z;
+				data[7][i] = __uint_as_float(cvisibility);
+			}
+			else {
+				/* keep packed bounds and visibility of unchanged child */
+				cbbox.min = make_float3(data[0][i], data[2][i], data[4][i]);
+				cbbox.max = make_float3(data[1][i], data[3][i], data[5][i]);
+				cvisibility = __float_as_uint(data[7][i]);
+			}
+
+			bbox.grow(cbbox);
+			visibility |= cvisibility;
+		}
+	}
 }
 
 CCL_NAMESPACE_END
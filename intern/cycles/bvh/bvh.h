@@ -20,6 +20,7 @@
 
 #include "bvh_params.h"
 
+#include "util_map.h"
 #include "util_string.h"
 #include "util_types.h"
 #include "util_vector.h"
@@ -32,6 +33,7 @@ class BVHParams;
 class BoundBox;
 class CacheData;
 class LeafNode;
+class Mesh;
 class Object;
 class Progress;
 
@@ -78,6 +80,17 @@ struct PackedBVH {
 	}
 };
 
+/* BVH Refit Task
+ *
+ * Subtree refitted in parallel, along with the resulting bounds of its root. */
+
+struct BVHRefitTask {
+	int idx;
+	int depth;
+	BoundBox bbox;
+	uint visibility;
+};
+
 /* BVH */
 
 class BVH
@@ -86,34 +99,61 @@ public:
 	PackedBVH pack;
 	BVHParams params;
 	vector<Object*> objects;
-	string cache_filename;
 
 	static BVH *create(const BVHParams& params, const vector<Object*>& objects);
-	virtual ~BVH() {}
+	virtual ~BVH();
 
 	void build(Progress& progress);
 	void refit(Progress& progress);
-
-	void clear_cache_except();
+	void refit(Progress& progress, const vector<bool>& refit_objects);
 
 protected:
 	BVH(const BVHParams& params, const vector<Object*>& objects);
 
-	/* cache */
+	/* cache, packed arrays read from it reference the mapped file */
+	CacheData *cache_data;
+
 	bool cache_read(CacheData& key);
 	void cache_write(CacheData& key);
+	void cache_free();
 
 	/* triangles and strands*/
 	void pack_primitives();
-	void pack_triangle(int idx, float4 woop[3]);
-	void pack_curve_segment(int idx, float4 woop[3]);
+	void pack_triangle(const Mesh *mesh, int tidx, float4 woop[3]);
+	void pack_curve_segment(const Mesh *mesh, int cidx, int segment, float4 woop[3]);
 
 	/* merge instance BVH's */
 	void pack_instances(size_t nodes_size);
 
+	/* refit
+	 *
+	 * Nodes are refit bottom-up, with subtrees below REFIT_TASK_DEPTH done in
+	 * parallel. When refitting for a set of objects, only nodes with those
+	 * objects' primitives in their subtree are tagged and visited, the bounds
+	 * of other nodes are kept as packed. */
+	enum { REFIT_TASK_DEPTH = 6 };
+
+	vector<int> refit_parent;
+	vector<vector<int> > refit_object_leaves;
+	vector<bool> refit_tag;
+	vector<BVHRefitTask> refit_tasks;
+	map<int, int> refit_task_map;
+
+	void refit_init();
+	bool refit_instance_primitive(int prim) const;
+	void refit_tag_objects(const vector<bool>& refit_objects);
+	bool refit_tagged(int idx) const { return refit_tag.empty() || refit_tag[idx]; }
+	void refit_nodes();
+	void refit_collect_tasks(int idx, int depth);
+	void refit_task_run(BVHRefitTask *task);
+	void refit_child(int idx, int depth, BoundBox& bbox, uint& visibility);
+	void refit_primitives(int start, int end, BoundBox& bbox, uint& visibility);
+
 	/* for subclasses to implement */
 	virtual void pack_nodes(const array<int>& prims, const BVHNode *root) = 0;
-	virtual void refit_nodes() = 0;
+	virtual int get_children(int idx, int children[4]) const = 0;
+	virtual void get_leaf_range(int idx, int& lo, int& hi) const = 0;
+	virtual void refit_node(int idx, int depth, BoundBox& bbox, uint& visibility) = 0;
 };
 
 /* Regular BVH
@@ -133,8 +173,9 @@ protected:
 	void pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1);
 
 	/* refit */
-	void refit_nodes();
-	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+	int get_children(int idx, int children[4]) const;
+	void get_leaf_range(int idx, int& lo, int& hi) const;
+	void refit_node(int idx, int depth, BoundBox& bbox, uint& visibility);
 };
 
 /* QBVH
@@ -153,7 +194,9 @@ protected:
 	void pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num);
 
 	/* refit */
-	void refit_nodes();
+	int get_children(int idx, int children[4]) const;
+	void get_leaf_range(int idx, int& lo, int& hi) const;
+	void refit_node(int idx, int depth, BoundBox& bbox, uint& visibility);
 };
 
 CCL_NAMESPACE_END
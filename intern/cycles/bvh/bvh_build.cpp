@@ -46,6 +46,28 @@ public:
 	BVHObjectBinning range;
 };
 
+/* BVH Spatial Split Build Task
+ *
+ * Spatial splits duplicate references, so each task works on its own copy of
+ * the references in its range along with its own split scratch storage. */
+
+class BVHSpatialSplitBuildTask : public Task {
+public:
+	BVHSpatialSplitBuildTask(BVHBuild *build, InnerNode *node, int child, const BVHRange& range_,
+	                         const vector<BVHReference>& references_, int level)
+	: range(range_),
+	  references(references_.begin() + range_.start(), references_.begin() + range_.end())
+	{
+		range.set_start(0);
+		run = function_bind(&BVHBuild::thread_build_spatial_split_node, build, node, child,
+			&range, &references, &storage, level);
+	}
+
+	BVHRange range;
+	vector<BVHReference> references;
+	BVHSpatialStorage storage;
+};
+
 /* Constructor / Destructor */
 
 BVHBuild::BVHBuild(const vector<Object*>& objects_,
@@ -198,8 +220,6 @@ BVHNode* BVHBuild::run()
 		params.use_spatial_split = false;
 
 	spatial_min_overlap = root.bounds().safe_area() * params.spatial_split_alpha;
-	spatial_right_bounds.clear();
-	spatial_right_bounds.resize(max(root.size(), (int)BVHParams::NUM_SPATIAL_BINS) - 1);
 
 	/* init progress updates */
 	progress_start_time = time_dt();
@@ -207,16 +227,25 @@ BVHNode* BVHBuild::run()
 	progress_total = references.size();
 	progress_original_total = progress_total;
 
-	prim_segment.resize(references.size());
-	prim_index.resize(references.size());
-	prim_object.resize(references.size());
+	if(params.use_spatial_split) {
+		/* primitives are appended as leaves get created */
+		prim_segment.reserve(references.size());
+		prim_index.reserve(references.size());
+		prim_object.reserve(references.size());
+	}
+	else {
+		prim_segment.resize(references.size());
+		prim_index.resize(references.size());
+		prim_object.resize(references.size());
+	}
 
 	/* build recursively */
 	BVHNode *rootnode;
 
 	if(params.use_spatial_split) {
-		/* singlethreaded spatial split build */
-		rootnode = build_node(root, 0);
+		/* multithreaded spatial split build */
+		rootnode = build_node(root, &references, 0, &spatial_storage);
+		task_pool.wait_work();
 	}
 	else {
 		/* multithreaded binning build */
@@ -231,7 +260,7 @@ BVHNode* BVHBuild::run()
 			rootnode->deleteSubtree();
 			rootnode = NULL;
 		}
-		else if(!params.use_spatial_split) {
+		else {
 			/*rotate(rootnode, 4, 5);*/
 			rootnode->update_visibility();
 		}
@@ -277,6 +306,30 @@ void BVHBuild::thread_build_node(InnerNode *inner, int child, BVHObjectBinning *
 	}
 }
 
+void BVHBuild::thread_build_spatial_split_node(InnerNode *inner, int child, BVHRange *range,
+	vector<BVHReference> *references, BVHSpatialStorage *storage, int level)
+{
+	if(progress.get_cancel())
+		return;
+
+	/* build nodes */
+	size_t num_references = references->size();
+	BVHNode *node = build_node(*range, references, level, storage);
+
+	/* set child in inner node */
+	inner->children[child] = node;
+
+	/* update progress, references added are duplicates from spatial splits */
+	thread_scoped_lock lock(build_mutex);
+
+	progress_total += references->size() - num_references;
+
+	if(range->size() < THREAD_TASK_SIZE) {
+		progress_count += range->size() + references->size() - num_references;
+		progress_update();
+	}
+}
+
 /* multithreaded binning builder */
 BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 {
@@ -286,7 +339,7 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 
 	/* make leaf node when threshold reached or SAH tells us */
 	if(params.small_enough_for_leaf(size, level) || (size <= params.max_leaf_size && leafSAH < splitSAH))
-		return create_leaf_node(range);
+		return create_leaf_node(range, &references);
 
 	/* perform split */
 	BVHObjectBinning left, right;
@@ -313,44 +366,52 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	return inner;
 }
 
-/* single threaded spatial split builder */
-BVHNode* BVHBuild::build_node(const BVHRange& range, int level)
+/* multithreaded spatial split builder */
+BVHNode* BVHBuild::build_node(const BVHRange& range, vector<BVHReference> *references,
+	int level, BVHSpatialStorage *storage)
 {
-	/* progress update */
-	progress_update();
 	if(progress.get_cancel())
 		return NULL;
 
 	/* small enough or too deep => create leaf. */
-	if(params.small_enough_for_leaf(range.size(), level)) {
-		progress_count += range.size();
-		return create_leaf_node(range);
-	}
+	if(params.small_enough_for_leaf(range.size(), level))
+		return create_leaf_node(range, references);
 
 	/* splitting test */
-	BVHMixedSplit split(this, range, level);
+	BVHMixedSplit split(this, storage, range, references, level);
 
-	if(split.no_split) {
-		progress_count += range.size();
-		return create_leaf_node(range);
-	}
+	if(split.no_split)
+		return create_leaf_node(range, references);
 	
 	/* do split */
 	BVHRange left, right;
-	split.split(this, left, right, range);
+	split.split(this, storage, left, right, range, references);
+
+	/* create inner node. */
+	InnerNode *inner;
+
+	if(range.size() < THREAD_TASK_SIZE) {
+		/* local build */
+		size_t num_references = references->size();
+
+		/* left node */
+		BVHNode *leftnode = build_node(left, references, level + 1, storage);
 
-	progress_total += left.size() + right.size() - range.size();
-	size_t total = progress_total;
+		/* right node (modify start for splits) */
+		right.set_start(right.start() + references->size() - num_references);
+		BVHNode *rightnode = build_node(right, references, level + 1, storage);
 
-	/* leaft node */
-	BVHNode *leftnode = build_node(left, level + 1);
+		inner = new InnerNode(range.bounds(), leftnode, rightnode);
+	}
+	else {
+		/* threaded build */
+		inner = new InnerNode(range.bounds());
 
-	/* right node (modify start for splits) */
-	right.set_start(right.start() + progress_total - total);
-	BVHNode *rightnode = build_node(right, level + 1);
+		task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 0, left, *references, level + 1), true);
+		task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 1, right, *references, level + 1), true);
+	}
 
-	/* inner node */
-	return new InnerNode(range.bounds(), leftnode, rightnode);
+	return inner;
 }
 
 /* Create Nodes */
@@ -391,7 +452,19 @@ BVHNode *BVHBuild::create_object_leaf_nodes(const BVHReference *ref, int start,
 	}
 }
 
-BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
+BVHNode* BVHBuild::create_leaf_node(const BVHRange& range, vector<BVHReference> *references)
+{
+	if(params.use_spatial_split) {
+		/* subtrees are built in parallel on their own reference arrays, so
+		 * primitives are appended to the output arrays in creation order */
+		thread_scoped_lock lock(spatial_mutex);
+		return create_leaf_node(range, references, prim_index.size());
+	}
+
+	return create_leaf_node(range, references, range.start());
+}
+
+BVHNode* BVHBuild::create_leaf_node(const BVHRange& range, vector<BVHReference> *references, int start)
 {
 	vector<int>& p_segment = prim_segment;
 	vector<int>& p_index = prim_index;
@@ -401,10 +474,10 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	uint visibility = 0;
 
 	for(int i = 0; i < range.size(); i++) {
-		BVHReference& ref = references[range.start() + i];
+		BVHReference& ref = (*references)[range.start() + i];
 
 		if(ref.prim_index() != -1) {
-			if(range.start() + num == prim_index.size()) {
+			if(start + num == prim_index.size()) {
 				assert(params.use_spatial_split);
 
 				p_segment.push_back(ref.prim_segment());
@@ -412,9 +485,9 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 				p_object.push_back(ref.prim_object());
 			}
 			else {
-				p_segment[range.start() + num] = ref.prim_segment();
-				p_index[range.start() + num] = ref.prim_index();
-				p_object[range.start() + num] = ref.prim_object();
+				p_segment[start + num] = ref.prim_segment();
+				p_index[start + num] = ref.prim_index();
+				p_object[start + num] = ref.prim_object();
 			}
 
 			bounds.grow(ref.bounds());
@@ -423,7 +496,7 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 		}
 		else {
 			if(ob_num < i)
-				references[range.start() + ob_num] = ref;
+				(*references)[range.start() + ob_num] = ref;
 			ob_num++;
 		}
 	}
@@ -431,7 +504,7 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 	BVHNode *leaf = NULL;
 	
 	if(num > 0) {
-		leaf = new LeafNode(bounds, visibility, range.start(), range.start() + num);
+		leaf = new LeafNode(bounds, visibility, start, start + num);
 
 		if(num == range.size())
 			return leaf;
@@ -439,8 +512,8 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 
 	/* while there may be multiple triangles in a leaf, for object primitives
 	 * we want there to be the only one, so we keep splitting */
-	const BVHReference *ref = (ob_num)? &references[range.start()]: NULL;
-	BVHNode *oleaf = create_object_leaf_nodes(ref, range.start() + num, ob_num);
+	const BVHReference *ref = (ob_num)? &(*references)[range.start()]: NULL;
+	BVHNode *oleaf = create_object_leaf_nodes(ref, start + num, ob_num);
 	
 	if(leaf)
 		return new InnerNode(range.bounds(), leaf, oleaf);
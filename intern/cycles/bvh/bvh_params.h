@@ -19,6 +19,7 @@
 #define __BVH_PARAMS_H__
 
 #include "util_boundbox.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -171,6 +172,23 @@ struct BVHSpatialBin
 	}
 };
 
+/* BVH Spatial Storage
+ *
+ * Scratch memory used while finding and performing splits. Every build task
+ * owns one, so subtrees can be built in parallel without sharing state. */
+
+struct BVHSpatialStorage
+{
+	/* accumulated bounds when sweeping from right to left */
+	vector<BoundBox> right_bounds;
+
+	/* bins used for histogram when selecting best split plane */
+	BVHSpatialBin bins[3][BVHParams::NUM_SPATIAL_BINS];
+
+	/* references duplicated by a spatial split, appended after the split */
+	vector<BVHReference> new_references;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_PARAMS_H__ */
@@ -35,6 +35,7 @@ CCL_NAMESPACE_BEGIN
 
 class Progress;
 class RenderTile;
+class TextureCache;
 
 /* Device Types */
 
@@ -113,6 +114,9 @@ public:
 	/* open shading language, only for CPU device */
 	virtual void *osl_memory() { return NULL; }
 
+	/* image textures read on demand, only for CPU device */
+	virtual TextureCache *texture_cache() { return NULL; }
+
 	/* load/compile kernels, must be called before adding tasks */ 
 	virtual bool load_kernels(bool experimental) { return true; }
 
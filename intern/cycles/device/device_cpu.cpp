@@ -26,6 +26,7 @@
 #include "kernel_compat_cpu.h"
 #include "kernel_types.h"
 #include "kernel_globals.h"
+#include "kernel_texture_cache.h"
 
 #include "osl_shader.h"
 #include "osl_globals.h"
@@ -50,16 +51,19 @@ public:
 #ifdef WITH_OSL
 	OSLGlobals osl_globals;
 #endif
+	TextureCache tex_cache;
 	
 	CPUDevice(Stats &stats) : Device(stats)
 	{
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		kernel_globals.texture_cache = &tex_cache;
 
 		/* do now to avoid thread issues */
 		system_cpu_support_sse2();
 		system_cpu_support_sse3();
+		system_cpu_support_avx2();
 	}
 
 	~CPUDevice()
@@ -125,6 +129,11 @@ public:
 #endif
 	}
 
+	TextureCache *texture_cache()
+	{
+		return &tex_cache;
+	}
+
 	void thread_run(DeviceTask *task)
 	{
 		if(task->type == DeviceTask::PATH_TRACE)
@@ -165,6 +174,40 @@ public:
 			int start_sample = tile.start_sample;
 			int end_sample = tile.start_sample + tile.num_samples;
 
+#ifdef WITH_KERNEL_AVX2
+			if(system_cpu_support_avx2()) {
+				for(int sample = start_sample; sample < end_sample; sample++) {
+					if (task.get_cancel() || task_pool.cancelled()) {
+						if(task.need_finish_queue == false)
+							break;
+					}
+
+					for(int y = tile.y; y < tile.y + tile.h; y++) {
+						if(task.use_ray_packets) {
+							for(int x = tile.x; x < tile.x + tile.w; x += KERNEL_CPU_PACKET_SIZE) {
+								kernel_cpu_avx2_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, min(KERNEL_CPU_PACKET_SIZE, tile.x + tile.w - x), tile.offset, tile.stride);
+							}
+						}
+						else {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_avx2_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
+						}
+					}
+
+					tile.sample = sample + 1;
+
+					task.update_progress(tile);
+
+					if(kernel_cpu_adaptive_stopping(&kg, render_buffer, sample,
+						tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride))
+						break;
+				}
+			}
+			else
+#endif
 #ifdef WITH_OPTIMIZED_KERNEL
 			if(system_cpu_support_sse3()) {
 				for(int sample = start_sample; sample < end_sample; sample++) {
@@ -174,15 +217,27 @@ public:
 					}
 
 					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_sse3_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+						if(task.use_ray_packets) {
+							for(int x = tile.x; x < tile.x + tile.w; x += KERNEL_CPU_PACKET_SIZE) {
+								kernel_cpu_sse3_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, min(KERNEL_CPU_PACKET_SIZE, tile.x + tile.w - x), tile.offset, tile.stride);
+							}
+						}
+						else {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_sse3_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(kernel_cpu_adaptive_stopping(&kg, render_buffer, sample,
+						tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride))
+						break;
 				}
 			}
 			else if(system_cpu_support_sse2()) {
@@ -193,15 +248,27 @@ public:
 					}
 
 					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_sse2_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+						if(task.use_ray_packets) {
+							for(int x = tile.x; x < tile.x + tile.w; x += KERNEL_CPU_PACKET_SIZE) {
+								kernel_cpu_sse2_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, min(KERNEL_CPU_PACKET_SIZE, tile.x + tile.w - x), tile.offset, tile.stride);
+							}
+						}
+						else {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_sse2_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(kernel_cpu_adaptive_stopping(&kg, render_buffer, sample,
+						tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride))
+						break;
 				}
 			}
 			else
@@ -214,18 +281,34 @@ public:
 					}
 
 					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+						if(task.use_ray_packets) {
+							for(int x = tile.x; x < tile.x + tile.w; x += KERNEL_CPU_PACKET_SIZE) {
+								kernel_cpu_path_trace_packet(&kg, render_buffer, rng_state,
+									sample, x, y, min(KERNEL_CPU_PACKET_SIZE, tile.x + tile.w - x), tile.offset, tile.stride);
+							}
+						}
+						else {
+							for(int x = tile.x; x < tile.x + tile.w; x++) {
+								kernel_cpu_path_trace(&kg, render_buffer, rng_state,
+									sample, x, y, tile.offset, tile.stride);
+							}
 						}
 					}
 
 					tile.sample = sample + 1;
 
 					task.update_progress(tile);
+
+					if(kernel_cpu_adaptive_stopping(&kg, render_buffer, sample,
+						tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride))
+						break;
 				}
 			}
 
+			/* scale pixels that stopped sampling early, and count the saved samples */
+			tile.skipped_samples = kernel_cpu_adaptive_post_adjust(&kg, render_buffer, tile.sample, end_sample,
+				tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride);
+
 			task.release_tile(tile);
 
 			if(task_pool.cancelled()) {
@@ -241,6 +324,15 @@ public:
 
 	void thread_tonemap(DeviceTask& task)
 	{
+#ifdef WITH_KERNEL_AVX2
+		if(system_cpu_support_avx2()) {
+			for(int y = task.y; y < task.y + task.h; y++)
+				for(int x = task.x; x < task.x + task.w; x++)
+					kernel_cpu_avx2_tonemap(&kernel_globals, (uchar4*)task.rgba, (float*)task.buffer,
+						task.sample, x, y, task.offset, task.stride);
+		}
+		else
+#endif
 #ifdef WITH_OPTIMIZED_KERNEL
 		if(system_cpu_support_sse3()) {
 			for(int y = task.y; y < task.y + task.h; y++)
@@ -272,6 +364,17 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+#ifdef WITH_KERNEL_AVX2
+		if(system_cpu_support_avx2()) {
+			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
+				kernel_cpu_avx2_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x);
+
+				if(task_pool.cancelled())
+					break;
+			}
+		}
+		else
+#endif
 #ifdef WITH_OPTIMIZED_KERNEL
 		if(system_cpu_support_sse3()) {
 			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
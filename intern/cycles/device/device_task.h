@@ -51,6 +51,9 @@ public:
 	int shader_eval_type;
 	int shader_x, shader_w;
 
+	/* trace coherent camera rays in packets, CPU only */
+	bool use_ray_packets;
+
 	DeviceTask(Type type = PATH_TRACE);
 
 	void split(list<DeviceTask>& tasks, int num);
@@ -93,6 +93,65 @@ void kernel_cpu_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_s
 	kernel_path_trace(kg, buffer, rng_state, sample, x, y, offset, stride);
 }
 
+void kernel_cpu_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state, int sample, int x, int y, int num, int offset, int stride)
+{
+#ifdef __RAY_PACKETS__
+	kernel_path_trace_packet(kg, buffer, rng_state, sample, x, y, num, offset, stride);
+#else
+	for(int i = 0; i < num; i++)
+		kernel_path_trace(kg, buffer, rng_state, sample, x + i, y, offset, stride);
+#endif
+}
+
+/* Adaptive Sampling */
+
+bool kernel_cpu_adaptive_stopping(KernelGlobals *kg, float *buffer, int sample, int x, int y, int w, int h, int offset, int stride)
+{
+#ifdef __ADAPTIVE_SAMPLING__
+	if(!kernel_adaptive_sampling_enabled(kg) || !kernel_adaptive_need_filter(kg, sample))
+		return false;
+
+	int pass_stride = kernel_data.film.pass_stride;
+
+	for(int py = y; py < y + h; py++)
+		for(int px = x; px < x + w; px++)
+			kernel_adaptive_stopping(kg, buffer + (offset + px + py*stride)*pass_stride, sample);
+
+	/* keep sampling next to pixels that did not converge yet */
+	bool any_active = false;
+
+	for(int py = y; py < y + h; py++)
+		any_active |= kernel_adaptive_filter_line(kg, buffer, sample, offset + x + py*stride, 1, w);
+	for(int px = x; px < x + w; px++)
+		any_active |= kernel_adaptive_filter_line(kg, buffer, sample, offset + px + y*stride, stride, h);
+
+	return !any_active;
+#else
+	return false;
+#endif
+}
+
+uint64_t kernel_cpu_adaptive_post_adjust(KernelGlobals *kg, float *buffer, int sample, int end_sample, int x, int y, int w, int h, int offset, int stride)
+{
+	uint64_t skipped_samples = 0;
+
+#ifdef __ADAPTIVE_SAMPLING__
+	if(!kernel_adaptive_sampling_enabled(kg))
+		return 0;
+
+	int pass_stride = kernel_data.film.pass_stride;
+
+	for(int py = y; py < y + h; py++) {
+		for(int px = x; px < x + w; px++) {
+			int pixel_samples = kernel_adaptive_post_adjust(kg, buffer + (offset + px + py*stride)*pass_stride, sample);
+			skipped_samples += end_sample - pixel_samples;
+		}
+	}
+#endif
+
+	return skipped_samples;
+}
+
 /* Tonemapping */
 
 void kernel_cpu_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer, int sample, int x, int y, int offset, int stride)
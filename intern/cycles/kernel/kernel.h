@@ -27,6 +27,9 @@ CCL_NAMESPACE_BEGIN
 
 struct KernelGlobals;
 
+/* number of pixels traced together by the path_trace_packet functions */
+#define KERNEL_CPU_PACKET_SIZE 4
+
 KernelGlobals *kernel_globals_create();
 void kernel_globals_free(KernelGlobals *kg);
 
@@ -38,14 +41,23 @@ void kernel_tex_copy(KernelGlobals *kg, const char *name, device_ptr mem, size_t
 
 void kernel_cpu_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
+void kernel_cpu_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
+	int sample, int x, int y, int num, int offset, int stride);
 void kernel_cpu_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i);
 
+bool kernel_cpu_adaptive_stopping(KernelGlobals *kg, float *buffer, int sample,
+	int x, int y, int w, int h, int offset, int stride);
+uint64_t kernel_cpu_adaptive_post_adjust(KernelGlobals *kg, float *buffer, int sample, int end_sample,
+	int x, int y, int w, int h, int offset, int stride);
+
 #ifdef WITH_OPTIMIZED_KERNEL
 void kernel_cpu_sse2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
+void kernel_cpu_sse2_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
+	int sample, int x, int y, int num, int offset, int stride);
 void kernel_cpu_sse2_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
@@ -53,12 +65,25 @@ void kernel_cpu_sse2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 
 void kernel_cpu_sse3_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
 	int sample, int x, int y, int offset, int stride);
+void kernel_cpu_sse3_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
+	int sample, int x, int y, int num, int offset, int stride);
 void kernel_cpu_sse3_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer,
 	int sample, int x, int y, int offset, int stride);
 void kernel_cpu_sse3_shader(KernelGlobals *kg, uint4 *input, float4 *output,
 	int type, int i);
 #endif
 
+#ifdef WITH_KERNEL_AVX2
+void kernel_cpu_avx2_path_trace(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
+	int sample, int x, int y, int offset, int stride);
+void kernel_cpu_avx2_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state,
+	int sample, int x, int y, int num, int offset, int stride);
+void kernel_cpu_avx2_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer,
+	int sample, int x, int y, int offset, int stride);
+void kernel_cpu_avx2_shader(KernelGlobals *kg, uint4 *input, float4 *output,
+	int type, int i);
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __KERNEL_H__ */
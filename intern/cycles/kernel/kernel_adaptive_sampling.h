@@ -0,0 +1,151 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Adaptive Sampling
+ *
+ * Besides the combined pass, a second estimate of the pixel is accumulated
+ * from the odd samples only, in the RGB channels of the auxiliary pass. The
+ * difference between the two estimates gives the per pixel error, and once
+ * that drops below the threshold the pixel stops receiving samples. The W
+ * channel of the auxiliary pass stores the number of samples the pixel had
+ * when it converged, or zero while it is still being sampled.
+ *
+ * Converged pixels are still rendered while any neighbouring pixel is not,
+ * to avoid sharp transitions in noise level. At the end of the tile, pixels
+ * are scaled as if they received all samples of the tile. */
+
+#ifdef __ADAPTIVE_SAMPLING__
+
+__device_inline bool kernel_adaptive_sampling_enabled(KernelGlobals *kg)
+{
+	return (kernel_data.film.pass_flag & PASS_ADAPTIVE_AUX) != 0;
+}
+
+__device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg, __global float *buffer)
+{
+	return buffer[kernel_data.film.pass_adaptive_aux + 3] != 0.0f;
+}
+
+/* accumulate the odd sample estimate, weighted so both estimates have the
+ * same expected value */
+__device_inline void kernel_adaptive_write_aux(KernelGlobals *kg, __global float *buffer, int sample, float4 L)
+{
+	__global float4 *aux = (__global float4*)(buffer + kernel_data.film.pass_adaptive_aux);
+
+	if(sample == 0)
+		*aux = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+	else if(sample & 1)
+		*aux += make_float4(2.0f*L.x, 2.0f*L.y, 2.0f*L.z, 0.0f);
+}
+
+/* should the convergence test run after this sample? requires an even
+ * number of samples so that both estimates have the same sample count */
+__device_inline bool kernel_adaptive_need_filter(KernelGlobals *kg, int sample)
+{
+	int num_samples = sample + 1;
+
+	return (num_samples >= kernel_data.integrator.adaptive_min_samples) &&
+	       (num_samples % kernel_data.integrator.adaptive_step) == 0;
+}
+
+/* per pixel error test after sample, tags the pixel as converged */
+__device void kernel_adaptive_stopping(KernelGlobals *kg, __global float *buffer, int sample)
+{
+	int num_samples = sample + 1;
+
+	if(kernel_adaptive_pixel_converged(kg, buffer))
+		return;
+
+	float4 I = *((__global float4*)buffer);
+	float4 A = *((__global float4*)(buffer + kernel_data.film.pass_adaptive_aux));
+
+	/* error relative to the square root of the intensity, which matches the
+	 * perceived noise better than a plain relative error. a small epsilon
+	 * avoids division by zero in black pixels. */
+	float error = (fabsf(I.x - A.x) + fabsf(I.y - A.y) + fabsf(I.z - A.z)) /
+	              (num_samples*0.0001f + sqrtf(I.x + I.y + I.z));
+
+	if(error < kernel_data.integrator.adaptive_threshold*(float)num_samples)
+		buffer[kernel_data.film.pass_adaptive_aux + 3] = (float)num_samples;
+}
+
+/* un-converge pixels next to pixels that still need samples, in one row or
+ * column of the tile. only pixels that converged after this sample are
+ * affected, earlier ones skipped samples already. returns true if any pixel
+ * still needs samples. */
+__device bool kernel_adaptive_filter_line(KernelGlobals *kg, __global float *buffer,
+	int sample, int index, int step, int num)
+{
+	int pass_stride = kernel_data.film.pass_stride;
+	int aux_w = kernel_data.film.pass_adaptive_aux + 3;
+	float num_samples = (float)(sample + 1);
+	bool any_active = false;
+	bool prev_active = false;
+
+	for(int i = 0; i < num; i++) {
+		__global float *pixel = buffer + (index + i*step)*pass_stride;
+		bool active = (pixel[aux_w] == 0.0f);
+		bool next_active = (i < num - 1) && (pixel[step*pass_stride + aux_w] == 0.0f);
+
+		if(active)
+			any_active = true;
+		else if((prev_active || next_active) && pixel[aux_w] == num_samples)
+			pixel[aux_w] = 0.0f;
+
+		prev_active = active;
+	}
+
+	return any_active;
+}
+
+/* scale all filtered passes of a converged pixel, as if it received all
+ * num_samples samples. returns the number of samples the pixel received. */
+__device int kernel_adaptive_post_adjust(KernelGlobals *kg, __global float *buffer, int num_samples)
+{
+	int aux = kernel_data.film.pass_adaptive_aux;
+	int pixel_samples = (int)buffer[aux + 3];
+
+	if(pixel_samples == 0 || pixel_samples >= num_samples)
+		return num_samples;
+
+	float scale = (float)num_samples/(float)pixel_samples;
+	int flag = kernel_data.film.pass_flag;
+
+	for(int i = 0; i < kernel_data.film.pass_stride; i++) {
+		/* passes written once, not accumulated */
+		if((flag & PASS_DEPTH) && i == kernel_data.film.pass_depth)
+			continue;
+		if((flag & PASS_OBJECT_ID) && i == kernel_data.film.pass_object_id)
+			continue;
+		if((flag & PASS_MATERIAL_ID) && i == kernel_data.film.pass_material_id)
+			continue;
+		if(i >= aux && i < aux + 4)
+			continue;
+
+		buffer[i] *= scale;
+	}
+
+	return pixel_samples;
+}
+
+#endif
+
+CCL_NAMESPACE_END
+
@@ -882,6 +882,10 @@ __device_inline int scene_intersect_subsurface(KernelGlobals *kg, const Ray *ray
 }
 #endif
 
+#ifdef __RAY_PACKETS__
+#include "kernel_bvh_packet.h"
+#endif
+
 /* Ray offset to avoid self intersection */
 
 __device_inline float3 ray_offset(float3 P, float3 Ng)
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Ray Packet Traversal
+ *
+ * Coherent rays, like camera rays for neighbouring pixels, are traversed
+ * through the BVH together, four at a time with SSE. A node is visited when
+ * any active ray in the packet hits it, so the node data is fetched and the
+ * traversal decisions are made once for the whole packet. All rays in the
+ * packet must have the same visibility.
+ *
+ * Only triangles and instancing are supported, scenes with hair or object
+ * motion blur use the regular single ray traversal. */
+
+#define BVH_PACKET_SIZE 4
+
+typedef struct BVHPacketStackEntry {
+	int nodeAddr;
+	int mask;
+} BVHPacketStackEntry;
+
+__device_inline int bvh_packet_count(int mask)
+{
+	const int count[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+	return count[mask & 15];
+}
+
+/* packet ray data in SIMD registers, one ray per lane. With AVX the rays
+ * are duplicated in both halves, to test two child nodes at once. */
+typedef struct BVHPacket {
+	__m128 P[3];
+	__m128 idir[3];
+	__m128 t;
+#ifdef __KERNEL_AVX__
+	__m256 idir8[3];
+	__m256 Pidir8[3];
+	__m256 t8;
+#endif
+} BVHPacket;
+
+__device_inline void bvh_packet_update_t(const Intersection *isect, BVHPacket *packet)
+{
+	packet->t = _mm_setr_ps(isect[0].t, isect[1].t, isect[2].t, isect[3].t);
+#ifdef __KERNEL_AVX__
+	packet->t8 = _mm256_insertf128_ps(_mm256_castps128_ps256(packet->t), packet->t, 1);
+#endif
+}
+
+__device_inline void bvh_packet_setup(const float3 *P, const float3 *idir, const Intersection *isect,
+	BVHPacket *packet)
+{
+	packet->P[0] = _mm_setr_ps(P[0].x, P[1].x, P[2].x, P[3].x);
+	packet->P[1] = _mm_setr_ps(P[0].y, P[1].y, P[2].y, P[3].y);
+	packet->P[2] = _mm_setr_ps(P[0].z, P[1].z, P[2].z, P[3].z);
+
+	packet->idir[0] = _mm_setr_ps(idir[0].x, idir[1].x, idir[2].x, idir[3].x);
+	packet->idir[1] = _mm_setr_ps(idir[0].y, idir[1].y, idir[2].y, idir[3].y);
+	packet->idir[2] = _mm_setr_ps(idir[0].z, idir[1].z, idir[2].z, idir[3].z);
+
+#ifdef __KERNEL_AVX__
+	for(int i = 0; i < 3; i++) {
+		__m128 Pidir = _mm_mul_ps(packet->P[i], packet->idir[i]);
+
+		packet->idir8[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(packet->idir[i]), packet->idir[i], 1);
+		packet->Pidir8[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(Pidir), Pidir, 1);
+	}
+#endif
+
+	bvh_packet_update_t(isect, packet);
+}
+
+#ifdef __KERNEL_AVX__
+
+__device_inline __m256 bvh_packet_splat2(float a, float b)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a)), _mm_set1_ps(b), 1);
+}
+
+/* distance to a slab along one axis, (bound - P)*idir, for both children */
+__device_inline __m256 bvh_packet_slab(float bound0, float bound1, const __m256 idir, const __m256 Pidir)
+{
+#ifdef __KERNEL_AVX2__
+	return _mm256_fmsub_ps(bvh_packet_splat2(bound0, bound1), idir, Pidir);
+#else
+	return _mm256_sub_ps(_mm256_mul_ps(bvh_packet_splat2(bound0, bound1), idir), Pidir);
+#endif
+}
+
+/* intersect all rays in the packet with both child bounding boxes at once, 8
+ * wide with child 0 in the low and child 1 in the high half. Returns the mask
+ * of rays that hit each child in the low and high 4 bits. */
+__device_inline int bvh_packet_node_intersect(const BVHPacket *packet, float4 node0, float4 node1, float4 node2,
+	__m128 *c0min, __m128 *c1min)
+{
+	const __m256 t0x = bvh_packet_slab(node0.x, node0.y, packet->idir8[0], packet->Pidir8[0]);
+	const __m256 t1x = bvh_packet_slab(node0.z, node0.w, packet->idir8[0], packet->Pidir8[0]);
+	const __m256 t0y = bvh_packet_slab(node1.x, node1.y, packet->idir8[1], packet->Pidir8[1]);
+	const __m256 t1y = bvh_packet_slab(node1.z, node1.w, packet->idir8[1], packet->Pidir8[1]);
+	const __m256 t0z = bvh_packet_slab(node2.x, node2.y, packet->idir8[2], packet->Pidir8[2]);
+	const __m256 t1z = bvh_packet_slab(node2.z, node2.w, packet->idir8[2], packet->Pidir8[2]);
+
+	const __m256 tmin = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)),
+	                                  _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+	const __m256 tmax = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)),
+	                                  _mm256_min_ps(_mm256_max_ps(t0z, t1z), packet->t8));
+
+	*c0min = _mm256_castps256_ps128(tmin);
+	*c1min = _mm256_extractf128_ps(tmin, 1);
+
+	return _mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+}
+
+#else
+
+/* intersect all rays in the packet with one child bounding box, returning
+ * the mask of rays that hit it and their entry distances */
+__device_inline int bvh_packet_child_intersect(const BVHPacket *packet,
+	float lox, float hix, float loy, float hiy, float loz, float hiz, __m128 *tminv)
+{
+	const __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(lox), packet->P[0]), packet->idir[0]);
+	const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(hix), packet->P[0]), packet->idir[0]);
+	const __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(loy), packet->P[1]), packet->idir[1]);
+	const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(hiy), packet->P[1]), packet->idir[1]);
+	const __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(loz), packet->P[2]), packet->idir[2]);
+	const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set_ps1(hiz), packet->P[2]), packet->idir[2]);
+
+	const __m128 tmin = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+	                               _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+	const __m128 tmax = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+	                               _mm_min_ps(_mm_max_ps(t0z, t1z), packet->t));
+
+	*tminv = tmin;
+
+	return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+}
+
+/* intersect all rays in the packet with both child bounding boxes. Returns
+ * the mask of rays that hit each child in the low and high 4 bits. */
+__device_inline int bvh_packet_node_intersect(const BVHPacket *packet, float4 node0, float4 node1, float4 node2,
+	__m128 *c0min, __m128 *c1min)
+{
+	int mask0 = bvh_packet_child_intersect(packet,
+		node0.x, node0.z, node1.x, node1.z, node2.x, node2.z, c0min);
+	int mask1 = bvh_packet_child_intersect(packet,
+		node0.y, node0.w, node1.y, node1.w, node2.y, node2.w, c1min);
+
+	return mask0 | (mask1 << 4);
+}
+
+#endif
+
+/* Intersect up to BVH_PACKET_SIZE rays with the scene, the intersection array
+ * must have room for BVH_PACKET_SIZE entries. Returns a bitmask of the rays
+ * that hit something. */
+__device_noinline int bvh_intersect_packet(KernelGlobals *kg, const Ray *ray, Intersection *isect,
+	const uint visibility, int num_rays)
+{
+	/* traversal stack, each entry has the rays that still need the node */
+	BVHPacketStackEntry traversalStack[BVH_STACK_SIZE];
+	traversalStack[0].nodeAddr = ENTRYPOINT_SENTINEL;
+	traversalStack[0].mask = 0;
+
+	int stackPtr = 0;
+	int nodeAddr = kernel_data.bvh.root;
+	int object = ~0;
+	int instanceMask = 0;
+
+	/* unused rays are kept as copies of the first one, and never activated */
+	float3 P[BVH_PACKET_SIZE], idir[BVH_PACKET_SIZE];
+	float tmax[BVH_PACKET_SIZE];
+	int mask = (1 << num_rays) - 1;
+	int done = 0;
+
+	for(int i = 0; i < BVH_PACKET_SIZE; i++) {
+		const Ray *r = &ray[(i < num_rays)? i: 0];
+
+		P[i] = r->P;
+		idir[i] = bvh_inverse_direction(r->D);
+		tmax[i] = r->t;
+
+		isect[i].t = r->t;
+		isect[i].object = ~0;
+		isect[i].prim = ~0;
+		isect[i].u = 0.0f;
+		isect[i].v = 0.0f;
+	}
+
+	BVHPacket packet;
+	bvh_packet_setup(P, idir, isect, &packet);
+
+	/* traversal loop */
+	do {
+		do
+		{
+			/* traverse internal nodes */
+			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL)
+			{
+				float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
+				float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
+				float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
+				float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+3);
+
+				/* intersect packet against child nodes */
+				__m128 c0min, c1min;
+				int mask01 = bvh_packet_node_intersect(&packet, node0, node1, node2, &c0min, &c1min);
+				int mask0 = mask01 & mask;
+				int mask1 = (mask01 >> 4) & mask;
+
+#ifdef __VISIBILITY_FLAG__
+				if(!(__float_as_uint(cnodes.z) & visibility)) mask0 = 0;
+				if(!(__float_as_uint(cnodes.w) & visibility)) mask1 = 0;
+#endif
+
+				nodeAddr = __float_as_int(cnodes.x);
+				int nodeAddrChild1 = __float_as_int(cnodes.y);
+
+				if(mask0 && mask1) {
+					/* both children were intersected, push the one that is
+					 * farther for most rays */
+					int closer1 = _mm_movemask_ps(_mm_cmplt_ps(c1min, c0min)) & mask0 & mask1;
+
+					if(2*bvh_packet_count(closer1) > bvh_packet_count(mask0 & mask1)) {
+						int tmp = nodeAddr;
+						nodeAddr = nodeAddrChild1;
+						nodeAddrChild1 = tmp;
+
+						tmp = mask0;
+						mask0 = mask1;
+						mask1 = tmp;
+					}
+
+					++stackPtr;
+					traversalStack[stackPtr].nodeAddr = nodeAddrChild1;
+					traversalStack[stackPtr].mask = mask1;
+					mask = mask0;
+				}
+				else if(mask1) {
+					/* one child was intersected */
+					nodeAddr = nodeAddrChild1;
+					mask = mask1;
+				}
+				else if(mask0) {
+					mask = mask0;
+				}
+				else {
+					/* neither child was intersected */
+					nodeAddr = traversalStack[stackPtr].nodeAddr;
+					mask = traversalStack[stackPtr].mask & ~done;
+					--stackPtr;
+				}
+			}
+
+			/* if node is leaf, fetch triangle list */
+			if(nodeAddr < 0) {
+				float4 leaf = kernel_tex_fetch(__bvh_nodes, (-nodeAddr-1)*BVH_NODE_SIZE+(BVH_NODE_SIZE-1));
+				int primAddr = __float_as_int(leaf.x);
+
+#ifdef __INSTANCING__
+				if(primAddr >= 0) {
+#endif
+					int primAddr2 = __float_as_int(leaf.y);
+
+					/* primitive intersection, one ray at a time */
+					for(; primAddr < primAddr2; primAddr++) {
+						for(int i = 0; i < BVH_PACKET_SIZE; i++) {
+							if(!(mask & (1 << i)))
+								continue;
+
+							if(bvh_triangle_intersect(kg, &isect[i], P[i], idir[i], visibility, object, primAddr)) {
+								/* shadow ray early termination */
+								if(visibility == PATH_RAY_SHADOW_OPAQUE) {
+									done |= (1 << i);
+									mask &= ~(1 << i);
+								}
+							}
+						}
+					}
+
+					bvh_packet_update_t(isect, &packet);
+
+					if(done == (1 << num_rays) - 1)
+						return done;
+
+					/* pop */
+					nodeAddr = traversalStack[stackPtr].nodeAddr;
+					mask = traversalStack[stackPtr].mask & ~done;
+					--stackPtr;
+#ifdef __INSTANCING__
+				}
+				else {
+					/* instance push, all rays in the packet enter the same object */
+					object = kernel_tex_fetch(__prim_object, -primAddr-1);
+					instanceMask = mask;
+
+					for(int i = 0; i < BVH_PACKET_SIZE; i++)
+						if(mask & (1 << i))
+							bvh_instance_push(kg, object, &ray[i], &P[i], &idir[i], &isect[i].t, tmax[i]);
+
+					bvh_packet_setup(P, idir, isect, &packet);
+
+					++stackPtr;
+					traversalStack[stackPtr].nodeAddr = ENTRYPOINT_SENTINEL;
+					traversalStack[stackPtr].mask = mask;
+
+					nodeAddr = kernel_tex_fetch(__object_node, object);
+				}
+#endif
+			}
+
+			/* skip stack entries for which all rays have finished */
+			while(mask == 0 && nodeAddr != ENTRYPOINT_SENTINEL) {
+				nodeAddr = traversalStack[stackPtr].nodeAddr;
+				mask = traversalStack[stackPtr].mask & ~done;
+				--stackPtr;
+			}
+		} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+#ifdef __INSTANCING__
+		if(stackPtr >= 0) {
+			kernel_assert(object != ~0);
+
+			/* instance pop, for all rays that entered the object */
+			for(int i = 0; i < BVH_PACKET_SIZE; i++)
+				if(instanceMask & (1 << i))
+					bvh_instance_pop(kg, object, &ray[i], &P[i], &idir[i], &isect[i].t, tmax[i]);
+
+			bvh_packet_setup(P, idir, isect, &packet);
+
+			object = ~0;
+			instanceMask = 0;
+			nodeAddr = traversalStack[stackPtr].nodeAddr;
+			mask = traversalStack[stackPtr].mask & ~done;
+			--stackPtr;
+		}
+#endif
+	} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+	int hits = 0;
+
+	for(int i = 0; i < num_rays; i++)
+		if(isect[i].prim != ~0)
+			hits |= (1 << i);
+
+	return hits;
+}
+
+__device_inline bool scene_intersect_packet_supported(KernelGlobals *kg)
+{
+#ifdef __OBJECT_MOTION__
+	if(kernel_data.bvh.have_motion)
+		return false;
+#endif
+
+#ifdef __HAIR__
+	if(kernel_data.bvh.have_curves)
+		return false;
+#endif
+
+	return true;
+}
+
+/* Intersect a packet of rays with the scene, falling back to single ray
+ * traversal for features not supported by packets. */
+__device_inline int scene_intersect_packet(KernelGlobals *kg, const Ray *ray, const uint visibility,
+	Intersection *isect, int num_rays)
+{
+	if(!scene_intersect_packet_supported(kg)) {
+		int hits = 0;
+
+		for(int i = 0; i < num_rays; i++) {
+#ifdef __HAIR__
+			if(scene_intersect(kg, &ray[i], visibility, &isect[i], NULL, 0.0f, 0.0f))
+#else
+			if(scene_intersect(kg, &ray[i], visibility, &isect[i]))
+#endif
+				hits |= (1 << i);
+		}
+
+		return hits;
+	}
+
+	return bvh_intersect_packet(kg, ray, isect, visibility, num_rays);
+}
+
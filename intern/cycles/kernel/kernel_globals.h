@@ -33,6 +33,10 @@ struct OSLThreadData;
 struct OSLShadingSystem;
 #endif
 
+#ifdef __TEXTURE_CACHE__
+class TextureCache;
+#endif
+
 #define MAX_BYTE_IMAGES   512
 #define MAX_FLOAT_IMAGES  5
 
@@ -54,8 +58,17 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #endif
 
+#ifdef __TEXTURE_CACHE__
+	/* image textures that are read on demand, see kernel_texture_cache.h */
+	TextureCache *texture_cache;
+#endif
+
 } KernelGlobals;
 
+#ifdef __TEXTURE_CACHE__
+bool kernel_texture_cache_lookup(KernelGlobals *kg, int slot, float x, float y, float2 dx, float2 dy, float4 *result);
+#endif
+
 #endif
 
 /* For CUDA, constant memory textures must be globals, so we can't put them
@@ -544,10 +544,168 @@ __device int light_distribution_sample(KernelGlobals *kg, float randt)
 	return clamp(first-1, 0, kernel_data.integrator.num_distribution-1);
 }
 
+/* Light Tree
+ *
+ * Binary tree over emissive triangles, stored depth first so that the left
+ * child directly follows its parent. Each subtree spans a contiguous range of
+ * triangles in the light distribution. At every node we choose a child with
+ * probability proportional to its estimated contribution to the shading
+ * point, the emitted energy divided by the squared distance to its bounds. */
+
+#ifdef __LIGHT_TREE__
+
+__device float light_tree_node_importance(KernelGlobals *kg, int node, float3 P)
+{
+	float4 data0 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 0);
+	float4 data1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+
+	float3 bmin = make_float3(data0.x, data0.y, data0.z);
+	float3 bmax = make_float3(data1.x, data1.y, data1.z);
+	float energy = data0.w;
+
+	/* the distance is clamped to the size of the bounds, so that nearby
+	 * nodes and nodes containing P do not get all samples */
+	float3 center = 0.5f*(bmin + bmax);
+	float radius_sq = 0.25f*len_squared(bmax - bmin);
+	float dist_sq = len_squared(P - center);
+
+	return energy/max(max(dist_sq, radius_sq), 1e-10f);
+}
+
+__device float light_tree_child_probability(KernelGlobals *kg, int left, int right, float3 P)
+{
+	float importance_left = light_tree_node_importance(kg, left, P);
+	float importance_right = light_tree_node_importance(kg, right, P);
+	float importance = importance_left + importance_right;
+
+	return (importance > 0.0f)? importance_left/importance: 0.5f;
+}
+
+/* pick a triangle, randt is reused at every level of the tree */
+__device int light_tree_sample(KernelGlobals *kg, float3 P, float randt, float *pdf, float *area)
+{
+	int node = 0;
+	*pdf = 1.0f;
+
+	for(;;) {
+		float4 data1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+		int right = __float_as_int(data1.w);
+
+		if(right < 0) {
+			*area = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 2).y;
+			return ~right;
+		}
+
+		int left = node + 1;
+		float p_left = light_tree_child_probability(kg, left, right, P);
+
+		if(randt < p_left) {
+			randt = randt/p_left;
+			*pdf *= p_left;
+			node = left;
+		}
+		else {
+			randt = min((randt - p_left)/(1.0f - p_left), 1.0f - FLT_EPSILON);
+			*pdf *= 1.0f - p_left;
+			node = right;
+		}
+	}
+}
+
+/* probability of picking triangle index from P, the same walk as above */
+__device float light_tree_pdf(KernelGlobals *kg, float3 P, int index, float *area)
+{
+	int node = 0;
+	float pdf = 1.0f;
+
+	for(;;) {
+		float4 data1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+		float4 data2 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 2);
+		int right = __float_as_int(data1.w);
+
+		if(right < 0) {
+			*area = data2.y;
+			return pdf;
+		}
+
+		int left = node + 1;
+		float p_left = light_tree_child_probability(kg, left, right, P);
+
+		if(index < __float_as_int(data2.x)) {
+			pdf *= p_left;
+			node = left;
+		}
+		else {
+			pdf *= 1.0f - p_left;
+			node = right;
+		}
+	}
+}
+
+/* find the index of a triangle in the light distribution */
+__device int light_tree_triangle_index(KernelGlobals *kg, int object, int prim)
+{
+	uint offset = kernel_tex_fetch(__light_tree_prims, object*2 + 0);
+
+	if(offset == 0)
+		return -1;
+
+	uint tri_offset = kernel_tex_fetch(__light_tree_prims, object*2 + 1);
+	return (int)kernel_tex_fetch(__light_tree_prims, offset - 1 + prim - tri_offset);
+}
+
+/* pdf of sampling point P on a triangle, as seen from the previous vertex */
+__device float light_tree_triangle_pdf(KernelGlobals *kg, int object, int prim,
+	const float3 P, const float3 Ng, const float3 I, float t)
+{
+	int index = light_tree_triangle_index(kg, object, prim);
+
+	if(index == -1)
+		return 0.0f;
+
+	float cos_pi = fabsf(dot(Ng, I));
+
+	if(cos_pi == 0.0f)
+		return 0.0f;
+
+	/* I points from the triangle back to the previous vertex */
+	float area;
+	float pdf = light_tree_pdf(kg, P + I*t, index, &area);
+
+	return kernel_data.integrator.light_tree_fraction*pdf/area * t*t/cos_pi;
+}
+
+#endif
+
 /* Generic Light */
 
 __device void light_sample(KernelGlobals *kg, float randt, float randu, float randv, float time, float3 P, LightSample *ls)
 {
+#ifdef __LIGHT_TREE__
+	/* triangles are picked from the light tree, lamps from the distribution */
+	float fraction = kernel_data.integrator.light_tree_fraction;
+
+	if(kernel_data.integrator.use_light_tree && randt < fraction) {
+		float pdf, area;
+		int index = light_tree_sample(kg, P, randt/fraction, &pdf, &area);
+
+		float4 l = kernel_tex_fetch(__light_distribution, index);
+		int prim = __float_as_int(l.y);
+		int object = __float_as_int(l.w);
+
+		triangle_light_sample(kg, prim, object, randu, randv, time, ls);
+
+		/* compute incoming direction, distance and pdf */
+		ls->D = normalize_len(ls->P - P, &ls->t);
+		ls->shader |= __float_as_int(l.z) & (~SHADER_MASK);
+
+		float cos_pi = fabsf(dot(ls->Ng, ls->D));
+		ls->pdf = (cos_pi > 0.0f)? fraction*pdf/area * ls->t*ls->t/cos_pi: 0.0f;
+
+		return;
+	}
+#endif
+
 	/* sample index */
 	int index = light_distribution_sample(kg, randt);
 
@@ -36,6 +36,7 @@
 #include "kernel_light.h"
 #include "kernel_emission.h"
 #include "kernel_passes.h"
+#include "kernel_adaptive_sampling.h"
 
 #ifdef __SUBSURFACE__
 #include "kernel_subsurface.h"
@@ -233,7 +234,8 @@ __device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *ra
 	return result;
 }
 
-__device float4 kernel_path_progressive(KernelGlobals *kg, RNG *rng, int sample, Ray ray, __global float *buffer)
+__device float4 kernel_path_progressive(KernelGlobals *kg, RNG *rng, int sample, Ray ray, __global float *buffer,
+	const Intersection *camera_isect)
 {
 	/* initialize */
 	PathRadiance L;
@@ -262,26 +264,38 @@ __device float4 kernel_path_progressive(KernelGlobals *kg, RNG *rng, int sample,
 		/* intersect scene */
 		Intersection isect;
 		uint visibility = path_state_ray_visibility(kg, &state);
-
+		bool hit;
+
+#ifdef __RAY_PACKETS__
+		if(camera_isect) {
+			/* camera ray was already traced as part of a packet */
+			isect = *camera_isect;
+			hit = (isect.prim != ~0);
+			camera_isect = NULL;
+		}
+		else
+#endif
+		{
 #ifdef __HAIR__
-		float difl = 0.0f, extmax = 0.0f;
-		uint lcg_state = 0;
-
-		if(kernel_data.bvh.have_curves) {
-			if((kernel_data.cam.resolution == 1) && (state.flag & PATH_RAY_CAMERA)) {	
-				float3 pixdiff = ray.dD.dx + ray.dD.dy;
-				/*pixdiff = pixdiff - dot(pixdiff, ray.D)*ray.D;*/
-				difl = kernel_data.curve_kernel_data.minimum_width * len(pixdiff) * 0.5f;
-			}
+			float difl = 0.0f, extmax = 0.0f;
+			uint lcg_state = 0;
+
+			if(kernel_data.bvh.have_curves) {
+				if((kernel_data.cam.resolution == 1) && (state.flag & PATH_RAY_CAMERA)) {	
+					float3 pixdiff = ray.dD.dx + ray.dD.dy;
+					/*pixdiff = pixdiff - dot(pixdiff, ray.D)*ray.D;*/
+					difl = kernel_data.curve_kernel_data.minimum_width * len(pixdiff) * 0.5f;
+				}
 
-			extmax = kernel_data.curve_kernel_data.maximum_width;
-			lcg_state = lcg_init(*rng + rng_offset + sample*0x51633e2d);
-		}
+				extmax = kernel_data.curve_kernel_data.maximum_width;
+				lcg_state = lcg_init(*rng + rng_offset + sample*0x51633e2d);
+			}
 
-		bool hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
+			hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
 #else
-		bool hit = scene_intersect(kg, &ray, visibility, &isect);
+			hit = scene_intersect(kg, &ray, visibility, &isect);
 #endif
+		}
 
 #ifdef __LAMP_MIS__
 		if(kernel_data.integrator.use_lamp_mis && !(state.flag & PATH_RAY_CAMERA)) {
@@ -960,7 +974,8 @@ __device_noinline void kernel_path_non_progressive_lighting(KernelGlobals *kg, R
 	}
 }
 
-__device float4 kernel_path_non_progressive(KernelGlobals *kg, RNG *rng, int sample, Ray ray, __global float *buffer)
+__device float4 kernel_path_non_progressive(KernelGlobals *kg, RNG *rng, int sample, Ray ray, __global float *buffer,
+	const Intersection *camera_isect)
 {
 	/* initialize */
 	PathRadiance L;
@@ -984,26 +999,40 @@ __device float4 kernel_path_non_progressive(KernelGlobals *kg, RNG *rng, int sam
 		/* intersect scene */
 		Intersection isect;
 		uint visibility = path_state_ray_visibility(kg, &state);
-
+		bool hit;
+
+#ifdef __RAY_PACKETS__
+		if(camera_isect) {
+			/* camera ray was already traced as part of a packet */
+			isect = *camera_isect;
+			hit = (isect.prim != ~0);
+			camera_isect = NULL;
+		}
+		else
+#endif
+		{
 #ifdef __HAIR__
-		float difl = 0.0f, extmax = 0.0f;
-		uint lcg_state = 0;
-
-		if(kernel_data.bvh.have_curves) {
-			if((kernel_data.cam.resolution == 1) && (state.flag & PATH_RAY_CAMERA)) {	
-				float3 pixdiff = ray.dD.dx + ray.dD.dy;
-				/*pixdiff = pixdiff - dot(pixdiff, ray.D)*ray.D;*/
-				difl = kernel_data.curve_kernel_data.minimum_width * len(pixdiff) * 0.5f;
-			}
+			float difl = 0.0f, extmax = 0.0f;
+			uint lcg_state = 0;
+
+			if(kernel_data.bvh.have_curves) {
+				if((kernel_data.cam.resolution == 1) && (state.flag & PATH_RAY_CAMERA)) {	
+					float3 pixdiff = ray.dD.dx + ray.dD.dy;
+					/*pixdiff = pixdiff - dot(pixdiff, ray.D)*ray.D;*/
+					difl = kernel_data.curve_kernel_data.minimum_width * len(pixdiff) * 0.5f;
+				}
 
-			extmax = kernel_data.curve_kernel_data.maximum_width;
-			lcg_state = lcg_init(*rng + rng_offset + sample*0x51633e2d);
-		}
+				extmax = kernel_data.curve_kernel_data.maximum_width;
+				lcg_state = lcg_init(*rng + rng_offset + sample*0x51633e2d);
+			}
 
-		if(!scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax)) {
+			hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
 #else
-		if(!scene_intersect(kg, &ray, visibility, &isect)) {
+			hit = scene_intersect(kg, &ray, visibility, &isect);
 #endif
+		}
+
+		if(!hit) {
 			/* eval background shader if nothing hit */
 			if(kernel_data.background.transparent) {
 				L_transparent += average(throughput);
@@ -1137,20 +1166,10 @@ __device float4 kernel_path_non_progressive(KernelGlobals *kg, RNG *rng, int sam
 
 #endif
 
-__device void kernel_path_trace(KernelGlobals *kg,
-	__global float *buffer, __global uint *rng_state,
-	int sample, int x, int y, int offset, int stride)
+__device_inline void kernel_path_trace_setup(KernelGlobals *kg, __global uint *rng_state,
+	int sample, int x, int y, RNG *rng, Ray *ray)
 {
-	/* buffer offset */
-	int index = offset + x + y*stride;
-	int pass_stride = kernel_data.film.pass_stride;
-
-	rng_state += index;
-	buffer += index*pass_stride;
-
 	/* initialize random numbers */
-	RNG rng;
-
 	float filter_u;
 	float filter_v;
 #ifdef __CMJ__
@@ -1159,46 +1178,148 @@ __device void kernel_path_trace(KernelGlobals *kg,
 	int num_samples = 0;
 #endif
 
-	path_rng_init(kg, rng_state, sample, num_samples, &rng, x, y, &filter_u, &filter_v);
+	path_rng_init(kg, rng_state, sample, num_samples, rng, x, y, &filter_u, &filter_v);
 
 	/* sample camera ray */
-	Ray ray;
-
 	float lens_u = 0.0f, lens_v = 0.0f;
 
 	if(kernel_data.cam.aperturesize > 0.0f)
-		path_rng_2D(kg, &rng, sample, num_samples, PRNG_LENS_U, &lens_u, &lens_v);
+		path_rng_2D(kg, rng, sample, num_samples, PRNG_LENS_U, &lens_u, &lens_v);
 
 	float time = 0.0f;
 
 #ifdef __CAMERA_MOTION__
 	if(kernel_data.cam.shuttertime != -1.0f)
-		time = path_rng_1D(kg, &rng, sample, num_samples, PRNG_TIME);
+		time = path_rng_1D(kg, rng, sample, num_samples, PRNG_TIME);
 #endif
 
-	camera_sample(kg, x, y, filter_u, filter_v, lens_u, lens_v, time, &ray);
+	camera_sample(kg, x, y, filter_u, filter_v, lens_u, lens_v, time, ray);
+}
 
-	/* integrate */
+__device_inline float4 kernel_path_integrate(KernelGlobals *kg, RNG *rng, int sample, Ray ray,
+	__global float *buffer, const Intersection *camera_isect)
+{
 	float4 L;
 
 	if (ray.t != 0.0f) {
 #ifdef __NON_PROGRESSIVE__
 		if(kernel_data.integrator.progressive)
 #endif
-			L = kernel_path_progressive(kg, &rng, sample, ray, buffer);
+			L = kernel_path_progressive(kg, rng, sample, ray, buffer, camera_isect);
 #ifdef __NON_PROGRESSIVE__
 		else
-			L = kernel_path_non_progressive(kg, &rng, sample, ray, buffer);
+			L = kernel_path_non_progressive(kg, rng, sample, ray, buffer, camera_isect);
 #endif
 	}
 	else
 		L = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 
+	return L;
+}
+
+__device void kernel_path_trace(KernelGlobals *kg,
+	__global float *buffer, __global uint *rng_state,
+	int sample, int x, int y, int offset, int stride)
+{
+	/* buffer offset */
+	int index = offset + x + y*stride;
+	int pass_stride = kernel_data.film.pass_stride;
+
+	rng_state += index;
+	buffer += index*pass_stride;
+
+#ifdef __ADAPTIVE_SAMPLING__
+	/* skip pixels that already converged */
+	if(kernel_adaptive_sampling_enabled(kg) && sample != 0 && kernel_adaptive_pixel_converged(kg, buffer))
+		return;
+#endif
+
+	/* sample camera ray */
+	RNG rng;
+	Ray ray;
+
+	kernel_path_trace_setup(kg, rng_state, sample, x, y, &rng, &ray);
+
+	/* integrate */
+	float4 L = kernel_path_integrate(kg, &rng, sample, ray, buffer, NULL);
+
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
 
+#ifdef __ADAPTIVE_SAMPLING__
+	if(kernel_adaptive_sampling_enabled(kg))
+		kernel_adaptive_write_aux(kg, buffer, sample, L);
+#endif
+
 	path_rng_end(kg, rng_state, rng);
 }
 
+#ifdef __RAY_PACKETS__
+
+/* Path trace num (up to BVH_PACKET_SIZE) neighbouring pixels on a row, with
+ * the coherent camera rays traced together as a packet. */
+
+__device void kernel_path_trace_packet(KernelGlobals *kg,
+	__global float *buffer, __global uint *rng_state,
+	int sample, int x, int y, int num, int offset, int stride)
+{
+	if(!scene_intersect_packet_supported(kg)) {
+		for(int i = 0; i < num; i++)
+			kernel_path_trace(kg, buffer, rng_state, sample, x + i, y, offset, stride);
+		return;
+	}
+
+	/* buffer offset */
+	int index = offset + x + y*stride;
+	int pass_stride = kernel_data.film.pass_stride;
+
+#ifdef __ADAPTIVE_SAMPLING__
+	/* with converged pixels in the packet, trace the remaining ones individually */
+	if(kernel_adaptive_sampling_enabled(kg) && sample != 0) {
+		for(int i = 0; i < num; i++) {
+			if(kernel_adaptive_pixel_converged(kg, buffer + (index + i)*pass_stride)) {
+				for(int j = 0; j < num; j++)
+					kernel_path_trace(kg, buffer, rng_state, sample, x + j, y, offset, stride);
+				return;
+			}
+		}
+	}
+#endif
+
+	rng_state += index;
+	buffer += index*pass_stride;
+
+	/* sample camera rays */
+	RNG rng[BVH_PACKET_SIZE];
+	Ray ray[BVH_PACKET_SIZE];
+	Intersection isect[BVH_PACKET_SIZE];
+
+	for(int i = 0; i < num; i++)
+		kernel_path_trace_setup(kg, rng_state + i, sample, x + i, y, &rng[i], &ray[i]);
+
+	/* intersect packet */
+	PathState state;
+	path_state_init(&state);
+
+	scene_intersect_packet(kg, ray, path_state_ray_visibility(kg, &state), isect, num);
+
+	/* integrate */
+	for(int i = 0; i < num; i++) {
+		float4 L = kernel_path_integrate(kg, &rng[i], sample, ray[i], buffer + i*pass_stride, &isect[i]);
+
+		/* accumulate result in output buffer */
+		kernel_write_pass_float4(buffer + i*pass_stride, sample, L);
+
+#ifdef __ADAPTIVE_SAMPLING__
+		if(kernel_adaptive_sampling_enabled(kg))
+			kernel_adaptive_write_aux(kg, buffer + i*pass_stride, sample, L);
+#endif
+
+		path_rng_end(kg, rng_state + i, rng[i]);
+	}
+}
+
+#endif
+
 CCL_NAMESPACE_END
 
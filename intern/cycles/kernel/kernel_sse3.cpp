@@ -43,6 +43,16 @@ void kernel_cpu_sse3_path_trace(KernelGlobals *kg, float *buffer, unsigned int *
 	kernel_path_trace(kg, buffer, rng_state, sample, x, y, offset, stride);
 }
 
+void kernel_cpu_sse3_path_trace_packet(KernelGlobals *kg, float *buffer, unsigned int *rng_state, int sample, int x, int y, int num, int offset, int stride)
+{
+#ifdef __RAY_PACKETS__
+	kernel_path_trace_packet(kg, buffer, rng_state, sample, x, y, num, offset, stride);
+#else
+	for(int i = 0; i < num; i++)
+		kernel_path_trace(kg, buffer, rng_state, sample, x + i, y, offset, stride);
+#endif
+}
+
 /* Tonemapping */
 
 void kernel_cpu_sse3_tonemap(KernelGlobals *kg, uchar4 *rgba, float *buffer, int sample, int x, int y, int offset, int stride)
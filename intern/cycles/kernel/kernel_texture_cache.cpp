@@ -0,0 +1,166 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "kernel_compat_cpu.h"
+#include "kernel_types.h"
+#include "kernel_globals.h"
+#include "kernel_texture_cache.h"
+
+#include "util_string.h"
+
+CCL_NAMESPACE_BEGIN
+
+TextureCache::TextureCache()
+{
+	ts = NULL;
+	max_memory_mb = 1024;
+}
+
+TextureCache::~TextureCache()
+{
+	if(ts)
+		TextureSystem::destroy(ts);
+}
+
+void TextureCache::set_max_memory(size_t max_memory_mb_)
+{
+	thread_scoped_lock lock(ts_mutex);
+
+	max_memory_mb = max_memory_mb_;
+
+	if(ts)
+		ts->attribute("max_memory_MB", (float)max_memory_mb);
+}
+
+void TextureCache::add_image(int slot, const string& filename)
+{
+	thread_scoped_lock lock(ts_mutex);
+
+	/* not shared with OSL, so that both can have their own memory limit */
+	if(!ts) {
+		ts = TextureSystem::create(false);
+
+		ts->attribute("automip", 1);
+		ts->attribute("autotile", 64);
+		ts->attribute("gray_to_rgb", 1);
+		ts->attribute("max_memory_MB", (float)max_memory_mb);
+	}
+
+	if(slot >= filenames.size())
+		filenames.resize(slot + 1);
+	else if(!filenames[slot].empty())
+		ts->invalidate(filenames[slot]);
+
+	filenames[slot] = ustring(filename);
+}
+
+void TextureCache::remove_image(int slot)
+{
+	thread_scoped_lock lock(ts_mutex);
+
+	if(slot < filenames.size() && !filenames[slot].empty()) {
+		ts->invalidate(filenames[slot]);
+		filenames[slot] = ustring();
+	}
+}
+
+bool TextureCache::has_image(int slot)
+{
+	return (slot < filenames.size() && !filenames[slot].empty());
+}
+
+bool TextureCache::lookup(int slot, float x, float y, float2 dx, float2 dy, float4 *result)
+{
+	if(!has_image(slot))
+		return false;
+
+	TextureOpt options;
+	options.nchannels = 4;
+	options.fill = 1.0f;
+	options.swrap = TextureOpt::WrapPeriodic;
+	options.twrap = TextureOpt::WrapPeriodic;
+	options.interpmode = TextureOpt::InterpBilinear;
+
+	/* image rows are stored top to bottom in the file, but Cycles has the
+	 * origin at the bottom left */
+	float rgba[4];
+
+	if(!ts->texture(filenames[slot], options, x, 1.0f - y, dx.x, -dx.y, dy.x, -dy.y, rgba)) {
+		/* same color as missing images */
+		*result = make_float4(1.0f, 0.0f, 1.0f, 1.0f);
+		return true;
+	}
+
+	*result = make_float4(rgba[0], rgba[1], rgba[2], rgba[3]);
+	return true;
+}
+
+static uint64_t texture_cache_stat_int64(TextureSystem *ts, const char *name)
+{
+	long long value = 0;
+	ts->getattribute(name, TypeDesc::LONGLONG, &value);
+	return (uint64_t)value;
+}
+
+static int texture_cache_stat_int(TextureSystem *ts, const char *name)
+{
+	int value = 0;
+	ts->getattribute(name, TypeDesc::INT, &value);
+	return value;
+}
+
+void TextureCache::get_stats(Stats& stats)
+{
+	thread_scoped_lock lock(ts_mutex);
+
+	memset(&stats, 0, sizeof(stats));
+
+	if(!ts)
+		return;
+
+	/* every tile that had to be read from file was a cache miss */
+	uint64_t tile_lookups = texture_cache_stat_int64(ts, "stat:find_tile_calls");
+
+	stats.tile_misses = texture_cache_stat_int(ts, "stat:tiles_created");
+	stats.tile_hits = (tile_lookups > stats.tile_misses)? tile_lookups - stats.tile_misses: 0;
+	stats.memory_used = texture_cache_stat_int64(ts, "stat:cache_memory_used");
+	stats.bytes_read = texture_cache_stat_int64(ts, "stat:bytes_read");
+	stats.num_files = texture_cache_stat_int(ts, "stat:unique_files");
+}
+
+string TextureCache::get_stats_string(int level)
+{
+	thread_scoped_lock lock(ts_mutex);
+
+	if(!ts)
+		return "";
+
+	return ts->getstats(level);
+}
+
+/* Kernel Lookup */
+
+bool kernel_texture_cache_lookup(KernelGlobals *kg, int slot, float x, float y, float2 dx, float2 dy, float4 *result)
+{
+	return kg->texture_cache->lookup(slot, x, y, dx, dy, result);
+}
+
+CCL_NAMESPACE_END
+
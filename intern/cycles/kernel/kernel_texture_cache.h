@@ -0,0 +1,81 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KERNEL_TEXTURE_CACHE_H__
+#define __KERNEL_TEXTURE_CACHE_H__
+
+#include <OpenImageIO/texture.h>
+
+#include "util_string.h"
+#include "util_thread.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+/* Texture Cache
+ *
+ * On the CPU, image textures can be read on demand instead of being fully
+ * loaded into memory. OpenImageIO splits images into tiles and mipmap levels,
+ * and only keeps the tiles that were looked up recently in a cache of limited
+ * size. The mipmap level is chosen from the texture coordinate differentials,
+ * so that distant or blurry lookups only touch a few small tiles.
+ *
+ * Images that are not tiled and mipmapped already (e.g. converted with maketx)
+ * are tiled and mipmapped on first use, which still reads the full image once
+ * but does not keep it in memory. */
+
+class TextureCache {
+public:
+	struct Stats {
+		uint64_t tile_hits;
+		uint64_t tile_misses;
+		uint64_t memory_used;
+		uint64_t bytes_read;
+		int num_files;
+	};
+
+	TextureCache();
+	~TextureCache();
+
+	void set_max_memory(size_t max_memory_mb);
+
+	void add_image(int slot, const string& filename);
+	void remove_image(int slot);
+	bool has_image(int slot);
+
+	/* x, y and differentials in Cycles image coordinates, with the origin in
+	 * the bottom left corner. returns false if slot is not in the cache. */
+	bool lookup(int slot, float x, float y, float2 dx, float2 dy, float4 *result);
+
+	void get_stats(Stats& stats);
+	string get_stats_string(int level = 1);
+
+protected:
+	TextureSystem *ts;
+	size_t max_memory_mb;
+	vector<ustring> filenames;
+	thread_mutex ts_mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_TEXTURE_CACHE_H__ */
+
@@ -32,6 +32,7 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_SIZE 		11
 #define OBJECT_VECTOR_SIZE	6
 #define LIGHT_SIZE			4
+#define LIGHT_TREE_NODE_SIZE	3
 #define FILTER_TABLE_SIZE	256
 #define RAMP_TABLE_SIZE		256
 #define PARTICLE_SIZE 		5
@@ -56,6 +57,12 @@ CCL_NAMESPACE_BEGIN
 #endif
 #define __SUBSURFACE__
 #define __CMJ__
+#define __ADAPTIVE_SAMPLING__
+#define __TEXTURE_CACHE__
+#define __LIGHT_TREE__
+#ifdef __KERNEL_SSE2__
+#define __RAY_PACKETS__
+#endif
 #endif
 
 #ifdef __KERNEL_CUDA__
@@ -262,7 +269,8 @@ typedef enum PassType {
 	PASS_SHADOW = 262144,
 	PASS_MOTION = 524288,
 	PASS_MOTION_WEIGHT = 1048576,
-	PASS_MIST = 2097152
+	PASS_MIST = 2097152,
+	PASS_ADAPTIVE_AUX = 4194304
 } PassType;
 
 #define PASS_ALL (~0)
@@ -684,6 +692,11 @@ typedef struct KernelFilm {
 	float mist_start;
 	float mist_inv_depth;
 	float mist_falloff;
+
+	int pass_adaptive_aux;
+	int pass_pad2;
+	int pass_pad3;
+	int pass_pad4;
 } KernelFilm;
 
 typedef struct KernelBackground {
@@ -757,8 +770,14 @@ typedef struct KernelIntegrator {
 	/* sampler */
 	int sampling_pattern;
 
-	/* padding */
-	int pad;
+	/* adaptive sampling */
+	float adaptive_threshold;
+	int adaptive_min_samples;
+	int adaptive_step;
+
+	/* light tree, fraction of light samples that go to triangles */
+	int use_light_tree;
+	float light_tree_fraction;
 } KernelIntegrator;
 
 typedef struct KernelBVH {
@@ -18,6 +18,32 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* convert looked up image color to scene linear, un-premultiplied alpha */
+
+__device_inline float4 svm_image_texture_color(int id, float4 r, uint srgb, uint use_alpha)
+{
+	if(use_alpha && r.w != 1.0f && r.w != 0.0f) {
+		float invw = 1.0f/r.w;
+		r.x *= invw;
+		r.y *= invw;
+		r.z *= invw;
+
+		if(id >= TEX_NUM_FLOAT_IMAGES) {
+			r.x = min(r.x, 1.0f);
+			r.y = min(r.y, 1.0f);
+			r.z = min(r.z, 1.0f);
+		}
+	}
+
+	if(srgb) {
+		r.x = color_srgb_to_scene_linear(r.x);
+		r.y = color_srgb_to_scene_linear(r.y);
+		r.z = color_srgb_to_scene_linear(r.z);
+	}
+
+	return r;
+}
+
 #ifdef __KERNEL_OPENCL__
 
 /* For OpenCL all images are packed in a single array, and we do manual lookup
@@ -88,26 +114,7 @@ __device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, u
 	r += ty*(1.0f - tx)*svm_image_texture_read(kg, offset + ix + niy*width);
 	r += ty*tx*svm_image_texture_read(kg, offset + nix + niy*width);
 
-	if(use_alpha && r.w != 1.0f && r.w != 0.0f) {
-		float invw = 1.0f/r.w;
-		r.x *= invw;
-		r.y *= invw;
-		r.z *= invw;
-
-		if(id >= TEX_NUM_FLOAT_IMAGES) {
-			r.x = min(r.x, 1.0f);
-			r.y = min(r.y, 1.0f);
-			r.z = min(r.z, 1.0f);
-		}
-	}
-
-	if(srgb) {
-		r.x = color_srgb_to_scene_linear(r.x);
-		r.y = color_srgb_to_scene_linear(r.y);
-		r.z = color_srgb_to_scene_linear(r.z);
-	}
-
-	return r;
+	return svm_image_texture_color(id, r, srgb, use_alpha);
 }
 
 #else
@@ -117,6 +124,12 @@ __device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, u
 	float4 r;
 
 #ifdef __KERNEL_CPU__
+#ifdef __TEXTURE_CACHE__
+	/* images read on demand, without filtering */
+	if(kg->texture_cache && kernel_texture_cache_lookup(kg, id, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), &r))
+		return svm_image_texture_color(id, r, srgb, use_alpha);
+#endif
+
 	r = kernel_tex_image_interp(id, x, y);
 #else
 	/* not particularly proud of this massive switch, what are the
@@ -235,26 +248,7 @@ __device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, u
 	}
 #endif
 
-	if(use_alpha && r.w != 1.0f && r.w != 0.0f) {
-		float invw = 1.0f/r.w;
-		r.x *= invw;
-		r.y *= invw;
-		r.z *= invw;
-
-		if(id >= TEX_NUM_FLOAT_IMAGES) {
-			r.x = min(r.x, 1.0f);
-			r.y = min(r.y, 1.0f);
-			r.z = min(r.z, 1.0f);
-		}
-	}
-
-	if(srgb) {
-		r.x = color_srgb_to_scene_linear(r.x);
-		r.y = color_srgb_to_scene_linear(r.y);
-		r.z = color_srgb_to_scene_linear(r.z);
-	}
-
-	return r;
+	return svm_image_texture_color(id, r, srgb, use_alpha);
 }
 
 #endif
@@ -268,7 +262,26 @@ __device void svm_node_tex_image(KernelGlobals *kg, ShaderData *sd, float *stack
 
 	float3 co = stack_load_float3(stack, co_offset);
 	uint use_alpha = stack_valid(alpha_offset);
-	float4 f = svm_image_texture(kg, id, co.x, co.y, srgb, use_alpha);
+	float4 f;
+
+#ifdef __TEXTURE_CACHE__
+	/* texture coordinates evaluated at the ray differential offsets, used
+	 * to pick the mipmap level when the image is read on demand */
+	uint dx_offset, dy_offset, unused;
+	decode_node_uchar4(node.w, &dx_offset, &dy_offset, &unused, &unused);
+
+	if(kg->texture_cache && stack_valid(dx_offset) && stack_valid(dy_offset)) {
+		float3 co_dx = stack_load_float3(stack, dx_offset) - co;
+		float3 co_dy = stack_load_float3(stack, dy_offset) - co;
+
+		if(kernel_texture_cache_lookup(kg, id, co.x, co.y, make_float2(co_dx.x, co_dx.y), make_float2(co_dy.x, co_dy.y), &f))
+			f = svm_image_texture_color(id, f, srgb, use_alpha);
+		else
+			f = svm_image_texture(kg, id, co.x, co.y, srgb, use_alpha);
+	}
+	else
+#endif
+	f = svm_image_texture(kg, id, co.x, co.y, srgb, use_alpha);
 
 	if(stack_valid(out_offset))
 		stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
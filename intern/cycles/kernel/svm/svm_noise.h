@@ -112,12 +112,92 @@ __device float scale3(float result)
 	return 0.9820f * result;
 }
 
+#ifdef __KERNEL_AVX2__
+
+/* 8 wide versions of hash and grad, evaluating all corners of the noise
+ * lattice cell at once. Lane i holds corner (i & 1, (i >> 1) & 1, i >> 2). */
+
+__device_inline __m256i hash_avx2(__m256i kx, __m256i ky, __m256i kz)
+{
+#define rot(x,k) _mm256_or_si256(_mm256_slli_epi32((x), (k)), _mm256_srli_epi32((x), 32-(k)))
+#define mix(a,b,k) a = _mm256_sub_epi32(_mm256_xor_si256(a, b), rot(b, k))
+	__m256i a, b, c;
+	a = b = c = _mm256_set1_epi32(0xdeadbeef + (3 << 2) + 13);
+
+	c = _mm256_add_epi32(c, kz);
+	b = _mm256_add_epi32(b, ky);
+	a = _mm256_add_epi32(a, kx);
+
+	mix(c, b, 14);
+	mix(a, c, 11);
+	mix(b, a, 25);
+	mix(c, b, 16);
+	mix(a, c, 4);
+	mix(b, a, 14);
+	mix(c, b, 24);
+
+	return c;
+#undef rot
+#undef mix
+}
+
+__device_inline __m256 grad_avx2(__m256i hash, __m256 x, __m256 y, __m256 z)
+{
+	__m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+
+	__m256 h_lt8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+	__m256 h_lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+	__m256 h_12_14 = _mm256_castsi256_ps(_mm256_or_si256(
+		_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+		_mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+
+	__m256 u = _mm256_blendv_ps(y, x, h_lt8);
+	__m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, h_12_14), y, h_lt4);
+
+	/* negate by moving hash bits 0 and 1 into the sign bit */
+	__m256 u_sign = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+	__m256 v_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31));
+
+	return _mm256_add_ps(_mm256_xor_ps(u, u_sign), _mm256_xor_ps(v, v_sign));
+}
+
+__device_inline float perlin_avx2(__m256i kx, __m256i ky, __m256i kz, float fx, float fy, float fz)
+{
+	const __m256 corner_x = _mm256_setr_ps(0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+	const __m256 corner_y = _mm256_setr_ps(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	const __m256 corner_z = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+
+	__m256 g = grad_avx2(hash_avx2(kx, ky, kz),
+		_mm256_sub_ps(_mm256_set1_ps(fx), corner_x),
+		_mm256_sub_ps(_mm256_set1_ps(fy), corner_y),
+		_mm256_sub_ps(_mm256_set1_ps(fz), corner_z));
+
+	float c[8];
+	_mm256_storeu_ps(c, g);
+
+	float u = fade(fx);
+	float v = fade(fy);
+	float w = fade(fz);
+
+	return nerp(w, nerp(v, nerp(u, c[0], c[1]), nerp(u, c[2], c[3])),
+	               nerp(v, nerp(u, c[4], c[5]), nerp(u, c[6], c[7])));
+}
+
+#endif
+
 __device_noinline float perlin(float x, float y, float z)
 {
 	int X; float fx = floorfrac(x, &X);
 	int Y; float fy = floorfrac(y, &Y);
 	int Z; float fz = floorfrac(z, &Z);
 
+#ifdef __KERNEL_AVX2__
+	float result = perlin_avx2(
+		_mm256_add_epi32(_mm256_set1_epi32(X), _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1)),
+		_mm256_add_epi32(_mm256_set1_epi32(Y), _mm256_setr_epi32(0, 0, 1, 1, 0, 0, 1, 1)),
+		_mm256_add_epi32(_mm256_set1_epi32(Z), _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1)),
+		fx, fy, fz);
+#else
 	float u = fade(fx);
 	float v = fade(fy);
 	float w = fade(fz);
@@ -132,6 +212,7 @@ __device_noinline float perlin(float x, float y, float z)
 										grad (hash (X+1, Y  , Z+1), fx-1.0f, fy	 , fz-1.0f )),
 							   nerp (u, grad (hash (X  , Y+1, Z+1), fx	 , fy-1.0f, fz-1.0f ),
 										grad (hash (X+1, Y+1, Z+1), fx-1.0f, fy-1.0f, fz-1.0f ))));
+#endif
 	float r = scale3(result);
 
 	/* can happen for big coordinates, things even out to 0.0 then anyway */
@@ -150,6 +231,17 @@ __device_noinline float perlin_periodic(float x, float y, float z, float3 pperio
 	p.y = max(quick_floor(pperiod.y), 1);
 	p.z = max(quick_floor(pperiod.z), 1);
 
+#ifdef __KERNEL_AVX2__
+	int X0 = imod(X, p.x), X1 = imod(X+1, p.x);
+	int Y0 = imod(Y, p.y), Y1 = imod(Y+1, p.y);
+	int Z0 = imod(Z, p.z), Z1 = imod(Z+1, p.z);
+
+	float result = perlin_avx2(
+		_mm256_setr_epi32(X0, X1, X0, X1, X0, X1, X0, X1),
+		_mm256_setr_epi32(Y0, Y0, Y1, Y1, Y0, Y0, Y1, Y1),
+		_mm256_setr_epi32(Z0, Z0, Z0, Z0, Z1, Z1, Z1, Z1),
+		fx, fy, fz);
+#else
 	float u = fade(fx);
 	float v = fade(fy);
 	float w = fade(fz);
@@ -164,6 +256,7 @@ __device_noinline float perlin_periodic(float x, float y, float z, float3 pperio
 										grad (phash (X+1, Y  , Z+1, p), fx-1.0f, fy	 , fz-1.0f )),
 							   nerp (u, grad (phash (X  , Y+1, Z+1, p), fx	 , fy-1.0f, fz-1.0f ),
 										grad (phash (X+1, Y+1, Z+1, p), fx-1.0f, fy-1.0f, fz-1.0f ))));
+#endif
 	float r = scale3(result);
 
 	/* can happen for big coordinates, things even out to 0.0 then anyway */
@@ -91,6 +91,8 @@ RenderTile::RenderTile()
 	offset = 0;
 	stride = 0;
 
+	skipped_samples = 0;
+
 	buffer = 0;
 	rng_state = 0;
 	rgba = 0;
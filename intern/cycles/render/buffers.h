@@ -134,6 +134,9 @@ public:
 	int offset;
 	int stride;
 
+	/* pixel samples not rendered because of adaptive sampling */
+	uint64_t skipped_samples;
+
 	device_ptr buffer;
 	device_ptr rng_state;
 	device_ptr rgba;
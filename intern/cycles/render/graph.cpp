@@ -222,7 +222,7 @@ void ShaderGraph::disconnect(ShaderInput *to)
 	from->links.erase(remove(from->links.begin(), from->links.end(), to), from->links.end());
 }
 
-void ShaderGraph::finalize(bool do_bump, bool do_osl, bool do_multi_transform)
+void ShaderGraph::finalize(bool do_bump, bool do_osl, bool do_multi_transform, bool do_texture_derivatives)
 {
 	/* before compiling, the shader graph may undergo a number of modifications.
 	 * currently we set default geometry shader inputs, and create automatic bump
@@ -237,6 +237,9 @@ void ShaderGraph::finalize(bool do_bump, bool do_osl, bool do_multi_transform)
 		if(do_bump)
 			bump_from_displacement();
 
+		if(do_texture_derivatives)
+			refine_texture_derivatives();
+
 		if(do_multi_transform) {
 			ShaderInput *surface_in = output()->input("Surface");
 			ShaderInput *volume_in = output()->input("Volume");
@@ -605,6 +608,91 @@ void ShaderGraph::refine_bump_nodes()
 	}
 }
 
+void ShaderGraph::refine_texture_derivatives()
+{
+	/* image textures read on demand choose a mipmap level from the texture
+	 * coordinate differentials. like for bump mapping, we copy the subgraph
+	 * defining the texture coordinates twice, shifted by the ray differentials
+	 * dx and dy, and connect them to the VectorDX and VectorDY inputs. */
+	vector<ShaderNode*> image_nodes;
+
+	foreach(ShaderNode *node, nodes) {
+		if(node->name == ustring("image_texture") && node->input("Vector")->link) {
+			ImageTextureNode *image_node = (ImageTextureNode*)node;
+
+			/* box projection and builtin images are not supported */
+			if(image_node->projection == "Flat" && !image_node->builtin_data)
+				image_nodes.push_back(node);
+		}
+	}
+
+	foreach(ShaderNode *node, image_nodes) {
+		ShaderInput *vector_in = node->input("Vector");
+		ShaderOutput *out = vector_in->link;
+		set<ShaderNode*> nodes_vector;
+
+		map<ShaderNode*, ShaderNode*> nodes_center;
+		map<ShaderNode*, ShaderNode*> nodes_dx;
+		map<ShaderNode*, ShaderNode*> nodes_dy;
+
+		find_dependencies(nodes_vector, vector_in);
+
+		copy_nodes(nodes_vector, nodes_dx);
+		copy_nodes(nodes_vector, nodes_dy);
+
+		foreach(NodePair& pair, nodes_dx)
+			pair.second->bump = SHADER_BUMP_DX;
+		foreach(NodePair& pair, nodes_dy)
+			pair.second->bump = SHADER_BUMP_DY;
+
+		if(node->bump == SHADER_BUMP_NONE || node->bump == SHADER_BUMP_CENTER) {
+			connect(nodes_dx[out->parent]->output(out->name), node->input("VectorDX"));
+			connect(nodes_dy[out->parent]->output(out->name), node->input("VectorDY"));
+		}
+		else {
+			/* the copies made for bump mapping are already shifted by dx or dy,
+			 * and can't be shifted twice. they get the differentials of the
+			 * center, added to their own texture coordinates */
+			copy_nodes(nodes_vector, nodes_center);
+
+			foreach(NodePair& pair, nodes_center)
+				pair.second->bump = SHADER_BUMP_CENTER;
+
+			ShaderOutput *out_center = nodes_center[out->parent]->output(out->name);
+			ShaderOutput *out_dx = nodes_dx[out->parent]->output(out->name);
+			ShaderOutput *out_dy = nodes_dy[out->parent]->output(out->name);
+
+			connect(refine_texture_offset(out, out_center, out_dx), node->input("VectorDX"));
+			connect(refine_texture_offset(out, out_center, out_dy), node->input("VectorDY"));
+
+			foreach(NodePair& pair, nodes_center)
+				add(pair.second);
+		}
+
+		foreach(NodePair& pair, nodes_dx)
+			add(pair.second);
+		foreach(NodePair& pair, nodes_dy)
+			add(pair.second);
+	}
+}
+
+ShaderOutput *ShaderGraph::refine_texture_offset(ShaderOutput *vector, ShaderOutput *center, ShaderOutput *shifted)
+{
+	/* vector + (shifted - center) */
+	VectorMathNode *sub = (VectorMathNode*)add(new VectorMathNode());
+	VectorMathNode *sum = (VectorMathNode*)add(new VectorMathNode());
+
+	sub->type = ustring("Subtract");
+	sum->type = ustring("Add");
+
+	connect(shifted, sub->input("Vector1"));
+	connect(center, sub->input("Vector2"));
+	connect(vector, sum->input("Vector1"));
+	connect(sub->output("Vector"), sum->input("Vector2"));
+
+	return sum->output("Vector");
+}
+
 void ShaderGraph::bump_from_displacement()
 {
 	/* generate bump mapping automatically from displacement. bump mapping is
@@ -241,7 +241,8 @@ public:
 	void disconnect(ShaderInput *to);
 
 	void remove_unneeded_nodes();
-	void finalize(bool do_bump = false, bool do_osl = false, bool do_multi_closure = false);
+	void finalize(bool do_bump = false, bool do_osl = false, bool do_multi_closure = false,
+		bool do_texture_derivatives = false);
 
 protected:
 	typedef pair<ShaderNode* const, ShaderNode*> NodePair;
@@ -253,6 +254,8 @@ protected:
 	void clean();
 	void bump_from_displacement();
 	void refine_bump_nodes();
+	void refine_texture_derivatives();
+	ShaderOutput *refine_texture_offset(ShaderOutput *vector, ShaderOutput *center, ShaderOutput *shifted);
 	void default_inputs(bool do_osl);
 	void transform_multi_closure(ShaderNode *node, ShaderOutput *weight_out, bool volume);
 };
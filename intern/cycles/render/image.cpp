@@ -20,6 +20,8 @@
 #include "image.h"
 #include "scene.h"
 
+#include "kernel_texture_cache.h"
+
 #include "util_foreach.h"
 #include "util_image.h"
 #include "util_path.h"
@@ -36,6 +38,8 @@ ImageManager::ImageManager()
 	need_update = true;
 	pack_images = false;
 	osl_texture_system = NULL;
+	use_texture_cache = false;
+	texture_cache_size = 1024;
 	animation_frame = 0;
 
 	tex_num_images = TEX_NUM_IMAGES;
@@ -56,6 +60,17 @@ void ImageManager::set_pack_images(bool pack_images_)
 	pack_images = pack_images_;
 }
 
+void ImageManager::set_texture_cache(bool use_texture_cache_, int texture_cache_size_)
+{
+	use_texture_cache = use_texture_cache_;
+	texture_cache_size = texture_cache_size_;
+}
+
+bool ImageManager::get_use_texture_cache()
+{
+	return use_texture_cache && !pack_images;
+}
+
 void ImageManager::set_osl_texture_system(void *texture_system)
 {
 	osl_texture_system = texture_system;
@@ -453,6 +468,16 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		is_float = true;
 	}
 
+	/* images from files are read on demand during render, keeping only the
+	 * tiles that were used recently in memory */
+	TextureCache *texture_cache = (get_use_texture_cache())? device->texture_cache(): NULL;
+
+	if(texture_cache && !img->builtin_data && img->filename != "") {
+		texture_cache->add_image(slot, img->filename);
+		img->need_load = false;
+		return;
+	}
+
 	if(is_float) {
 		string filename = path_filename(float_images[slot]->filename);
 		progress->set_status("Updating Images", "Loading " + filename);
@@ -534,6 +559,11 @@ void ImageManager::device_free_image(Device *device, DeviceScene *dscene, int sl
 	}
 
 	if(img) {
+		TextureCache *texture_cache = device->texture_cache();
+
+		if(texture_cache && texture_cache->has_image(slot))
+			texture_cache->remove_image(slot);
+
 		if(osl_texture_system) {
 #ifdef WITH_OSL
 			ustring filename(images[slot]->filename);
@@ -574,6 +604,11 @@ void ImageManager::device_update(Device *device, DeviceScene *dscene, Progress&
 	if(!need_update)
 		return;
 
+	TextureCache *texture_cache = (get_use_texture_cache())? device->texture_cache(): NULL;
+
+	if(texture_cache)
+		texture_cache->set_max_memory(texture_cache_size);
+
 	TaskPool pool;
 
 	for(size_t slot = 0; slot < images.size(); slot++) {
@@ -60,6 +60,8 @@ public:
 
 	void set_osl_texture_system(void *texture_system);
 	void set_pack_images(bool pack_images_);
+	void set_texture_cache(bool use_texture_cache_, int texture_cache_size_);
+	bool get_use_texture_cache();
 	void set_extended_image_limits(void);
 	bool set_animation_frame_update(int frame);
 
@@ -88,6 +90,8 @@ private:
 	vector<Image*> float_images;
 	void *osl_texture_system;
 	bool pack_images;
+	bool use_texture_cache;
+	int texture_cache_size;
 
 	bool file_load_image(Image *img, device_vector<uchar4>& tex_img);
 	bool file_load_float_image(Image *img, device_vector<float4>& tex_img);
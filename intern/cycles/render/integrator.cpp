@@ -60,6 +60,11 @@ Integrator::Integrator()
 
 	sampling_pattern = SAMPLING_PATTERN_SOBOL;
 
+	adaptive_threshold = 0.0f;
+	adaptive_min_samples = 16;
+
+	use_light_tree = false;
+
 	need_update = true;
 }
 
@@ -117,6 +122,12 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 
 	kintegrator->sampling_pattern = sampling_pattern;
 
+	/* the convergence test needs an even number of samples */
+	kintegrator->adaptive_threshold = adaptive_threshold;
+	kintegrator->adaptive_step = 4;
+	kintegrator->adaptive_min_samples = max(align_up(adaptive_min_samples, kintegrator->adaptive_step),
+	                                        kintegrator->adaptive_step);
+
 	/* sobol directions table */
 	int max_samples = 1;
 
@@ -174,7 +185,10 @@ bool Integrator::modified(const Integrator& integrator)
 		mesh_light_samples == integrator.mesh_light_samples &&
 		subsurface_samples == integrator.subsurface_samples &&
 		motion_blur == integrator.motion_blur &&
-		sampling_pattern == integrator.sampling_pattern);
+		sampling_pattern == integrator.sampling_pattern &&
+		adaptive_threshold == integrator.adaptive_threshold &&
+		adaptive_min_samples == integrator.adaptive_min_samples &&
+		use_light_tree == integrator.use_light_tree);
 }
 
 void Integrator::tag_update(Scene *scene)
@@ -63,6 +63,15 @@ public:
 
 	SamplingPattern sampling_pattern;
 
+	/* adaptive sampling, stop sampling pixels when their error estimate
+	 * is below the threshold, zero disables */
+	float adaptive_threshold;
+	int adaptive_min_samples;
+
+	/* sample emissive triangles with a light tree, by estimated contribution
+	 * to the shading point instead of by area */
+	bool use_light_tree;
+
 	bool need_update;
 
 	Integrator();
@@ -19,14 +19,18 @@
 #include "device.h"
 #include "integrator.h"
 #include "film.h"
+#include "graph.h"
 #include "light.h"
 #include "mesh.h"
 #include "object.h"
 #include "scene.h"
 #include "shader.h"
 
+#include "util_algorithm.h"
+#include "util_boundbox.h"
 #include "util_foreach.h"
 #include "util_progress.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -94,6 +98,95 @@ static void shade_background_pixels(Device *device, DeviceScene *dscene, int res
 	}
 }
 
+/* Light Tree */
+
+struct LightTreeEmitter {
+	float4 distribution;
+	BoundBox bounds;
+	float3 centroid;
+	float area;
+	float energy;
+	int object;
+	int prim;
+};
+
+struct LightTreeCentroidCompare {
+	int axis;
+
+	LightTreeCentroidCompare(int axis_) : axis(axis_) {}
+
+	bool operator()(const LightTreeEmitter& a, const LightTreeEmitter& b) const
+	{
+		return a.centroid[axis] < b.centroid[axis];
+	}
+};
+
+static float light_tree_shader_strength(Shader *shader)
+{
+	/* the emitted power is not known in general, but for the common case of
+	 * an emission shader with constant inputs we can use its strength */
+	ShaderInput *surface_in = shader->graph->output()->input("Surface");
+
+	if(surface_in->link && surface_in->link->parent->name == ustring("emission")) {
+		ShaderNode *emission = surface_in->link->parent;
+		ShaderInput *color_in = emission->input("Color");
+		ShaderInput *strength_in = emission->input("Strength");
+
+		if(!color_in->link && !strength_in->link)
+			return max(average(color_in->value)*strength_in->value.x, 0.0f);
+	}
+
+	return 1.0f;
+}
+
+static int light_tree_build_node(vector<LightTreeEmitter>& emitters, int begin, int end, vector<float4>& nodes)
+{
+	/* nodes are stored depth first, the left child directly follows the
+	 * parent and the right child index is stored in the node */
+	int node = nodes.size()/LIGHT_TREE_NODE_SIZE;
+	nodes.resize(nodes.size() + LIGHT_TREE_NODE_SIZE);
+
+	BoundBox bounds = BoundBox::empty;
+	BoundBox centroid_bounds = BoundBox::empty;
+	float energy = 0.0f;
+
+	for(int i = begin; i < end; i++) {
+		bounds.grow(emitters[i].bounds);
+		centroid_bounds.grow(emitters[i].centroid);
+		energy += emitters[i].energy;
+	}
+
+	int right;
+	int middle;
+	float area;
+
+	if(end - begin == 1) {
+		right = ~begin;
+		middle = begin;
+		area = emitters[begin].area;
+	}
+	else {
+		/* split at the median centroid along the largest axis */
+		float3 size = centroid_bounds.size();
+		int axis = (size.x > size.y)? ((size.x > size.z)? 0: 2): ((size.y > size.z)? 1: 2);
+
+		middle = (begin + end)/2;
+		std::nth_element(emitters.begin() + begin, emitters.begin() + middle,
+			emitters.begin() + end, LightTreeCentroidCompare(axis));
+
+		light_tree_build_node(emitters, begin, middle, nodes);
+		right = light_tree_build_node(emitters, middle, end, nodes);
+		area = 0.0f;
+	}
+
+	float4 *data = &nodes[node*LIGHT_TREE_NODE_SIZE];
+	data[0] = make_float4(bounds.min.x, bounds.min.y, bounds.min.z, energy);
+	data[1] = make_float4(bounds.max.x, bounds.max.y, bounds.max.z, __int_as_float(right));
+	data[2] = make_float4(__int_as_float(middle), area, 0.0f, 0.0f);
+
+	return node;
+}
+
 /* Light */
 
 Light::Light()
@@ -136,6 +229,10 @@ LightManager::LightManager()
 {
 	need_update = true;
 	use_light_visibility = false;
+
+	light_tree_num_emitters = 0;
+	light_tree_num_nodes = 0;
+	light_tree_build_time = 0.0;
 }
 
 LightManager::~LightManager()
@@ -197,6 +294,18 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
 	float totarea = 0.0f;
 
+	/* light tree */
+	bool use_light_tree = scene->integrator->use_light_tree && num_triangles > 0;
+	vector<LightTreeEmitter> emitters;
+	vector<float> shader_strength;
+
+	if(use_light_tree) {
+		emitters.reserve(num_triangles);
+
+		foreach(Shader *shader, scene->shaders)
+			shader_strength.push_back(light_tree_shader_strength(shader));
+	}
+
 	/* triangles */
 	size_t offset = 0;
 	int j = 0;
@@ -265,7 +374,25 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 						p3 = transform_point(&tfm, p3);
 					}
 
-					totarea += triangle_area(p1, p2, p3);
+					float area = triangle_area(p1, p2, p3);
+
+					if(use_light_tree) {
+						LightTreeEmitter emitter;
+
+						emitter.distribution = distribution[offset - 1];
+						emitter.bounds = BoundBox(p1);
+						emitter.bounds.grow(p2);
+						emitter.bounds.grow(p3);
+						emitter.centroid = (p1 + p2 + p3)*(1.0f/3.0f);
+						emitter.area = area;
+						emitter.energy = area*shader_strength[mesh->shader[i]];
+						emitter.object = j;
+						emitter.prim = i;
+
+						emitters.push_back(emitter);
+					}
+
+					totarea += area;
 				}
 			}
 
@@ -311,6 +438,15 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 
 	float trianglearea = totarea;
 
+	light_tree_num_emitters = 0;
+	light_tree_num_nodes = 0;
+	light_tree_build_time = 0.0;
+
+	if(use_light_tree) {
+		device_update_tree(device, dscene, scene, emitters, distribution, progress);
+		if(progress.get_cancel()) return;
+	}
+
 	/* point lights */
 	float lightarea = (totarea > 0.0f)? totarea/scene->lights.size(): 1.0f;
 	bool use_lamp_mis = false;
@@ -377,6 +513,10 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 
 		kintegrator->use_lamp_mis = use_lamp_mis;
 
+		/* triangles take the same share of samples as in the distribution */
+		kintegrator->use_light_tree = use_light_tree && trianglearea > 0.0f;
+		kintegrator->light_tree_fraction = trianglearea/totarea;
+
 		/* bit of an ugly hack to compensate for emitting triangles influencing
 		 * amount of samples we get for this pass */
 		kfilm->pass_shadow_scale = 1.0f;
@@ -399,10 +539,70 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		kintegrator->pdf_lights = 0.0f;
 		kintegrator->inv_pdf_lights = 0.0f;
 		kintegrator->use_lamp_mis = false;
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_fraction = 0.0f;
 		kfilm->pass_shadow_scale = 1.0f;
 	}
 }
 
+void LightManager::device_update_tree(Device *device, DeviceScene *dscene, Scene *scene,
+	vector<LightTreeEmitter>& emitters, float4 *distribution, Progress& progress)
+{
+	progress.set_status("Updating Lights", "Building light tree");
+
+	double build_start = time_dt();
+
+	/* build nodes, this reorders emitters to match the leaves */
+	vector<float4> nodes;
+	nodes.reserve(emitters.size()*2*LIGHT_TREE_NODE_SIZE);
+
+	light_tree_build_node(emitters, 0, emitters.size(), nodes);
+
+	if(progress.get_cancel()) return;
+
+	/* store triangles in the distribution in the same order, so that every
+	 * subtree spans a contiguous range */
+	float totarea = 0.0f;
+
+	for(size_t i = 0; i < emitters.size(); i++) {
+		distribution[i] = emitters[i].distribution;
+		distribution[i].x = totarea;
+		totarea += emitters[i].area;
+	}
+
+	/* lookup from object and triangle to the distribution, for MIS. every
+	 * object has two entries: the offset of its triangles in this table plus
+	 * one (zero if it has no emissive triangles), and the mesh triangle offset */
+	vector<uint> prims(scene->objects.size()*2, 0);
+
+	for(size_t i = 0; i < emitters.size(); i++) {
+		int object = emitters[i].object;
+
+		if(prims[object*2 + 0] == 0) {
+			Mesh *mesh = scene->objects[object]->mesh;
+
+			prims[object*2 + 0] = prims.size() + 1;
+			prims[object*2 + 1] = mesh->tri_offset;
+			prims.resize(prims.size() + mesh->triangles.size(), ~0);
+		}
+
+		prims[prims[object*2 + 0] - 1 + emitters[i].prim] = i;
+	}
+
+	float4 *tree_nodes = dscene->light_tree_nodes.resize(nodes.size());
+	memcpy(tree_nodes, &nodes[0], nodes.size()*sizeof(float4));
+
+	uint *tree_prims = dscene->light_tree_prims.resize(prims.size());
+	memcpy(tree_prims, &prims[0], prims.size()*sizeof(uint));
+
+	device->tex_alloc("__light_tree_nodes", dscene->light_tree_nodes);
+	device->tex_alloc("__light_tree_prims", dscene->light_tree_prims);
+
+	light_tree_num_emitters = emitters.size();
+	light_tree_num_nodes = nodes.size()/LIGHT_TREE_NODE_SIZE;
+	light_tree_build_time = time_dt() - build_start;
+}
+
 void LightManager::device_update_background(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	KernelIntegrator *kintegrator = &dscene->data.integrator;
@@ -643,11 +843,15 @@ void LightManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->light_data);
 	device->tex_free(dscene->light_background_marginal_cdf);
 	device->tex_free(dscene->light_background_conditional_cdf);
+	device->tex_free(dscene->light_tree_nodes);
+	device->tex_free(dscene->light_tree_prims);
 
 	dscene->light_distribution.clear();
 	dscene->light_data.clear();
 	dscene->light_background_marginal_cdf.clear();
 	dscene->light_background_conditional_cdf.clear();
+	dscene->light_tree_nodes.clear();
+	dscene->light_tree_prims.clear();
 }
 
 void LightManager::tag_update(Scene *scene)
@@ -30,6 +30,7 @@ class Device;
 class DeviceScene;
 class Progress;
 class Scene;
+struct LightTreeEmitter;
 
 class Light {
 public:
@@ -68,6 +69,11 @@ public:
 	bool use_light_visibility;
 	bool need_update;
 
+	/* light tree statistics */
+	int light_tree_num_emitters;
+	int light_tree_num_nodes;
+	double light_tree_build_time;
+
 	LightManager();
 	~LightManager();
 
@@ -80,6 +86,8 @@ protected:
 	void device_update_points(Device *device, DeviceScene *dscene, Scene *scene);
 	void device_update_distribution(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_background(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_tree(Device *device, DeviceScene *dscene, Scene *scene,
+		vector<LightTreeEmitter>& emitters, float4 *distribution, Progress& progress);
 };
 
 CCL_NAMESPACE_END
@@ -31,8 +31,10 @@
 
 #include "util_cache.h"
 #include "util_foreach.h"
+#include "util_hash.h"
 #include "util_progress.h"
 #include "util_set.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -48,6 +50,7 @@ Mesh::Mesh()
 	bounds = BoundBox::empty;
 
 	bvh = NULL;
+	geometry_hash = 0;
 
 	tri_offset = 0;
 	vert_offset = 0;
@@ -358,6 +361,22 @@ void Mesh::pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, s
 	}
 }
 
+void Mesh::compute_geometry_hash()
+{
+	uint64_t hash = 0;
+
+	if(verts.size())
+		hash = hash_buffer(&verts[0], verts.size()*sizeof(float3), hash);
+	if(triangles.size())
+		hash = hash_buffer(&triangles[0], triangles.size()*sizeof(Triangle), hash);
+	if(curve_keys.size())
+		hash = hash_buffer(&curve_keys[0], curve_keys.size()*sizeof(CurveKey), hash);
+	if(curves.size())
+		hash = hash_buffer(&curves[0], curves.size()*sizeof(Curve), hash);
+
+	geometry_hash = hash;
+}
+
 void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total)
 {
 	if(progress->get_cancel())
@@ -365,6 +384,10 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 
 	compute_bounds();
 
+	/* hash once per update, the BVH cache keys for the mesh and scene BVH
+	 * use this instead of hashing all geometry on every lookup */
+	compute_geometry_hash();
+
 	if(!transform_applied) {
 		string msg = "Updating Mesh BVH ";
 		if(name == "")
@@ -378,10 +401,14 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 		vector<Object*> objects;
 		objects.push_back(&object);
 
+		double start_time = time_dt();
+
 		if(bvh && !need_update_rebuild) {
 			progress->set_status(msg, "Refitting BVH");
 			bvh->objects = objects;
 			bvh->refit(*progress);
+
+			progress->add_bvh_refit_time(time_dt() - start_time);
 		}
 		else {
 			progress->set_status(msg, "Building BVH");
@@ -394,6 +421,8 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 			delete bvh;
 			bvh = BVH::create(bparams, objects);
 			bvh->build(*progress);
+
+			progress->add_bvh_build_time(time_dt() - start_time);
 		}
 	}
 
@@ -424,6 +453,7 @@ void Mesh::tag_update(Scene *scene, bool rebuild)
 MeshManager::MeshManager()
 {
 	bvh = NULL;
+	device_num_meshes = 0;
 	need_update = true;
 }
 
@@ -803,20 +833,141 @@ void MeshManager::device_update_mesh(Device *device, DeviceScene *dscene, Scene
 	}
 }
 
-void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
+bool MeshManager::need_bvh_rebuild(Scene *scene, vector<bool>& refit_objects)
 {
-	/* bvh build */
-	progress.set_status("Updating Scene BVH", "Building");
+	/* if the scene objects are unchanged and only meshes in the scene BVH
+	 * deformed, its structure remains valid and we only refit the nodes
+	 * containing the changed objects */
+	if(!bvh || bvh->objects != scene->objects || bvh_transform_applied.size() != scene->objects.size())
+		return true;
 
-	BVHParams bparams;
-	bparams.top_level = true;
-	bparams.use_qbvh = scene->params.use_qbvh;
-	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
-	bparams.use_cache = scene->params.use_bvh_cache;
+	if(bvh->params.use_qbvh != scene->params.use_qbvh ||
+	   bvh->params.use_spatial_split != scene->params.use_bvh_spatial_split ||
+	   bvh->params.use_cache != scene->params.use_bvh_cache)
+		return true;
 
-	delete bvh;
-	bvh = BVH::create(bparams, scene->objects);
-	bvh->build(progress);
+	refit_objects.clear();
+	refit_objects.resize(scene->objects.size(), false);
+
+	size_t num_instances = 0;
+
+	for(size_t i = 0; i < scene->objects.size(); i++) {
+		Mesh *mesh = scene->objects[i]->mesh;
+
+		/* mesh moved in or out of the scene BVH */
+		if(mesh->transform_applied != bvh_transform_applied[i])
+			return true;
+
+		if(mesh->transform_applied) {
+			if(mesh->need_update_rebuild)
+				return true;
+
+			refit_objects[i] = mesh->need_update;
+		}
+		else {
+			/* instance BVH nodes are merged into the scene BVH arrays */
+			if(mesh->need_update)
+				return true;
+
+			/* instance bounds follow the object transform */
+			refit_objects[i] = true;
+			num_instances++;
+		}
+	}
+
+	/* a two-level BVH over instances only is cheap to rebuild, and gives
+	 * better trees than refitting after objects moved */
+	if(num_instances == scene->objects.size())
+		return true;
+
+	return false;
+}
+
+bool MeshManager::is_transform_only_update(Scene *scene)
+{
+	/* with a dynamic BVH all meshes have their own BVH, and the scene BVH is a
+	 * top level BVH over the object instances. if meshes and objects are the
+	 * same as in the last update, only object transforms changed and mesh data
+	 * on the device remains valid */
+	if(scene->params.bvh_type != SceneParams::BVH_DYNAMIC || !bvh)
+		return false;
+
+	if(bvh->objects != scene->objects || device_object_meshes.size() != scene->objects.size())
+		return false;
+
+	if(device_num_meshes != scene->meshes.size())
+		return false;
+
+	for(size_t i = 0; i < scene->objects.size(); i++)
+		if(scene->objects[i]->mesh != device_object_meshes[i])
+			return false;
+
+	foreach(Mesh *mesh, scene->meshes) {
+		if(mesh->need_update || mesh->transform_applied)
+			return false;
+
+		foreach(uint shader, mesh->used_shaders)
+			if(scene->shaders[shader]->need_update_attributes)
+				return false;
+	}
+
+	return true;
+}
+
+void MeshManager::compute_object_bounds(Device *device, Scene *scene)
+{
+	float shuttertime = scene->camera->shuttertime;
+#ifdef __OBJECT_MOTION__
+	Scene::MotionType need_motion = scene->need_motion(device->info.advanced_shading);
+	bool motion_blur = need_motion == Scene::MOTION_BLUR;
+#else
+	bool motion_blur = false;
+#endif
+
+	foreach(Object *object, scene->objects)
+		object->compute_bounds(motion_blur, shuttertime);
+}
+
+void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress,
+	const vector<bool>& refit_objects)
+{
+	double start_time = time_dt();
+
+	if(bvh && refit_objects.size()) {
+		/* bvh refit */
+		progress.set_status("Updating Scene BVH", "Refitting");
+
+		bvh->refit(progress, refit_objects);
+
+		progress.add_bvh_refit_time(time_dt() - start_time);
+	}
+	else {
+		/* bvh build */
+		progress.set_status("Updating Scene BVH", "Building");
+
+		BVHParams bparams;
+		bparams.top_level = true;
+		bparams.use_qbvh = scene->params.use_qbvh;
+		bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
+		bparams.use_cache = scene->params.use_bvh_cache;
+
+		if(bparams.use_cache)
+			Cache::global.set_size_limit((size_t)scene->params.bvh_cache_size << 20);
+
+		delete bvh;
+		bvh = BVH::create(bparams, scene->objects);
+		bvh->build(progress);
+
+		progress.add_bvh_build_time(time_dt() - start_time);
+
+		/* remember which meshes are in the scene bvh, for refitting */
+		bvh_transform_applied.clear();
+
+		if(!progress.get_cancel()) {
+			foreach(Object *object, scene->objects)
+				bvh_transform_applied.push_back(object->mesh->transform_applied);
+		}
+	}
 
 	if(progress.get_cancel()) return;
 
@@ -862,6 +1013,19 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	if(!need_update)
 		return;
 
+	/* only rebuild the top level BVH if just object transforms changed */
+	if(is_transform_only_update(scene)) {
+		compute_object_bounds(device, scene);
+
+		if(progress.get_cancel()) return;
+
+		device_free_bvh(device, dscene);
+		device_update_bvh(device, dscene, scene, progress, vector<bool>());
+
+		need_update = false;
+		return;
+	}
+
 	/* update normals */
 	foreach(Mesh *mesh, scene->meshes) {
 		foreach(uint shader, mesh->used_shaders)
@@ -906,6 +1070,12 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 		if(progress.get_cancel()) return;
 	}
 
+	/* find objects to refit in the scene bvh, before mesh update flags are cleared */
+	vector<bool> refit_objects;
+
+	if(need_bvh_rebuild(scene, refit_objects))
+		refit_objects.clear();
+
 	/* update bvh */
 	size_t i = 0, num_bvh = 0;
 
@@ -927,25 +1097,24 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	foreach(Shader *shader, scene->shaders)
 		shader->need_update_attributes = false;
 
-	float shuttertime = scene->camera->shuttertime;
-#ifdef __OBJECT_MOTION__
-	Scene::MotionType need_motion = scene->need_motion(device->info.advanced_shading);
-	bool motion_blur = need_motion == Scene::MOTION_BLUR;
-#else
-	bool motion_blur = false;
-#endif
+	compute_object_bounds(device, scene);
 
-	foreach(Object *object, scene->objects)
-		object->compute_bounds(motion_blur, shuttertime);
+	if(progress.get_cancel()) return;
+
+	device_update_bvh(device, dscene, scene, progress, refit_objects);
 
 	if(progress.get_cancel()) return;
 
-	device_update_bvh(device, dscene, scene, progress);
+	/* remember meshes used by objects to detect transform only updates */
+	foreach(Object *object, scene->objects)
+		device_object_meshes.push_back(object->mesh);
+
+	device_num_meshes = scene->meshes.size();
 
 	need_update = false;
 }
 
-void MeshManager::device_free(Device *device, DeviceScene *dscene)
+void MeshManager::device_free_bvh(Device *device, DeviceScene *dscene)
 {
 	device->tex_free(dscene->bvh_nodes);
 	device->tex_free(dscene->object_node);
@@ -954,6 +1123,20 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->prim_visibility);
 	device->tex_free(dscene->prim_index);
 	device->tex_free(dscene->prim_object);
+
+	dscene->bvh_nodes.clear();
+	dscene->object_node.clear();
+	dscene->tri_woop.clear();
+	dscene->prim_segment.clear();
+	dscene->prim_visibility.clear();
+	dscene->prim_index.clear();
+	dscene->prim_object.clear();
+}
+
+void MeshManager::device_free(Device *device, DeviceScene *dscene)
+{
+	device_free_bvh(device, dscene);
+
 	device->tex_free(dscene->tri_normal);
 	device->tex_free(dscene->tri_vnormal);
 	device->tex_free(dscene->tri_vindex);
@@ -964,13 +1147,6 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->attributes_float);
 	device->tex_free(dscene->attributes_float3);
 
-	dscene->bvh_nodes.clear();
-	dscene->object_node.clear();
-	dscene->tri_woop.clear();
-	dscene->prim_segment.clear();
-	dscene->prim_visibility.clear();
-	dscene->prim_index.clear();
-	dscene->prim_object.clear();
 	dscene->tri_normal.clear();
 	dscene->tri_vnormal.clear();
 	dscene->tri_vindex.clear();
@@ -990,6 +1166,10 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 		og->object_names.clear();
 	}
 #endif
+
+	/* mesh data is no longer on the device */
+	device_object_meshes.clear();
+	device_num_meshes = 0;
 }
 
 void MeshManager::tag_update(Scene *scene)
@@ -98,6 +98,7 @@ public:
 
 	/* BVH */
 	BVH *bvh;
+	uint64_t geometry_hash;
 	size_t tri_offset;
 	size_t vert_offset;
 
@@ -121,6 +122,7 @@ public:
 	void pack_normals(Scene *scene, float4 *normal, float4 *vnormal);
 	void pack_verts(float4 *tri_verts, float4 *tri_vindex, size_t vert_offset);
 	void pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, size_t curvekey_offset);
+	void compute_geometry_hash();
 	void compute_bvh(SceneParams *params, Progress *progress, int n, int total);
 
 	bool need_attribute(Scene *scene, AttributeStandard std);
@@ -134,6 +136,11 @@ public:
 class MeshManager {
 public:
 	BVH *bvh;
+	vector<bool> bvh_transform_applied;
+
+	/* meshes used by objects in the last full device update */
+	vector<Mesh*> device_object_meshes;
+	size_t device_num_meshes;
 
 	bool need_update;
 
@@ -150,8 +157,14 @@ public:
 	void device_update_object(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_mesh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_attributes(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
-	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress,
+		const vector<bool>& refit_objects);
 	void device_free(Device *device, DeviceScene *dscene);
+	void device_free_bvh(Device *device, DeviceScene *dscene);
+
+	bool need_bvh_rebuild(Scene *scene, vector<bool>& refit_objects);
+	bool is_transform_only_update(Scene *scene);
+	void compute_object_bounds(Device *device, Scene *scene);
 
 	void tag_update(Scene *scene);
 };
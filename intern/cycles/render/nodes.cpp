@@ -150,6 +150,9 @@ ImageTextureNode::ImageTextureNode()
 	animated = false;
 
 	add_input("Vector", SHADER_SOCKET_POINT, ShaderInput::TEXTURE_UV);
+	/* only connected when images are read on demand */
+	add_input("VectorDX", SHADER_SOCKET_POINT, ShaderInput::NONE, ShaderInput::USE_SVM);
+	add_input("VectorDY", SHADER_SOCKET_POINT, ShaderInput::NONE, ShaderInput::USE_SVM);
 	add_output("Color", SHADER_SOCKET_COLOR);
 	add_output("Alpha", SHADER_SOCKET_FLOAT);
 }
@@ -200,13 +203,43 @@ void ImageTextureNode::compile(SVMCompiler& compiler)
 		}
 
 		if(projection == "Flat") {
+			ShaderInput *vector_dx_in = input("VectorDX");
+			ShaderInput *vector_dy_in = input("VectorDY");
+			int vector_dx_offset = SVM_STACK_INVALID;
+			int vector_dy_offset = SVM_STACK_INVALID;
+
+			if(vector_dx_in->link && vector_dy_in->link) {
+				compiler.stack_assign(vector_dx_in);
+				compiler.stack_assign(vector_dy_in);
+
+				vector_dx_offset = vector_dx_in->stack_offset;
+				vector_dy_offset = vector_dy_in->stack_offset;
+
+				/* shifted coordinates must use the same texture mapping */
+				if(!tex_mapping.skip()) {
+					vector_dx_offset = compiler.stack_find_offset(SHADER_SOCKET_VECTOR);
+					vector_dy_offset = compiler.stack_find_offset(SHADER_SOCKET_VECTOR);
+					tex_mapping.compile(compiler, vector_dx_in->stack_offset, vector_dx_offset);
+					tex_mapping.compile(compiler, vector_dy_in->stack_offset, vector_dy_offset);
+				}
+			}
+
 			compiler.add_node(NODE_TEX_IMAGE,
 				slot,
 				compiler.encode_uchar4(
 					vector_offset,
 					color_out->stack_offset,
 					alpha_out->stack_offset,
-					srgb));
+					srgb),
+				compiler.encode_uchar4(
+					vector_dx_offset,
+					vector_dy_offset,
+					0, 0));
+
+			if(vector_dx_offset != SVM_STACK_INVALID && vector_dx_offset != vector_dx_in->stack_offset) {
+				compiler.stack_clear_offset(vector_dx_in->type, vector_dx_offset);
+				compiler.stack_clear_offset(vector_dy_in->type, vector_dy_offset);
+			}
 		}
 		else {
 			compiler.add_node(NODE_TEX_IMAGE_BOX,
@@ -63,8 +63,12 @@ Scene::Scene(const SceneParams& params_, const DeviceInfo& device_info_)
 	else
 		shader_manager = ShaderManager::create(this, SceneParams::SVM);
 
-	if (device_info_.type == DEVICE_CPU)
+	if (device_info_.type == DEVICE_CPU) {
 		image_manager->set_extended_image_limits();
+
+		/* reading images on demand is only supported by the CPU device */
+		image_manager->set_texture_cache(params.use_texture_cache, params.texture_cache_size);
+	}
 }
 
 Scene::~Scene()
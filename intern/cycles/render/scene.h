@@ -90,6 +90,8 @@ public:
 	device_vector<float4> light_data;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
+	device_vector<float4> light_tree_nodes;
+	device_vector<uint> light_tree_prims;
 
 	/* particles */
 	device_vector<float4> particles;
@@ -123,30 +125,39 @@ public:
 	enum { OSL, SVM } shadingsystem;
 	enum BVHType { BVH_DYNAMIC, BVH_STATIC } bvh_type;
 	bool use_bvh_cache;
+	int bvh_cache_size;
 	bool use_bvh_spatial_split;
 	bool use_qbvh;
 	bool persistent_data;
+	bool use_texture_cache;
+	int texture_cache_size;
 
 	SceneParams()
 	{
 		shadingsystem = SVM;
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_cache = false;
+		bvh_cache_size = 2048;
 		use_bvh_spatial_split = false;
 #ifdef __QBVH__
 		use_qbvh = true;
 #else
 		use_qbvh = false;
 #endif
+		use_texture_cache = false;
+		texture_cache_size = 1024;
 	}
 
 	bool modified(const SceneParams& params)
 	{ return !(shadingsystem == params.shadingsystem
 		&& bvh_type == params.bvh_type
 		&& use_bvh_cache == params.use_bvh_cache
+		&& bvh_cache_size == params.bvh_cache_size
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_qbvh == params.use_qbvh
-		&& persistent_data == params.persistent_data); }
+		&& persistent_data == params.persistent_data
+		&& use_texture_cache == params.use_texture_cache
+		&& texture_cache_size == params.texture_cache_size); }
 };
 
 /* Scene */
@@ -52,6 +52,12 @@ Session::Session(const SessionParams& params_)
 
 	device = Device::create(params.device, stats, params.background);
 
+	/* CPU threads each pull tiles, other devices render one tile at a time */
+	if(params.device.type == DEVICE_CPU)
+		tile_manager.set_num_workers(TaskScheduler::num_threads());
+	else
+		tile_manager.set_num_workers(max(params.device.multi_devices.size(), 1));
+
 	if(params.background) {
 		buffers = NULL;
 		display = NULL;
@@ -264,6 +270,8 @@ void Session::run_gpu()
 
 			device->task_wait();
 
+			update_idle_time();
+
 			if(device->error_message() != "")
 				progress.set_cancel(device->error_message());
 
@@ -352,8 +360,10 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	Tile tile;
 	int device_num = device->device_number(tile_device);
 
-	if(!tile_manager.next_tile(tile, device_num))
+	if(!tile_manager.next_tile(tile, device_num)) {
+		worker_done_time.push_back(time_dt());
 		return false;
+	}
 	
 	/* fill render tile */
 	rtile.x = tile_manager.state.buffer.full_x + tile.x;
@@ -448,6 +458,16 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
+	if(params.adaptive_sampling && !progress.get_cancel()) {
+		int end_sample = rtile.start_sample + rtile.num_samples;
+
+		/* samples of a tile that converged early still count towards progress */
+		if(rtile.sample < end_sample)
+			progress.increment_sample(end_sample - rtile.sample);
+
+		progress.add_pixel_samples((uint64_t)rtile.w*rtile.h*rtile.num_samples, rtile.skipped_samples);
+	}
+
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
 			/* todo: optimize this by making it thread safe and removing lock */
@@ -558,6 +578,9 @@ void Session::run_cpu()
 
 		device->task_wait();
 
+		if(!no_tiles)
+			update_idle_time();
+
 		{
 			thread_scoped_lock reset_lock(delayed_reset.mutex);
 			thread_scoped_lock buffers_lock(buffers_mutex);
@@ -791,6 +814,14 @@ void Session::update_status_time(bool show_pause, bool show_done)
 	else
 		substatus = string_printf("Path Tracing Sample %d/%d", sample+1, tile_manager.num_samples);
 	
+	if(params.adaptive_sampling) {
+		uint64_t pixel_samples, skipped_pixel_samples;
+		progress.get_pixel_samples(pixel_samples, skipped_pixel_samples);
+
+		if(pixel_samples > 0)
+			substatus += string_printf(", Adaptive saved %.1f%%", 100.0*skipped_pixel_samples/pixel_samples);
+	}
+
 	if(show_pause)
 		status = "Paused";
 	else if(show_done)
@@ -817,6 +848,19 @@ void Session::update_progress_sample()
 	progress.increment_sample();
 }
 
+void Session::update_idle_time()
+{
+	/* called after all workers finished, the time between a worker running
+	 * out of tiles and the last worker finishing was spent idle */
+	thread_scoped_lock tile_lock(tile_mutex);
+	double end_time = time_dt();
+
+	for(int i = 0; i < worker_done_time.size(); i++)
+		progress.add_worker_idle_time(i, end_time - worker_done_time[i]);
+
+	worker_done_time.clear();
+}
+
 void Session::path_trace()
 {
 	/* add path trace task */
@@ -828,6 +872,7 @@ void Session::path_trace()
 	task.update_tile_sample = function_bind(&Session::update_tile_sample, this, _1);
 	task.update_progress_sample = function_bind(&Session::update_progress_sample, this);
 	task.need_finish_queue = params.progressive_refine;
+	task.use_ray_packets = params.use_ray_packets;
 
 	device->task_add(task);
 }
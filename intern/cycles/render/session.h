@@ -54,6 +54,8 @@ public:
 	int tile_order;
 	int start_resolution;
 	int threads;
+	bool use_ray_packets;
+	bool adaptive_sampling;
 
 	double cancel_timeout;
 	double reset_timeout;
@@ -73,6 +75,8 @@ public:
 		tile_size = make_int2(64, 64);
 		start_resolution = INT_MAX;
 		threads = 0;
+		use_ray_packets = false;
+		adaptive_sampling = false;
 
 		cancel_timeout = 0.1;
 		reset_timeout = 0.1;
@@ -93,6 +97,8 @@ public:
 		&& tile_size == params.tile_size
 		&& start_resolution == params.start_resolution
 		&& threads == params.threads
+		&& use_ray_packets == params.use_ray_packets
+		&& adaptive_sampling == params.adaptive_sampling
 		&& cancel_timeout == params.cancel_timeout
 		&& reset_timeout == params.reset_timeout
 		&& text_timeout == params.text_timeout
@@ -162,6 +168,7 @@ protected:
 	void release_tile(RenderTile& tile);
 
 	void update_progress_sample();
+	void update_idle_time();
 
 	bool device_use_gl;
 
@@ -192,6 +199,9 @@ protected:
 	bool update_progressive_refine(bool cancel);
 
 	vector<RenderBuffers *> tile_buffers;
+
+	/* times at which render workers ran out of tiles in the current task */
+	vector<double> worker_done_time;
 };
 
 CCL_NAMESPACE_END
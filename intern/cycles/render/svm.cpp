@@ -662,9 +662,11 @@ void SVMCompiler::compile(Shader *shader, vector<int4>& global_svm_nodes, int in
 			shader->graph_bump = shader->graph->copy();
 
 	/* finalize */
-	shader->graph->finalize(false, false, use_multi_closure);
+	bool use_texture_derivatives = image_manager->get_use_texture_cache();
+
+	shader->graph->finalize(false, false, use_multi_closure, use_texture_derivatives);
 	if(shader->graph_bump)
-		shader->graph_bump->finalize(true, false, use_multi_closure);
+		shader->graph_bump->finalize(true, false, use_multi_closure, use_texture_derivatives);
 
 	current_shader = shader;
 
@@ -23,6 +23,9 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* tiles are not split into parts smaller than this */
+#define TILE_MIN_SPLIT_SIZE 16
+
 TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, int start_resolution_,
                          bool preserve_tile_device_, bool background_, int tile_order_, int num_devices_)
 {
@@ -33,6 +36,7 @@ TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, i
 	num_devices = num_devices_;
 	preserve_tile_device = preserve_tile_device_;
 	background = background_;
+	num_workers = 1;
 
 	BufferParams buffer_params;
 	reset(buffer_params, 0);
@@ -64,9 +68,12 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	state.sample = -1;
 	state.num_tiles = 0;
 	state.num_rendered_tiles = 0;
+	state.num_split_tiles = 0;
+	state.num_stolen_tiles = 0;
 	state.num_samples = 0;
 	state.resolution_divider = divider;
 	state.tiles.clear();
+	state.tile_device.clear();
 }
 
 void TileManager::set_samples(int num_samples_)
@@ -93,6 +100,8 @@ void TileManager::gen_tiles_global()
 	int tiles_per_device = (tile_w * tile_h + num - 1) / num;
 	int cur_device = 0, cur_tiles = 0;
 
+	state.tile_device.resize(tile_w * tile_h, -1);
+
 	for(int tile_y = 0; tile_y < tile_h; tile_y++) {
 		for(int tile_x = 0; tile_x < tile_w; tile_x++, tile_index++) {
 			int x = tile_x * tile_size.x;
@@ -100,7 +109,10 @@ void TileManager::gen_tiles_global()
 			int w = (tile_x == tile_w-1)? image_w - x: tile_size.x;
 			int h = (tile_y == tile_h-1)? image_h - y: tile_size.y;
 
-			state.tiles.push_back(Tile(tile_index, x, y, w, h, cur_device));
+			/* tiles that were already rendered stay on their device */
+			int device = (state.tile_device[tile_index] != -1)? state.tile_device[tile_index]: cur_device;
+
+			state.tiles.push_back(Tile(tile_index, x, y, w, h, device));
 			cur_tiles++;
 
 			if(cur_tiles == tiles_per_device) {
@@ -180,6 +192,42 @@ list<Tile>::iterator TileManager::next_viewport_tile(int device)
 	return state.tiles.end();
 }
 
+int64_t TileManager::tile_order_distance(const Tile& tile, int tile_order)
+{
+	int resolution = state.resolution_divider;
+
+	int64_t cordx = max(1, params.width/resolution);
+	int64_t cordy = max(1, params.height/resolution);
+
+	int64_t centx = cordx / 2, centy = cordy / 2;
+	int64_t distx = cordx;
+	int64_t disty = cordy;
+
+	switch (tile_order) {
+		case TileManager::CENTER:
+			distx = centx - (tile.x + tile.w);
+			disty = centy - (tile.y + tile.h);
+			distx = (int64_t) sqrt((double)distx * distx + disty * disty);
+			break;
+		case TileManager::RIGHT_TO_LEFT:
+			distx = cordx - tile.x;
+			break;
+		case TileManager::LEFT_TO_RIGHT:
+			distx = cordx + tile.x;
+			break;
+		case TileManager::TOP_TO_BOTTOM:
+			distx = cordx - tile.y;
+			break;
+		case TileManager::BOTTOM_TO_TOP:
+			distx = cordx + tile.y;
+			break;
+		default:
+			break;
+	}
+
+	return distx;
+}
+
 list<Tile>::iterator TileManager::next_background_tile(int device, int tile_order)
 {
 	list<Tile>::iterator iter, best = state.tiles.end();
@@ -190,37 +238,10 @@ list<Tile>::iterator TileManager::next_background_tile(int device, int tile_orde
 	int64_t cordx = max(1, params.width/resolution);
 	int64_t cordy = max(1, params.height/resolution);
 	int64_t mindist = cordx * cordy;
-	
-	int64_t centx = cordx / 2, centy = cordy / 2;
 
 	for(iter = state.tiles.begin(); iter != state.tiles.end(); iter++) {
 		if(iter->device == logical_device && iter->rendering == false) {
-			Tile &cur_tile = *iter;
-			
-			int64_t distx = cordx;
-			int64_t disty = cordy;
-			
-			switch (tile_order) {
-				case TileManager::CENTER:
-					distx = centx - (cur_tile.x + cur_tile.w);
-					disty = centy - (cur_tile.y + cur_tile.h);
-					distx = (int64_t) sqrt((double)distx * distx + disty * disty);
-					break;
-				case TileManager::RIGHT_TO_LEFT:
-					distx = cordx - cur_tile.x;
-					break;
-				case TileManager::LEFT_TO_RIGHT:
-					distx = cordx + cur_tile.x;	
-					break;
-				case TileManager::TOP_TO_BOTTOM:
-					distx = cordx - cur_tile.y;
-					break;
-				case TileManager::BOTTOM_TO_TOP:
-					distx = cordx + cur_tile.y;
-					break; 
-				default:
-					break;
-			}
+			int64_t distx = tile_order_distance(*iter, tile_order);
 
 			if(distx < mindist) {
 				best = iter;
@@ -232,12 +253,117 @@ list<Tile>::iterator TileManager::next_background_tile(int device, int tile_orde
 	return best;
 }
 
+list<Tile>::iterator TileManager::steal_background_tile(int device, int tile_order)
+{
+	/* without preserving devices all tiles are shared already */
+	if(!preserve_tile_device || num_devices == 1)
+		return state.tiles.end();
+
+	/* count remaining tiles per device, only tiles that were never rendered
+	 * can move, others have their buffers on the device */
+	vector<int> num_remaining(num_devices, 0);
+	list<Tile>::iterator iter, best = state.tiles.end();
+
+	for(iter = state.tiles.begin(); iter != state.tiles.end(); iter++)
+		if(iter->rendering == false && state.tile_device[iter->index] == -1)
+			num_remaining[iter->device]++;
+
+	int victim = 0;
+
+	for(int i = 1; i < num_devices; i++)
+		if(num_remaining[i] > num_remaining[victim])
+			victim = i;
+
+	if(victim == device || num_remaining[victim] == 0)
+		return state.tiles.end();
+
+	/* take the tile the other device would render last */
+	int64_t maxdist = -1;
+
+	for(iter = state.tiles.begin(); iter != state.tiles.end(); iter++) {
+		if(iter->device == victim && iter->rendering == false && state.tile_device[iter->index] == -1) {
+			int64_t distx = tile_order_distance(*iter, tile_order);
+
+			if(distx >= maxdist) {
+				best = iter;
+				maxdist = distx;
+			}
+		}
+	}
+
+	if(best != state.tiles.end()) {
+		best->device = device;
+		state.num_stolen_tiles++;
+	}
+
+	return best;
+}
+
+void TileManager::split_tail_tiles()
+{
+	/* split tiles are new tiles with their own index, which is only possible
+	 * when tiles don't keep their buffers over samples */
+	if(preserve_tile_device)
+		return;
+
+	int num_free = 0;
+
+	for(list<Tile>::iterator iter = state.tiles.begin(); iter != state.tiles.end(); iter++)
+		if(iter->rendering == false)
+			num_free++;
+
+	/* only split in the tail, when some workers would otherwise go idle */
+	while(num_free > 0 && num_free < num_workers) {
+		list<Tile>::iterator iter, largest = state.tiles.end();
+
+		for(iter = state.tiles.begin(); iter != state.tiles.end(); iter++) {
+			if(iter->rendering == false) {
+				if(largest == state.tiles.end() || iter->w*iter->h > largest->w*largest->h)
+					largest = iter;
+			}
+		}
+
+		Tile& tile = *largest;
+		Tile half = tile;
+
+		/* split along the longest axis */
+		if(tile.w >= tile.h) {
+			if(tile.w < 2*TILE_MIN_SPLIT_SIZE)
+				break;
+
+			tile.w /= 2;
+			half.x += tile.w;
+			half.w -= tile.w;
+		}
+		else {
+			if(tile.h < 2*TILE_MIN_SPLIT_SIZE)
+				break;
+
+			tile.h /= 2;
+			half.y += tile.h;
+			half.h -= tile.h;
+		}
+
+		half.index = state.num_tiles++;
+
+		state.tiles.push_back(half);
+		state.num_split_tiles++;
+		num_free++;
+	}
+}
+
 bool TileManager::next_tile(Tile& tile, int device)
 {
 	list<Tile>::iterator tile_it;
 	
-	if (background)
+	if (background) {
+		split_tail_tiles();
+
 		tile_it = next_background_tile(device, tile_order);
+
+		if(tile_it == state.tiles.end())
+			tile_it = steal_background_tile(device, tile_order);
+	}
 	else
 		tile_it = next_viewport_tile(device);
 
@@ -246,6 +372,9 @@ bool TileManager::next_tile(Tile& tile, int device)
 		tile = *tile_it;
 		state.num_rendered_tiles++;
 
+		if(background && preserve_tile_device)
+			state.tile_device[tile.index] = tile.device;
+
 		return true;
 	}
 
@@ -23,6 +23,7 @@
 
 #include "buffers.h"
 #include "util_list.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -55,7 +56,12 @@ public:
 		int resolution_divider;
 		int num_tiles;
 		int num_rendered_tiles;
+		int num_split_tiles;
+		int num_stolen_tiles;
 		list<Tile> tiles;
+		/* device that first rendered each tile, kept over samples so tiles
+		 * stolen by another device stay with it */
+		vector<int> tile_device;
 	} state;
 
 	int num_samples;
@@ -71,6 +77,7 @@ public:
 	bool done();
 
 	void set_tile_order(int tile_order_) { tile_order = tile_order_; }
+	void set_num_workers(int num_workers_) { num_workers = max(num_workers_, 1); }
 protected:
 	/* Note: this should match enum_tile_order in properties.py */
 	enum {
@@ -89,6 +96,10 @@ protected:
 	int start_resolution;
 	int num_devices;
 
+	/* number of threads or devices pulling tiles, used to decide when to
+	 * split the remaining tiles at the end of the frame */
+	int num_workers;
+
 	/* in some cases it is important that the same tile will be returned for the same
 	 * device it was originally generated for (i.e. viewport rendering when buffer is
 	 * allocating once for tile and then always used by it)
@@ -114,9 +125,20 @@ protected:
 	/* slices image into as much pieces as how many devices are rendering this image */
 	void gen_tiles_sliced();
 
+	/* distance used to sort tiles in tile_order, lower is rendered first */
+	int64_t tile_order_distance(const Tile& tile, int tile_order);
+
 	/* returns tiles for background render */
 	list<Tile>::iterator next_background_tile(int device, int tile_order);
 
+	/* takes a tile not yet rendered from the device with most remaining
+	 * tiles, for devices that ran out of their own tiles */
+	list<Tile>::iterator steal_background_tile(int device, int tile_order);
+
+	/* splits remaining tiles when there are fewer of them than workers, so
+	 * workers don't idle waiting for the last big tiles */
+	void split_tail_tiles();
+
 	/* returns first unhandled tile for viewport render */
 	list<Tile>::iterator next_viewport_tile(int device);
 };
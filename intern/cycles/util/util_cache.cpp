@@ -17,12 +17,25 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "util_algorithm.h"
 #include "util_cache.h"
 #include "util_debug.h"
 #include "util_foreach.h"
+#include "util_hash.h"
 #include "util_map.h"
-#include "util_md5.h"
 #include "util_path.h"
 #include "util_types.h"
 
@@ -37,41 +50,175 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* File Layout
+ *
+ * Header, followed by a table with the size of each buffer, followed by the
+ * buffers themselves, each starting at a multiple of CACHE_ALIGN bytes. */
+
+struct CacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t num_buffers;
+	uint64_t file_size;
+};
+
+static const char cache_magic[8] = {'C', 'Y', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+static size_t cache_align(size_t offset)
+{
+	return (offset + CACHE_ALIGN - 1) & ~((size_t)CACHE_ALIGN - 1);
+}
+
 /* CacheData */
 
 CacheData::CacheData(const string& name_)
 {
 	name = name_;
-	f = NULL;
 	have_filename = false;
+	map_data = NULL;
+	map_size = 0;
+	read_index = 0;
 }
 
 CacheData::~CacheData()
 {
-	if(f)
-		fclose(f);
+	unmap();
 }
 
 const string& CacheData::get_filename()
 {
 	if(!have_filename) {
-		MD5Hash hash;
+		uint64_t hash = CACHE_VERSION;
 
 		foreach(const CacheBuffer& buffer, buffers)
-			if(buffer.size)
-				hash.append((uint8_t*)buffer.data, buffer.size);
+			hash = hash_buffer(buffer.data, buffer.size, hash);
 		
-		filename = name + "_" + hash.get_hex();
+		filename = name + "_" + string_printf("%016llx", (unsigned long long)hash);
 		have_filename = true;
 	}
 
 	return filename;
 }
 
+bool CacheData::map(const string& filename)
+{
+	unmap();
+
+#ifndef _WIN32
+	int fd = open(filename.c_str(), O_RDONLY);
+
+	if(fd == -1)
+		return false;
+
+	struct stat st;
+
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+		close(fd);
+		return false;
+	}
+
+	/* private mapping, so that data can be modified in place, for example to
+	 * refit nodes, with pages copied on write and the file left untouched */
+	void *data = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(data == MAP_FAILED)
+		return false;
+
+	map_data = data;
+	map_size = st.st_size;
+#else
+	vector<uint8_t> binary;
+
+	if(!path_read_binary(filename, binary) || binary.size() < sizeof(CacheHeader))
+		return false;
+
+	map_data = new uint8_t[binary.size()];
+	map_size = binary.size();
+	memcpy(map_data, &binary[0], map_size);
+#endif
+
+	/* validate header and buffer table */
+	const CacheHeader *header = (const CacheHeader*)map_data;
+	size_t offset = sizeof(CacheHeader) + sizeof(uint64_t)*header->num_buffers;
+
+	if(memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0 ||
+	   header->version != CACHE_VERSION ||
+	   header->file_size != map_size ||
+	   offset > map_size)
+	{
+		unmap();
+		return false;
+	}
+
+	const uint64_t *sizes = (const uint64_t*)((const uint8_t*)map_data + sizeof(CacheHeader));
+	buffers.clear();
+
+	for(uint32_t i = 0; i < header->num_buffers; i++) {
+		offset = cache_align(offset);
+
+		if(offset + sizes[i] > map_size) {
+			unmap();
+			return false;
+		}
+
+		buffers.push_back(CacheBuffer((uint8_t*)map_data + offset, sizes[i]));
+		offset += sizes[i];
+	}
+
+	read_index = 0;
+
+	return true;
+}
+
+void CacheData::unmap()
+{
+	if(map_data) {
+#ifndef _WIN32
+		munmap(map_data, map_size);
+#else
+		delete [] (uint8_t*)map_data;
+#endif
+		map_data = NULL;
+		map_size = 0;
+		buffers.clear();
+	}
+}
+
+const CacheBuffer *CacheData::read_buffer(size_t size)
+{
+	if(read_index >= buffers.size()) {
+		fprintf(stderr, "Failed to read buffer %lu from cache.\n", (unsigned long)read_index);
+		return NULL;
+	}
+
+	const CacheBuffer *buffer = &buffers[read_index++];
+
+	if(size && buffer->size != size) {
+		fprintf(stderr, "Unexpected buffer size in cache (%lu).\n", (unsigned long)buffer->size);
+		return NULL;
+	}
+
+	return (buffer->size)? buffer: NULL;
+}
+
+void CacheData::read_value(void *data, size_t size)
+{
+	const CacheBuffer *buffer = read_buffer(size);
+
+	if(buffer)
+		memcpy(data, buffer->data, size);
+}
+
 /* Cache */
 
 Cache Cache::global;
 
+Cache::Cache()
+{
+	size_limit = CACHE_DEFAULT_SIZE;
+}
+
 string Cache::data_filename(CacheData& key)
 {
 	return path_user_get(path_join("cache", key.get_filename()));
@@ -81,58 +228,175 @@ void Cache::insert(CacheData& key, CacheData& value)
 {
 	string filename = data_filename(key);
 	path_create_directories(filename);
-	FILE *f = fopen(filename.c_str(), "wb");
+
+	/* write to a temporary file first, so that other threads or processes
+	 * never map a partially written file. the address of the value is only
+	 * unique within this process, so the process id is part of the name */
+	string tmp_filename = string_printf("%s.%d.%p.tmp", filename.c_str(), (int)getpid(), (void*)&value);
+	FILE *f = fopen(tmp_filename.c_str(), "wb");
 
 	if(!f) {
-		fprintf(stderr, "Failed to open file %s for writing.\n", filename.c_str());
+		fprintf(stderr, "Failed to open file %s for writing.\n", tmp_filename.c_str());
 		return;
 	}
 
+	/* header and buffer table */
+	CacheHeader header;
+	size_t offset = sizeof(CacheHeader) + sizeof(uint64_t)*value.buffers.size();
+	vector<uint64_t> sizes;
+
 	foreach(CacheBuffer& buffer, value.buffers) {
-		if(!fwrite(&buffer.size, sizeof(buffer.size), 1, f))
-			fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
-		if(buffer.size)
-			if(!fwrite(buffer.data, buffer.size, 1, f))
-				fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+		offset = cache_align(offset);
+		sizes.push_back(buffer.size);
+		offset += buffer.size;
+	}
+
+	memcpy(header.magic, cache_magic, sizeof(cache_magic));
+	header.version = CACHE_VERSION;
+	header.num_buffers = value.buffers.size();
+	header.file_size = offset;
+
+	bool ok = (fwrite(&header, sizeof(header), 1, f) == 1);
+
+	if(ok && sizes.size())
+		ok = (fwrite(&sizes[0], sizeof(uint64_t)*sizes.size(), 1, f) == 1);
+
+	/* aligned buffers */
+	static const char padding[CACHE_ALIGN] = {0};
+	offset = sizeof(CacheHeader) + sizeof(uint64_t)*value.buffers.size();
+
+	foreach(CacheBuffer& buffer, value.buffers) {
+		size_t aligned = cache_align(offset);
+
+		if(ok && aligned != offset)
+			ok = (fwrite(padding, aligned - offset, 1, f) == 1);
+		if(ok && buffer.size)
+			ok = (fwrite(buffer.data, buffer.size, 1, f) == 1);
+
+		offset = aligned + buffer.size;
 	}
 	
 	fclose(f);
+
+	boost::system::error_code ec;
+
+	if(ok) {
+		boost::filesystem::rename(tmp_filename, filename, ec);
+		ok = !ec;
+	}
+
+	if(!ok) {
+		fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+		boost::filesystem::remove(tmp_filename, ec);
+		return;
+	}
+
+	thread_scoped_lock lock(mutex);
+	stats.bytes_written += offset;
 }
 
 bool Cache::lookup(CacheData& key, CacheData& value)
 {
 	string filename = data_filename(key);
-	FILE *f = fopen(filename.c_str(), "rb");
+	bool hit = value.map(filename);
 
-	if(!f)
+	thread_scoped_lock lock(mutex);
+
+	if(!hit) {
+		stats.misses++;
 		return false;
-	
+	}
+
+	stats.hits++;
+	stats.bytes_read += value.map_size;
+	lock.unlock();
+
+	/* mark as recently used for eviction, access times are not reliable as
+	 * file systems are often mounted without updating them */
+	boost::system::error_code ec;
+	boost::filesystem::last_write_time(filename, time(NULL), ec);
+
 	value.name = key.name;
-	value.f = f;
 
 	return true;
 }
 
-void Cache::clear_except(const string& name, const set<string>& except)
+struct CacheFile {
+	time_t time;
+	uintmax_t size;
+	boost::filesystem::path path;
+
+	bool operator<(const CacheFile& other) const
+	{
+		return time < other.time;
+	}
+};
+
+void Cache::evict(const string& name)
 {
 	string dir = path_user_get("cache");
+	if(!boost::filesystem::exists(dir))
+		return;
 
-	if(boost::filesystem::exists(dir)) {
-		boost::filesystem::directory_iterator it(dir), it_end;
+	thread_scoped_lock lock(mutex);
 
-		for(; it != it_end; it++) {
+	/* gather files and their total size */
+	vector<CacheFile> files;
+	uintmax_t total_size = 0;
+
+	boost::system::error_code ec;
+	boost::filesystem::directory_iterator it(dir), it_end;
+
+	for(; it != it_end; it++) {
 #if (BOOST_FILESYSTEM_VERSION == 2)
-			string filename = it->path().filename();
+		string filename = it->path().filename();
 #else
-			string filename = it->path().filename().string();
+		string filename = it->path().filename().string();
 #endif
 
-			if(boost::starts_with(filename, name))
-				if(except.find(filename) == except.end())
-					boost::filesystem::remove(it->path());
+		if(!boost::starts_with(filename, name))
+			continue;
+
+		CacheFile file;
+		file.path = it->path();
+		file.size = boost::filesystem::file_size(file.path, ec);
+		file.time = boost::filesystem::last_write_time(file.path, ec);
+
+		if(ec) {
+			ec.clear();
+			continue;
+		}
+
+		files.push_back(file);
+		total_size += file.size;
+	}
+
+	/* remove least recently used files first. mapped files stay valid until
+	 * they are unmapped, so files in use can be safely removed too */
+	sort(files.begin(), files.end());
+
+	foreach(CacheFile& file, files) {
+		if(total_size <= size_limit)
+			break;
+
+		if(boost::filesystem::remove(file.path, ec)) {
+			total_size -= file.size;
+			stats.evictions++;
 		}
 	}
 }
 
+void Cache::set_size_limit(size_t size)
+{
+	thread_scoped_lock lock(mutex);
+	size_limit = size;
+}
+
+CacheStats Cache::get_stats()
+{
+	thread_scoped_lock lock(mutex);
+	return stats;
+}
+
 CCL_NAMESPACE_END
 
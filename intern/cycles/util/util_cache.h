@@ -22,22 +22,34 @@
 /* Disk Cache based on Hashing
  *
  * To be used to cache expensive computations. The hash key is created from an
- * arbitrary number of bytes, by hashing the bytes using MD5, which then gives
- * the file name containing the data. This data then is read from the file
- * again into the appropriate data structures.
+ * arbitrary number of bytes, by hashing the bytes with a fast 64 bit hash,
+ * which then gives the file name containing the data. Large inputs like mesh
+ * geometry should be hashed once when they change, and only that hash added
+ * to the key, so that lookups stay cheap.
+ *
+ * Files start with a versioned header and a table of buffer sizes, followed by
+ * the buffers aligned to 16 bytes. This way files can be memory mapped, and
+ * arrays read from the cache point directly into the mapped file without any
+ * copying. Files written by other versions are ignored.
  *
  * This way we do not need to accurately track changes, compare dates and
  * invalidate cache entries, at the cost of exta computation. If everything
  * is stored in a global cache, computations can perhaps even be shared between
- * different scenes where it may be hard to detect duplicate work.
+ * different scenes where it may be hard to detect duplicate work. The total
+ * size of the cache is bounded, evicting least recently used files first.
  */
 
 #include "util_set.h"
 #include "util_string.h"
+#include "util_thread.h"
 #include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
+#define CACHE_VERSION		1
+#define CACHE_ALIGN			16
+#define CACHE_DEFAULT_SIZE	((size_t)2 << 30)
+
 class CacheBuffer {
 public:
 	const void *data;
@@ -53,7 +65,6 @@ public:
 	string name;
 	string filename;
 	bool have_filename;
-	FILE *f;
 
 	CacheData(const string& name = "");
 	~CacheData();
@@ -98,54 +109,62 @@ public:
 		buffers.push_back(buffer);
 	}
 
+	/* arrays reference the mapped file, so the cache data must be kept
+	 * alive for as long as they are used */
 	template<typename T> void read(array<T>& data)
 	{
-		size_t size;
-
-		if(!fread(&size, sizeof(size), 1, f)) {
-			fprintf(stderr, "Failed to read vector size from cache.\n");
-			return;
-		}
-
-		if(!size)
-			return;
-
-		data.resize(size/sizeof(T));
+		const CacheBuffer *buffer = read_buffer(0);
 
-		if(!fread(&data[0], size, 1, f)) {
-			fprintf(stderr, "Failed to read vector data from cache (%lu).\n", (unsigned long)size);
-			return;
-		}
+		if(buffer)
+			data.reference((T*)buffer->data, buffer->size/sizeof(T));
+		else
+			data.clear();
 	}
 
 	void read(int& data)
 	{
-		size_t size;
-
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read int size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read int from cache.\n");
+		read_value(&data, sizeof(data));
 	}
 
 	void read(float& data)
 	{
-		size_t size;
-
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read float size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read float from cache.\n");
+		read_value(&data, sizeof(data));
 	}
 
 	void read(size_t& data)
 	{
-		size_t size;
+		read_value(&data, sizeof(data));
+	}
+
+protected:
+	friend class Cache;
+
+	const CacheBuffer *read_buffer(size_t size);
+	void read_value(void *data, size_t size);
+
+	bool map(const string& filename);
+	void unmap();
 
-		if(!fread(&size, sizeof(size), 1, f))
-			fprintf(stderr, "Failed to read size_t size from cache.\n");
-		if(!fread(&data, sizeof(data), 1, f))
-			fprintf(stderr, "Failed to read size_t from cache.\n");
+	void *map_data;
+	size_t map_size;
+	size_t read_index;
+};
+
+class CacheStats {
+public:
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	size_t bytes_read;
+	size_t bytes_written;
+
+	CacheStats()
+	{
+		hits = 0;
+		misses = 0;
+		evictions = 0;
+		bytes_read = 0;
+		bytes_written = 0;
 	}
 };
 
@@ -153,13 +172,24 @@ class Cache {
 public:
 	static Cache global;
 
+	Cache();
+
 	void insert(CacheData& key, CacheData& value);
 	bool lookup(CacheData& key, CacheData& value);
 
-	void clear_except(const string& name, const set<string>& except);
+	/* remove least recently used files with the given name, until the total
+	 * size of those files is within the size limit */
+	void evict(const string& name);
+	void set_size_limit(size_t size);
+
+	CacheStats get_stats();
 
 protected:
 	string data_filename(CacheData& key);
+
+	thread_mutex mutex;
+	CacheStats stats;
+	size_t size_limit;
 };
 
 CCL_NAMESPACE_END
@@ -19,6 +19,8 @@
 #ifndef __UTIL_HASH_H__
 #define __UTIL_HASH_H__
 
+#include <string.h>
+
 #include "util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -61,6 +63,48 @@ static inline uint hash_string(const char *str)
 	return i;
 }
 
+/* Fast 64 bit hash of a buffer, processing 8 bytes at a time (MurmurHash64A).
+ * Not cryptographically secure, only meant for detecting changed data. Passing
+ * the result of a previous call as seed hashes multiple buffers incrementally. */
+
+static inline uint64_t hash_buffer(const void *data, size_t size, uint64_t seed = 0)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	const unsigned char *p = (const unsigned char*)data;
+	const unsigned char *end = p + (size & ~(size_t)7);
+	uint64_t h = seed ^ ((uint64_t)size * m);
+
+	for(; p != end; p += 8) {
+		uint64_t k;
+		memcpy(&k, p, sizeof(k));
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	size_t tail = size & 7;
+
+	if(tail) {
+		uint64_t k = 0;
+		memcpy(&k, p, tail);
+
+		h ^= k;
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_HASH_H__ */
@@ -29,6 +29,8 @@
 #include "util_string.h"
 #include "util_time.h"
 #include "util_thread.h"
+#include "util_types.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -41,6 +43,10 @@ public:
 		start_time = time_dt();
 		total_time = 0.0f;
 		tile_time = 0.0f;
+		bvh_build_time = 0.0;
+		bvh_refit_time = 0.0;
+		pixel_samples = 0;
+		skipped_pixel_samples = 0;
 		status = "Initializing";
 		substatus = "";
 		sync_status = "";
@@ -65,6 +71,14 @@ public:
 
 		sample = progress.get_sample();
 
+		bvh_build_time = progress.bvh_build_time;
+		bvh_refit_time = progress.bvh_refit_time;
+
+		pixel_samples = progress.pixel_samples;
+		skipped_pixel_samples = progress.skipped_pixel_samples;
+
+		worker_idle_time = progress.worker_idle_time;
+
 		return *this;
 	}
 
@@ -75,6 +89,11 @@ public:
 		start_time = time_dt();
 		total_time = 0.0f;
 		tile_time = 0.0f;
+		bvh_build_time = 0.0;
+		bvh_refit_time = 0.0;
+		pixel_samples = 0;
+		skipped_pixel_samples = 0;
+		worker_idle_time.clear();
 		status = "Initializing";
 		substatus = "";
 		sync_status = "";
@@ -142,13 +161,15 @@ public:
 		thread_scoped_lock lock(progress_mutex);
 
 		sample = 0;
+		pixel_samples = 0;
+		skipped_pixel_samples = 0;
 	}
 
-	void increment_sample()
+	void increment_sample(int num = 1)
 	{
 		thread_scoped_lock lock(progress_mutex);
 
-		sample++;
+		sample += num;
 	}
 
 	int get_sample()
@@ -156,6 +177,69 @@ public:
 		return sample;
 	}
 
+	/* bvh timing, accumulated over all meshes and the scene bvh */
+
+	void add_bvh_build_time(double time)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		bvh_build_time += time;
+	}
+
+	void add_bvh_refit_time(double time)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		bvh_refit_time += time;
+	}
+
+	void get_bvh_time(double& build_time, double& refit_time)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		build_time = bvh_build_time;
+		refit_time = bvh_refit_time;
+	}
+
+	/* adaptive sampling, pixel samples of finished tiles and how many of
+	 * those were skipped because the pixels converged early */
+
+	void add_pixel_samples(uint64_t num_samples, uint64_t num_skipped)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		pixel_samples += num_samples;
+		skipped_pixel_samples += num_skipped;
+	}
+
+	void get_pixel_samples(uint64_t& num_samples, uint64_t& num_skipped)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		num_samples = pixel_samples;
+		num_skipped = skipped_pixel_samples;
+	}
+
+	/* time render workers spent waiting for other workers to finish their
+	 * tiles, indexed by the order in which they ran out of tiles */
+
+	void add_worker_idle_time(int worker, double time)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		if(worker >= worker_idle_time.size())
+			worker_idle_time.resize(worker + 1, 0.0);
+
+		worker_idle_time[worker] += time;
+	}
+
+	void get_worker_idle_time(vector<double>& idle_time)
+	{
+		thread_scoped_lock lock(progress_mutex);
+
+		idle_time = worker_idle_time;
+	}
+
 	/* status messages */
 
 	void set_status(const string& status_, const string& substatus_ = "")
@@ -247,6 +331,14 @@ protected:
 	double total_time;
 	double tile_time;
 
+	double bvh_build_time;
+	double bvh_refit_time;
+
+	uint64_t pixel_samples;
+	uint64_t skipped_pixel_samples;
+
+	vector<double> worker_idle_time;
+
 	string status;
 	string substatus;
 
@@ -60,23 +60,46 @@ int system_cpu_thread_count()
 }
 
 #if !defined(_WIN32) || defined(FREE_WINDOWS)
-static void __cpuid(int data[4], int selector)
+static void __cpuidex(int data[4], int selector, int subselector)
 {
 #ifdef __x86_64__
-	asm("cpuid" : "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector));
+	asm("cpuid" : "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(subselector));
 #else
 #ifdef __i386__
 	asm("pushl %%ebx    \n\t"
 		"cpuid          \n\t"
 		"movl %%ebx, %1 \n\t"
-		"popl %%ebx     \n\t" : "=a" (data[0]), "=r" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector));
+		"popl %%ebx     \n\t" : "=a" (data[0]), "=r" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(subselector));
 #else
 	data[0] = data[1] = data[2] = data[3] = 0;
 #endif
 #endif
 }
+
+static void __cpuid(int data[4], int selector)
+{
+	__cpuidex(data, selector, 0);
+}
 #endif
 
+/* register state the OS saves on context switches, needed for AVX */
+static uint64_t system_xgetbv()
+{
+#if defined(_WIN32) && !defined(FREE_WINDOWS)
+#if defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219)
+	return _xgetbv(0);
+#else
+	return 0;
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+	uint32_t eax, edx;
+	asm(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t)edx << 32) | eax;
+#else
+	return 0;
+#endif
+}
+
 static void replace_string(string& haystack, const string& needle, const string& other)
 {
 	size_t i;
@@ -131,6 +154,7 @@ struct CPUCapabilities {
 	bool sse42;
 	bool sse4a;
 	bool avx;
+	bool avx2;
 	bool xop;
 	bool fma3;
 	bool fma4;
@@ -165,8 +189,20 @@ static CPUCapabilities& system_cpu_capabilities()
 			caps.sse41 = (result[2] & ((int)1 << 19)) != 0;
 			caps.sse42 = (result[2] & ((int)1 << 20)) != 0;
 
-			caps.avx = (result[2] & ((int)1 << 28)) != 0;
 			caps.fma3 = (result[2] & ((int)1 << 12)) != 0;
+
+			/* AVX also needs the OS to save the YMM registers */
+			bool os_avx = false;
+
+			if((result[2] & ((int)1 << 27)) != 0)
+				os_avx = (system_xgetbv() & 6) == 6;
+
+			caps.avx = os_avx && (result[2] & ((int)1 << 28)) != 0;
+		}
+
+		if(num >= 7) {
+			__cpuidex(result, 0x00000007, 0);
+			caps.avx2 = caps.avx && (result[1] & ((int)1 << 5)) != 0;
 		}
 
 #if 0
@@ -197,6 +233,12 @@ bool system_cpu_support_sse3()
 	return caps.sse && caps.sse2 && caps.sse3 && caps.ssse3;
 }
 
+bool system_cpu_support_avx2()
+{
+	CPUCapabilities& caps = system_cpu_capabilities();
+	return caps.sse && caps.sse2 && caps.sse3 && caps.ssse3 && caps.sse41 && caps.avx && caps.avx2 && caps.fma3;
+}
+
 #else
 
 bool system_cpu_support_sse2()
@@ -209,6 +251,11 @@ bool system_cpu_support_sse3()
 	return false;
 }
 
+bool system_cpu_support_avx2()
+{
+	return false;
+}
+
 #endif
 
 CCL_NAMESPACE_END
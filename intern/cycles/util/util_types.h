@@ -106,6 +106,12 @@
 #ifdef __KERNEL_SSSE3__
 #include <tmmintrin.h> /* SSSE 3 */
 #endif
+#ifdef __KERNEL_SSE41__
+#include <smmintrin.h> /* SSE 4.1 */
+#endif
+#ifdef __KERNEL_AVX__
+#include <immintrin.h> /* AVX, AVX2, FMA */
+#endif
 #endif
 
 #ifndef __KERNEL_SSE2__
@@ -43,10 +43,13 @@ public:
 	{
 		data = NULL;
 		datasize = 0;
+		owned = true;
 	}
 
 	array(size_t newsize)
 	{
+		owned = true;
+
 		if(newsize == 0) {
 			data = NULL;
 			datasize = 0;
@@ -59,11 +62,20 @@ public:
 
 	array(const array& from)
 	{
+		data = NULL;
+		datasize = 0;
+		owned = true;
+
 		*this = from;
 	}
 
 	array& operator=(const array& from)
 	{
+		if(this == &from)
+			return *this;
+
+		free_data();
+
 		if(from.datasize == 0) {
 			data = NULL;
 			datasize = 0;
@@ -79,6 +91,8 @@ public:
 
 	array& operator=(const vector<T>& from)
 	{
+		free_data();
+
 		datasize = from.size();
 		data = NULL;
 
@@ -92,7 +106,7 @@ public:
 
 	~array()
 	{
-		delete [] data;
+		free_data();
 	}
 
 	void resize(size_t newsize)
@@ -103,7 +117,7 @@ public:
 		else {
 			T *newdata = new T[newsize];
 			memcpy(newdata, data, ((datasize < newsize)? datasize: newsize)*sizeof(T));
-			delete [] data;
+			free_data();
 
 			data = newdata;
 			datasize = newsize;
@@ -112,11 +126,28 @@ public:
 
 	void clear()
 	{
-		delete [] data;
+		free_data();
 		data = NULL;
 		datasize = 0;
 	}
 
+	/* use memory owned by someone else, e.g. a memory mapped file, without
+	 * copying. the memory must stay valid until the array is cleared, resized
+	 * or assigned, after which it owns a copy again. */
+	void reference(T *ptr, size_t newsize)
+	{
+		free_data();
+
+		data = (newsize)? ptr: NULL;
+		datasize = newsize;
+		owned = (newsize == 0);
+	}
+
+	bool is_reference() const
+	{
+		return !owned;
+	}
+
 	size_t size() const
 	{
 		return datasize;
@@ -128,8 +159,17 @@ public:
 	}
 
 protected:
+	void free_data()
+	{
+		if(owned)
+			delete [] data;
+
+		owned = true;
+	}
+
 	T *data;
 	size_t datasize;
+	bool owned;
 };
 
 CCL_NAMESPACE_END
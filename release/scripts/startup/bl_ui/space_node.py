@@ -378,13 +378,16 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
+        col.prop(tree, "edit_proxy", text="Proxy")
         col.prop(tree, "chunk_size")
+        col.prop(tree, "memory_limit")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
         col.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
+        col.prop(tree, "use_profile")
         col.prop(snode, "show_highlight")
         col.prop(snode, "use_hidden_preview")
 
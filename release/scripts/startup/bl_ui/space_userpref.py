@@ -382,6 +382,8 @@ class USERPREF_PT_system(Panel):
         sub.prop(system, "audio_mixing_buffer", text="Mixing Buffer")
         sub.prop(system, "audio_sample_rate", text="Sample Rate")
         sub.prop(system, "audio_sample_format", text="Sample Format")
+        sub.prop(system, "audio_cache_limit", text="Cache Limit")
+        sub.prop(system, "use_audio_cache_spill")
 
         col.separator()
         col.separator()
@@ -438,6 +440,7 @@ class USERPREF_PT_system(Panel):
         col.label(text="Sequencer / Clip Editor:")
         col.prop(system, "prefetch_frames")
         col.prop(system, "memory_cache_limit")
+        col.prop(system, "use_compositor_cache")
 
         # 3. Column
         column = split.column()
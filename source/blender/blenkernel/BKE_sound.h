@@ -53,6 +53,8 @@ void sound_init(struct Main *main);
 
 void sound_init_main(struct Main *bmain);
 
+void sound_init_cache(void);
+
 void sound_exit(void);
 
 void sound_force_device(int device);
@@ -29,6 +29,7 @@
  *  \ingroup bke
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -204,9 +205,16 @@ void sound_init(struct Main *bmain)
 	if (!AUD_init(device, specs, buffersize))
 		AUD_init(AUD_NULL_DEVICE, specs, buffersize);
 
+	sound_init_cache();
+
 	sound_init_main(bmain);
 }
 
+void sound_init_cache(void)
+{
+	AUD_setBufferCacheLimit(U.audiocachelimit, (U.audiocacheflag & USER_AUDIO_CACHE_SPILL) ? BLI_temporary_dir() : NULL);
+}
+
 void sound_init_main(struct Main *bmain)
 {
 #ifdef WITH_JACK
@@ -223,6 +231,16 @@ void sound_exit(void)
 
 void sound_exit_once(void)
 {
+	if (G.debug & G_DEBUG) {
+		AUD_BufferCacheStatistics statistics;
+
+		AUD_getBufferCacheStatistics(&statistics);
+		printf("Sound cache: %d sounds, %d hits, %d misses, %d evictions, %d spill reads, "
+		       "%.1f MB in memory, %.1f MB spilled\n",
+		       statistics.sounds, statistics.hits, statistics.misses, statistics.evictions, statistics.spill_reads,
+		       statistics.memory / (1024.0 * 1024.0), statistics.spilled / (1024.0 * 1024.0));
+	}
+
 	AUD_exit();
 	AUD_exitOnce();
 }
@@ -291,11 +309,16 @@ void sound_delete(struct Main *bmain, bSound *sound)
 
 void sound_cache(bSound *sound)
 {
+	void *old_cache = sound->cache;
+
 	sound->flags |= SOUND_FLAGS_CACHING;
-	if (sound->cache)
-		AUD_unload(sound->cache);
 
+	/* unload the old cache after buffering, so the decoded sound
+	 * stays in the audio cache and isn't decoded again */
 	sound->cache = AUD_bufferSound(sound->handle);
+	if (old_cache)
+		AUD_unload(old_cache);
+
 	if (sound->cache)
 		sound->playback_handle = sound->cache;
 	else
@@ -321,10 +344,9 @@ void sound_delete_cache(bSound *sound)
 void sound_load(struct Main *bmain, bSound *sound)
 {
 	if (sound) {
-		if (sound->cache) {
-			AUD_unload(sound->cache);
-			sound->cache = NULL;
-		}
+		/* unloaded after buffering again, see sound_cache() */
+		void *old_cache = sound->cache;
+		sound->cache = NULL;
 
 		if (sound->handle) {
 			AUD_unload(sound->handle);
@@ -381,6 +403,9 @@ void sound_load(struct Main *bmain, bSound *sound)
 			sound->cache = AUD_bufferSound(sound->handle);
 		}
 
+		if (old_cache)
+			AUD_unload(old_cache);
+
 		if (sound->cache)
 			sound->playback_handle = sound->cache;
 		else
@@ -577,6 +602,12 @@ void sound_stop_scene(struct Scene *scene)
 
 		if (scene->audio.flag & AUDIO_SYNC)
 			AUD_stopPlayback();
+
+		if (G.debug & G_DEBUG) {
+			int underruns, dropouts;
+			AUD_getUnderruns(&underruns, &dropouts);
+			printf("sound: %d underruns, %d dropouts\n", underruns, dropouts);
+		}
 	}
 }
 
@@ -785,6 +816,7 @@ int sound_define_from_str(const char *UNUSED(str)) { return -1;}
 void sound_force_device(int UNUSED(device)) {}
 void sound_init_once(void) {}
 void sound_init(struct Main *UNUSED(bmain)) {}
+void sound_init_cache(void) {}
 void sound_exit(void) {}
 void sound_exit_once(void) {}
 void sound_cache(struct bSound *UNUSED(sound)) { }
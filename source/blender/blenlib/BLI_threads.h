@@ -101,6 +101,7 @@ void BLI_mutex_free(ThreadMutex *mutex);
 
 void BLI_mutex_lock(ThreadMutex *mutex);
 void BLI_mutex_unlock(ThreadMutex *mutex);
+int BLI_mutex_trylock(ThreadMutex *mutex);
 
 /* Spin Lock */
 
@@ -131,6 +132,17 @@ void BLI_rw_mutex_free(ThreadRWMutex *mutex);
 void BLI_rw_mutex_lock(ThreadRWMutex *mutex, int mode);
 void BLI_rw_mutex_unlock(ThreadRWMutex *mutex);
 
+/* Condition */
+
+typedef pthread_cond_t ThreadCondition;
+#define BLI_CONDITION_INITIALIZER   PTHREAD_COND_INITIALIZER
+
+void BLI_condition_init(ThreadCondition *cond);
+void BLI_condition_wait(ThreadCondition *cond, ThreadMutex *mutex);
+void BLI_condition_notify_one(ThreadCondition *cond);
+void BLI_condition_notify_all(ThreadCondition *cond);
+void BLI_condition_end(ThreadCondition *cond);
+
 /* ThreadedWorker
  *
  * A simple tool for dispatching work to a limited number of threads
@@ -66,6 +66,14 @@ extern "C" {
  * Ranging from low-end machines to very high-end machines.
  * The system should work on high-end machines and on low-end machines.
  *
+ * @section buffercache Buffer cache
+ * The output buffers of complex ExecutionGroup's are kept between executions in the BufferCache,
+ * identified by a digest of the operations, settings and inputs they depend on.
+ * When the buffer of a group is found in the cache its chunks are not scheduled,
+ * and neither are the chunks of the groups it depends on.
+ * The cache uses the memory limit of the movie cache.
+ *
+ * @see BufferCache
  *
  * @page executing Executing
  * @section prepare Prepare execution
@@ -100,9 +108,10 @@ extern "C" {
  *  - [@ref OrderOfChunks.COM_TO_TOP_DOWN]: Start calculation from the bottom to the top of the image
  *  - [@ref OrderOfChunks.COM_TO_RULE_OF_THIRDS]: Experimental order based on 9 hot-spots in the image
  *
- * When the chunk-order is determined, the first few chunks will be checked if they can be scheduled.
- * Chunks can have three states:
- *  - [@ref ChunkExecutionState.COM_ES_NOT_SCHEDULED]: Chunk is not yet scheduled, or dependencies are not met
+ * When the chunk-order is determined, the first few chunks will be requested.
+ * Chunks can have four states:
+ *  - [@ref ChunkExecutionState.COM_ES_NOT_SCHEDULED]: Chunk is not yet requested
+ *  - [@ref ChunkExecutionState.COM_ES_WAITING]: Chunk is requested, but dependencies are not met
  *  - [@ref ChunkExecutionState.COM_ES_SCHEDULED]: All dependencies are met, chunk is scheduled, but not finished
  *  - [@ref ChunkExecutionState.COM_ES_EXECUTED]: Chunk is finished
  *
@@ -113,7 +122,7 @@ extern "C" {
  * @section interest Area of interest
  * An ExecutionGroup can have dependencies to other ExecutionGroup's. Data passing from one ExecutionGroup to another
  * one are stored in 'chunks'.
- * If not all input chunks are available the chunk execution will not be scheduled.
+ * If not all input chunks are available the chunk execution will not be scheduled, it waits for the input chunks.
  * <pre>
  * +-------------------------------------+              +--------------------------------------+
  * | ExecutionGroup A                    |              | ExecutionGroup B                     |
@@ -137,12 +146,15 @@ extern "C" {
  * </pre>
  *
  * In the above example ExecutionGroup B has an outputoperation (ViewerOperation) and is being executed.
- * The first chunk is evaluated [@ref ExecutionGroup.scheduleChunkWhenPossible],
+ * The first chunk is requested [@ref ExecutionGroup.requestChunk],
  * but not all input chunks are available. The relevant ExecutionGroup (that can calculate the missing chunks;
  * ExecutionGroup A) is asked to calculate the area ExecutionGroup B is missing.
- * [@ref ExecutionGroup.scheduleAreaWhenPossible]
- * ExecutionGroup B checks what chunks the area spans, and tries to schedule these chunks.
- * If all input data is available these chunks are scheduled [@ref ExecutionGroup.scheduleChunk]
+ * [@ref ExecutionGroup.requestArea]
+ * ExecutionGroup A checks what chunks the area spans, and requests these chunks.
+ * If all input data is available these chunks are scheduled [@ref WorkScheduler.schedule]
+ * The chunk of ExecutionGroup B waits for them. When the last of them is executed
+ * [@ref ExecutionGroup.finalizeChunkExecution] the chunk of ExecutionGroup B is scheduled as well,
+ * there is no polling of chunk states.
  *
  * <pre>
  *
@@ -155,18 +167,18 @@ extern "C" {
  *            O------------------------------->O                                            |
  *            .                                O                                            |
  *            .                                O-------\                                    |
- *            .                                .       | ExecutionGroup.scheduleChunkWhenPossible
+ *            .                                .       | ExecutionGroup.requestChunk
  *            .                                .  O----/ (*)                                |
  *            .                                .  O                                         |
  *            .                                .  O                                         |
- *            .                                .  O  ExecutionGroup.scheduleAreaWhenPossible|
+ *            .                                .  O  ExecutionGroup.requestArea             |
  *            .                                .  O---------------------------------------->O
- *            .                                .  .                                         O----------\ ExecutionGroup.scheduleChunkWhenPossible
+ *            .                                .  .                                         O----------\ ExecutionGroup.requestChunk
  *            .                                .  .                                         .          | (*)
  *            .                                .  .                                         .  O-------/
  *            .                                .  .                                         .  O
  *            .                                .  .                                         .  O
- *            .                                .  .                                         .  O-------\ ExecutionGroup.scheduleChunk
+ *            .                                .  .                                         .  O-------\ WorkScheduler.schedule
  *            .                                .  .                                         .  .       |
  *            .                                .  .                                         .  .  O----/
  *            .                                .  .                                         .  O<=O
@@ -204,11 +216,11 @@ extern "C" {
  * </pre>
  *
  * @see ExecutionGroup.execute Execute a complete ExecutionGroup. Halts until finished or breaked by user
- * @see ExecutionGroup.scheduleChunkWhenPossible Tries to schedule a single chunk,
+ * @see ExecutionGroup.requestChunk Requests a single chunk,
  * checks if all input data is available. Can trigger dependant chunks to be calculated
- * @see ExecutionGroup.scheduleAreaWhenPossible Tries to schedule an area. This can be multiple chunks
- * (is called from [@ref ExecutionGroup.scheduleChunkWhenPossible])
- * @see ExecutionGroup.scheduleChunk Schedule a chunk on the WorkScheduler
+ * @see ExecutionGroup.requestArea Requests an area. This can be multiple chunks
+ * (is called from [@ref ExecutionGroup.requestChunk])
+ * @see WorkScheduler.schedule Schedule a chunk on the WorkScheduler
  * @see NodeOperation.determineDependingAreaOfInterest Influence the area of interest of a chunk.
  * @see WriteBufferOperation NodeOperation to write to a MemoryProxy/MemoryBuffer
  * @see ReadBufferOperation NodeOperation to read from a MemoryProxy/MemoryBuffer
@@ -222,9 +234,11 @@ extern "C" {
  *
  * @subsection multithread Multi threaded
  * Default the work-scheduler will place all work as WorkPackage in a queue.
- * For every CPUcore a working thread is created. These working threads will ask the WorkScheduler if there is work
- * for a specific Device.
- * the work-scheduler will find work for the device and the device will be asked to execute the WorkPackage
+ * For every CPUcore a working thread is created with its own queue. Work that becomes available by executing a
+ * WorkPackage is added to the queue of the same thread, so it uses the data that was just calculated.
+ * When the queue of a thread is empty, it steals the oldest work of the other threads.
+ * Run with --debug-jobs to print the time the WorkPackages of every ExecutionGroup waited in the queues
+ * and the time they were executed.
  *
  * @subsection singlethread Single threaded
  * For debugging reasons the multi-threading can be disabled. This is done by changing the COM_CURRENT_THREADING_MODEL
@@ -324,8 +338,10 @@ void COM_deinitialize(void);
 /**
  * @brief Clear all compositor caches. (Compositor system will still remain available). 
  * To deinitialize the compositor use the COM_deinitialize method.
+ * Called when the data-blocks the cached buffers were created from are freed (file load, undo).
+ * When the compositor is executing, the caches are cleared by its next execution.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 /**
  * @brief Return a list of highlighted bnodes pointers.
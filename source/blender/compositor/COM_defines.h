@@ -107,6 +107,35 @@ typedef enum OrderOfChunks {
 
 #define COM_NUMBER_OF_CHANNELS 4
 
+/**
+ * @brief maximum number of pixels calculated by a single executeRow call
+ * the size of the input buffers of RowBuffers.
+ * @see SocketReader.executeRow
+ */
+#define COM_ROW_BLOCK_SIZE 256
+
+/**
+ * @brief bpy.app.debug_value to calculate non-complex execution groups pixel by pixel
+ * instead of in rows, to compare both paths
+ * @see WriteBufferOperation.executeRegion
+ */
+#define COM_DEBUG_VALUE_PIXEL_EXECUTION 17
+
+/**
+ * @brief kernel radius in pixels from which the bokeh blurs convolve the whole image with
+ * an FFTConvolution instead of summing the kernel for every pixel.
+ * on a single thread the FFT is faster from a radius of about 14 pixels, but it calculates
+ * the image on one thread while the sum runs on all threads.
+ * @see source/tests/bl_compositor_convolution_benchmark.py
+ */
+#define COM_FFT_CONVOLUTION_MIN_RADIUS 32
+
+/**
+ * @brief bpy.app.debug_value to always sum the kernel for every pixel, to compare with the
+ * FFT convolution
+ */
+#define COM_DEBUG_VALUE_DIRECT_CONVOLUTION 18
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
 #endif
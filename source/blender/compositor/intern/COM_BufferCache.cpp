@@ -0,0 +1,401 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_BufferCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_Node.h"
+#include "COM_NodeOperation.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_md5.h"
+#include "BKE_camera.h"
+#include "BKE_global.h"
+#include "BKE_node.h"
+#include "DNA_camera_types.h"
+#include "DNA_color_types.h"
+#include "DNA_image_types.h"
+#include "DNA_mask_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+}
+
+static struct MovieCache *s_moviecache = NULL;
+
+/* generation of the external data of a node, per node instance key. generations are
+ * unique over the session, so an entry that is pruned and created again can't match
+ * the keys of the buffers cached before */
+typedef struct NodeGeneration {
+	unsigned int generation;
+	unsigned int lastExecution;
+} NodeGeneration;
+
+static map<unsigned int, NodeGeneration> s_nodeGenerations;
+static unsigned int s_generationCounter = 0;
+static unsigned int s_executionCounter = 0;
+
+/* generations of nodes not seen in this many executions are removed */
+#define COM_BUFFERCACHE_GENERATION_LIFETIME 64
+
+static unsigned int buffercache_hashhash(const void *key_v)
+{
+	const BufferCacheKey *key = (const BufferCacheKey *)key_v;
+	unsigned int hash;
+
+	/* the key is a digest already */
+	memcpy(&hash, key->digest, sizeof(hash));
+
+	return hash;
+}
+
+static int buffercache_hashcmp(const void *a_v, const void *b_v)
+{
+	const BufferCacheKey *a = (const BufferCacheKey *)a_v;
+	const BufferCacheKey *b = (const BufferCacheKey *)b_v;
+
+	return memcmp(a->digest, b->digest, sizeof(a->digest));
+}
+
+static void buffercache_append(string &data, const void *value, size_t size)
+{
+	data.append((const char *)value, size);
+}
+
+static NodeGeneration &determineNodeGeneration(unsigned int instanceKey, bool changed)
+{
+	map<unsigned int, NodeGeneration>::iterator found = s_nodeGenerations.find(instanceKey);
+
+	if (found == s_nodeGenerations.end() || changed) {
+		NodeGeneration &generation = s_nodeGenerations[instanceKey];
+		generation.generation = ++s_generationCounter;
+		generation.lastExecution = s_executionCounter;
+		return generation;
+	}
+
+	found->second.lastExecution = s_executionCounter;
+	return found->second;
+}
+
+/* returns true when the mask depends on data that isn't added, points parented to tracks */
+static bool appendMask(string &data, Mask *mask)
+{
+	bool isVolatile = false;
+
+	for (MaskLayer *masklay = (MaskLayer *)mask->masklayers.first; masklay; masklay = masklay->next) {
+		char settings[5] = {masklay->blend, masklay->blend_flag, masklay->falloff, masklay->flag, masklay->restrictflag};
+		buffercache_append(data, &masklay->alpha, sizeof(masklay->alpha));
+		buffercache_append(data, settings, sizeof(settings));
+
+		for (MaskSpline *spline = (MaskSpline *)masklay->splines.first; spline; spline = spline->next) {
+			buffercache_append(data, &spline->flag, sizeof(spline->flag));
+			buffercache_append(data, &spline->offset_mode, sizeof(spline->offset_mode));
+			buffercache_append(data, &spline->weight_interp, sizeof(spline->weight_interp));
+			buffercache_append(data, &spline->tot_point, sizeof(spline->tot_point));
+
+			if (spline->parent.id)
+				isVolatile = true;
+
+			for (int i = 0; i < spline->tot_point; i++) {
+				MaskSplinePoint *point = &spline->points[i];
+				buffercache_append(data, point->bezt.vec, sizeof(point->bezt.vec));
+				buffercache_append(data, &point->bezt.weight, sizeof(point->bezt.weight));
+				buffercache_append(data, &point->tot_uw, sizeof(point->tot_uw));
+				if (point->tot_uw)
+					buffercache_append(data, point->uw, sizeof(*point->uw) * point->tot_uw);
+
+				if (point->parent.id)
+					isVolatile = true;
+			}
+		}
+
+		for (MaskLayerShape *shape = (MaskLayerShape *)masklay->splines_shapes.first; shape; shape = shape->next) {
+			buffercache_append(data, &shape->frame, sizeof(shape->frame));
+			buffercache_append(data, &shape->tot_vert, sizeof(shape->tot_vert));
+			buffercache_append(data, shape->data, sizeof(float) * shape->tot_vert * MASK_OBJECT_SHAPE_ELEM_SIZE);
+		}
+	}
+
+	return isVolatile;
+}
+
+static void appendCamera(string &data, Object *camob)
+{
+	buffercache_append(data, &camob, sizeof(camob));
+
+	if (camob && camob->type == OB_CAMERA) {
+		Camera *camera = (Camera *)camob->data;
+		float settings[4] = {camera->lens, camera->sensor_x, camera->sensor_y,
+		                     BKE_camera_object_dof_distance(camob)};
+		buffercache_append(data, settings, sizeof(settings));
+		buffercache_append(data, &camera->sensor_fit, sizeof(camera->sensor_fit));
+	}
+}
+
+static void appendCurveMapping(string &data, CurveMapping *cumap)
+{
+	buffercache_append(data, &cumap->flag, sizeof(cumap->flag));
+	buffercache_append(data, &cumap->clipr, sizeof(cumap->clipr));
+	buffercache_append(data, cumap->black, sizeof(cumap->black));
+	buffercache_append(data, cumap->white, sizeof(cumap->white));
+
+	for (int i = 0; i < CM_TOT; i++) {
+		CurveMap *cuma = &cumap->cm[i];
+		buffercache_append(data, &cuma->totpoint, sizeof(cuma->totpoint));
+		buffercache_append(data, &cuma->flag, sizeof(cuma->flag));
+		buffercache_append(data, cuma->ext_in, sizeof(cuma->ext_in));
+		buffercache_append(data, cuma->ext_out, sizeof(cuma->ext_out));
+
+		/* the tables are evaluated from the points, the selection doesn't change them */
+		for (int a = 0; a < cuma->totpoint; a++) {
+			CurveMapPoint *cmp = &cuma->curve[a];
+			short vector = cmp->flag & CUMA_VECTOR;
+			buffercache_append(data, &cmp->x, sizeof(cmp->x));
+			buffercache_append(data, &cmp->y, sizeof(cmp->y));
+			buffercache_append(data, &vector, sizeof(vector));
+		}
+	}
+}
+
+/* the settings a node creates its operations from. the compositor runs on a localized copy
+ * of the tree, where the pointers in the storage can point to copies of the data, so the
+ * storage is only added as a whole for types without such pointers */
+static void appendNodeSettings(string &data, bNode *editorNode)
+{
+	buffercache_append(data, &editorNode->type, sizeof(editorNode->type));
+	buffercache_append(data, &editorNode->custom1, sizeof(editorNode->custom1));
+	buffercache_append(data, &editorNode->custom2, sizeof(editorNode->custom2));
+	buffercache_append(data, &editorNode->custom3, sizeof(editorNode->custom3));
+	buffercache_append(data, &editorNode->custom4, sizeof(editorNode->custom4));
+	buffercache_append(data, &editorNode->id, sizeof(editorNode->id));
+
+	if (editorNode->storage) {
+		switch (editorNode->type) {
+			case CMP_NODE_CURVE_VEC:
+			case CMP_NODE_CURVE_RGB:
+			case CMP_NODE_TIME:
+			case CMP_NODE_HUECORRECT:
+				/* copies of the curves and tables */
+				appendCurveMapping(data, (CurveMapping *)editorNode->storage);
+				break;
+			case CMP_NODE_IMAGE:
+			{
+				/* the frame is added with the generation, ok and flag are runtime state */
+				ImageUser *iuser = (ImageUser *)editorNode->storage;
+				int frames[3] = {iuser->frames, iuser->offset, iuser->sfra};
+				short layers[3] = {iuser->multi_index, iuser->layer, iuser->pass};
+				buffercache_append(data, frames, sizeof(frames));
+				buffercache_append(data, &iuser->cycl, sizeof(iuser->cycl));
+				buffercache_append(data, layers, sizeof(layers));
+				break;
+			}
+			case CMP_NODE_MOVIEDISTORTION:
+				/* distortion context of the last execution, the clip is added with the generation */
+				break;
+			default:
+				/* storage is always allocated with guardedalloc */
+				buffercache_append(data, editorNode->storage, MEM_allocN_len(editorNode->storage));
+				break;
+		}
+	}
+
+	for (bNodeSocket *sock = (bNodeSocket *)editorNode->inputs.first; sock; sock = sock->next) {
+		buffercache_append(data, &sock->type, sizeof(sock->type));
+		if (sock->default_value)
+			buffercache_append(data, sock->default_value, MEM_allocN_len(sock->default_value));
+	}
+}
+
+bool BufferCache::isEnabled()
+{
+	return !G.background && !(U.compositor_flag & USER_COMPOSITOR_DISABLE_CACHE);
+}
+
+void BufferCache::startExecution()
+{
+	if (!isEnabled()) {
+		clear();
+		return;
+	}
+
+	s_executionCounter++;
+
+	map<unsigned int, NodeGeneration>::iterator it = s_nodeGenerations.begin();
+	while (it != s_nodeGenerations.end()) {
+		/* nodes that were deleted or belong to a tree that isn't composited anymore */
+		if (s_executionCounter - it->second.lastExecution > COM_BUFFERCACHE_GENERATION_LIFETIME)
+			s_nodeGenerations.erase(it++);
+		else
+			++it;
+	}
+}
+
+void BufferCache::determineNodeKey(CompositorContext *context, Node *node, BufferCacheKey *r_key)
+{
+	bNode *editorNode = node->getbNode();
+	string data;
+
+	/* settings of the context that change the operations that are created */
+	int quality = context->getQuality();
+	float proxyScale = context->getProxyScale();
+	char flags[3] = {context->isRendering(), context->isFastCalculation(), context->getHasActiveOpenCLDevices()};
+	/* the debug value switches between algorithms of some operations */
+	short debugValue = G.debug_value;
+	buffercache_append(data, &quality, sizeof(quality));
+	buffercache_append(data, &proxyScale, sizeof(proxyScale));
+	buffercache_append(data, flags, sizeof(flags));
+	buffercache_append(data, &debugValue, sizeof(debugValue));
+
+	if (editorNode) {
+		appendNodeSettings(data, editorNode);
+
+#ifndef NDEBUG
+		/* the compositor runs on a localized copy of the tree, the settings of the copy
+		 * have to give the same key as the node in the editor or the cache never hits */
+		if (editorNode->original) {
+			string localData, originalData;
+			appendNodeSettings(localData, editorNode);
+			appendNodeSettings(originalData, editorNode->original);
+			if (localData != originalData)
+				printf("Compositor: buffer cache key of node %s changes with localization\n", editorNode->name);
+		}
+#endif
+
+		/* data outside of the node tree can change without changing the node. the editors
+		 * tag the node for execution in that case (image reload or paint, finished render,
+		 * edited movie clip), which makes a new generation of the node. masks and the
+		 * camera of the defocus node are added themselves, their editors don't tag nodes */
+		if (editorNode->id || editorNode->type == CMP_NODE_TIME) {
+			int framenumber = context->getFramenumber();
+			bool isVolatile = false;
+
+			if (editorNode->type == CMP_NODE_MASK && editorNode->id)
+				isVolatile = appendMask(data, (Mask *)editorNode->id);
+			else if (editorNode->type == CMP_NODE_DEFOCUS && editorNode->id)
+				appendCamera(data, ((Scene *)editorNode->id)->camera);
+
+			bool changed = editorNode->need_exec || node->isInChangedGroup() || isVolatile;
+			NodeGeneration &generation = determineNodeGeneration(node->getInstanceKey().value, changed);
+
+			buffercache_append(data, &framenumber, sizeof(framenumber));
+			buffercache_append(data, &generation.generation, sizeof(generation.generation));
+		}
+	}
+
+	md5_buffer(data.data(), data.size(), r_key->digest);
+}
+
+void BufferCache::determineOperationKey(NodeOperation *operation, const BufferCacheKey *nodeKey, int index,
+                                        const vector<const BufferCacheKey *> &inputKeys, BufferCacheKey *r_key)
+{
+	static const BufferCacheKey unconnected = {{0}};
+	const char *name = typeid(*operation).name();
+	unsigned int resolution[2] = {operation->getWidth(), operation->getHeight()};
+	string data;
+
+	buffercache_append(data, name, strlen(name) + 1);
+	buffercache_append(data, resolution, sizeof(resolution));
+
+	if (operation->getNumberOfOutputSockets() > 0) {
+		DataType datatype = operation->getOutputSocket()->getDataType();
+		buffercache_append(data, &datatype, sizeof(datatype));
+	}
+
+	/* nodes can create multiple operations of the same class */
+	if (nodeKey) {
+		buffercache_append(data, nodeKey->digest, sizeof(nodeKey->digest));
+		buffercache_append(data, &index, sizeof(index));
+	}
+
+	for (unsigned int i = 0; i < inputKeys.size(); i++) {
+		const BufferCacheKey *inputKey = inputKeys[i] ? inputKeys[i] : &unconnected;
+		buffercache_append(data, inputKey->digest, sizeof(inputKey->digest));
+	}
+
+	md5_buffer(data.data(), data.size(), r_key->digest);
+}
+
+bool BufferCache::read(const BufferCacheKey *key, MemoryBuffer *buffer)
+{
+	if (s_moviecache == NULL || !isEnabled())
+		return false;
+
+	ImBuf *ibuf = IMB_moviecache_get(s_moviecache, (void *)key);
+	bool found = false;
+
+	if (ibuf == NULL)
+		return false;
+
+	if (ibuf->x == buffer->getWidth() && ibuf->y == buffer->getHeight() &&
+	    ibuf->channels == buffer->getNumberOfChannels())
+	{
+		memcpy(buffer->getBuffer(), ibuf->rect_float, sizeof(float) * ibuf->x * ibuf->y * ibuf->channels);
+		buffer->setCreatedState();
+		found = true;
+	}
+
+	IMB_freeImBuf(ibuf);
+
+	return found;
+}
+
+void BufferCache::write(const BufferCacheKey *key, MemoryBuffer *buffer)
+{
+	const unsigned int width = buffer->getWidth();
+	const unsigned int height = buffer->getHeight();
+	const unsigned int num_channels = buffer->getNumberOfChannels();
+	const size_t size = sizeof(float) * width * height * num_channels;
+
+	if (!isEnabled())
+		return;
+
+	if (s_moviecache == NULL)
+		s_moviecache = IMB_moviecache_create("compositor buffers", sizeof(BufferCacheKey), buffercache_hashhash, buffercache_hashcmp);
+
+	/* value and vector buffers are stored with their own number of channels,
+	 * the image buffer is only used to be able to store them in the movie cache */
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 32, 0);
+	ibuf->channels = num_channels;
+	ibuf->rect_float = (float *)MEM_mapallocN(size, "compositor cached buffer");
+	ibuf->mall |= IB_rectfloat;
+	ibuf->flags |= IB_rectfloat;
+	memcpy(ibuf->rect_float, buffer->getBuffer(), size);
+
+	IMB_moviecache_put(s_moviecache, (void *)key, ibuf);
+	IMB_freeImBuf(ibuf);
+}
+
+void BufferCache::clear()
+{
+	if (s_moviecache) {
+		IMB_moviecache_free(s_moviecache);
+		s_moviecache = NULL;
+	}
+	s_nodeGenerations.clear();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_BufferCache_h_
+#define _COM_BufferCache_h_
+
+#include <vector>
+
+class CompositorContext;
+class MemoryBuffer;
+class Node;
+class NodeOperation;
+
+using namespace std;
+
+/**
+ * @brief digest of the operations that produce the content of a buffer
+ * @ingroup Memory
+ */
+typedef struct BufferCacheKey {
+	unsigned char digest[16];
+} BufferCacheKey;
+
+/**
+ * @brief cache of the output buffers of complex execution groups
+ *
+ * The cache is kept between executions of the compositor, so that changing a node
+ * downstream of an expensive operation (a blur, defocus or glare) does not execute
+ * that operation again.
+ *
+ * Buffers are identified by a digest of all operations they depend on: the class and
+ * resolution of every operation, the settings of the node it was created from and the
+ * digests of its inputs. Nodes that read data outside of the node tree (images, render
+ * results, movie clips) also add the frame number and a generation that is
+ * increased every time the node is tagged with bNode.need_exec. Mask nodes add the
+ * mask data and the defocus node the camera settings.
+ *
+ * The keys contain pointers to data-blocks, so the cache is cleared when a file is
+ * loaded or an undo step is read.
+ *
+ * Buffers are stored in the movie cache, so they share its memory limit and least
+ * recently used eviction with the sequencer and movie clip caches.
+ * @ingroup Memory
+ */
+class BufferCache {
+public:
+	/**
+	 * @brief whether buffers are cached, a user preference. the cache is never used in background mode
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief called before the node keys of an execution are determined
+	 * removes the generations of nodes that weren't executed for a while, frees the cache when it's disabled
+	 */
+	static void startExecution();
+
+	/**
+	 * @brief determine the digest of a node, the settings the operations of the node are created from
+	 * @note this increases the generation of the node when it is tagged for execution,
+	 * so it should be called once per execution.
+	 */
+	static void determineNodeKey(CompositorContext *context, Node *node, BufferCacheKey *r_key);
+
+	/**
+	 * @brief determine the digest of an operation
+	 * @param nodeKey digest of the node that created the operation, NULL for conversion operations
+	 * @param index index of the operation among the operations created by the node
+	 * @param inputKeys digests of the connected inputs, NULL for unconnected inputs
+	 */
+	static void determineOperationKey(NodeOperation *operation, const BufferCacheKey *nodeKey, int index,
+	                                  const vector<const BufferCacheKey *> &inputKeys, BufferCacheKey *r_key);
+
+	/**
+	 * @brief copy the cached content to a buffer
+	 * @return true when the content was found in the cache
+	 */
+	static bool read(const BufferCacheKey *key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief store a copy of the content of a buffer
+	 */
+	static void write(const BufferCacheKey *key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all cached buffers and node generations
+	 * called when the data the keys refer to is freed (file load, undo) and at exit
+	 */
+	static void clear();
+};
+
+#endif
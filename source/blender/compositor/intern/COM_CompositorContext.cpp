@@ -30,6 +30,7 @@ CompositorContext::CompositorContext()
 	this->m_quality = COM_QUALITY_HIGH;
 	this->m_hasActiveOpenCLDevices = false;
 	this->m_fastCalculation = false;
+	this->m_proxyScale = 1.0f;
 	this->m_viewSettings = NULL;
 	this->m_displaySettings = NULL;
 }
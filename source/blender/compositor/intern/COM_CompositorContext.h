@@ -81,6 +81,12 @@ private:
 	 */
 	bool m_fastCalculation;
 
+	/**
+	 * @brief factor of the full resolution that the sources are scaled to
+	 * 1.0 for the full resolution, smaller for a proxy pass during editing
+	 */
+	float m_proxyScale;
+
 	/* @brief color management settings */
 	const ColorManagedViewSettings *m_viewSettings;
 	const ColorManagedDisplaySettings *m_displaySettings;
@@ -177,9 +183,24 @@ public:
 	void setHasActiveOpenCLDevices(bool hasAvtiveOpenCLDevices) { this->m_hasActiveOpenCLDevices = hasAvtiveOpenCLDevices; }
 	
 	int getChunksize() { return this->getbNodeTree()->chunksize; }
+
+	/**
+	 * @brief get the memory limit in megabytes for the buffers of complex nodes, 0 for no limit
+	 * @see MemoryBudget
+	 */
+	int getMemoryLimit() { return this->getbNodeTree()->memory_limit; }
 	
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() {return this->m_fastCalculation;}
+
+	void setProxyScale(float proxyScale) { this->m_proxyScale = proxyScale; }
+
+	/**
+	 * @brief get the factor of the full resolution the tree is calculated at
+	 * nodes with sizes in pixels multiply them with this factor
+	 */
+	float getProxyScale() const { return this->m_proxyScale; }
+	bool isProxy() const { return this->m_proxyScale != 1.0f; }
 	inline bool isGroupnodeBufferEnabled() {return this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER;}
 };
 
@@ -24,6 +24,8 @@
 #include <math.h>
 #include <sstream>
 #include <stdlib.h>
+#include <stdio.h>
+#include <typeinfo>
 
 #include "COM_ExecutionGroup.h"
 #include "COM_InputSocket.h"
@@ -37,15 +39,25 @@
 #include "COM_ViewerOperation.h"
 #include "COM_ChunkOrder.h"
 #include "COM_ExecutionSystemHelper.h"
+#include "COM_BufferCache.h"
+#include "COM_WorkPackage.h"
+#include "COM_Profiler.h"
 
 #include "MEM_guardedalloc.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BKE_global.h"
 #include "PIL_time.h"
 #include "WM_api.h"
 #include "WM_types.h"
 
+/* protects the execution states and dependencies of the chunks of all groups. chunks are
+ * requested by the main thread and finished by the devices, which makes waiting chunks ready */
+static ThreadMutex s_chunkMutex = BLI_MUTEX_INITIALIZER;
+/* notified when a chunk is executed, the main thread waits on it in ExecutionGroup.execute */
+static ThreadCondition s_chunkCondition = BLI_CONDITION_INITIALIZER;
+
 ExecutionGroup::ExecutionGroup()
 {
 	this->m_isOutput = false;
@@ -64,6 +76,11 @@ ExecutionGroup::ExecutionGroup()
 	this->m_chunksFinished = 0;
 	BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
 	this->m_executionStartTime = 0;
+	this->m_queueWaitTime = 0.0;
+	this->m_computeTime = 0.0;
+	this->m_pixelsComputed = 0.0;
+	this->m_areaOfInterestPixels = 0.0;
+	this->m_areaOfInterestChunkPixels = 0.0;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -166,6 +183,19 @@ void ExecutionGroup::initExecution()
 		}
 	}
 
+	for (index = 0; index < this->m_workPackages.size(); index++) {
+		delete this->m_workPackages[index];
+	}
+	this->m_workPackages.clear();
+	for (index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_workPackages.push_back(new WorkPackage(this, index));
+	}
+	this->m_queueWaitTime = 0.0;
+	this->m_computeTime = 0.0;
+	this->m_pixelsComputed = 0.0;
+	this->m_areaOfInterestPixels = 0.0;
+	this->m_areaOfInterestChunkPixels = 0.0;
+
 
 	unsigned int maxNumber = 0;
 
@@ -188,6 +218,10 @@ void ExecutionGroup::deinitExecution()
 		MEM_freeN(this->m_chunkExecutionStates);
 		this->m_chunkExecutionStates = NULL;
 	}
+	for (unsigned int index = 0; index < this->m_workPackages.size(); index++) {
+		delete this->m_workPackages[index];
+	}
+	this->m_workPackages.clear();
 	this->m_numberOfChunks = 0;
 	this->m_numberOfXChunks = 0;
 	this->m_numberOfYChunks = 0;
@@ -344,45 +378,41 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	}
 
 	bool breaked = false;
-	bool finished = false;
-	unsigned int startIndex = 0;
-	const int maxNumberEvaluated = BLI_system_thread_count() * 2;
-
-	while (!finished && !breaked) {
-		bool startEvaluated = false;
-		finished = true;
-		int numberEvaluated = 0;
-
-		for (index = startIndex; index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated; index++) {
-			chunkNumber = chunkOrder[index];
-			int yChunk = chunkNumber / this->m_numberOfXChunks;
-			int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-			const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-			if (state == COM_ES_NOT_SCHEDULED) {
-				scheduleChunkWhenPossible(graph, xChunk, yChunk);
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-
-				if (bTree->update_draw)
-					bTree->update_draw(bTree->udh);
-			}
-			else if (state == COM_ES_SCHEDULED) {
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-			}
-			else if (state == COM_ES_EXECUTED && !startEvaluated) {
-				startIndex = index + 1;
-			}
+	unsigned int numberRequested = 0;
+	const unsigned int maxNumberEvaluated = BLI_system_thread_count() * 2;
+	vector<WorkPackage *> readyPackages;
+
+	/* chunks are requested in the chunk order, the chunks they depend on are scheduled
+	 * first and the requested chunks are scheduled by the devices as soon as their
+	 * inputs are executed. only a limited number of chunks is requested at a time, so
+	 * they are finished roughly in the chunk order */
+	BLI_mutex_lock(&s_chunkMutex);
+	while (!breaked && this->m_chunksFinished < this->m_numberOfChunks) {
+		while (numberRequested < this->m_numberOfChunks && numberRequested - this->m_chunksFinished < maxNumberEvaluated) {
+			requestChunk(chunkOrder[numberRequested], NULL, &readyPackages);
+			numberRequested++;
 		}
 
-		WorkScheduler::finish();
+		if (readyPackages.empty()) {
+			BLI_condition_wait(&s_chunkCondition, &s_chunkMutex);
+		}
+		BLI_mutex_unlock(&s_chunkMutex);
+
+		for (index = 0; index < readyPackages.size(); index++) {
+			WorkScheduler::schedule(readyPackages[index]);
+		}
+		readyPackages.clear();
+
+		if (bTree->update_draw)
+			bTree->update_draw(bTree->udh);
 
 		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
 			breaked = true;
 		}
+
+		BLI_mutex_lock(&s_chunkMutex);
 	}
+	BLI_mutex_unlock(&s_chunkMutex);
 
 	MEM_freeN(chunkOrder);
 }
@@ -440,16 +470,64 @@ void ExecutionGroup::printBackgroundStats(void)
 	printf("| Tree %s, Tile %d-%d ", this->m_bTree->id.name + 2,
 	       this->m_chunksFinished, this->m_numberOfChunks);
 
+	/* time spent in the chunks of this group summed over all threads */
+	BLI_timestr(this->m_computeTime, timestr, sizeof(timestr));
+	printf("| Compute %s ", timestr);
+
 	fputc('\n', stdout);
 	fflush(stdout);
 }
 
+void ExecutionGroup::printSchedulingStats(void)
+{
+	NodeOperation *operation = this->getOutputNodeOperation();
+	unsigned int numberOfChunks = max(this->m_chunksFinished, 1u);
+
+	if (operation->isWriteBufferOperation()) {
+		operation = ((WriteBufferOperation *)operation)->getInput();
+	}
+
+	printf("Compositor group %-32s %-20s %5u chunks | wait %8.3fs (%.3fms/chunk) | compute %8.3fs (%.3fms/chunk)\n",
+	       typeid(*operation).name(), operation->getbNode() ? operation->getbNode()->name : "",
+	       this->m_chunksFinished,
+	       this->m_queueWaitTime, 1000.0 * this->m_queueWaitTime / numberOfChunks,
+	       this->m_computeTime, 1000.0 * this->m_computeTime / numberOfChunks);
+}
+
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED)
-		this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
-	
+	WorkPackage *package = this->m_workPackages[chunkNumber];
+	vector<WorkPackage *> readyPackages;
+	unsigned int index;
+	const double executionEndTime = PIL_check_seconds_timer();
+	rcti rect;
+
+	determineChunkRect(&rect, chunkNumber);
+
+	if (Profiler::isActive()) {
+		Profiler::addChunk(this, chunkNumber, package->getExecutionStartTime(), executionEndTime);
+	}
+
+	BLI_mutex_lock(&s_chunkMutex);
+	this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
 	this->m_chunksFinished++;
+	this->m_queueWaitTime += package->getExecutionStartTime() - package->getScheduleTime();
+	this->m_computeTime += executionEndTime - package->getExecutionStartTime();
+	this->m_pixelsComputed += (double)BLI_rcti_size_x(&rect) * BLI_rcti_size_y(&rect);
+
+	/* chunks of other groups that were waiting for this chunk */
+	package->finishDependents(&readyPackages);
+	for (index = 0; index < readyPackages.size(); index++) {
+		WorkPackage *readyPackage = readyPackages[index];
+		readyPackage->getExecutionGroup()->m_chunkExecutionStates[readyPackage->getChunkNumber()] = COM_ES_SCHEDULED;
+	}
+	BLI_condition_notify_all(&s_chunkCondition);
+	BLI_mutex_unlock(&s_chunkMutex);
+
+	for (index = 0; index < readyPackages.size(); index++) {
+		WorkScheduler::schedule(readyPackages[index]);
+	}
+
 	if (memoryBuffers) {
 		for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
 			MemoryBuffer *buffer = memoryBuffers[index];
@@ -510,10 +588,11 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int chunkNumber, rcti *rect)
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::requestArea(rcti *area, WorkPackage *dependent, vector<WorkPackage *> *readyPackages)
 {
 	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
+		requestChunk(0, dependent, readyPackages);
+		return;
 	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -530,55 +609,41 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	maxxchunk = min(maxxchunk, (int)this->m_numberOfXChunks);
 	maxychunk = min(maxychunk, (int)this->m_numberOfYChunks);
 
-	bool result = true;
 	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
 		for (indexy = minychunk; indexy < maxychunk; indexy++) {
-			if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
-				result = false;
-			}
+			requestChunk(indexy * this->m_numberOfXChunks + indexx, dependent, readyPackages);
 		}
 	}
-
-	return result;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+void ExecutionGroup::requestChunk(unsigned int chunkNumber, WorkPackage *dependent, vector<WorkPackage *> *readyPackages)
 {
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
-		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-		WorkScheduler::schedule(this, chunkNumber);
-		return true;
-	}
-	return false;
-}
+	const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
+	WorkPackage *package = this->m_workPackages[chunkNumber];
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
-{
-	if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
-		return true;
-	}
-	if (yChunk < 0 || yChunk >= (int)this->m_numberOfYChunks) {
-		return true;
-	}
-	int chunkNumber = yChunk * this->m_numberOfXChunks + xChunk;
 	// chunk is already executed
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_EXECUTED) {
-		return true;
+	if (state == COM_ES_EXECUTED) {
+		return;
 	}
 
-	// chunk is scheduled, but not executed
-	if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_SCHEDULED) {
-		return false;
+	if (dependent) {
+		package->addDependent(dependent);
+	}
+
+	// chunk is requested already, the dependent waits for it
+	if (state != COM_ES_NOT_SCHEDULED) {
+		return;
 	}
 
-	// chunk is nor executed nor scheduled.
+	// chunk is nor executed nor requested, request the input areas it depends on
+	this->m_chunkExecutionStates[chunkNumber] = COM_ES_WAITING;
+
 	vector<MemoryProxy *> memoryProxies;
 	this->determineDependingMemoryProxies(&memoryProxies);
 
 	rcti rect;
-	determineChunkRect(&rect, xChunk, yChunk);
+	determineChunkRect(&rect, chunkNumber);
 	unsigned int index;
-	bool canBeExecuted = true;
 	rcti area;
 
 	for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
@@ -588,21 +653,62 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 		determineDependingAreaOfInterest(&rect, readOperation, &area);
 		ExecutionGroup *group = memoryProxy->getExecutor();
 
+		/* only the part of the area inside of the input buffer is calculated */
+		WriteBufferOperation *writeOperation = memoryProxy->getWriteBufferOperation();
+		rcti bounds, clipped;
+		BLI_rcti_init(&bounds, 0, writeOperation->getWidth(), 0, writeOperation->getHeight());
+		if (BLI_rcti_isect(&area, &bounds, &clipped)) {
+			this->m_areaOfInterestPixels += (double)BLI_rcti_size_x(&clipped) * BLI_rcti_size_y(&clipped);
+		}
+		this->m_areaOfInterestChunkPixels += (double)BLI_rcti_size_x(&rect) * BLI_rcti_size_y(&rect);
+
 		if (group != NULL) {
-			if (!group->scheduleAreaWhenPossible(graph, &area)) {
-				canBeExecuted = false;
-			}
+			group->requestArea(&area, package, readyPackages);
 		}
 		else {
 			throw "ERROR";
 		}
 	}
 
-	if (canBeExecuted) {
-		scheduleChunk(chunkNumber);
+	if (package->getNumberOfPendingInputs() == 0) {
+		this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
+		readyPackages->push_back(package);
 	}
+}
 
-	return false;
+bool ExecutionGroup::readFromBufferCache(const BufferCacheKey *key)
+{
+	NodeOperation *operation = this->getOutputNodeOperation();
+	if (!this->isComplex() || !operation->isWriteBufferOperation() || this->m_numberOfChunks == 0) {
+		return false;
+	}
+
+	WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+	if (!BufferCache::read(key, writeOperation->getMemoryProxy()->getBuffer())) {
+		return false;
+	}
+
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+	return true;
+}
+
+void ExecutionGroup::writeToBufferCache(const BufferCacheKey *key)
+{
+	NodeOperation *operation = this->getOutputNodeOperation();
+	if (!this->isComplex() || !operation->isWriteBufferOperation() || this->m_numberOfChunks == 0) {
+		return;
+	}
+
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return;
+		}
+	}
+
+	WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+	BufferCache::write(key, writeOperation->getMemoryProxy()->getBuffer());
 }
 
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
@@ -41,19 +41,25 @@ typedef enum ChunkExecutionState {
 	 * @brief chunk is not yet scheduled
 	 */
 	COM_ES_NOT_SCHEDULED = 0,
+	/**
+	 * @brief chunk is requested, but waiting for the chunks of other groups it depends on
+	 */
+	COM_ES_WAITING = 1,
 	/**
 	 * @brief chunk is scheduled, but not yet executed
 	 */
-	COM_ES_SCHEDULED = 1,
+	COM_ES_SCHEDULED = 2,
 	/**
 	 * @brief chunk is executed.
 	 */
-	COM_ES_EXECUTED = 2
+	COM_ES_EXECUTED = 3
 } ChunkExecutionState;
 
 class MemoryProxy;
 class ReadBufferOperation;
 class Device;
+class WorkPackage;
+struct BufferCacheKey;
 
 /**
  * @brief Class ExecutionGroup is a group of NodeOperations that are executed as one.
@@ -146,10 +152,39 @@ private:
 	/**
 	 * @brief the chunkExecutionStates holds per chunk the execution state. this state can be
 	 *   - COM_ES_NOT_SCHEDULED: not scheduled
+	 *   - COM_ES_WAITING: waiting for input chunks
 	 *   - COM_ES_SCHEDULED: scheduled
 	 *   - COM_ES_EXECUTED: executed
 	 */
 	ChunkExecutionState *m_chunkExecutionStates;
+
+	/**
+	 * @brief the work package of every chunk, allocated once in initExecution
+	 */
+	vector<WorkPackage *> m_workPackages;
+
+	/**
+	 * @brief total time the chunks of this group waited in the WorkScheduler before being executed
+	 */
+	double m_queueWaitTime;
+
+	/**
+	 * @brief total time spent executing the chunks of this group
+	 */
+	double m_computeTime;
+
+	/**
+	 * @brief number of pixels calculated by the chunks of this group
+	 */
+	double m_pixelsComputed;
+
+	/**
+	 * @brief pixels of the input buffers requested by the chunks of this group, and the pixels of
+	 * the chunks they were requested for, once for every input buffer. their ratio is how much
+	 * determineDependingAreaOfInterest inflates the area
+	 */
+	double m_areaOfInterestPixels;
+	double m_areaOfInterestChunkPixels;
 	
 	/**
 	 * @brief indicator when this ExecutionGroup has valid NodeOperations in its vector for Execution
@@ -203,34 +238,22 @@ private:
 	void determineNumberOfChunks();
 	
 	/**
-	 * @brief try to schedule a specific chunk.
-	 * @note scheduling succeeds when all input requirements are met and the chunks hasn't been scheduled yet.
-	 * @param graph
-	 * @param xChunk
-	 * @param yChunk
-	 * @return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * @brief request a specific chunk to be executed.
+	 * @note the chunks of other groups the chunk depends on are requested as well. when all of them are executed
+	 * the chunk is ready, otherwise it waits for them and becomes ready when the last of them is executed.
+	 * @note must be called with the chunk mutex locked
+	 * @param chunkNumber
+	 * @param dependent work package of another group that needs this chunk, or NULL
+	 * @param readyPackages work packages that can be scheduled are added to this list
 	 */
-	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+	void requestChunk(unsigned int chunkNumber, WorkPackage *dependent, vector<WorkPackage *> *readyPackages);
 
 	/**
-	 * @brief try to schedule a specific area.
-	 * @note Check if a certain area is available, when not available this are will be checked.
+	 * @brief request all chunks in a specific area to be executed.
 	 * @note This method is called from other ExecutionGroup's.
-	 * @param graph
-	 * @param rect
-	 * @return [true:false]
-	 * true: package(s) are scheduled
-	 * false: scheduling is deferred (depending workpackages are scheduled)
+	 * @see requestChunk
 	 */
-	bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
-
-	/**
-	 * @brief add a chunk to the WorkScheduler.
-	 * @param chunknumber
-	 */
-	bool scheduleChunk(unsigned int chunkNumber);
+	void requestArea(rcti *rect, WorkPackage *dependent, vector<WorkPackage *> *readyPackages);
 	
 	/**
 	 * @brief determine the area of interest of a certain input area
@@ -351,6 +374,25 @@ public:
 	 * @brief print execution statistics to stdout when running in a background mode
 	 */
 	void printBackgroundStats(void);
+
+	/**
+	 * @brief print the time the chunks of this group waited in the WorkScheduler and the time they were executed
+	 * @note printed with --debug-jobs
+	 */
+	void printSchedulingStats(void);
+
+	/**
+	 * @brief statistics of the last execution
+	 * @see Profiler
+	 */
+	unsigned int getNumberOfChunksFinished() const { return this->m_chunksFinished; }
+	double getQueueWaitTime() const { return this->m_queueWaitTime; }
+	double getComputeTime() const { return this->m_computeTime; }
+	double getPixelsComputed() const { return this->m_pixelsComputed; }
+	float getAreaOfInterestInflation() const {
+		return (this->m_areaOfInterestChunkPixels > 0.0) ? this->m_areaOfInterestPixels / this->m_areaOfInterestChunkPixels : 1.0f;
+	}
+	const vector<NodeOperation *> &getOperations() const { return this->m_operations; }
 	
 	/**
 	 * @brief after a chunk is executed the needed resources can be freed or unlocked.
@@ -382,6 +424,19 @@ public:
 	 */
 	void execute(ExecutionSystem *system);
 	
+	/**
+	 * @brief fill the output buffer of a complex ExecutionGroup from the BufferCache
+	 * @note when found all chunks are marked as executed, so the ExecutionGroups this group depends on are not scheduled
+	 * @return the output buffer was found in the cache
+	 */
+	bool readFromBufferCache(const BufferCacheKey *key);
+
+	/**
+	 * @brief store the output buffer of a complex ExecutionGroup in the BufferCache
+	 * @note nothing is stored when not all chunks have been executed (viewer border, fast calculation or user break)
+	 */
+	void writeToBufferCache(const BufferCacheKey *key);
+
 	/**
 	 * @brief this method determines the MemoryProxy's where this execution group depends on.
 	 * @note After this method determineDependingAreaOfInterest can be called to determine
@@ -40,6 +40,9 @@ extern "C" {
 #include "COM_WriteBufferOperation.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_ExecutionSystemHelper.h"
+#include "COM_MemoryBudget.h"
+#include "COM_Profiler.h"
+#include "COM_ProxyScaleOperation.h"
 
 #include "BKE_global.h"
 
@@ -47,12 +50,13 @@ extern "C" {
 #include "MEM_guardedalloc.h"
 #endif
 
-ExecutionSystem::ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool rendering, bool fastcalculation,
+ExecutionSystem::ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool rendering, bool fastcalculation, float proxyScale,
                                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings)
 {
 	this->m_context.setbNodeTree(editingtree);
 	this->m_context.setPreviewHash(editingtree->previews);
 	this->m_context.setFastCalculation(fastcalculation);
+	this->m_context.setProxyScale(proxyScale);
 	/* initialize the CompositorContext */
 	if (rendering) {
 		this->m_context.setQuality((CompositorQuality)editingtree->render_quality);
@@ -63,7 +67,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool re
 	this->m_context.setRendering(rendering);
 	this->m_context.setHasActiveOpenCLDevices(WorkScheduler::hasGPUDevices() && (editingtree->flag & NTREE_COM_OPENCL));
 
-	ExecutionSystemHelper::addbNodeTree(*this, 0, editingtree, NODE_INSTANCE_KEY_BASE);
+	ExecutionSystemHelper::addbNodeTree(*this, 0, editingtree, NODE_INSTANCE_KEY_BASE, false);
 
 	this->m_context.setRenderData(rd);
 	this->m_context.setViewSettings(viewSettings);
@@ -145,6 +149,10 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
+	/* the buffers of the write buffer operations are allocated in initExecution */
+	MemoryBudget::start(this->m_context);
+	Profiler::start(this);
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->setbNodeTree(this->m_context.getbNodeTree());
@@ -163,6 +171,20 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	/* complex groups that have been executed before with the same settings and inputs are
+	 * read from the cache, the groups they depend on will not be scheduled */
+	map<NodeOperation *, BufferCacheKey> cacheKeys;
+	vector<ExecutionGroup *> uncachedGroups;
+	for (index = 0; index < this->m_groups.size(); index++) {
+		ExecutionGroup *executionGroup = this->m_groups[index];
+		if (executionGroup->isComplex()) {
+			const BufferCacheKey *key = determineBufferCacheKey(executionGroup->getOutputNodeOperation(), cacheKeys);
+			if (!executionGroup->readFromBufferCache(key)) {
+				uncachedGroups.push_back(executionGroup);
+			}
+		}
+	}
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -174,6 +196,19 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	if (G.debug & G_DEBUG_JOBS) {
+		for (index = 0; index < this->m_groups.size(); index++) {
+			this->m_groups[index]->printSchedulingStats();
+		}
+	}
+
+	Profiler::stop(this);
+
+	for (index = 0; index < uncachedGroups.size(); index++) {
+		ExecutionGroup *executionGroup = uncachedGroups[index];
+		executionGroup->writeToBufferCache(&cacheKeys[executionGroup->getOutputNodeOperation()]);
+	}
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->deinitExecution();
@@ -182,6 +217,47 @@ void ExecutionSystem::execute()
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->deinitExecution();
 	}
+
+	MemoryBudget::stop();
+}
+
+const BufferCacheKey *ExecutionSystem::determineBufferCacheKey(NodeOperation *operation, map<NodeOperation *, BufferCacheKey> &keys)
+{
+	map<NodeOperation *, BufferCacheKey>::iterator found = keys.find(operation);
+	if (found != keys.end()) {
+		return &found->second;
+	}
+
+	vector<const BufferCacheKey *> inputKeys;
+	if (operation->isReadBufferOperation()) {
+		/* the content of a read buffer is the content of the write buffer */
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		inputKeys.push_back(determineBufferCacheKey(readOperation->getMemoryProxy()->getWriteBufferOperation(), keys));
+	}
+	else {
+		unsigned int index;
+		for (index = 0; index < operation->getNumberOfInputSockets(); index++) {
+			InputSocket *inputSocket = operation->getInputSocket(index);
+			if (inputSocket->isConnected()) {
+				NodeOperation *inputOperation = (NodeOperation *)inputSocket->getConnection()->getFromNode();
+				inputKeys.push_back(determineBufferCacheKey(inputOperation, keys));
+			}
+			else {
+				inputKeys.push_back(NULL);
+			}
+		}
+	}
+
+	BufferCacheKey &key = keys[operation];
+	map<NodeOperation *, pair<BufferCacheKey, int> >::iterator source = this->m_operationSourceKeys.find(operation);
+	if (source != this->m_operationSourceKeys.end()) {
+		BufferCache::determineOperationKey(operation, &source->second.first, source->second.second, inputKeys, &key);
+	}
+	else {
+		/* data type and resolution conversions */
+		BufferCache::determineOperationKey(operation, NULL, 0, inputKeys, &key);
+	}
+	return &key;
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -217,13 +293,13 @@ void ExecutionSystem::addReadWriteBufferOperations(NodeOperation *operation)
 				OutputSocket *fromsocket = connection->getFromSocket();
 				WriteBufferOperation *writeoperation = fromsocket->findAttachedWriteBufferOperation();
 				if (writeoperation == NULL) {
-					writeoperation = new WriteBufferOperation();
+					writeoperation = new WriteBufferOperation(fromsocket->getDataType());
 					writeoperation->setbNodeTree(this->getContext().getbNodeTree());
 					this->addOperation(writeoperation);
 					ExecutionSystemHelper::addLink(this->getConnections(), fromsocket, writeoperation->getInputSocket(0));
 					writeoperation->readResolutionFromInputSocket();
 				}
-				ReadBufferOperation *readoperation = new ReadBufferOperation();
+				ReadBufferOperation *readoperation = new ReadBufferOperation(fromsocket->getDataType());
 				readoperation->setMemoryProxy(writeoperation->getMemoryProxy());
 				connection->setFromSocket(readoperation->getOutputSocket());
 				readoperation->getOutputSocket()->addConnection(connection);
@@ -240,14 +316,14 @@ void ExecutionSystem::addReadWriteBufferOperations(NodeOperation *operation)
 	OutputSocket *outputsocket = operation->getOutputSocket();
 	if (outputsocket->isConnected()) {
 		WriteBufferOperation *writeOperation;
-		writeOperation = new WriteBufferOperation();
+		writeOperation = new WriteBufferOperation(outputsocket->getDataType());
 		writeOperation->setbNodeTree(this->getContext().getbNodeTree());
 		this->addOperation(writeOperation);
 		ExecutionSystemHelper::addLink(this->getConnections(), outputsocket, writeOperation->getInputSocket(0));
 		writeOperation->readResolutionFromInputSocket();
 		for (index = 0; index < outputsocket->getNumberOfConnections() - 1; index++) {
 			SocketConnection *connection = outputsocket->getConnection(index);
-			ReadBufferOperation *readoperation = new ReadBufferOperation();
+			ReadBufferOperation *readoperation = new ReadBufferOperation(outputsocket->getDataType());
 			readoperation->setMemoryProxy(writeOperation->getMemoryProxy());
 			connection->setFromSocket(readoperation->getOutputSocket());
 			readoperation->getOutputSocket()->addConnection(connection);
@@ -285,9 +361,17 @@ void ExecutionSystem::convertToOperations()
 	unsigned int index;
 	for (index = 0; index < this->m_nodes.size(); index++) {
 		Node *node = (Node *)this->m_nodes[index];
+		unsigned int operationsStart = this->m_operations.size();
 		node->convertToOperations(this, &this->m_context);
 
 		debug_check_node_connections(node);
+
+		/* remember which node the operations are created from, for the BufferCache */
+		BufferCacheKey nodeKey;
+		BufferCache::determineNodeKey(&this->m_context, node, &nodeKey);
+		for (unsigned int i = operationsStart; i < this->m_operations.size(); i++) {
+			this->m_operationSourceKeys[this->m_operations[i]] = make_pair(nodeKey, (int)(i - operationsStart));
+		}
 	}
 
 	for (index = 0; index < this->m_connections.size(); index++) {
@@ -299,6 +383,10 @@ void ExecutionSystem::convertToOperations()
 		}
 	}
 
+	if (this->m_context.isProxy()) {
+		this->addProxyScaleOperations();
+	}
+
 	// determine all resolutions of the operations (Width/Height)
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -330,6 +418,59 @@ void ExecutionSystem::convertToOperations()
 	}
 }
 
+void ExecutionSystem::addProxyScaleOperations()
+{
+	const int divider = (int)(1.0f / this->m_context.getProxyScale() + 0.5f);
+	const bool rendering = this->m_context.isRendering();
+	unsigned int numberOfOperations = this->m_operations.size();
+	unsigned int index;
+
+	for (index = 0; index < numberOfOperations; index++) {
+		NodeOperation *operation = this->m_operations[index];
+
+		if (operation->getNumberOfInputSockets() == 0 && !operation->isSetOperation()) {
+			/* images, render layers, movie clips... inputs without resize, like the bokeh image
+			 * of the bokeh blur, keep reading the full resolution */
+			for (unsigned int i = 0; i < operation->getNumberOfOutputSockets(); i++) {
+				OutputSocket *outputSocket = operation->getOutputSocket(i);
+				ProxyDownscaleOperation *downscale = NULL;
+				vector<SocketConnection *> connections;
+
+				for (int j = 0; j < outputSocket->getNumberOfConnections(); j++) {
+					SocketConnection *connection = outputSocket->getConnection(j);
+					if (connection->getToSocket()->getResizeMode() != COM_SC_NO_RESIZE) {
+						connections.push_back(connection);
+					}
+				}
+				if (connections.empty()) {
+					continue;
+				}
+
+				downscale = new ProxyDownscaleOperation(outputSocket->getDataType(), divider);
+				for (unsigned int j = 0; j < connections.size(); j++) {
+					SocketConnection *connection = connections[j];
+					outputSocket->removeConnection(connection);
+					connection->setFromSocket(downscale->getOutputSocket());
+					downscale->getOutputSocket()->addConnection(connection);
+				}
+				ExecutionSystemHelper::addLink(this->getConnections(), outputSocket, downscale->getInputSocket(0));
+				this->addOperation(downscale);
+			}
+		}
+		else if (operation->isOutputOperation(rendering) && !operation->isPreviewOperation()) {
+			for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+				InputSocket *inputSocket = operation->getInputSocket(i);
+				if (inputSocket->isConnected()) {
+					ProxyUpscaleOperation *upscale = new ProxyUpscaleOperation(inputSocket->getDataType(), divider);
+					inputSocket->relinkConnections(upscale->getInputSocket(0));
+					ExecutionSystemHelper::addLink(this->getConnections(), upscale->getOutputSocket(), inputSocket);
+					this->addOperation(upscale);
+				}
+			}
+		}
+	}
+}
+
 void ExecutionSystem::groupOperations()
 {
 	vector<NodeOperation *> outputOperations;
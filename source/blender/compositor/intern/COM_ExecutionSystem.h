@@ -27,7 +27,9 @@ class ExecutionGroup;
 
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
+#include <map>
 #include <vector>
+#include "COM_BufferCache.h"
 #include "COM_Node.h"
 #include "COM_SocketConnection.h"
 #include "BKE_text.h"
@@ -141,6 +143,12 @@ private:
 	 */
 	vector<SocketConnection *> m_connections;
 
+	/**
+	 * @brief digest of the node an operation was created from, combined with its index among the operations of the node
+	 * @see BufferCache
+	 */
+	map<NodeOperation *, pair<BufferCacheKey, int> > m_operationSourceKeys;
+
 private: //methods
 	/**
 	 * @brief add ReadBufferOperation and WriteBufferOperation around an operation
@@ -159,6 +167,19 @@ private: //methods
 	 */
 	void findOutputExecutionGroup(vector<ExecutionGroup *> *result) const;
 
+	/**
+	 * @brief determine the digest of the content an operation produces
+	 * @param keys digests of the operations that have been determined already
+	 * @see BufferCache
+	 */
+	const BufferCacheKey *determineBufferCacheKey(NodeOperation *operation, map<NodeOperation *, BufferCacheKey> &keys);
+
+	/**
+	 * @brief scale the sources down to the proxy resolution and the inputs of the outputs back up
+	 * @see CompositorContext.getProxyScale
+	 */
+	void addProxyScaleOperations();
+
 public:
 	/**
 	 * @brief Create a new ExecutionSystem and initialize it with the
@@ -166,8 +187,9 @@ public:
 	 *
 	 * @param editingtree [bNodeTree *]
 	 * @param rendering [true false]
+	 * @param proxyScale factor of the full resolution to calculate the tree at
 	 */
-	ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool rendering, bool fastcalculation,
+	ExecutionSystem(RenderData *rd, bNodeTree *editingtree, bool rendering, bool fastcalculation, float proxyScale,
 	                const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings);
 
 	/**
@@ -42,7 +42,8 @@ extern "C" {
 #include "BKE_node.h"
 }
 
-void ExecutionSystemHelper::addbNodeTree(ExecutionSystem &system, int nodes_start, bNodeTree *tree, bNodeInstanceKey parent_key)
+void ExecutionSystemHelper::addbNodeTree(ExecutionSystem &system, int nodes_start, bNodeTree *tree, bNodeInstanceKey parent_key,
+                                         bool inChangedGroup)
 {
 	vector<Node *>& nodes = system.getNodes();
 	vector<SocketConnection *>& links = system.getConnections();
@@ -56,6 +57,7 @@ void ExecutionSystemHelper::addbNodeTree(ExecutionSystem &system, int nodes_star
 		if (nnode) {
 			nnode->setbNodeTree(tree);
 			nnode->setInstanceKey(BKE_node_instance_key(parent_key, tree, node));
+			nnode->setIsInChangedGroup(inChangedGroup);
 		}
 		node = node->next;
 	}
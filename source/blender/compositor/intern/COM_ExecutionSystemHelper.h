@@ -46,9 +46,11 @@ public:
 	 * @param system Execution system
 	 * @param nodes_start Starting index in the system's nodes list for nodes in this tree.
 	 * @param tree bNodeTree to add
+	 * @param inChangedGroup the tree is a group of which nodes were tagged for execution
 	 * @return Node representing the "Compositor node" of the maintree. or NULL when a subtree is added
 	 */
-	static void addbNodeTree(ExecutionSystem &system, int nodes_start, bNodeTree *tree, bNodeInstanceKey parent_key);
+	static void addbNodeTree(ExecutionSystem &system, int nodes_start, bNodeTree *tree, bNodeInstanceKey parent_key,
+	                         bool inChangedGroup);
 
 	/**
 	 * @brief add an editor node to the system.
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+
+#ifdef WIN32
+#  include <io.h>
+#  include <process.h>
+#  include "mmap_win.h"
+#else
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/resource.h>
+#  define O_BINARY 0
+#endif
+
+#include "COM_MemoryBudget.h"
+#include "COM_CompositorContext.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_sys_types.h"
+#include "BLI_utildefines.h"
+#include "BKE_global.h"
+}
+
+using namespace std;
+
+typedef struct ScratchFile {
+	int file;
+	char filepath[FILE_MAX];
+} ScratchFile;
+
+static size_t s_memoryLimit = 0;
+static size_t s_memoryInUse = 0;
+static size_t s_memoryPeak = 0;
+static size_t s_spilledInUse = 0;
+static size_t s_spilledPeak = 0;
+static unsigned int s_numberOfScratchFiles = 0;
+
+/* scratch file of every spilled buffer */
+static map<float *, ScratchFile> s_scratchFiles;
+
+static float *memorybudget_map_scratch_file(size_t size)
+{
+	ScratchFile scratch;
+	char filename[64];
+	void *buffer;
+
+	BLI_snprintf(filename, sizeof(filename), "compositor_%d_%u.scratch", abs(getpid()), s_numberOfScratchFiles++);
+	BLI_make_file_string("/", scratch.filepath, BLI_temporary_dir(), filename);
+
+	scratch.file = BLI_open(scratch.filepath, O_BINARY | O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (scratch.file == -1) {
+		return NULL;
+	}
+
+	/* extend the file to the size of the buffer */
+	if (lseek(scratch.file, size - 1, SEEK_SET) == -1 || write(scratch.file, "", 1) != 1) {
+		close(scratch.file);
+		BLI_delete(scratch.filepath, false, false);
+		return NULL;
+	}
+
+	buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, scratch.file, 0);
+	if (buffer == MAP_FAILED) {
+		close(scratch.file);
+		BLI_delete(scratch.filepath, false, false);
+		return NULL;
+	}
+
+#ifndef WIN32
+	/* the file is only used through the mapping, removing it right away
+	 * makes sure it is removed when blender does not exit normally */
+	BLI_delete(scratch.filepath, false, false);
+#endif
+
+	s_scratchFiles[(float *)buffer] = scratch;
+	return (float *)buffer;
+}
+
+void MemoryBudget::start(CompositorContext &context)
+{
+	s_memoryLimit = (size_t)context.getMemoryLimit() * 1024 * 1024;
+	s_memoryInUse = 0;
+	s_memoryPeak = 0;
+	s_spilledInUse = 0;
+	s_spilledPeak = 0;
+}
+
+void MemoryBudget::stop()
+{
+	if (s_spilledPeak == 0 && !(G.debug & G_DEBUG_JOBS)) {
+		return;
+	}
+
+	printf("Compositor buffers: peak %.2fM in memory, %.2fM in scratch files",
+	       s_memoryPeak / (1024.0 * 1024.0), s_spilledPeak / (1024.0 * 1024.0));
+
+#ifndef WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#  ifdef __APPLE__
+		/* bytes */
+		printf(", peak resident %.2fM", usage.ru_maxrss / (1024.0 * 1024.0));
+#  else
+		/* kilobytes */
+		printf(", peak resident %.2fM", usage.ru_maxrss / 1024.0);
+#  endif
+	}
+#endif
+
+	printf("\n");
+}
+
+float *MemoryBudget::allocate(size_t size, bool *r_spilled)
+{
+	if (s_memoryLimit != 0 && s_memoryInUse + size > s_memoryLimit) {
+		float *buffer = memorybudget_map_scratch_file(size);
+
+		if (buffer) {
+			s_spilledInUse += size;
+			s_spilledPeak = max(s_spilledPeak, s_spilledInUse);
+			*r_spilled = true;
+			return buffer;
+		}
+
+		printf("Compositor: could not create a scratch file in %s, keeping the buffer in memory\n", BLI_temporary_dir());
+	}
+
+	s_memoryInUse += size;
+	s_memoryPeak = max(s_memoryPeak, s_memoryInUse);
+	*r_spilled = false;
+	return (float *)MEM_mallocN(size, "COM_MemoryBuffer");
+}
+
+void MemoryBudget::free(float *buffer, size_t size, bool spilled)
+{
+	if (spilled) {
+		map<float *, ScratchFile>::iterator scratch = s_scratchFiles.find(buffer);
+
+		BLI_assert(scratch != s_scratchFiles.end());
+
+		munmap(buffer, size);
+		close(scratch->second.file);
+#ifdef WIN32
+		BLI_delete(scratch->second.filepath, false, false);
+#endif
+		s_scratchFiles.erase(scratch);
+		s_spilledInUse -= size;
+	}
+	else {
+		MEM_freeN(buffer);
+		s_memoryInUse -= size;
+	}
+}
+
+void MemoryBudget::release(float *buffer, size_t offset, size_t size)
+{
+#ifndef WIN32
+	const uintptr_t pagesize = sysconf(_SC_PAGESIZE);
+	const uintptr_t start = ((uintptr_t)buffer + offset + pagesize - 1) & ~(pagesize - 1);
+	const uintptr_t end = ((uintptr_t)buffer + offset + size) & ~(pagesize - 1);
+
+	if (end <= start) {
+		return;
+	}
+
+	/* start writing to the scratch file, clean pages can be reused without swapping */
+	msync((void *)start, end - start, MS_ASYNC);
+#  ifdef __linux__
+	/* release the pages from the process, the mapping is shared so the content stays
+	 * in the file (or the page cache) and is read back on the next access */
+	madvise((void *)start, end - start, MADV_DONTNEED);
+#  endif
+#else
+	(void)buffer;
+	(void)offset;
+	(void)size;
+#endif
+}
+
+void MemoryBudget::getPeak(size_t *r_memory, size_t *r_spilled)
+{
+	*r_memory = s_memoryPeak;
+	*r_spilled = s_spilledPeak;
+}
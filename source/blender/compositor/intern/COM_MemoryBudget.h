@@ -0,0 +1,73 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_MemoryBudget_h_
+#define _COM_MemoryBudget_h_
+
+#include <stddef.h>
+
+class CompositorContext;
+
+/**
+ * @brief keeps the full resolution buffers of the MemoryProxy's within a memory budget
+ *
+ * Every complex node needs a full resolution buffer, which makes compositing very large images
+ * with several complex nodes run out of memory. When the node tree has a memory limit, the buffers
+ * that do not fit in the limit are memory mapped scratch files in the temporary directory.
+ *
+ * The chunks written to a scratch file are flushed to disk and released from memory, when a
+ * ReadBufferOperation accesses them again the operating system reads them back.
+ * @ingroup Memory
+ */
+class MemoryBudget {
+public:
+	/**
+	 * @brief start an execution with the memory limit of the node tree
+	 */
+	static void start(CompositorContext &context);
+
+	/**
+	 * @brief end an execution, prints the peak memory usage when buffers were spilled or with --debug-jobs
+	 */
+	static void stop();
+
+	/**
+	 * @brief allocate a buffer in memory, or in a scratch file when the memory limit is reached
+	 * @note called from initExecution, not thread safe
+	 * @param r_spilled is set when the buffer is in a scratch file
+	 */
+	static float *allocate(size_t size, bool *r_spilled);
+
+	/**
+	 * @brief free a buffer allocated with allocate
+	 */
+	static void free(float *buffer, size_t size, bool spilled);
+
+	/**
+	 * @brief write a range of a buffer in a scratch file to disk and release it from memory
+	 * @note only whole memory pages inside the range are released
+	 */
+	static void release(float *buffer, size_t offset, size_t size);
+
+	/**
+	 * @brief peak size of the buffers in memory and in scratch files since start
+	 */
+	static void getPeak(size_t *r_memory, size_t *r_spilled);
+};
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_MemoryBudget.h"
 #include "MEM_guardedalloc.h"
 //#include "BKE_global.h"
 
@@ -38,14 +39,27 @@ int MemoryBuffer::getHeight() const
 	return this->m_rect.ymax - this->m_rect.ymin;
 }
 
+unsigned int MemoryBuffer::determineNumberOfChannels(DataType datatype)
+{
+	switch (datatype) {
+		case COM_DT_VALUE:
+			return 1;
+		case COM_DT_VECTOR:
+			return 3;
+		default:
+			return COM_NUMBER_OF_CHANNELS;
+	}
+}
+
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect)
 {
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = (memoryProxy) ? memoryProxy->getDataType() : COM_DT_COLOR;
+	this->m_num_channels = determineNumberOfChannels(this->m_datatype);
+	this->m_buffer = MemoryBudget::allocate(sizeof(float) * determineBufferSize() * this->m_num_channels, &this->m_spilled);
 	this->m_state = COM_MB_ALLOCATED;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
 
@@ -54,20 +68,37 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = -1;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = (memoryProxy) ? memoryProxy->getDataType() : COM_DT_COLOR;
+	this->m_num_channels = determineNumberOfChannels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+	this->m_spilled = false;
+	this->m_state = COM_MB_TEMPORARILY;
+	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
+}
+
+MemoryBuffer::MemoryBuffer(DataType datatype, rcti *rect)
+{
+	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
+	this->m_memoryProxy = NULL;
+	this->m_chunkNumber = -1;
+	this->m_datatype = datatype;
+	this->m_num_channels = determineNumberOfChannels(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+	this->m_spilled = false;
 	this->m_state = COM_MB_TEMPORARILY;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
+
 MemoryBuffer *MemoryBuffer::duplicate()
 {
-	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
+	result->m_memoryProxy = this->m_memoryProxy;
+	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 	return result;
 }
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 }
 
 float *MemoryBuffer::convertToValueBuffer()
@@ -80,7 +111,12 @@ float *MemoryBuffer::convertToValueBuffer()
 	const float *fp_src = this->m_buffer;
 	float       *fp_dst = result;
 
-	for (i = 0; i < size; i++, fp_dst++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	if (this->m_num_channels == 1) {
+		memcpy(result, this->m_buffer, sizeof(float) * size);
+		return result;
+	}
+
+	for (i = 0; i < size; i++, fp_dst++, fp_src += this->m_num_channels) {
 		*fp_dst = *fp_src;
 	}
 
@@ -95,7 +131,7 @@ float MemoryBuffer::getMaximumValue()
 
 	const float *fp_src = this->m_buffer;
 
-	for (i = 0; i < size; i++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_src += this->m_num_channels) {
 		float value = *fp_src;
 		if (value > result) {
 			result = value;
@@ -113,7 +149,7 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 	BLI_rcti_isect(rect, &this->m_rect, &rect_clamp);
 
 	if (!BLI_rcti_is_empty(&rect_clamp)) {
-		MemoryBuffer *temp = new MemoryBuffer(NULL, &rect_clamp);
+		MemoryBuffer *temp = new MemoryBuffer(this->m_datatype, &rect_clamp);
 		temp->copyContentFrom(this);
 		float result = temp->getMaximumValue();
 		delete temp;
@@ -128,11 +164,31 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 MemoryBuffer::~MemoryBuffer()
 {
 	if (this->m_buffer) {
-		MEM_freeN(this->m_buffer);
+		if (this->isTemporarily()) {
+			MEM_freeN(this->m_buffer);
+		}
+		else {
+			MemoryBudget::free(this->m_buffer, sizeof(float) * determineBufferSize() * this->m_num_channels, this->m_spilled);
+		}
 		this->m_buffer = NULL;
 	}
 }
 
+void MemoryBuffer::releaseArea(rcti *rect)
+{
+	if (!this->m_spilled) {
+		return;
+	}
+
+	/* all rows of the area, the parts of other chunks in between are released as well */
+	const size_t start = (this->m_chunkWidth * (rect->ymin - this->m_rect.ymin) + rect->xmin - this->m_rect.xmin) * this->m_num_channels;
+	const size_t end = (this->m_chunkWidth * (rect->ymax - 1 - this->m_rect.ymin) + rect->xmax - this->m_rect.xmin) * this->m_num_channels;
+
+	if (end > start) {
+		MemoryBudget::release(this->m_buffer, start * sizeof(float), (end - start) * sizeof(float));
+	}
+}
+
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 {
 	if (!otherBuffer) {
@@ -147,11 +203,77 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 	int offset;
 	int otherOffset;
 
+	/* both buffers store the same data type */
+	BLI_assert(this->m_num_channels == otherBuffer->m_num_channels);
 
 	for (otherY = minY; otherY < maxY; otherY++) {
-		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * this->m_num_channels;
+		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * this->m_num_channels;
+		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * this->m_num_channels * sizeof(float));
+	}
+}
+
+void MemoryBuffer::readRow(float *result, int x, int y, int num)
+{
+	if (y < this->m_rect.ymin || y >= this->m_rect.ymax) {
+		memset(result, 0, sizeof(float) * num * COM_NUMBER_OF_CHANNELS);
+		return;
+	}
+
+	/* clip the span against the buffer, the parts outside are zeroed */
+	const int x1 = max_ii(x, this->m_rect.xmin);
+	const int x2 = min_ii(x + num, this->m_rect.xmax);
+
+	if (x2 <= x1) {
+		memset(result, 0, sizeof(float) * num * COM_NUMBER_OF_CHANNELS);
+		return;
+	}
+
+	if (x1 > x) {
+		memset(result, 0, sizeof(float) * (x1 - x) * COM_NUMBER_OF_CHANNELS);
+	}
+
+	const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x1 - this->m_rect.xmin) * this->m_num_channels;
+
+	if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+		memcpy(&result[(x1 - x) * COM_NUMBER_OF_CHANNELS], &this->m_buffer[offset], sizeof(float) * (x2 - x1) * COM_NUMBER_OF_CHANNELS);
+	}
+	else {
+		const float *pixel = &this->m_buffer[offset];
+		float *output = &result[(x1 - x) * COM_NUMBER_OF_CHANNELS];
+
+		for (int i = x1; i < x2; i++, pixel += this->m_num_channels, output += COM_NUMBER_OF_CHANNELS) {
+			readPixel(output, pixel);
+		}
+	}
+
+	if (x2 < x + num) {
+		memset(&result[(x2 - x) * COM_NUMBER_OF_CHANNELS], 0, sizeof(float) * (x + num - x2) * COM_NUMBER_OF_CHANNELS);
+	}
+}
+
+void MemoryBuffer::writeRow(const float *row, int x, int y, int num)
+{
+	BLI_assert(x >= this->m_rect.xmin && x + num <= this->m_rect.xmax &&
+	           y >= this->m_rect.ymin && y < this->m_rect.ymax);
+
+	const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+	float *pixel = &this->m_buffer[offset];
+
+	switch (this->m_num_channels) {
+		case 1:
+			for (int i = 0; i < num; i++, row += COM_NUMBER_OF_CHANNELS) {
+				pixel[i] = row[0];
+			}
+			break;
+		case 3:
+			for (int i = 0; i < num; i++, pixel += 3, row += COM_NUMBER_OF_CHANNELS) {
+				copy_v3_v3(pixel, row);
+			}
+			break;
+		default:
+			memcpy(pixel, row, sizeof(float) * num * COM_NUMBER_OF_CHANNELS);
+			break;
 	}
 }
 
@@ -160,8 +282,8 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		copy_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
 	}
 }
 
@@ -170,8 +292,11 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		add_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		float *pixel = &this->m_buffer[offset];
+		for (unsigned int i = 0; i < this->m_num_channels; i++) {
+			pixel[i] += color[i];
+		}
 	}
 }
 
@@ -62,6 +62,11 @@ private:
 	 * @brief the type of buffer COM_DT_VALUE, COM_DT_VECTOR, COM_DT_COLOR
 	 */
 	DataType m_datatype;
+
+	/**
+	 * @brief number of floats stored per pixel, determined by the datatype
+	 */
+	unsigned int m_num_channels;
 	
 	
 	/**
@@ -90,9 +95,15 @@ private:
 	 */
 	float *m_buffer;
 
+	/**
+	 * @brief the buffer is a scratch file, see MemoryBudget
+	 */
+	bool m_spilled;
+
 public:
 	/**
 	 * @brief construct new MemoryBuffer for a chunk
+	 * @note the buffer is allocated by the MemoryBudget
 	 */
 	MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, rcti *rect);
 	
@@ -100,6 +111,11 @@ public:
 	 * @brief construct new temporarily MemoryBuffer for an area
 	 */
 	MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect);
+
+	/**
+	 * @brief construct new temporarily MemoryBuffer for an area, not related to a MemoryProxy
+	 */
+	MemoryBuffer(DataType datatype, rcti *rect);
 	
 	/**
 	 * @brief destructor
@@ -116,6 +132,22 @@ public:
 	 * @note buffer should already be available in memory
 	 */
 	float *getBuffer() { return this->m_buffer; }
+
+	/**
+	 * @brief get the type of data in this MemoryBuffer
+	 */
+	DataType getDataType() const { return this->m_datatype; }
+
+	/**
+	 * @brief get the number of floats per pixel in the buffer, pixels in getBuffer() are this far apart
+	 * @note read methods always return COM_NUMBER_OF_CHANNELS floats, missing channels are zero
+	 */
+	unsigned int getNumberOfChannels() const { return this->m_num_channels; }
+
+	/**
+	 * @brief number of floats per pixel for a datatype
+	 */
+	static unsigned int determineNumberOfChannels(DataType datatype);
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -125,6 +157,26 @@ public:
 		this->m_state = COM_MB_AVAILABLE;
 	}
 	
+	/**
+	 * @brief copy a stored pixel to a COM_NUMBER_OF_CHANNELS result
+	 */
+	inline void readPixel(float result[4], const float *pixel) const
+	{
+		switch (this->m_num_channels) {
+			case 1:
+				result[0] = pixel[0];
+				result[1] = result[2] = result[3] = 0.0f;
+				break;
+			case 3:
+				copy_v3_v3(result, pixel);
+				result[3] = 0.0f;
+				break;
+			default:
+				copy_v4_v4(result, pixel);
+				break;
+		}
+	}
+
 	inline void read(float result[4], int x, int y)
 	{
 		if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
@@ -132,8 +184,8 @@ public:
 		{
 			const int dx = x - this->m_rect.xmin;
 			const int dy = y - this->m_rect.ymin;
-			const int offset = (this->m_chunkWidth * dy + dx) * COM_NUMBER_OF_CHANNELS;
-			copy_v4_v4(result, &this->m_buffer[offset]);
+			const int offset = (this->m_chunkWidth * dy + dx) * this->m_num_channels;
+			readPixel(result, &this->m_buffer[offset]);
 		}
 		else {
 			zero_v4(result);
@@ -144,22 +196,32 @@ public:
 	{
 		const int dx = x - this->m_rect.xmin;
 		const int dy = y - this->m_rect.ymin;
-		const int offset = (this->m_chunkWidth * dy + dx) * COM_NUMBER_OF_CHANNELS;
+		const int offset = (this->m_chunkWidth * dy + dx) * this->m_num_channels;
 
 		BLI_assert(offset >= 0);
-		BLI_assert(offset < this->determineBufferSize() * COM_NUMBER_OF_CHANNELS);
+		BLI_assert(offset < this->determineBufferSize() * this->m_num_channels);
 		BLI_assert(x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 		           y >= this->m_rect.ymin && y < this->m_rect.ymax);
 
 #if 0
 		/* always true */
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
-		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
+		           (int)(this->determineBufferSize() * this->m_num_channels));
 #endif
 
-		copy_v4_v4(result, &this->m_buffer[offset]);
+		readPixel(result, &this->m_buffer[offset]);
 	}
 	
+	/**
+	 * @brief read num pixels of row y starting at x, pixels outside of the buffer are black transparent
+	 */
+	void readRow(float *result, int x, int y, int num);
+
+	/**
+	 * @brief write num pixels of COM_NUMBER_OF_CHANNELS floats to row y starting at x, must be inside the buffer
+	 */
+	void writeRow(const float *row, int x, int y, int num);
+
 	void writePixel(int x, int y, const float color[4]);
 	void addPixel(int x, int y, const float color[4]);
 	inline void readCubic(float result[4], float x, float y)
@@ -204,6 +266,12 @@ public:
 
 	void readEWA(float result[4], float fx, float fy, float dx, float dy, PixelSampler sampler);
 	
+	/**
+	 * @brief write an area of a buffer in a scratch file to disk and release it from memory
+	 * @note does nothing for buffers in memory
+	 */
+	void releaseArea(rcti *rect);
+
 	/**
 	 * @brief is this MemoryBuffer a temporarily buffer (based on an area, not on a chunk)
 	 */
@@ -42,6 +42,7 @@
 Node::Node(bNode *editorNode, bool create_sockets): NodeBase()
 {
 	setbNode(editorNode);
+	this->m_inChangedGroup = false;
 	
 	if (create_sockets) {
 		bNodeSocket *input = (bNodeSocket *)editorNode->inputs.first;
@@ -54,6 +54,11 @@ private:
 	 */
 	bool m_inActiveGroup;
 
+	/**
+	 * @brief Nodes of the group were tagged for execution, see localize in node_composite_tree.c
+	 */
+	bool m_inChangedGroup;
+
 	/**
 	 * @brief Instance key to identify the node in an instance hash table
 	 */
@@ -76,6 +81,13 @@ public:
 	 */
 	inline bool isInActiveGroup() { return this->m_inActiveGroup; }
 
+	/**
+	 * @brief Is this node in a group of which nodes were tagged for execution
+	 * the tags of the nodes inside groups are moved to the group node of the main tree when it is localized
+	 */
+	void setIsInChangedGroup(bool value) { this->m_inChangedGroup = value; }
+	inline bool isInChangedGroup() { return this->m_inChangedGroup; }
+
 	/**
 	 * @brief convert node to operation
 	 *
@@ -96,6 +96,11 @@ public:
 
 	cl_command_queue getQueue() { return this->m_queue; }
 
+	/**
+	 * @brief determine the image format matching the number of channels of a MemoryBuffer
+	 */
+	static const cl_image_format *determineImageFormat(MemoryBuffer *memoryBuffer);
+
 	cl_mem COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel, int parameterIndex, int offsetIndex, list<cl_mem> *cleanup, MemoryBuffer **inputMemoryBuffers, SocketReader *reader);
 	cl_mem COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel, int parameterIndex, int offsetIndex, list<cl_mem> *cleanup, MemoryBuffer **inputMemoryBuffers, ReadBufferOperation *reader);
 	void COM_clAttachMemoryBufferOffsetToKernelParameter(cl_kernel kernel, int offsetIndex, MemoryBuffer *memoryBuffers);
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <typeinfo>
+#include <vector>
+
+#include "COM_Profiler.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_MemoryBudget.h"
+#include "COM_Node.h"
+#include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
+
+extern "C" {
+#  include "BLI_fileops.h"
+#  include "BLI_path_util.h"
+#  include "BLI_threads.h"
+#  include "BKE_global.h"
+#  include "DNA_node_types.h"
+#  include "PIL_time.h"
+}
+
+using namespace std;
+
+typedef struct ProfilerChunk {
+	ExecutionGroup *group;
+	unsigned int chunkNumber;
+	double startTime;
+	double endTime;
+	int thread;
+} ProfilerChunk;
+
+static bool s_active = false;
+static bool s_writeReport = false;
+static double s_startTime = 0.0;
+static ThreadMutex s_chunksMutex = BLI_MUTEX_INITIALIZER;
+static vector<ProfilerChunk> s_chunks;
+
+/* the operation the time of a group is attributed to */
+static NodeOperation *profiler_group_operation(ExecutionGroup *group)
+{
+	NodeOperation *operation = group->getOutputNodeOperation();
+	if (operation->isWriteBufferOperation()) {
+		operation = ((WriteBufferOperation *)operation)->getInput();
+	}
+	return operation;
+}
+
+static void profiler_write_string(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\') {
+			fprintf(file, "\\%c", *str);
+		}
+		else if ((unsigned char)*str < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned char)*str);
+		}
+		else {
+			fputc(*str, file);
+		}
+	}
+	fputc('"', file);
+}
+
+static const char *profiler_node_name(NodeOperation *operation)
+{
+	bNode *node = operation->getbNode();
+	return node ? node->name : "";
+}
+
+static void profiler_write_report(ExecutionSystem *system, const char *filepath, double time)
+{
+	vector<ExecutionGroup *> &groups = system->getExecutionGroups();
+	FILE *file = BLI_fopen(filepath, "w");
+	size_t peakMemory, peakSpilled;
+	unsigned int index;
+	bool first = true;
+
+	if (file == NULL) {
+		printf("Compositor: could not write the profile to %s\n", filepath);
+		return;
+	}
+
+	MemoryBudget::getPeak(&peakMemory, &peakSpilled);
+
+	fprintf(file, "{\n\t\"tree\": ");
+	profiler_write_string(file, system->getContext().getbNodeTree()->id.name + 2);
+	fprintf(file, ",\n\t\"rendering\": %s,\n", system->getContext().isRendering() ? "true" : "false");
+	fprintf(file, "\t\"time\": %f,\n", time);
+	fprintf(file, "\t\"buffers_peak_memory\": %lu,\n", (unsigned long)peakMemory);
+	fprintf(file, "\t\"buffers_peak_scratch_files\": %lu,\n", (unsigned long)peakSpilled);
+	fprintf(file, "\t\"groups\": [");
+
+	for (index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		NodeOperation *operation = profiler_group_operation(group);
+		NodeOperation *outputOperation = group->getOutputNodeOperation();
+		const vector<NodeOperation *> &operations = group->getOperations();
+		unsigned long bufferBytes = 0;
+
+		if (group->getNumberOfChunksFinished() == 0) {
+			continue;
+		}
+
+		if (outputOperation->isWriteBufferOperation()) {
+			MemoryBuffer *buffer = ((WriteBufferOperation *)outputOperation)->getMemoryProxy()->getBuffer();
+			if (buffer) {
+				bufferBytes = (unsigned long)buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels() * sizeof(float);
+			}
+		}
+
+		fprintf(file, "%s\n\t\t{\n\t\t\t\"operation\": ", first ? "" : ",");
+		profiler_write_string(file, typeid(*operation).name());
+		fprintf(file, ",\n\t\t\t\"node\": ");
+		profiler_write_string(file, profiler_node_name(operation));
+		fprintf(file, ",\n\t\t\t\"complex\": %s,\n", group->isComplex() ? "true" : "false");
+		fprintf(file, "\t\t\t\"chunks\": %u,\n", group->getNumberOfChunksFinished());
+		fprintf(file, "\t\t\t\"pixels\": %.0f,\n", group->getPixelsComputed());
+		fprintf(file, "\t\t\t\"compute_time\": %f,\n", group->getComputeTime());
+		fprintf(file, "\t\t\t\"wait_time\": %f,\n", group->getQueueWaitTime());
+		fprintf(file, "\t\t\t\"area_of_interest_inflation\": %f,\n", group->getAreaOfInterestInflation());
+		fprintf(file, "\t\t\t\"buffer_bytes\": %lu,\n", bufferBytes);
+		fprintf(file, "\t\t\t\"operations\": [");
+
+		for (unsigned int i = 0; i < operations.size(); i++) {
+			fprintf(file, "%s\n\t\t\t\t{\"operation\": ", i == 0 ? "" : ",");
+			profiler_write_string(file, typeid(*operations[i]).name());
+			fprintf(file, ", \"node\": ");
+			profiler_write_string(file, profiler_node_name(operations[i]));
+			fprintf(file, ", \"width\": %u, \"height\": %u}", operations[i]->getWidth(), operations[i]->getHeight());
+		}
+
+		fprintf(file, "\n\t\t\t]\n\t\t}");
+		first = false;
+	}
+
+	fprintf(file, "\n\t]\n}\n");
+	fclose(file);
+}
+
+/* chrome://tracing, times in microseconds */
+static void profiler_write_trace(const char *filepath)
+{
+	FILE *file = BLI_fopen(filepath, "w");
+	unsigned int index;
+
+	if (file == NULL) {
+		printf("Compositor: could not write the trace to %s\n", filepath);
+		return;
+	}
+
+	fprintf(file, "{\"traceEvents\": [");
+	for (index = 0; index < s_chunks.size(); index++) {
+		const ProfilerChunk &chunk = s_chunks[index];
+		NodeOperation *operation = profiler_group_operation(chunk.group);
+		const char *nodeName = profiler_node_name(operation);
+
+		fprintf(file, "%s\n{\"name\": ", index == 0 ? "" : ",");
+		profiler_write_string(file, nodeName[0] ? nodeName : typeid(*operation).name());
+		fprintf(file, ", \"cat\": ");
+		profiler_write_string(file, typeid(*operation).name());
+		fprintf(file, ", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.1f, \"dur\": %.1f, \"args\": {\"chunk\": %u}}",
+		        chunk.thread + 1,
+		        (chunk.startTime - s_startTime) * 1000000.0,
+		        (chunk.endTime - chunk.startTime) * 1000000.0,
+		        chunk.chunkNumber);
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+}
+
+void Profiler::start(ExecutionSystem *system)
+{
+	const bNodeTree *tree = system->getContext().getbNodeTree();
+	vector<Node *> &nodes = system->getNodes();
+	unsigned int index;
+
+	s_writeReport = (G.debug & G_DEBUG_COMPOSITOR) != 0;
+	s_active = s_writeReport || (tree->flag & NTREE_COM_PROFILE);
+
+	if (!s_active) {
+		return;
+	}
+
+	s_startTime = PIL_check_seconds_timer();
+	s_chunks.clear();
+
+	for (index = 0; index < nodes.size(); index++) {
+		bNode *node = nodes[index]->getbNode();
+		if (node) {
+			node->exec_time = 0.0f;
+		}
+	}
+}
+
+void Profiler::stop(ExecutionSystem *system)
+{
+	vector<ExecutionGroup *> &groups = system->getExecutionGroups();
+	unsigned int index;
+
+	if (!s_active) {
+		return;
+	}
+
+	for (index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		bNode *node = profiler_group_operation(group)->getbNode();
+		if (node) {
+			node->exec_time += group->getComputeTime();
+		}
+	}
+
+	if (s_writeReport) {
+		char filepath[FILE_MAX];
+		double time = PIL_check_seconds_timer() - s_startTime;
+
+		BLI_make_file_string("/", filepath, BLI_temporary_dir(), "compositor_profile.json");
+		profiler_write_report(system, filepath, time);
+		printf("Compositor: profile written to %s", filepath);
+
+		BLI_make_file_string("/", filepath, BLI_temporary_dir(), "compositor_trace.json");
+		profiler_write_trace(filepath);
+		printf(", trace to %s\n", filepath);
+	}
+
+	s_chunks.clear();
+	s_active = false;
+}
+
+bool Profiler::isActive()
+{
+	return s_active;
+}
+
+void Profiler::addChunk(ExecutionGroup *group, unsigned int chunkNumber, double startTime, double endTime)
+{
+	ProfilerChunk chunk;
+
+	if (!s_writeReport) {
+		return;
+	}
+
+	chunk.group = group;
+	chunk.chunkNumber = chunkNumber;
+	chunk.startTime = startTime;
+	chunk.endTime = endTime;
+	chunk.thread = WorkScheduler::getCurrentThreadIndex();
+
+	BLI_mutex_lock(&s_chunksMutex);
+	s_chunks.push_back(chunk);
+	BLI_mutex_unlock(&s_chunksMutex);
+}
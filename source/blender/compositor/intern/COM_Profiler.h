@@ -0,0 +1,63 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_Profiler_h_
+#define _COM_Profiler_h_
+
+class ExecutionGroup;
+class ExecutionSystem;
+
+/**
+ * @brief records where the time of an execution goes
+ *
+ * The operations of an ExecutionGroup are calculated together, a chunk at a time, so the time
+ * is measured per group. It is attributed to the operation the group writes a buffer for, or to
+ * the output operation of the group. Operations that are calculated inside the chunks of another
+ * group, like most color operations, are part of the time of that group.
+ *
+ * When the node tree has NTREE_COM_PROFILE set, the time of every group is added to bNode.exec_time
+ * of its node, which the node editor shows above the node. With --debug-compositor a JSON report
+ * of the groups (time, pixels, area of interest inflation and buffer size) and a trace of all
+ * chunks for chrome://tracing are written to the temporary directory after every execution.
+ * @ingroup Execution
+ */
+class Profiler {
+public:
+	/**
+	 * @brief start recording an execution when the node tree or --debug-compositor asks for it
+	 */
+	static void start(ExecutionSystem *system);
+
+	/**
+	 * @brief end of an execution, sets the node times and writes the report and the trace
+	 */
+	static void stop(ExecutionSystem *system);
+
+	/**
+	 * @brief is an execution being recorded
+	 */
+	static bool isActive();
+
+	/**
+	 * @brief record a calculated chunk for the trace
+	 * @note thread safe, called by the devices
+	 */
+	static void addChunk(ExecutionGroup *group, unsigned int chunkNumber, double startTime, double endTime);
+};
+
+#endif
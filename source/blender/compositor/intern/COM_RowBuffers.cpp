@@ -0,0 +1,107 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <vector>
+
+#include "COM_RowBuffers.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+}
+
+using namespace std;
+
+typedef struct RowBufferStack {
+	vector<float *> buffers;
+	unsigned int used;
+} RowBufferStack;
+
+static pthread_key_t s_stackKey;
+static pthread_once_t s_stackKeyOnce = PTHREAD_ONCE_INIT;
+
+static void rowbuffers_free_stack(void *stack_v)
+{
+	RowBufferStack *stack = (RowBufferStack *)stack_v;
+
+	BLI_assert(stack->used == 0);
+
+	for (unsigned int i = 0; i < stack->buffers.size(); i++) {
+		MEM_freeN(stack->buffers[i]);
+	}
+	delete stack;
+}
+
+static void rowbuffers_create_key()
+{
+	pthread_key_create(&s_stackKey, rowbuffers_free_stack);
+}
+
+static RowBufferStack *rowbuffers_thread_stack()
+{
+	RowBufferStack *stack;
+
+	pthread_once(&s_stackKeyOnce, rowbuffers_create_key);
+	stack = (RowBufferStack *)pthread_getspecific(s_stackKey);
+
+	if (stack == NULL) {
+		stack = new RowBufferStack();
+		stack->used = 0;
+		pthread_setspecific(s_stackKey, stack);
+	}
+
+	return stack;
+}
+
+RowBuffers::RowBuffers(unsigned int num)
+{
+	BLI_assert(num <= COM_MAX_ROW_BUFFERS);
+
+	this->m_stack = rowbuffers_thread_stack();
+	this->m_num = num;
+
+	for (unsigned int i = 0; i < num; i++) {
+		RowBufferStack *stack = this->m_stack;
+
+		if (stack->used == stack->buffers.size()) {
+			stack->buffers.push_back((float *)MEM_mallocN(sizeof(float) * COM_ROW_BLOCK_SIZE * COM_NUMBER_OF_CHANNELS,
+			                                              "row buffer"));
+		}
+		this->m_buffers[i] = stack->buffers[stack->used++];
+	}
+}
+
+RowBuffers::~RowBuffers()
+{
+	this->m_stack->used -= this->m_num;
+}
+
+void RowBuffers::freeThreadBuffers()
+{
+	RowBufferStack *stack;
+
+	pthread_once(&s_stackKeyOnce, rowbuffers_create_key);
+	stack = (RowBufferStack *)pthread_getspecific(s_stackKey);
+
+	if (stack) {
+		rowbuffers_free_stack(stack);
+		pthread_setspecific(s_stackKey, NULL);
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_RowBuffers_h_
+#define _COM_RowBuffers_h_
+
+#include "COM_defines.h"
+
+/**
+ * @brief maximum number of buffers of a RowBuffers
+ */
+#define COM_MAX_ROW_BUFFERS 4
+
+struct RowBufferStack;
+
+/**
+ * @brief input buffers of SocketReader.executeRow
+ *
+ * executeRow reads its inputs with readRow, which calls executeRow of the input operations,
+ * so a chain of row operations nests as deep as it is long. The row buffers are taken from a
+ * stack on the heap of the calling thread instead of the call stack, which would overflow in
+ * long chains. The buffers are kept for the next rows and freed when the thread exits.
+ *
+ * The buffers are given back by the destructor, so they must be a local variable:
+ * @code
+ * RowBuffers buffers(2);
+ * this->m_inputOperation->readRow(buffers[0], x, y, num);
+ * @endcode
+ * @ingroup Memory
+ */
+class RowBuffers {
+private:
+	struct RowBufferStack *m_stack;
+	float *m_buffers[COM_MAX_ROW_BUFFERS];
+	unsigned int m_num;
+
+public:
+	/**
+	 * @brief take num buffers of COM_ROW_BLOCK_SIZE * COM_NUMBER_OF_CHANNELS floats
+	 */
+	RowBuffers(unsigned int num);
+	~RowBuffers();
+
+	inline float *operator[](unsigned int index) const { return this->m_buffers[index]; }
+
+	/**
+	 * @brief free the buffers of the calling thread, for threads that don't exit
+	 */
+	static void freeThreadBuffers();
+};
+
+#endif
@@ -90,6 +90,23 @@ protected:
 	 */
 	virtual void executePixel(float output[4], float x, float y, float dx, float dy, PixelSampler sampler) {}
 
+	/**
+	 * @brief calculate a row of pixels
+	 * @note this method is called for non-complex, with nearest sampling.
+	 * Operations can implement this to process a contiguous span of pixels at once, the
+	 * default implementation calls executePixel for every pixel. The rows of the inputs are
+	 * read into RowBuffers, this method is called recursively for every row operation before it.
+	 * @param output is a float array of num * COM_NUMBER_OF_CHANNELS to store the result
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the row to calculate in image space
+	 * @param num the number of pixels to calculate, never more than COM_ROW_BLOCK_SIZE
+	 */
+	virtual void executeRow(float *output, int x, int y, int num) {
+		for (int i = 0; i < num; i++) {
+			executePixel(output + i * COM_NUMBER_OF_CHANNELS, (float)(x + i), (float)y, COM_PS_NEAREST);
+		}
+	}
+
 public:
 	inline void read(float *result, float x, float y, PixelSampler sampler) {
 		executePixel(result, x, y, sampler);
@@ -101,6 +118,20 @@ public:
 		executePixel(result, x, y, dx, dy, sampler);
 	}
 
+	/**
+	 * @brief read a row of pixels, in blocks of at most COM_ROW_BLOCK_SIZE
+	 * @see executeRow
+	 */
+	inline void readRow(float *result, int x, int y, int num) {
+		while (num > 0) {
+			int block = (num < COM_ROW_BLOCK_SIZE) ? num : COM_ROW_BLOCK_SIZE;
+			executeRow(result, x, y, block);
+			result += block * COM_NUMBER_OF_CHANNELS;
+			x += block;
+			num -= block;
+		}
+	}
+
 	virtual void *initializeTileData(rcti *rect) { return 0; }
 	virtual void deinitializeTileData(rcti *rect, void *data) {
 	}
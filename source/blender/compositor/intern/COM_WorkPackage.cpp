@@ -26,4 +26,19 @@ WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber)
 {
 	this->m_executionGroup = group;
 	this->m_chunkNumber = chunkNumber;
+	this->m_numberOfPendingInputs = 0;
+	this->m_scheduleTime = 0.0;
+	this->m_executionStartTime = 0.0;
 }
+
+void WorkPackage::finishDependents(vector<WorkPackage *> *readyPackages)
+{
+	for (unsigned int index = 0; index < this->m_dependents.size(); index++) {
+		WorkPackage *dependent = this->m_dependents[index];
+		if (--dependent->m_numberOfPendingInputs == 0) {
+			readyPackages->push_back(dependent);
+		}
+	}
+	this->m_dependents.clear();
+}
+
@@ -25,10 +25,19 @@ class WorkPackage;
 #ifndef _COM_WorkPackage_h_
 #define _COM_WorkPackage_h_
 class ExecutionGroup;
+#include <vector>
 #include "COM_ExecutionGroup.h"
 
+using namespace std;
+
 /**
  * @brief contains data about work that can be scheduled
+ *
+ * An ExecutionGroup has a WorkPackage for every chunk, they are created once in
+ * ExecutionGroup.initExecution and reused by the WorkScheduler.
+ *
+ * The WorkPackage also holds the dependencies of the chunk: the number of chunks of
+ * other groups it is waiting for, and the chunks that are waiting for this chunk.
  * @see WorkScheduler
  */
 class WorkPackage {
@@ -42,6 +51,26 @@ private:
 	 * @brief number of the chunk to be executed
 	 */
 	unsigned int m_chunkNumber;
+
+	/**
+	 * @brief number of input chunks that are not executed yet
+	 */
+	unsigned int m_numberOfPendingInputs;
+
+	/**
+	 * @brief work packages that are waiting for this chunk to be executed
+	 */
+	vector<WorkPackage *> m_dependents;
+
+	/**
+	 * @brief time the package was added to the WorkScheduler
+	 */
+	double m_scheduleTime;
+
+	/**
+	 * @brief time a device started executing the package
+	 */
+	double m_executionStartTime;
 public:
 	/**
 	 * constructor
@@ -60,6 +89,27 @@ public:
 	 */
 	unsigned int getChunkNumber() const { return this->m_chunkNumber; }
 
+	/**
+	 * @brief let a work package wait for this package to be executed
+	 */
+	void addDependent(WorkPackage *dependent) {
+		this->m_dependents.push_back(dependent);
+		dependent->m_numberOfPendingInputs++;
+	}
+
+	/**
+	 * @brief mark the package as executed for its dependents
+	 * @param readyPackages the dependents that are not waiting for other packages anymore are added to this list
+	 */
+	void finishDependents(vector<WorkPackage *> *readyPackages);
+
+	unsigned int getNumberOfPendingInputs() const { return this->m_numberOfPendingInputs; }
+
+	void setScheduleTime(double time) { this->m_scheduleTime = time; }
+	double getScheduleTime() const { return this->m_scheduleTime; }
+	void setExecutionStartTime(double time) { this->m_executionStartTime = time; }
+	double getExecutionStartTime() const { return this->m_executionStartTime; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
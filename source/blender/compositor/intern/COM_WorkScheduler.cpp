@@ -20,6 +20,7 @@
  *		Monique Dewanchand
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
 
@@ -30,6 +31,7 @@
 #include "COM_OpenCLKernels.cl.h"
 #include "OCL_opencl.h"
 #include "COM_WriteBufferOperation.h"
+#include "COM_RowBuffers.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -53,11 +55,39 @@
 static vector<CPUDevice *> g_cpudevices;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+/**
+ * @brief work of a single CPU thread
+ * the thread takes the most recent work from the back, so the chunks that become ready
+ * after executing a chunk are executed next by the same thread. idle threads steal the
+ * oldest work from the front of the deques of other threads.
+ */
+typedef struct CPUThreadQueue {
+	SpinLock lock;
+	deque<WorkPackage *> packages;
+	CPUDevice *device;
+	unsigned int index;
+	unsigned int numberOfStolen;
+} CPUThreadQueue;
+
 /// @brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// @brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/// @brief the work deque of every CPU thread, in the same order as g_cpudevices
+static vector<CPUThreadQueue *> g_cpuqueues;
+/// @brief the work deque of the calling CPU thread, NULL for other threads
+static pthread_key_t g_cpuqueuekey;
+/// @brief deque to add work to when scheduled from outside the CPU threads
+static unsigned int g_cpuqueueNext;
+/// @brief protects the fields below
+static ThreadMutex g_schedulerMutex;
+/// @brief idle CPU threads wait for new work or stopping
+static ThreadCondition g_cpuCondition;
+/// @brief increased every time work is added to a deque
+static unsigned int g_cpuWorkGeneration;
+static bool g_cpuStopping;
+/// @brief WorkScheduler.finish waits until all scheduled work is executed
+static ThreadCondition g_finishCondition;
+static unsigned int g_numberOfPending;
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -139,17 +169,109 @@ int COM_isHighlightedbNode(bNode *bnode)
 } // end extern "C"
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static void cpu_queue_push(WorkPackage *package)
+{
+	CPUThreadQueue *queue = (CPUThreadQueue *)pthread_getspecific(g_cpuqueuekey);
+
+	if (queue == NULL) {
+		/* scheduled from the main thread or an OpenCL thread, spread the work over the deques */
+		BLI_mutex_lock(&g_schedulerMutex);
+		queue = g_cpuqueues[g_cpuqueueNext++ % g_cpuqueues.size()];
+		BLI_mutex_unlock(&g_schedulerMutex);
+	}
+
+	BLI_spin_lock(&queue->lock);
+	queue->packages.push_back(package);
+	BLI_spin_unlock(&queue->lock);
+
+	BLI_mutex_lock(&g_schedulerMutex);
+	g_cpuWorkGeneration++;
+	BLI_condition_notify_one(&g_cpuCondition);
+	BLI_mutex_unlock(&g_schedulerMutex);
+}
+
+static WorkPackage *cpu_queue_take(CPUThreadQueue *queue)
+{
+	WorkPackage *package = NULL;
+	unsigned int index;
+
+	/* own work, most recent first */
+	BLI_spin_lock(&queue->lock);
+	if (!queue->packages.empty()) {
+		package = queue->packages.back();
+		queue->packages.pop_back();
+	}
+	BLI_spin_unlock(&queue->lock);
+
+	/* steal the oldest work of other threads */
+	for (index = 1; package == NULL && index < g_cpuqueues.size(); index++) {
+		CPUThreadQueue *victim = g_cpuqueues[(queue->index + index) % g_cpuqueues.size()];
+
+		BLI_spin_lock(&victim->lock);
+		if (!victim->packages.empty()) {
+			package = victim->packages.front();
+			victim->packages.pop_front();
+			victim->numberOfStolen++;
+		}
+		BLI_spin_unlock(&victim->lock);
+	}
+
+	return package;
+}
+
+static void work_package_executed()
+{
+	BLI_mutex_lock(&g_schedulerMutex);
+	if (--g_numberOfPending == 0) {
+		BLI_condition_notify_all(&g_finishCondition);
+	}
+	BLI_mutex_unlock(&g_schedulerMutex);
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
-	Device *device = (Device *)data;
+	CPUThreadQueue *queue = (CPUThreadQueue *)data;
+	Device *device = queue->device;
 	WorkPackage *work;
-	
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+
+	pthread_setspecific(g_cpuqueuekey, queue);
+
+	while (true) {
+		work = cpu_queue_take(queue);
+
+		if (work == NULL) {
+			/* no work found, sleep until work is added after the deques were checked */
+			BLI_mutex_lock(&g_schedulerMutex);
+			unsigned int generation = g_cpuWorkGeneration;
+			BLI_mutex_unlock(&g_schedulerMutex);
+
+			work = cpu_queue_take(queue);
+
+			if (work == NULL) {
+				bool stopping;
+
+				BLI_mutex_lock(&g_schedulerMutex);
+				while (generation == g_cpuWorkGeneration && !g_cpuStopping) {
+					BLI_condition_wait(&g_cpuCondition, &g_schedulerMutex);
+				}
+				stopping = (generation == g_cpuWorkGeneration);
+				BLI_mutex_unlock(&g_schedulerMutex);
+
+				if (stopping) {
+					break;
+				}
+				continue;
+			}
+		}
+
 		HIGHLIGHT(work);
+		work->setExecutionStartTime(PIL_check_seconds_timer());
 		device->execute(work);
-		delete work;
+		work_package_executed();
 	}
-	
+
+	pthread_setspecific(g_cpuqueuekey, NULL);
+
 	return NULL;
 }
 
@@ -160,8 +282,9 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 	
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
 		HIGHLIGHT(work);
+		work->setExecutionStartTime(PIL_check_seconds_timer());
 		device->execute(work);
-		delete work;
+		work_package_executed();
 	}
 	
 	return NULL;
@@ -170,23 +293,27 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 
 
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+void WorkScheduler::schedule(WorkPackage *package)
 {
-	WorkPackage *package = new WorkPackage(group, chunkNumber);
+	package->setScheduleTime(PIL_check_seconds_timer());
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
 	CPUDevice device;
+	package->setExecutionStartTime(PIL_check_seconds_timer());
 	device.execute(package);
-	delete package;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_schedulerMutex);
+	g_numberOfPending++;
+	BLI_mutex_unlock(&g_schedulerMutex);
+
 #ifdef COM_OPENCL_ENABLED
-	if (group->isOpenCL() && g_openclActive) {
+	if (package->getExecutionGroup()->isOpenCL() && g_openclActive) {
 		BLI_thread_queue_push(g_gpuqueue, package);
 	}
 	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
+		cpu_queue_push(package);
 	}
 #else
-	BLI_thread_queue_push(cpuqueue, package);
+	cpu_queue_push(package);
 #endif
 #endif
 }
@@ -195,11 +322,13 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
-	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
-	for (index = 0; index < g_cpudevices.size(); index++) {
-		Device *device = g_cpudevices[index];
-		BLI_insert_thread(&g_cputhreads, device);
+	g_cpuStopping = false;
+	g_numberOfPending = 0;
+	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpuqueues.size());
+	for (index = 0; index < g_cpuqueues.size(); index++) {
+		CPUThreadQueue *queue = g_cpuqueues[index];
+		queue->numberOfStolen = 0;
+		BLI_insert_thread(&g_cputhreads, queue);
 	}
 #ifdef COM_OPENCL_ENABLED
 	if (context.getHasActiveOpenCLDevices()) {
@@ -220,26 +349,30 @@ void WorkScheduler::start(CompositorContext &context)
 void WorkScheduler::finish()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#ifdef COM_OPENCL_ENABLED
-	if (g_openclActive) {
-		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
+	/* executed work can schedule more work on any device, wait for all of it */
+	BLI_mutex_lock(&g_schedulerMutex);
+	while (g_numberOfPending > 0) {
+		BLI_condition_wait(&g_finishCondition, &g_schedulerMutex);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
-#endif
+	BLI_mutex_unlock(&g_schedulerMutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
+	BLI_mutex_lock(&g_schedulerMutex);
+	g_cpuStopping = true;
+	BLI_condition_notify_all(&g_cpuCondition);
+	BLI_mutex_unlock(&g_schedulerMutex);
 	BLI_end_threads(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+
+	if (G.debug & G_DEBUG_JOBS) {
+		unsigned int numberOfStolen = 0;
+		for (unsigned int index = 0; index < g_cpuqueues.size(); index++) {
+			numberOfStolen += g_cpuqueues[index]->numberOfStolen;
+		}
+		printf("Compositor scheduler: %u work packages stolen by %d threads\n", numberOfStolen, (int)g_cpuqueues.size());
+	}
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
@@ -264,6 +397,17 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
+int WorkScheduler::getCurrentThreadIndex()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	CPUThreadQueue *queue = (CPUThreadQueue *)pthread_getspecific(g_cpuqueuekey);
+	if (queue) {
+		return queue->index;
+	}
+#endif
+	return -1;
+}
+
 static void clContextError(const char *errinfo, const void *private_info, size_t cb, void *user_data)
 {
 	printf("OPENCL error: %s\n", errinfo);
@@ -293,8 +437,22 @@ void WorkScheduler::initialize(bool use_opencl)
 			CPUDevice *device = new CPUDevice();
 			device->initialize();
 			g_cpudevices.push_back(device);
+
+			CPUThreadQueue *queue = new CPUThreadQueue();
+			BLI_spin_init(&queue->lock);
+			queue->device = device;
+			queue->index = index;
+			queue->numberOfStolen = 0;
+			g_cpuqueues.push_back(queue);
 		}
 
+		pthread_key_create(&g_cpuqueuekey, NULL);
+		BLI_mutex_init(&g_schedulerMutex);
+		BLI_condition_init(&g_cpuCondition);
+		BLI_condition_init(&g_finishCondition);
+		g_cpuqueueNext = 0;
+		g_cpuWorkGeneration = 0;
+
 		g_cpuInitialized = true;
 	}
 
@@ -368,10 +526,25 @@ void WorkScheduler::initialize(bool use_opencl)
 
 void WorkScheduler::deinitialize()
 {
+	/* the CPU threads free their row buffers when they exit, without threads the rows are calculated here */
+	RowBuffers::freeThreadBuffers();
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	/* deinitialize CPU threads */
 	if (g_cpuInitialized) {
 		Device *device;
+		while (g_cpuqueues.size() > 0) {
+			CPUThreadQueue *queue = g_cpuqueues.back();
+			g_cpuqueues.pop_back();
+			BLI_spin_end(&queue->lock);
+			delete queue;
+		}
+
+		pthread_key_delete(g_cpuqueuekey);
+		BLI_mutex_end(&g_schedulerMutex);
+		BLI_condition_end(&g_cpuCondition);
+		BLI_condition_end(&g_finishCondition);
+
 		while (g_cpudevices.size() > 0) {
 			device = g_cpudevices.back();
 			g_cpudevices.pop_back();
@@ -57,14 +57,16 @@ class WorkScheduler {
 public:
 	/**
 	 * @brief schedule a chunk of a group to be calculated.
-	 * An execution group schedules a chunk in the WorkScheduler
+	 * An execution group schedules a chunk in the WorkScheduler when all chunks it depends on are executed
 	 * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
 	 * otherwide the work is scheduled for an CPUDevice
+	 *
+	 * Every CPU thread has its own deque of work. Work scheduled from a CPU thread is added to its own
+	 * deque, other work is spread over all deques. Idle threads steal work from the other deques.
 	 * @see ExecutionGroup.execute
-	 * @param group the execution group
-	 * @param chunkNumber the number of the chunk in the group to be executed
+	 * @param package the work package of the chunk to be executed
 	 */
-	static void schedule(ExecutionGroup *group, int chunkNumber);
+	static void schedule(WorkPackage *package);
 
 	/**
 	 * @brief initialize the WorkScheduler
@@ -102,6 +104,7 @@ public:
 
 	/**
 	 * @brief wait for all work to be completed.
+	 * @note this includes work that is scheduled by executing other work
 	 */
 	static void finish();
 
@@ -113,6 +116,11 @@ public:
 	 */
 	static bool hasGPUDevices();
 
+	/**
+	 * @brief index of the CPU thread that calls this method, -1 for other threads
+	 */
+	static int getCurrentThreadIndex();
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkScheduler")
 #endif
@@ -31,15 +31,19 @@ extern "C" {
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_WorkScheduler.h"
+#include "COM_BufferCache.h"
 #include "OCL_opencl.h"
 #include "COM_MovieDistortionOperation.h"
 
 static ThreadMutex s_compositorMutex;
 static char is_compositorMutex_init = FALSE;
+/* the caches are cleared by the next execution when they are in use */
+static volatile bool s_clearCachesRequested = false;
 
 static void intern_freeCompositorCaches()
 {
 	deintializeDistortionCache();
+	BufferCache::clear();
 }
 
 void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
@@ -70,6 +74,12 @@ void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
 	float aspect = rd->xsch > 0 ? (float)rd->ysch / (float)rd->xsch : 1.0f;
 	BKE_node_preview_init_tree(editingtree, COM_PREVIEW_SIZE, (int)(COM_PREVIEW_SIZE * aspect), FALSE);
 
+	if (s_clearCachesRequested) {
+		intern_freeCompositorCaches();
+		s_clearCachesRequested = false;
+	}
+	BufferCache::startExecution();
+
 	/* initialize workscheduler, will check if already done. TODO deinitialize somewhere */
 	bool use_opencl = (editingtree->flag & NTREE_COM_OPENCL) != 0;
 	WorkScheduler::initialize(use_opencl);
@@ -78,9 +88,14 @@ void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
 	editingtree->progress(editingtree->prh, 0.0);
 
 	bool twopass = (editingtree->flag & NTREE_TWO_PASS) > 0 && !rendering;
+	bool proxy = editingtree->edit_proxy > 1 && !rendering;
 	/* initialize execution system */
-	if (twopass) {
-		ExecutionSystem *system = new ExecutionSystem(rd, editingtree, rendering, twopass, viewSettings, displaySettings);
+	if (twopass || proxy) {
+		/* a quick first pass, the full resolution pass afterwards refines it from the viewer
+		 * hotspot outwards and is skipped when the tree is edited again in the mean time */
+		float proxyScale = proxy ? 1.0f / editingtree->edit_proxy : 1.0f;
+		ExecutionSystem *system = new ExecutionSystem(rd, editingtree, rendering, twopass, proxyScale,
+		                                              viewSettings, displaySettings);
 		system->execute();
 		delete system;
 		
@@ -92,7 +107,7 @@ void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
 		}
 	}
 
-	ExecutionSystem *system = new ExecutionSystem(rd, editingtree, rendering, false,
+	ExecutionSystem *system = new ExecutionSystem(rd, editingtree, rendering, false, 1.0f,
 	                                              viewSettings, displaySettings);
 	system->execute();
 	delete system;
@@ -100,12 +115,17 @@ void COM_execute(RenderData *rd, bNodeTree *editingtree, int rendering,
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
-static void UNUSED_FUNCTION(COM_freeCaches)()
+void COM_clearCaches()
 {
 	if (is_compositorMutex_init) {
-		BLI_mutex_lock(&s_compositorMutex);
-		intern_freeCompositorCaches();
-		BLI_mutex_unlock(&s_compositorMutex);
+		/* don't wait for a running execution, the undo and file loading would block on it */
+		if (BLI_mutex_trylock(&s_compositorMutex)) {
+			intern_freeCompositorCaches();
+			BLI_mutex_unlock(&s_compositorMutex);
+		}
+		else {
+			s_clearCachesRequested = true;
+		}
 	}
 }
 
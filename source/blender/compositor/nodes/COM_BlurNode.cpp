@@ -42,6 +42,16 @@ void BlurNode::convertToOperations(ExecutionSystem *graph, CompositorContext *co
 {
 	bNode *editorNode = this->getbNode();
 	NodeBlurData *data = (NodeBlurData *)editorNode->storage;
+
+	if (context->isProxy() && !data->relative) {
+		/* the sizes are in pixels of the full resolution */
+		const float proxyScale = context->getProxyScale();
+		this->m_proxyData = *data;
+		this->m_proxyData.sizex = (short)(data->sizex * proxyScale + 0.5f);
+		this->m_proxyData.sizey = (short)(data->sizey * proxyScale + 0.5f);
+		data = &this->m_proxyData;
+	}
+
 	InputSocket *inputSizeSocket = this->getInputSocket(1);
 	bool connectedSizeSocket = inputSizeSocket->isConnected();
 
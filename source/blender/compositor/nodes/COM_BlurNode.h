@@ -24,12 +24,14 @@
 #define _COM_BlurNode_h_
 
 #include "COM_Node.h"
+#include "DNA_node_types.h"
 
 /**
  * @brief BlurNode
  * @ingroup Node
  */
 class BlurNode : public Node {
+	NodeBlurData m_proxyData; /* sizes scaled to the proxy resolution */
 public:
 	BlurNode(bNode *editorNode);
 	void convertToOperations(ExecutionSystem *graph, CompositorContext *context);
@@ -37,10 +37,13 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 {
 	
 	bNode *editorNode = this->getbNode();
+	/* distances are in pixels of the full resolution */
+	const int distance = (int)(editorNode->custom2 * context->getProxyScale() + (editorNode->custom2 < 0 ? -0.5f : 0.5f));
+
 	if (editorNode->custom1 == CMP_NODE_DILATEERODE_DISTANCE_THRESH) {
 		DilateErodeThresholdOperation *operation = new DilateErodeThresholdOperation();
 		operation->setbNode(editorNode);
-		operation->setDistance(editorNode->custom2);
+		operation->setDistance(distance);
 		operation->setInset(editorNode->custom3);
 		
 		this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
@@ -57,10 +60,10 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		graph->addOperation(operation);
 	}
 	else if (editorNode->custom1 == CMP_NODE_DILATEERODE_DISTANCE) {
-		if (editorNode->custom2 > 0) {
+		if (distance > 0) {
 			DilateDistanceOperation *operation = new DilateDistanceOperation();
 			operation->setbNode(editorNode);
-			operation->setDistance(editorNode->custom2);
+			operation->setDistance(distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -68,7 +71,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		else {
 			ErodeDistanceOperation *operation = new ErodeDistanceOperation();
 			operation->setbNode(editorNode);
-			operation->setDistance(-editorNode->custom2);
+			operation->setDistance(-distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -83,11 +86,11 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		memset(data, 0, sizeof(*data));
 		data->filtertype = R_FILTER_GAUSS;
 
-		if (editorNode->custom2 > 0) {
-			data->sizex = data->sizey = editorNode->custom2;
+		if (distance > 0) {
+			data->sizex = data->sizey = distance;
 		}
 		else {
-			data->sizex = data->sizey = -editorNode->custom2;
+			data->sizex = data->sizey = -distance;
 
 		}
 
@@ -131,10 +134,10 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		}
 	}
 	else {
-		if (editorNode->custom2 > 0) {
+		if (distance > 0) {
 			DilateStepOperation *operation = new DilateStepOperation();
 			operation->setbNode(editorNode);
-			operation->setIterations(editorNode->custom2);
+			operation->setIterations(distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -142,7 +145,7 @@ void DilateErodeNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		else {
 			ErodeStepOperation *operation = new ErodeStepOperation();
 			operation->setbNode(editorNode);
-			operation->setIterations(-editorNode->custom2);
+			operation->setIterations(-distance);
 			this->getInputSocket(0)->relinkConnections(operation->getInputSocket(0), 0, graph);
 			this->getOutputSocket(0)->relinkConnections(operation->getOutputSocket(0));
 			graph->addOperation(operation);
@@ -141,7 +141,9 @@ void GroupNode::ungroup(ExecutionSystem &system)
 		sock->clearConnections();
 	}
 	
-	ExecutionSystemHelper::addbNodeTree(system, nodes_start, subtree, this->getInstanceKey());
+	/* only the group nodes of the localized main tree carry the tags of the nodes inside */
+	bool inChangedGroup = this->getbNode()->need_exec || this->isInChangedGroup();
+	ExecutionSystemHelper::addbNodeTree(system, nodes_start, subtree, this->getInstanceKey(), inChangedGroup);
 }
 
 bNodeSocket *GroupNode::findInterfaceInput(InputSocket *socket)
@@ -57,8 +57,9 @@ void SocketProxyNode::convertToOperations(ExecutionSystem *graph, CompositorCont
 		graph->addOperation(operation);
 		
 		if (m_buffer) {
-			WriteBufferOperation *writeOperation = new WriteBufferOperation();
-			ReadBufferOperation *readOperation = new ReadBufferOperation();
+			DataType datatype = operation->getOutputSocket()->getDataType();
+			WriteBufferOperation *writeOperation = new WriteBufferOperation(datatype);
+			ReadBufferOperation *readOperation = new ReadBufferOperation(datatype);
 			readOperation->setMemoryProxy(writeOperation->getMemoryProxy());
 			
 			operation->getOutputSocket()->relinkConnections(readOperation->getOutputSocket());
@@ -33,6 +33,14 @@ void VectorBlurNode::convertToOperations(ExecutionSystem *system, CompositorCont
 {
 	bNode *node = this->getbNode();
 	NodeBlurData *vectorBlurSettings = (NodeBlurData *)node->storage;
+
+	if (context->isProxy()) {
+		/* the speed vectors are in pixels of the full resolution */
+		this->m_proxyData = *vectorBlurSettings;
+		this->m_proxyData.fac *= context->getProxyScale();
+		vectorBlurSettings = &this->m_proxyData;
+	}
+
 	VectorBlurOperation *operation = new VectorBlurOperation();
 	operation->setbNode(node);
 	operation->setVectorBlurSettings(vectorBlurSettings);
@@ -24,12 +24,14 @@
 #define _COM_VectorBlurNode_h_
 
 #include "COM_Node.h"
+#include "DNA_node_types.h"
 
 /**
  * @brief VectorBlurNode
  * @ingroup Node
  */
 class VectorBlurNode : public Node {
+	NodeBlurData m_proxyData; /* settings for the proxy resolution */
 public:
 	VectorBlurNode(bNode *editorNode);
 	void convertToOperations(ExecutionSystem *graph, CompositorContext *context);
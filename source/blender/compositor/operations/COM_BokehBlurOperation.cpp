@@ -22,10 +22,13 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 	#include "RE_pipeline.h"
+	#include "BKE_global.h"
 }
 
 BokehBlurOperation::BokehBlurOperation() : NodeOperation()
@@ -43,6 +46,7 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	this->m_convolvedBuffer = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti *rect)
@@ -51,11 +55,64 @@ void *BokehBlurOperation::initializeTileData(rcti *rect)
 	if (!this->m_sizeavailable) {
 		updateSize();
 	}
-	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	MemoryBuffer *buffer = (MemoryBuffer *)getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_convolvedBuffer == NULL && useFFTConvolution(this->m_size)) {
+		this->m_convolvedBuffer = createConvolvedBuffer(buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
 
+bool BokehBlurOperation::useFFTConvolution(float size)
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	int pixelSize = size * max_dim / 100.0f;
+
+	return (pixelSize >= COM_FFT_CONVOLUTION_MIN_RADIUS && G.debug_value != COM_DEBUG_VALUE_DIRECT_CONVOLUTION);
+}
+
+MemoryBuffer *BokehBlurOperation::createConvolvedBuffer(MemoryBuffer *inputBuffer)
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	const int pixelSize = this->m_size * max_dim / 100.0f;
+	const int kernelSize = 2 * pixelSize + 1;
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+	const float m = this->m_bokehDimension / pixelSize;
+
+	/* sample the bokeh image the same way as executePixel, which does not include the
+	 * last row and column of the kernel in its sum */
+	float *kernel = (float *)MEM_callocN(sizeof(float) * COM_NUMBER_OF_CHANNELS * kernelSize * kernelSize, __func__);
+	for (int j = 1; j < kernelSize; j++) {
+		for (int i = 1; i < kernelSize; i++) {
+			float u = this->m_bokehMidX - (pixelSize - i) * m;
+			float v = this->m_bokehMidY - (pixelSize - j) * m;
+			this->m_inputBokehProgram->read(&kernel[(j * kernelSize + i) * COM_NUMBER_OF_CHANNELS], u, v, COM_PS_NEAREST);
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	MemoryBuffer *weights = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	result->clear();
+	weights->clear();
+
+	/* divide by the sum of the weights inside of the image, like executePixel */
+	FFTConvolution convolution(kernel, kernelSize, kernelSize, COM_NUMBER_OF_CHANNELS);
+	convolution.convolve(result->getBuffer(), inputBuffer->getBuffer(), width, height, COM_NUMBER_OF_CHANNELS, COM_NUMBER_OF_CHANNELS);
+	convolution.convolve(weights->getBuffer(), NULL, width, height, COM_NUMBER_OF_CHANNELS, COM_NUMBER_OF_CHANNELS);
+
+	float *color = result->getBuffer();
+	float *weight = weights->getBuffer();
+	for (int i = 0; i < width * height * COM_NUMBER_OF_CHANNELS; i++) {
+		color[i] *= 1.0f / weight[i];
+	}
+
+	delete weights;
+	MEM_freeN(kernel);
+
+	return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -81,7 +138,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->read(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_convolvedBuffer) {
+		this->m_convolvedBuffer->readNoCheck(output, x, y);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -140,6 +200,10 @@ void BokehBlurOperation::deinitExecution()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	if (this->m_convolvedBuffer) {
+		delete this->m_convolvedBuffer;
+		this->m_convolvedBuffer = NULL;
+	}
 }
 
 bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
@@ -148,7 +212,14 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (useFFTConvolution(this->m_sizeavailable ? this->m_size : 10.0f)) {
+		/* the whole image is convolved at once */
+		newInput.xmax = this->getWidth();
+		newInput.xmin = 0;
+		newInput.ymax = this->getHeight();
+		newInput.ymin = 0;
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
@@ -37,6 +37,13 @@ private:
 	float m_bokehMidX;
 	float m_bokehMidY;
 	float m_bokehDimension;
+
+	/**
+	 * @brief the whole blurred image, when it is calculated with an FFTConvolution
+	 */
+	MemoryBuffer *m_convolvedBuffer;
+	bool useFFTConvolution(float size);
+	MemoryBuffer *createConvolvedBuffer(MemoryBuffer *inputBuffer);
 public:
 	BokehBlurOperation();
 
@@ -21,6 +21,7 @@
  */
 
 #include "COM_ConvertColorToBWOperation.h"
+#include "COM_RowBuffers.h"
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : NodeOperation()
 {
@@ -41,6 +42,19 @@ void ConvertColorToBWOperation::executePixel(float output[4], float x, float y,
 	output[0] = rgb_to_bw(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(1);
+	float *inputColor = buffers[0];
+
+	this->m_inputOperation->readRow(inputColor, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = rgb_to_bw(&inputColor[offset]);
+	}
+}
+
 void ConvertColorToBWOperation::deinitExecution()
 {
 	this->m_inputOperation = NULL;
@@ -21,6 +21,7 @@
  */
 
 #include "COM_ConvertColorToValueProg.h"
+#include "COM_RowBuffers.h"
 
 ConvertColorToValueProg::ConvertColorToValueProg() : NodeOperation()
 {
@@ -41,6 +42,19 @@ void ConvertColorToValueProg::executePixel(float output[4], float x, float y, Pi
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueProg::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(1);
+	float *inputColor = buffers[0];
+
+	this->m_inputOperation->readRow(inputColor, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = (inputColor[offset + 0] + inputColor[offset + 1] + inputColor[offset + 2]) / 3.0f;
+	}
+}
+
 void ConvertColorToValueProg::deinitExecution()
 {
 	this->m_inputOperation = NULL;
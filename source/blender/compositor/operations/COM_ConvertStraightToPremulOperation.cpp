@@ -20,8 +20,13 @@
  */
 
 #include "COM_ConvertStraightToPremulOperation.h"
+
 #include "BLI_math.h"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
@@ -49,6 +54,24 @@ void ConvertStraightToPremulOperation::executePixel(float output[4], float x, fl
 	output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeRow(float *output, int x, int y, int num)
+{
+	/* the input is read directly into the output row */
+	this->m_inputColor->readRow(output, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		const float alpha = output[offset + 3];
+#ifdef __SSE__
+		_mm_storeu_ps(&output[offset], _mm_mul_ps(_mm_loadu_ps(&output[offset]), _mm_set1_ps(alpha)));
+#else
+		mul_v3_fl(&output[offset], alpha);
+#endif
+		/* never touches the alpha */
+		output[offset + 3] = alpha;
+	}
+}
+
 void ConvertStraightToPremulOperation::deinitExecution()
 {
 	this->m_inputColor = NULL;
@@ -21,6 +21,11 @@
  */
 
 #include "COM_ConvertValueToColorProg.h"
+#include "COM_RowBuffers.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 ConvertValueToColorProg::ConvertValueToColorProg() : NodeOperation()
 {
@@ -41,6 +46,25 @@ void ConvertValueToColorProg::executePixel(float output[4], float x, float y, Pi
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorProg::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(1);
+	float *inputValue = buffers[0];
+
+	this->m_inputProgram->readRow(inputValue, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		const float value = inputValue[offset];
+#ifdef __SSE__
+		_mm_storeu_ps(&output[offset], _mm_set_ps(1.0f, value, value, value));
+#else
+		output[offset + 0] = output[offset + 1] = output[offset + 2] = value;
+		output[offset + 3] = 1.0f;
+#endif
+	}
+}
+
 void ConvertValueToColorProg::deinitExecution()
 {
 	this->m_inputProgram = NULL;
@@ -0,0 +1,356 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "COM_FFTConvolution.h"
+#include "BLI_math.h"
+#include "MEM_guardedalloc.h"
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+typedef float fREAL;
+
+// returns next highest power of 2 of x, as well it's log2 in L2
+static unsigned int nextPow2(unsigned int x, unsigned int *L2)
+{
+	unsigned int pw, x_notpow2 = x & (x - 1);
+	*L2 = 0;
+	while (x >>= 1) ++(*L2);
+	pw = 1 << (*L2);
+	if (x_notpow2) { (*L2)++;  pw <<= 1; }
+	return pw;
+}
+
+//------------------------------------------------------------------------------
+
+// from FXT library by Joerg Arndt, faster in order bitreversal
+// use: r = revbin_upd(r, h) where h = N>>1
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+	while (!((r ^= h) & h)) h >>= 1;
+	return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+	double tt, fc, dc, fs, ds, a = M_PI;
+	fREAL t1, t2;
+	int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+	int i, j = 0;
+	unsigned int Nh = len >> 1;
+	for (i = 1; i < (len - 1); ++i) {
+		j = revbin_upd(j, Nh);
+		if (j > i) {
+			t1 = data[i];
+			data[i] = data[j];
+			data[j] = t1;
+		}
+	}
+
+	do {
+		fREAL *data_n = &data[n];
+
+		istep = n << 1;
+		for (k = 0; k < len; k += istep) {
+			t1 = data_n[k];
+			data_n[k] = data[k] - t1;
+			data[k] += t1;
+		}
+
+		n2 = n >> 1;
+		if (n > 2) {
+			fc = dc = cos(a);
+			fs = ds = sqrt(1.0 - fc * fc); //sin(a);
+			bd = n - 2;
+			for (bl = 1; bl < n2; bl++) {
+				fREAL *data_nbd = &data_n[bd];
+				fREAL *data_bd = &data[bd];
+				for (k = bl; k < len; k += istep) {
+					t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+					t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+					data_n[k] = data[k] - t1;
+					data_nbd[k] = data_bd[k] - t2;
+					data[k] += t1;
+					data_bd[k] += t2;
+				}
+				tt = fc * dc - fs * ds;
+				fs = fs * dc + fc * ds;
+				fc = tt;
+				bd -= 2;
+			}
+		}
+
+		if (n > 1) {
+			for (k = n2; k < len; k += istep) {
+				t1 = data_n[k];
+				data_n[k] = data[k] - t1;
+				data[k] += t1;
+			}
+		}
+
+		n = istep;
+		a *= 0.5;
+	} while (n < len);
+
+	if (inverse) {
+		fREAL sc = (fREAL)1 / (fREAL)len;
+		for (k = 0; k < len; ++k)
+			data[k] *= sc;
+	}
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above */
+static void FHT2D(fREAL *data, unsigned int Mx, unsigned int My,
+                  unsigned int nzp, unsigned int inverse)
+{
+	unsigned int i, j, Nx, Ny, maxy;
+	fREAL t;
+
+	Nx = 1 << Mx;
+	Ny = 1 << My;
+
+	// rows (forward transform skips 0 pad data)
+	maxy = inverse ? Ny : nzp;
+	for (j = 0; j < maxy; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// transpose data
+	if (Nx == Ny) {  // square
+		for (j = 0; j < Ny; ++j)
+			for (i = j + 1; i < Nx; ++i) {
+				unsigned int op = i + (j << Mx), np = j + (i << My);
+				t = data[op], data[op] = data[np], data[np] = t;
+			}
+	}
+	else {  // rectangular
+		unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+		for (i = 0; stm > 0; i++) {
+			#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+			for (j = PRED(i); j > i; j = PRED(j)) ;
+			if (j < i) continue;
+			for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+				t = data[j], data[j] = data[k], data[k] = t;
+			}
+			#undef PRED
+			stm--;
+		}
+	}
+	// swap Mx/My & Nx/Ny
+	i = Nx, Nx = Ny, Ny = i;
+	i = Mx, Mx = My, My = i;
+
+	// now columns == transposed rows
+	for (j = 0; j < Ny; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// finalize
+	for (j = 0; j <= (Ny >> 1); j++) {
+		unsigned int jm = (Ny - j) & (Ny - 1);
+		unsigned int ji = j << Mx;
+		unsigned int jmi = jm << Mx;
+		for (i = 0; i <= (Nx >> 1); i++) {
+			unsigned int im = (Nx - i) & (Nx - 1);
+			fREAL A = data[ji + i];
+			fREAL B = data[jmi + i];
+			fREAL C = data[ji + im];
+			fREAL D = data[jmi + im];
+			fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+			data[ji + i] = A - E;
+			data[jmi + i] = B + E;
+			data[ji + im] = C + E;
+			data[jmi + im] = D - E;
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
+static void fht_convolve(fREAL *d1, fREAL *d2, unsigned int M, unsigned int N)
+{
+	fREAL a, b;
+	unsigned int i, j, k, L, mj, mL;
+	unsigned int m = 1 << M, n = 1 << N;
+	unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+	unsigned int mn2 = m << (N - 1);
+
+	d1[0] *= d2[0];
+	d1[mn2] *= d2[mn2];
+	d1[m2] *= d2[m2];
+	d1[m2 + mn2] *= d2[m2 + mn2];
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		a = d1[i] * d2[i] - d1[k] * d2[k];
+		b = d1[k] * d2[i] + d1[i] * d2[k];
+		d1[i] = (b + a) * (fREAL)0.5;
+		d1[k] = (b - a) * (fREAL)0.5;
+		a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+		b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+		d1[i + mn2] = (b + a) * (fREAL)0.5;
+		d1[k + mn2] = (b - a) * (fREAL)0.5;
+	}
+	for (j = 1; j < n2; j++) {
+		L = n - j;
+		mj = j << M;
+		mL = L << M;
+		a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+		b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+		d1[mj] = (b + a) * (fREAL)0.5;
+		d1[mL] = (b - a) * (fREAL)0.5;
+		a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+		b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+		d1[m2 + mj] = (b + a) * (fREAL)0.5;
+		d1[m2 + mL] = (b - a) * (fREAL)0.5;
+	}
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		for (j = 1; j < n2; j++) {
+			L = n - j;
+			mj = j << M;
+			mL = L << M;
+			a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+			b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+			d1[i + mj] = (b + a) * (fREAL)0.5;
+			d1[k + mL] = (b - a) * (fREAL)0.5;
+			a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+			b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+			d1[i + mL] = (b + a) * (fREAL)0.5;
+			d1[k + mj] = (b - a) * (fREAL)0.5;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+
+FFTConvolution::FFTConvolution(const float *kernel, int kernelWidth, int kernelHeight, int kernelChannels)
+{
+	this->m_kernel = kernel;
+	this->m_kernelWidth = kernelWidth;
+	this->m_kernelHeight = kernelHeight;
+	this->m_kernelChannels = kernelChannels;
+
+	// convolution result width & height, FFT pow2 required size & log2
+	this->m_width = nextPow2(2 * kernelWidth - 1, &this->m_log2Width);
+	this->m_height = nextPow2(2 * kernelHeight - 1, &this->m_log2Height);
+
+	this->m_kernelTransforms.resize(kernelChannels, NULL);
+}
+
+FFTConvolution::~FFTConvolution()
+{
+	for (unsigned int ch = 0; ch < this->m_kernelTransforms.size(); ch++) {
+		if (this->m_kernelTransforms[ch])
+			MEM_freeN(this->m_kernelTransforms[ch]);
+	}
+}
+
+float *FFTConvolution::getKernelTransform(unsigned int channel)
+{
+	float *transform = this->m_kernelTransforms[channel];
+
+	if (transform == NULL) {
+		transform = (fREAL *)MEM_callocN(this->m_width * this->m_height * sizeof(fREAL), "FFTConvolution kernel");
+
+		for (unsigned int y = 0; y < this->m_kernelHeight; y++) {
+			fREAL *fp = &transform[y * this->m_width];
+			const float *kp = &this->m_kernel[(y * this->m_kernelWidth) * this->m_kernelChannels + channel];
+			for (unsigned int x = 0; x < this->m_kernelWidth; x++, kp += this->m_kernelChannels)
+				fp[x] = *kp;
+		}
+
+		// zero pad data starts after the kernel
+		FHT2D(transform, this->m_log2Width, this->m_log2Height, this->m_kernelHeight, 0);
+		this->m_kernelTransforms[channel] = transform;
+	}
+
+	return transform;
+}
+
+void FFTConvolution::convolve(float *output, const float *image, int width, int height, int imageChannels, int numberOfChannels)
+{
+	const unsigned int w2 = this->m_width;
+	const unsigned int h2 = this->m_height;
+	fREAL *data = (fREAL *)MEM_mallocN(w2 * h2 * sizeof(fREAL), "FFTConvolution block");
+
+	// block add-overlap, every block gives a result of w2 * h2 pixels
+	const int hw = this->m_kernelWidth >> 1;
+	const int hh = this->m_kernelHeight >> 1;
+	const int xbsz = (w2 + 1) - this->m_kernelWidth;
+	const int ybsz = (h2 + 1) - this->m_kernelHeight;
+	const int nxb = (width + xbsz - 1) / xbsz;
+	const int nyb = (height + ybsz - 1) / ybsz;
+
+	for (int ybl = 0; ybl < nyb; ybl++) {
+		for (int xbl = 0; xbl < nxb; xbl++) {
+			const int xstart = xbl * xbsz;
+			const int ystart = ybl * ybsz;
+			const int xend = min(xstart + xbsz, width);
+			const int yend = min(ystart + ybsz, height);
+
+			// each channel one by one
+			for (int ch = 0; ch < numberOfChannels; ch++) {
+				fREAL *kernelTransform = getKernelTransform(this->m_kernelChannels == 1 ? 0 : ch);
+
+				// image, channel ch -> data
+				memset(data, 0, w2 * h2 * sizeof(fREAL));
+				for (int yy = ystart; yy < yend; yy++) {
+					fREAL *fp = &data[(yy - ystart) * w2];
+					if (image) {
+						const float *colp = &image[(yy * width + xstart) * imageChannels + ch];
+						for (int xx = xstart; xx < xend; xx++, colp += imageChannels)
+							fp[xx - xstart] = *colp;
+					}
+					else {
+						for (int xx = xstart; xx < xend; xx++)
+							fp[xx - xstart] = 1.0f;
+					}
+				}
+
+				// forward FHT, zero pad data starts after the block
+				FHT2D(data, this->m_log2Width, this->m_log2Height, yend - ystart, 0);
+
+				// FHT2D transposed data, row/col now swapped
+				// convolve & inverse FHT
+				fht_convolve(data, kernelTransform, this->m_log2Height, this->m_log2Width);
+				FHT2D(data, this->m_log2Height, this->m_log2Width, 0, 1);
+				// data again transposed, so in order again
+
+				// overlap-add result
+				const int ymin = max(ystart - hh, 0);
+				const int ymax = min(ystart + (int)h2 - hh, height);
+				const int xmin = max(xstart - hw, 0);
+				const int xmax = min(xstart + (int)w2 - hw, width);
+				for (int yy = ymin; yy < ymax; yy++) {
+					const fREAL *fp = &data[(yy - ystart + hh) * w2 + (xmin - xstart + hw)];
+					float *colp = &output[(yy * width + xmin) * imageChannels + ch];
+					for (int xx = xmin; xx < xmax; xx++, colp += imageChannels)
+						*colp += *fp++;
+				}
+			}
+		}
+	}
+
+	MEM_freeN(data);
+}
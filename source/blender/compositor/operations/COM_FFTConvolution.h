@@ -0,0 +1,80 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_FFTConvolution_h_
+#define _COM_FFTConvolution_h_
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief convolution of images with large kernels using the fast Hartley transform
+ *
+ * The image is split in blocks that are convolved with the kernel in the frequency
+ * domain and added together (overlap-add), so the cost per pixel grows with the
+ * logarithm of the kernel size instead of with its area. The transforms of the kernel
+ * are calculated once and reused for every block and every call to convolve.
+ *
+ * The kernel is centered at (kernelWidth / 2, kernelHeight / 2):
+ * output(x, y) = sum of image(x - i + kernelWidth / 2, y - j + kernelHeight / 2) * kernel(i, j)
+ * where pixels outside of the image are zero.
+ *
+ * @see COM_FFT_CONVOLUTION_MIN_RADIUS
+ */
+class FFTConvolution {
+private:
+	const float *m_kernel;
+	unsigned int m_kernelWidth;
+	unsigned int m_kernelHeight;
+	unsigned int m_kernelChannels;
+
+	/**
+	 * @brief size of the transforms, powers of two at least twice the size of the kernel
+	 */
+	unsigned int m_width;
+	unsigned int m_height;
+	unsigned int m_log2Width;
+	unsigned int m_log2Height;
+
+	/**
+	 * @brief transform of every channel of the kernel, calculated when first used
+	 */
+	vector<float *> m_kernelTransforms;
+
+	float *getKernelTransform(unsigned int channel);
+
+public:
+	/**
+	 * @param kernel the kernel, it is not copied and must stay valid while the convolution is used
+	 * @param kernelChannels number of channels per kernel pixel, when 1 all channels of the image
+	 * are convolved with the same kernel
+	 */
+	FFTConvolution(const float *kernel, int kernelWidth, int kernelHeight, int kernelChannels);
+	~FFTConvolution();
+
+	/**
+	 * @brief add the convolution of the first numberOfChannels channels of an image to output
+	 * @param output buffer of width * height pixels with the same number of channels as the image
+	 * @param image the image, or NULL to convolve an image that is one inside of its bounds,
+	 * which gives the sum of the kernel weights that fall inside of the image for every pixel
+	 */
+	void convolve(float *output, const float *image, int width, int height, int imageChannels, int numberOfChannels);
+};
+
+#endif
@@ -120,6 +120,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsign
 	unsigned int x, y, sz;
 	unsigned int i;
 	float *buffer = src->getBuffer();
+	const unsigned int num_channels = src->getNumberOfChannels();
 	
 	// <0.5 not valid, though can have a possibly useful sort of sharpening effect
 	if (sigma < 0.5f) return;
@@ -198,19 +199,19 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsign
 		for (y = 0; y < src_height; ++y) {
 			const int yx = y * src_width;
 			for (x = 0; x < src_width; ++x)
-				X[x] = buffer[(x + yx) * COM_NUMBER_OF_CHANNELS + chan];
+				X[x] = buffer[(x + yx) * num_channels + chan];
 			YVV(src_width);
 			for (x = 0; x < src_width; ++x)
-				buffer[(x + yx) * COM_NUMBER_OF_CHANNELS + chan] = Y[x];
+				buffer[(x + yx) * num_channels + chan] = Y[x];
 		}
 	}
 	if (xy & 2) {   // V
 		for (x = 0; x < src_width; ++x) {
 			for (y = 0; y < src_height; ++y)
-				X[y] = buffer[(x + y * src_width) * COM_NUMBER_OF_CHANNELS + chan];
+				X[y] = buffer[(x + y * src_width) * num_channels + chan];
 			YVV(src_height);
 			for (y = 0; y < src_height; ++y)
-				buffer[(x + y * src_width) * COM_NUMBER_OF_CHANNELS + chan] = Y[y];
+				buffer[(x + y * src_width) * num_channels + chan] = Y[y];
 		}
 	}
 	
@@ -277,12 +278,13 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 	if (!this->m_iirgaus) {
 		MemoryBuffer *newBuf = (MemoryBuffer *)this->m_inputprogram->initializeTileData(rect);
 		MemoryBuffer *copy = newBuf->duplicate();
+		const int num_channels = copy->getNumberOfChannels();
 		FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 0, 3);
 
 		if (this->m_overlay == FAST_GAUSS_OVERLAY_MIN) {
 			float *src = newBuf->getBuffer();
 			float *dst = copy->getBuffer();
-			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += COM_NUMBER_OF_CHANNELS, dst += COM_NUMBER_OF_CHANNELS) {
+			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += num_channels, dst += num_channels) {
 				if (*src < *dst) {
 					*dst = *src;
 				}
@@ -291,7 +293,7 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 		else if (this->m_overlay == FAST_GAUSS_OVERLAY_MAX) {
 			float *src = newBuf->getBuffer();
 			float *dst = copy->getBuffer();
-			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += COM_NUMBER_OF_CHANNELS, dst += COM_NUMBER_OF_CHANNELS) {
+			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += num_channels, dst += num_channels) {
 				if (*src > *dst) {
 					*dst = *src;
 				}
@@ -21,15 +21,19 @@
  */
 
 #include "COM_GaussianBokehBlurOperation.h"
+#include "COM_FFTConvolution.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 extern "C" {
 	#include "RE_pipeline.h"
+	#include "BKE_global.h"
 }
 
 GaussianBokehBlurOperation::GaussianBokehBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
 	this->m_gausstab = NULL;
+	this->m_convolvedBuffer = NULL;
+	this->m_useFFTConvolution = false;
 }
 
 void *GaussianBokehBlurOperation::initializeTileData(rcti *rect)
@@ -38,7 +42,10 @@ void *GaussianBokehBlurOperation::initializeTileData(rcti *rect)
 	if (!this->m_sizeavailable) {
 		updateGauss();
 	}
-	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	MemoryBuffer *buffer = (MemoryBuffer *)getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_convolvedBuffer == NULL && this->m_useFFTConvolution) {
+		this->m_convolvedBuffer = createConvolvedBuffer(buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
@@ -49,11 +56,54 @@ void GaussianBokehBlurOperation::initExecution()
 
 	initMutex();
 
+	/* the whole image is only requested from the input when the size is known here,
+	 * see determineDependingAreaOfInterest */
 	if (this->m_sizeavailable) {
 		updateGauss();
+
+		this->m_useFFTConvolution = (max(this->m_radx, this->m_rady) >= COM_FFT_CONVOLUTION_MIN_RADIUS &&
+		                             G.debug_value != COM_DEBUG_VALUE_DIRECT_CONVOLUTION);
 	}
 }
 
+MemoryBuffer *GaussianBokehBlurOperation::createConvolvedBuffer(MemoryBuffer *inputBuffer)
+{
+	const int kernelWidth = 2 * this->m_radx + 1;
+	const int kernelHeight = 2 * this->m_rady + 1;
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+
+	/* the FFT convolution mirrors the kernel, executePixel does not include
+	 * the last row and column of the gauss table in its sum */
+	float *kernel = (float *)MEM_callocN(sizeof(float) * kernelWidth * kernelHeight, __func__);
+	for (int j = 1; j < kernelHeight; j++) {
+		for (int i = 1; i < kernelWidth; i++) {
+			kernel[j * kernelWidth + i] = this->m_gausstab[(kernelHeight - 1 - j) * kernelWidth + (kernelWidth - 1 - i)];
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	MemoryBuffer *weights = new MemoryBuffer(COM_DT_VALUE, inputBuffer->getRect());
+	result->clear();
+	weights->clear();
+
+	/* divide by the sum of the weights inside of the image, like executePixel */
+	FFTConvolution convolution(kernel, kernelWidth, kernelHeight, 1);
+	convolution.convolve(result->getBuffer(), inputBuffer->getBuffer(), width, height, COM_NUMBER_OF_CHANNELS, COM_NUMBER_OF_CHANNELS);
+	convolution.convolve(weights->getBuffer(), NULL, width, height, 1, 1);
+
+	float *color = result->getBuffer();
+	float *weight = weights->getBuffer();
+	for (int i = 0; i < width * height; i++, color += COM_NUMBER_OF_CHANNELS) {
+		mul_v4_fl(color, 1.0f / weight[i]);
+	}
+
+	delete weights;
+	MEM_freeN(kernel);
+
+	return result;
+}
+
 void GaussianBokehBlurOperation::updateGauss()
 {
 	if (this->m_gausstab == NULL) {
@@ -119,6 +169,11 @@ void GaussianBokehBlurOperation::updateGauss()
 
 void GaussianBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+	if (this->m_convolvedBuffer) {
+		this->m_convolvedBuffer->readNoCheck(output, x, y);
+		return;
+	}
+
 	float tempColor[4];
 	tempColor[0] = 0;
 	tempColor[1] = 0;
@@ -166,6 +221,12 @@ void GaussianBokehBlurOperation::deinitExecution()
 	MEM_freeN(this->m_gausstab);
 	this->m_gausstab = NULL;
 
+	if (this->m_convolvedBuffer) {
+		delete this->m_convolvedBuffer;
+		this->m_convolvedBuffer = NULL;
+	}
+	this->m_useFFTConvolution = false;
+
 	deinitMutex();
 }
 
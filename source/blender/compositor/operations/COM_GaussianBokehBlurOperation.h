@@ -32,6 +32,13 @@ private:
 	int m_radx, m_rady;
 	void updateGauss();
 
+	/**
+	 * @brief the whole blurred image, when it is calculated with an FFTConvolution
+	 */
+	MemoryBuffer *m_convolvedBuffer;
+	bool m_useFFTConvolution;
+	MemoryBuffer *createConvolvedBuffer(MemoryBuffer *inputBuffer);
+
 public:
 	GaussianBokehBlurOperation();
 	void initExecution();
@@ -21,10 +21,32 @@
  */
 
 #include "COM_MathBaseOperation.h"
+#include "COM_RowBuffers.h"
 extern "C" {
 #include "BLI_math.h"
 }
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+
+/* gather and scatter the value channel of four consecutive pixels in a row */
+static inline __m128 load_value4(const float *row)
+{
+	return _mm_set_ps(row[3 * COM_NUMBER_OF_CHANNELS], row[2 * COM_NUMBER_OF_CHANNELS],
+	                  row[COM_NUMBER_OF_CHANNELS], row[0]);
+}
+
+static inline void store_value4(float *row, __m128 value)
+{
+	float result[4];
+	_mm_storeu_ps(result, value);
+	row[0] = result[0];
+	row[COM_NUMBER_OF_CHANNELS] = result[1];
+	row[2 * COM_NUMBER_OF_CHANNELS] = result[2];
+	row[3 * COM_NUMBER_OF_CHANNELS] = result[3];
+}
+#endif
+
 MathBaseOperation::MathBaseOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_VALUE);
@@ -72,6 +94,21 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::readInputRows(float *value1, float *value2, int x, int y, int num)
+{
+	this->m_inputValue1Operation->readRow(value1, x, y, num);
+	this->m_inputValue2Operation->readRow(value2, x, y, num);
+}
+
+void MathBaseOperation::clampRowIfNeeded(float *output, int num)
+{
+	if (this->m_useClamp) {
+		for (int i = 0; i < num; i++) {
+			CLAMP(output[i * COM_NUMBER_OF_CHANNELS], 0.0f, 1.0f);
+		}
+	}
+}
+
 void MathAddOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +122,31 @@ void MathAddOperation::executePixel(float output[4], float x, float y, PixelSamp
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_add_ps(a, b));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = inputValue1[offset] + inputValue2[offset];
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathSubtractOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +160,31 @@ void MathSubtractOperation::executePixel(float output[4], float x, float y, Pixe
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_sub_ps(a, b));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = inputValue1[offset] - inputValue2[offset];
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathMultiplyOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +198,31 @@ void MathMultiplyOperation::executePixel(float output[4], float x, float y, Pixe
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_mul_ps(a, b));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = inputValue1[offset] * inputValue2[offset];
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathDivideOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -127,6 +239,31 @@ void MathDivideOperation::executePixel(float output[4], float x, float y, PixelS
 	clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_and_ps(_mm_cmpneq_ps(b, _mm_setzero_ps()), _mm_div_ps(a, b)));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = (inputValue2[offset] == 0.0f) ? 0.0f : inputValue1[offset] / inputValue2[offset];
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathSineOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -265,6 +402,31 @@ void MathMinimumOperation::executePixel(float output[4], float x, float y, Pixel
 	clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_min_ps(a, b));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = min(inputValue1[offset], inputValue2[offset]);
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathMaximumOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -278,6 +440,31 @@ void MathMaximumOperation::executePixel(float output[4], float x, float y, Pixel
 	clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(2);
+	float *inputValue1 = buffers[0];
+	float *inputValue2 = buffers[1];
+	int i = 0;
+
+	readInputRows(inputValue1, inputValue2, x, y, num);
+
+#ifdef __SSE__
+	for (; i + 4 <= num; i += 4) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		__m128 a = load_value4(&inputValue1[offset]);
+		__m128 b = load_value4(&inputValue2[offset]);
+		store_value4(&output[offset], _mm_max_ps(a, b));
+	}
+#endif
+	for (; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+		output[offset] = max(inputValue1[offset], inputValue2[offset]);
+	}
+
+	clampRowIfNeeded(output, num);
+}
+
 void MathRoundOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -21,6 +21,11 @@
  */
 
 #include "COM_MixAddOperation.h"
+#include "COM_RowBuffers.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
@@ -50,3 +55,29 @@ void MixAddOperation::executePixel(float output[4], float x, float y, PixelSampl
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(3);
+	float *inputColor1 = buffers[0];
+	float *inputColor2 = buffers[1];
+	float *inputValue = buffers[2];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+#ifdef __SSE__
+		__m128 value = _mm_set1_ps(inputValue[offset]);
+		_mm_storeu_ps(&output[offset], _mm_add_ps(_mm_loadu_ps(&inputColor1[offset]),
+		                                          _mm_mul_ps(value, _mm_loadu_ps(&inputColor2[offset]))));
+#else
+		float value = inputValue[offset];
+		output[offset + 0] = inputColor1[offset + 0] + value * inputColor2[offset + 0];
+		output[offset + 1] = inputColor1[offset + 1] + value * inputColor2[offset + 1];
+		output[offset + 2] = inputColor1[offset + 2] + value * inputColor2[offset + 2];
+#endif
+		output[offset + 3] = inputColor1[offset + 3];
+	}
+
+	clampRowIfNeeded(output, num);
+}
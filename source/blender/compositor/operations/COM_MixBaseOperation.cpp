@@ -63,6 +63,28 @@ void MixBaseOperation::executePixel(float output[4], float x, float y, PixelSamp
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readInputRows(float *value, float *color1, float *color2, int x, int y, int num)
+{
+	this->m_inputValueOperation->readRow(value, x, y, num);
+	this->m_inputColor1Operation->readRow(color1, x, y, num);
+	this->m_inputColor2Operation->readRow(color2, x, y, num);
+
+	if (this->useValueAlphaMultiply()) {
+		for (int i = 0; i < num; i++) {
+			value[i * COM_NUMBER_OF_CHANNELS] *= color2[i * COM_NUMBER_OF_CHANNELS + 3];
+		}
+	}
+}
+
+void MixBaseOperation::clampRowIfNeeded(float *output, int num)
+{
+	if (this->m_useClamp) {
+		for (int i = 0; i < num; i++) {
+			clampIfNeeded(&output[i * COM_NUMBER_OF_CHANNELS]);
+		}
+	}
+}
+
 void MixBaseOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
@@ -49,6 +49,14 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	/**
+	 * read a row of all inputs for executeRow, the value row already has
+	 * the alpha of the second color multiplied in when needed
+	 */
+	void readInputRows(float *value, float *color1, float *color2, int x, int y, int num);
+
+	void clampRowIfNeeded(float *output, int num);
 	
 public:
 	/**
@@ -21,6 +21,11 @@
  */
 
 #include "COM_MixMultiplyOperation.h"
+#include "COM_RowBuffers.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
@@ -50,3 +55,31 @@ void MixMultiplyOperation::executePixel(float output[4], float x, float y, Pixel
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(3);
+	float *inputColor1 = buffers[0];
+	float *inputColor2 = buffers[1];
+	float *inputValue = buffers[2];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		const int offset = i * COM_NUMBER_OF_CHANNELS;
+#ifdef __SSE__
+		__m128 value = _mm_set1_ps(inputValue[offset]);
+		__m128 valuem = _mm_set1_ps(1.0f - inputValue[offset]);
+		_mm_storeu_ps(&output[offset], _mm_mul_ps(_mm_loadu_ps(&inputColor1[offset]),
+		                                          _mm_add_ps(valuem, _mm_mul_ps(value, _mm_loadu_ps(&inputColor2[offset])))));
+#else
+		float value = inputValue[offset];
+		float valuem = 1.0f - value;
+		output[offset + 0] = inputColor1[offset + 0] * (valuem + value * inputColor2[offset + 0]);
+		output[offset + 1] = inputColor1[offset + 1] * (valuem + value * inputColor2[offset + 1]);
+		output[offset + 2] = inputColor1[offset + 2] * (valuem + value * inputColor2[offset + 2]);
+#endif
+		output[offset + 3] = inputColor1[offset + 3];
+	}
+
+	clampRowIfNeeded(output, num);
+}
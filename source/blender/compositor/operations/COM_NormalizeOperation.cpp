@@ -91,6 +91,7 @@ void *NormalizeOperation::initializeTileData(rcti *rect)
 		float *buffer = tile->getBuffer();
 		int p = tile->getWidth() * tile->getHeight();
 		float *bc = buffer;
+		const int numChannels = tile->getNumberOfChannels();
 
 		float minv = 1.0f + BLENDER_ZMAX;
 		float maxv = -1.0f - BLENDER_ZMAX;
@@ -104,7 +105,7 @@ void *NormalizeOperation::initializeTileData(rcti *rect)
 			if ((value < minv) && (value >= -BLENDER_ZMAX)) {
 				minv = value;
 			}
-			bc += 4;
+			bc += numChannels;
 		}
 
 		minmult->x = minv;
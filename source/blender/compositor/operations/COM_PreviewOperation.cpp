@@ -22,6 +22,7 @@
 
 #include "COM_PreviewOperation.h"
 #include "COM_SocketConnection.h"
+#include "COM_ReadBufferOperation.h"
 #include "BLI_listbase.h"
 #include "BKE_image.h"
 #include "WM_api.h"
@@ -86,41 +87,116 @@ void PreviewOperation::deinitExecution()
 	this->m_input = NULL;
 }
 
-void PreviewOperation::executeRegion(rcti *rect, unsigned int tileNumber)
+void PreviewOperation::sampleRegion(float *region, rcti *rect)
 {
-	int offset;
-	float color[4];
-	struct ColormanageProcessor *cm_processor;
-
-	cm_processor = IMB_colormanagement_display_processor_new(this->m_viewSettings, this->m_displaySettings);
+	float *color = region;
 
 	for (int y = rect->ymin; y < rect->ymax; y++) {
-		offset = (y * getWidth() + rect->xmin) * 4;
 		for (int x = rect->xmin; x < rect->xmax; x++) {
 			float rx = floor(x / this->m_divider);
 			float ry = floor(y / this->m_divider);
-	
+
 			color[0] = 0.0f;
 			color[1] = 0.0f;
 			color[2] = 0.0f;
 			color[3] = 1.0f;
 			this->m_input->read(color, rx, ry, COM_PS_NEAREST);
-			IMB_colormanagement_processor_apply_v4(cm_processor, color);
+			color += COM_NUMBER_OF_CHANNELS;
+		}
+	}
+}
+
+void PreviewOperation::downsampleRegion(float *region, rcti *rect, MemoryBuffer *inputBuffer)
+{
+	const int inputWidth = inputBuffer->getWidth();
+	const int inputHeight = inputBuffer->getHeight();
+	/* input columns covered by the region */
+	const int inputXMin = min_ii((int)(rect->xmin / this->m_divider), inputWidth - 1);
+	const int inputXMax = min_ii(max_ii((int)(rect->xmax / this->m_divider), inputXMin + 1), inputWidth);
+	float *row = (float *)MEM_mallocN(sizeof(float) * COM_NUMBER_OF_CHANNELS * (inputXMax - inputXMin), "PreviewOperation row");
+	float *color = region;
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const int y1 = min_ii((int)(y / this->m_divider), inputHeight - 1);
+		const int y2 = min_ii(max_ii((int)((y + 1) / this->m_divider), y1 + 1), inputHeight);
+		float *rowColor = color;
+
+		memset(color, 0, sizeof(float) * COM_NUMBER_OF_CHANNELS * BLI_rcti_size_x(rect));
+
+		/* sum the input rows, then divide by the number of pixels every preview pixel covers */
+		for (int inputY = y1; inputY < y2; inputY++) {
+			inputBuffer->readRow(row, inputXMin, inputY, inputXMax - inputXMin);
+
+			rowColor = color;
+			for (int x = rect->xmin; x < rect->xmax; x++) {
+				const int x1 = min_ii((int)(x / this->m_divider), inputXMax - 1);
+				const int x2 = min_ii(max_ii((int)((x + 1) / this->m_divider), x1 + 1), inputXMax);
+
+				for (int inputX = x1; inputX < x2; inputX++) {
+					add_v4_v4(rowColor, row + (inputX - inputXMin) * COM_NUMBER_OF_CHANNELS);
+				}
+				rowColor += COM_NUMBER_OF_CHANNELS;
+			}
+		}
+
+		rowColor = color;
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			const int x1 = min_ii((int)(x / this->m_divider), inputXMax - 1);
+			const int x2 = min_ii(max_ii((int)((x + 1) / this->m_divider), x1 + 1), inputXMax);
+
+			mul_v4_fl(rowColor, 1.0f / ((x2 - x1) * (y2 - y1)));
+			rowColor += COM_NUMBER_OF_CHANNELS;
+		}
+
+		color += COM_NUMBER_OF_CHANNELS * BLI_rcti_size_x(rect);
+	}
+
+	MEM_freeN(row);
+}
+
+void PreviewOperation::executeRegion(rcti *rect, unsigned int tileNumber)
+{
+	const int width = BLI_rcti_size_x(rect);
+	const int height = BLI_rcti_size_y(rect);
+	NodeOperation *inputOperation = this->getInputOperation(0);
+	float *region = (float *)MEM_mallocN(sizeof(float) * COM_NUMBER_OF_CHANNELS * width * height, "PreviewOperation region");
+	float *color = region;
+	struct ColormanageProcessor *cm_processor;
+
+	/* a buffered input is box filtered, other inputs would have to be calculated for
+	 * every pixel of the full resolution for that, so they are point sampled */
+	if (inputOperation->isReadBufferOperation()) {
+		MemoryBuffer *inputBuffer = ((ReadBufferOperation *)inputOperation)->getMemoryProxy()->getBuffer();
+		downsampleRegion(region, rect, inputBuffer);
+	}
+	else {
+		sampleRegion(region, rect);
+	}
+
+	cm_processor = IMB_colormanagement_display_processor_new(this->m_viewSettings, this->m_displaySettings);
+	IMB_colormanagement_processor_apply(cm_processor, region, width, height, COM_NUMBER_OF_CHANNELS, FALSE);
+	IMB_colormanagement_processor_free(cm_processor);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		int offset = (y * getWidth() + rect->xmin) * 4;
+		for (int x = rect->xmin; x < rect->xmax; x++) {
 			F4TOCHAR4(color, this->m_outputBuffer + offset);
+			color += COM_NUMBER_OF_CHANNELS;
 			offset += 4;
 		}
 	}
 
-	IMB_colormanagement_processor_free(cm_processor);
+	MEM_freeN(region);
 }
 bool PreviewOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
 
+	/* the input pixels covered by the preview pixels, for the box filter */
 	newInput.xmin = input->xmin / this->m_divider;
-	newInput.xmax = input->xmax / this->m_divider;
+	newInput.xmax = ceilf(input->xmax / this->m_divider);
 	newInput.ymin = input->ymin / this->m_divider;
-	newInput.ymax = input->ymax / this->m_divider;
+	newInput.ymax = ceilf(input->ymax / this->m_divider);
 
 	return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
 }
@@ -41,6 +41,16 @@ protected:
 
 	const ColorManagedViewSettings *m_viewSettings;
 	const ColorManagedDisplaySettings *m_displaySettings;
+
+	/**
+	 * @brief fill region with the input pixel at the position of every preview pixel
+	 */
+	void sampleRegion(float *region, rcti *rect);
+
+	/**
+	 * @brief fill region with the average of the input pixels every preview pixel covers
+	 */
+	void downsampleRegion(float *region, rcti *rect, MemoryBuffer *inputBuffer);
 public:
 	PreviewOperation(const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings);
 	void verifyPreview(bNodeInstanceHash *previews, bNodeInstanceKey key);
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "COM_ProxyScaleOperation.h"
+
+extern "C" {
+#  include "BLI_math.h"
+}
+
+ProxyDownscaleOperation::ProxyDownscaleOperation(DataType datatype, int divider) : NodeOperation()
+{
+	this->addInputSocket(datatype, COM_SC_NO_RESIZE);
+	this->addOutputSocket(datatype);
+	this->m_inputOperation = NULL;
+	this->m_divider = divider;
+}
+
+void ProxyDownscaleOperation::initExecution()
+{
+	this->m_inputOperation = this->getInputSocketReader(0);
+}
+
+void ProxyDownscaleOperation::deinitExecution()
+{
+	this->m_inputOperation = NULL;
+}
+
+void ProxyDownscaleOperation::executePixel(float output[4], float x, float y, PixelSampler sampler)
+{
+	const int divider = this->m_divider;
+
+	if (sampler != COM_PS_NEAREST) {
+		this->m_inputOperation->read(output, (x + 0.5f) * divider - 0.5f, (y + 0.5f) * divider - 0.5f, sampler);
+		return;
+	}
+
+	/* box filter, the last row and column of the proxy can extend beyond the source */
+	const int maxx = this->m_inputOperation->getWidth() - 1;
+	const int maxy = this->m_inputOperation->getHeight() - 1;
+	const int startx = (int)x * divider;
+	const int starty = (int)y * divider;
+	float color[4];
+	int i, j;
+
+	zero_v4(output);
+	for (j = 0; j < divider; j++) {
+		for (i = 0; i < divider; i++) {
+			zero_v4(color);
+			this->m_inputOperation->read(color, min_ii(startx + i, maxx), min_ii(starty + j, maxy), COM_PS_NEAREST);
+			add_v4_v4(output, color);
+		}
+	}
+	mul_v4_fl(output, 1.0f / (divider * divider));
+}
+
+void ProxyDownscaleOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
+{
+	unsigned int inputPreferredResolution[2];
+	inputPreferredResolution[0] = preferredResolution[0] * this->m_divider;
+	inputPreferredResolution[1] = preferredResolution[1] * this->m_divider;
+
+	NodeOperation::determineResolution(resolution, inputPreferredResolution);
+
+	resolution[0] = (resolution[0] + this->m_divider - 1) / this->m_divider;
+	resolution[1] = (resolution[1] + this->m_divider - 1) / this->m_divider;
+}
+
+bool ProxyDownscaleOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
+{
+	rcti newInput;
+
+	newInput.xmin = input->xmin * this->m_divider - 1;
+	newInput.xmax = (input->xmax + 1) * this->m_divider;
+	newInput.ymin = input->ymin * this->m_divider - 1;
+	newInput.ymax = (input->ymax + 1) * this->m_divider;
+
+	return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
+
+
+ProxyUpscaleOperation::ProxyUpscaleOperation(DataType datatype, int divider) : NodeOperation()
+{
+	this->addInputSocket(datatype, COM_SC_NO_RESIZE);
+	this->addOutputSocket(datatype);
+	this->setComplex(true);
+	this->m_inputOperation = NULL;
+	this->m_divider = divider;
+	this->m_relX = 1.0f;
+	this->m_relY = 1.0f;
+}
+
+void ProxyUpscaleOperation::initExecution()
+{
+	this->m_inputOperation = this->getInputSocketReader(0);
+	this->m_relX = this->m_inputOperation->getWidth() / (float)this->getWidth();
+	this->m_relY = this->m_inputOperation->getHeight() / (float)this->getHeight();
+}
+
+void ProxyUpscaleOperation::deinitExecution()
+{
+	this->m_inputOperation = NULL;
+}
+
+void ProxyUpscaleOperation::executePixel(float output[4], int x, int y, void *data)
+{
+	this->m_inputOperation->read(output, (x + 0.5f) * this->m_relX - 0.5f, (y + 0.5f) * this->m_relY - 0.5f, COM_PS_BILINEAR);
+}
+
+void ProxyUpscaleOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
+{
+	unsigned int inputPreferredResolution[2];
+	inputPreferredResolution[0] = preferredResolution[0] / this->m_divider;
+	inputPreferredResolution[1] = preferredResolution[1] / this->m_divider;
+
+	NodeOperation::determineResolution(resolution, inputPreferredResolution);
+
+	/* outputs with a resolution of their own, like the composite output, get exactly that */
+	if (preferredResolution[0] && preferredResolution[1]) {
+		resolution[0] = preferredResolution[0];
+		resolution[1] = preferredResolution[1];
+	}
+	else {
+		resolution[0] *= this->m_divider;
+		resolution[1] *= this->m_divider;
+	}
+}
+
+bool ProxyUpscaleOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
+{
+	NodeOperation *inputOperation = this->getInputOperation(0);
+	const float relX = inputOperation->getWidth() / (float)this->getWidth();
+	const float relY = inputOperation->getHeight() / (float)this->getHeight();
+	rcti newInput;
+
+	newInput.xmin = (int)(input->xmin * relX) - 1;
+	newInput.xmax = (int)(input->xmax * relX) + 2;
+	newInput.ymin = (int)(input->ymin * relY) - 1;
+	newInput.ymax = (int)(input->ymax * relY) + 2;
+
+	return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2013, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ProxyScaleOperation_h_
+#define _COM_ProxyScaleOperation_h_
+#include "COM_NodeOperation.h"
+
+/**
+ * @brief reduces the resolution of a source by an integer divider for a proxy pass
+ * pixels are the average of the divider x divider pixels of the source they cover
+ * @see CompositorContext.getProxyScale
+ */
+class ProxyDownscaleOperation : public NodeOperation {
+private:
+	SocketReader *m_inputOperation;
+	int m_divider;
+
+public:
+	ProxyDownscaleOperation(DataType datatype, int divider);
+
+	void executePixel(float output[4], float x, float y, PixelSampler sampler);
+	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
+
+	void initExecution();
+	void deinitExecution();
+};
+
+/**
+ * @brief scales the result of a proxy pass back to the full resolution for the output operations,
+ * so viewers and the composite output keep their size.
+ * the input is buffered, so the tree before it is only calculated for the proxy resolution
+ */
+class ProxyUpscaleOperation : public NodeOperation {
+private:
+	SocketReader *m_inputOperation;
+	int m_divider;
+	float m_relX;
+	float m_relY;
+
+public:
+	ProxyUpscaleOperation(DataType datatype, int divider);
+
+	void executePixel(float output[4], int x, int y, void *data);
+	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
+
+	void initExecution();
+	void deinitExecution();
+};
+
+#endif
@@ -24,9 +24,9 @@
 #include "COM_WriteBufferOperation.h"
 #include "COM_defines.h"
 
-ReadBufferOperation::ReadBufferOperation() : NodeOperation()
+ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
 {
-	this->addOutputSocket(COM_DT_COLOR);
+	this->addOutputSocket(datatype);
 	this->m_offset = 0;
 	this->m_buffer = NULL;
 }
@@ -64,6 +64,11 @@ void ReadBufferOperation::executePixel(float output[4], float x, float y, float
 	m_buffer->readEWA(output, x, y, dx, dy, sampler);
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int num)
+{
+	m_buffer->readRow(output, x, y, num);
+}
+
 bool ReadBufferOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	if (this == readOperation) {
@@ -21,6 +21,7 @@
  */
 
 #include "COM_SetAlphaOperation.h"
+#include "COM_RowBuffers.h"
 
 SetAlphaOperation::SetAlphaOperation() : NodeOperation()
 {
@@ -48,6 +49,19 @@ void SetAlphaOperation::executePixel(float output[4], float x, float y, PixelSam
 	output[3] = alphaInput[0];
 }
 
+void SetAlphaOperation::executeRow(float *output, int x, int y, int num)
+{
+	RowBuffers buffers(1);
+	float *alphaInput = buffers[0];
+
+	this->m_inputColor->readRow(output, x, y, num);
+	this->m_inputAlpha->readRow(alphaInput, x, y, num);
+
+	for (int i = 0; i < num; i++) {
+		output[i * COM_NUMBER_OF_CHANNELS + 3] = alphaInput[i * COM_NUMBER_OF_CHANNELS];
+	}
+}
+
 void SetAlphaOperation::deinitExecution()
 {
 	this->m_inputColor = NULL;
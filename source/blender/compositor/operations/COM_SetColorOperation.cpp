@@ -32,6 +32,13 @@ void SetColorOperation::executePixel(float output[4], float x, float y, PixelSam
 	copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::executeRow(float *output, int x, int y, int num)
+{
+	for (int i = 0; i < num; i++) {
+		copy_v4_v4(&output[i * COM_NUMBER_OF_CHANNELS], this->m_color);
+	}
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
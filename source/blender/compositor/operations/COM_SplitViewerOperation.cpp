@@ -27,6 +27,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_math_base.h"
 
 extern "C" {
 	#include "MEM_guardedalloc.h"
@@ -68,24 +69,19 @@ void SplitViewerOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 	int y1 = rect->ymin;
 	int x2 = rect->xmax;
 	int y2 = rect->ymax;
-	int offset = (y1 * this->getWidth() + x1) * 4;
-	int x;
 	int y;
 	int perc = this->m_xSplit ? this->m_splitPercentage * this->getWidth() / 100.0f : this->m_splitPercentage * this->getHeight() / 100.0f;
 	for (y = y1; y < y2; y++) {
-		for (x = x1; x < x2; x++) {
-			bool image1;
-			image1 = this->m_xSplit ? x > perc : y > perc;
-			if (image1) {
-				this->m_image1Input->read(&(buffer[offset]), x, y, COM_PS_NEAREST);
-			}
-			else {
-				this->m_image2Input->read(&(buffer[offset]), x, y, COM_PS_NEAREST);
-			}
+		int offset = (y * this->getWidth() + x1) * 4;
+		/* the first image is shown right of and above the split */
+		int xsplit = this->m_xSplit ? max_ii(x1, min_ii(x2, perc + 1)) : (y > perc ? x1 : x2);
 
-			offset += 4;
+		if (xsplit > x1) {
+			this->m_image2Input->readRow(&(buffer[offset]), x1, y, xsplit - x1);
+		}
+		if (xsplit < x2) {
+			this->m_image1Input->readRow(&(buffer[offset + (xsplit - x1) * 4]), xsplit, y, x2 - xsplit);
 		}
-		offset += (this->getWidth() - (x2 - x1)) * 4;
 	}
 	updateImage(rect);
 }
@@ -23,8 +23,6 @@
 #include "COM_VectorBlurOperation.h"
 #include "BLI_math.h"
 
-#include "MEM_guardedalloc.h"
-
 // use the implementation of blender internal renderer to calculate the vector blur.
 extern "C" {
 	#include "RE_pipeline.h"
@@ -56,9 +54,8 @@ void VectorBlurOperation::initExecution()
 
 void VectorBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
-	float *buffer = (float *) data;
-	int index = (y * this->getWidth() + x) * COM_NUMBER_OF_CHANNELS;
-	copy_v4_v4(output, &buffer[index]);
+	MemoryBuffer *buffer = (MemoryBuffer *)data;
+	buffer->readNoCheck(output, x, y);
 }
 
 void VectorBlurOperation::deinitExecution()
@@ -68,12 +65,49 @@ void VectorBlurOperation::deinitExecution()
 	this->m_inputSpeedProgram = NULL;
 	this->m_inputZProgram = NULL;
 	if (this->m_cachedInstance) {
-		MEM_freeN(this->m_cachedInstance);
+		delete this->m_cachedInstance;
 		this->m_cachedInstance = NULL;
 	}
 }
+
+bool VectorBlurOperation::isTiled() const
+{
+	/* without a maximum speed pixels can move across the whole image */
+	return (this->m_settings->maxspeed != 0);
+}
+
+int VectorBlurOperation::getMargin() const
+{
+	/* vertices move at most maxspeed * fac / 2 pixels, or maxspeed pixels along a curve,
+	 * two more pixels for the size of the quads and the antialiasing of the moving pixels */
+	return ceilf(this->m_settings->maxspeed * max(1.0f, 0.5f * this->m_settings->fac)) + 2;
+}
+
+void VectorBlurOperation::determineBlurArea(rcti *rect, rcti *r_area)
+{
+	const int margin = getMargin();
+
+	r_area->xmin = max(rect->xmin - margin, 0);
+	r_area->xmax = min(rect->xmax + margin, (int)this->getWidth());
+	r_area->ymin = max(rect->ymin - margin, 0);
+	r_area->ymax = min(rect->ymax + margin, (int)this->getHeight());
+}
+
 void *VectorBlurOperation::initializeTileData(rcti *rect)
 {
+	if (isTiled()) {
+		MemoryBuffer *tile = (MemoryBuffer *)this->m_inputImageProgram->initializeTileData(rect);
+		MemoryBuffer *speed = (MemoryBuffer *)this->m_inputSpeedProgram->initializeTileData(rect);
+		MemoryBuffer *z = (MemoryBuffer *)this->m_inputZProgram->initializeTileData(rect);
+		rcti area;
+
+		/* every chunk blurs the pixels that can move into it, independent of the other chunks */
+		determineBlurArea(rect, &area);
+		MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, &area);
+		this->generateVectorBlur(result, tile, speed, z);
+		return result;
+	}
+
 	if (this->m_cachedInstance) {
 		return this->m_cachedInstance;
 	}
@@ -83,18 +117,32 @@ void *VectorBlurOperation::initializeTileData(rcti *rect)
 		MemoryBuffer *tile = (MemoryBuffer *)this->m_inputImageProgram->initializeTileData(rect);
 		MemoryBuffer *speed = (MemoryBuffer *)this->m_inputSpeedProgram->initializeTileData(rect);
 		MemoryBuffer *z = (MemoryBuffer *)this->m_inputZProgram->initializeTileData(rect);
-		float *data = (float *)MEM_dupallocN(tile->getBuffer());
-		this->generateVectorBlur(data, tile, speed, z);
-		this->m_cachedInstance = data;
+		rcti area;
+		BLI_rcti_init(&area, 0, this->getWidth(), 0, this->getHeight());
+		MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, &area);
+		this->generateVectorBlur(result, tile, speed, z);
+		this->m_cachedInstance = result;
 	}
 	unlockMutex();
 	return this->m_cachedInstance;
 }
 
+void VectorBlurOperation::deinitializeTileData(rcti *rect, void *data)
+{
+	if (data != this->m_cachedInstance) {
+		delete (MemoryBuffer *)data;
+	}
+}
+
 bool VectorBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
-	if (this->m_cachedInstance == NULL) {
-		rcti newInput;
+	rcti newInput;
+
+	if (isTiled()) {
+		determineBlurArea(input, &newInput);
+		return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+	}
+	else if (this->m_cachedInstance == NULL) {
 		newInput.xmax = this->getWidth();
 		newInput.xmin = 0;
 		newInput.ymax = this->getHeight();
@@ -106,16 +154,28 @@ bool VectorBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuff
 	}
 }
 
-void VectorBlurOperation::generateVectorBlur(float *data, MemoryBuffer *inputImage, MemoryBuffer *inputSpeed, MemoryBuffer *inputZ)
+void VectorBlurOperation::generateVectorBlur(MemoryBuffer *result, MemoryBuffer *inputImage, MemoryBuffer *inputSpeed, MemoryBuffer *inputZ)
 {
-	float *zbuf = inputZ->convertToValueBuffer();
+	rcti *area = result->getRect();
+
+	/* the blur writes to the speed buffer and needs the area as separate buffers */
+	MemoryBuffer *image = new MemoryBuffer(COM_DT_COLOR, area);
+	MemoryBuffer *speed = new MemoryBuffer(COM_DT_COLOR, area);
+	MemoryBuffer *z = new MemoryBuffer(COM_DT_VALUE, area);
+	image->copyContentFrom(inputImage);
+	speed->copyContentFrom(inputSpeed);
+	z->copyContentFrom(inputZ);
+
 	NodeBlurData blurdata;
 	blurdata.samples = this->m_settings->samples / QualityStepHelper::getStep();
 	blurdata.maxspeed = this->m_settings->maxspeed;
 	blurdata.minspeed = this->m_settings->minspeed;
 	blurdata.curved = this->m_settings->curved;
 	blurdata.fac = this->m_settings->fac;
-	RE_zbuf_accumulate_vecblur(&blurdata, this->getWidth(), this->getHeight(), data, inputImage->getBuffer(), inputSpeed->getBuffer(), zbuf);
-	MEM_freeN((void *)zbuf);
-	return;
+	RE_zbuf_accumulate_vecblur(&blurdata, result->getWidth(), result->getHeight(), result->getBuffer(),
+	                           image->getBuffer(), speed->getBuffer(), z->getBuffer());
+
+	delete image;
+	delete speed;
+	delete z;
 }
@@ -40,7 +40,22 @@ private:
 	 */
 	NodeBlurData *m_settings;
 	
-	float *m_cachedInstance;
+	/**
+	 * @brief the blurred image, when it is calculated at once because the speed is not limited
+	 */
+	MemoryBuffer *m_cachedInstance;
+
+	bool isTiled() const;
+
+	/**
+	 * @brief distance in pixels that the blur can move pixels
+	 */
+	int getMargin() const;
+
+	/**
+	 * @brief area of the inputs that is blurred to calculate a chunk
+	 */
+	void determineBlurArea(rcti *rect, rcti *r_area);
 
 public:
 	VectorBlurOperation();
@@ -61,12 +76,13 @@ public:
 	void deinitExecution();
 
 	void *initializeTileData(rcti *rect);
+	void deinitializeTileData(rcti *rect, void *data);
 
 	void setVectorBlurSettings(NodeBlurData *settings) { this->m_settings = settings; }
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 protected:
 	
-	void generateVectorBlur(float *data, MemoryBuffer *inputImage, MemoryBuffer *inputSpeed, MemoryBuffer *inputZ);
+	void generateVectorBlur(MemoryBuffer *result, MemoryBuffer *inputImage, MemoryBuffer *inputSpeed, MemoryBuffer *inputZ);
 	
 	
 };
@@ -30,6 +30,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_math_base.h"
 
 extern "C" {
 	#include "MEM_guardedalloc.h"
@@ -77,40 +78,47 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 	const int y1 = rect->ymin;
 	const int x2 = rect->xmax;
 	const int y2 = rect->ymax;
-	const int offsetadd = (this->getWidth() - (x2 - x1));
-	const int offsetadd4 = offsetadd * 4;
-	int offset = (y1 * this->getWidth() + x1);
-	int offset4 = offset * 4;
-	float alpha[4], depth[4];
+	float row[COM_ROW_BLOCK_SIZE * COM_NUMBER_OF_CHANNELS];
 	int x;
 	int y;
+	int i;
 	bool breaked = false;
 
+	/* the inputs are read a row at a time, the display buffer of the whole region
+	 * is updated at once by updateImage */
 	for (y = y1; y < y2 && (!breaked); y++) {
-		for (x = x1; x < x2; x++) {
-			this->m_imageInput->read(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-			if (this->m_ignoreAlpha) {
-				buffer[offset4 + 3] = 1.0f;
+		const int offset = y * this->getWidth() + x1;
+
+		this->m_imageInput->readRow(&(buffer[offset * 4]), x1, y, x2 - x1);
+
+		if (this->m_ignoreAlpha) {
+			for (i = 0; i < x2 - x1; i++) {
+				buffer[(offset + i) * 4 + 3] = 1.0f;
 			}
-			else {
-				if (this->m_alphaInput != NULL) {
-					this->m_alphaInput->read(alpha, x, y, COM_PS_NEAREST);
-					buffer[offset4 + 3] = alpha[0];
+		}
+		else if (this->m_alphaInput != NULL) {
+			for (x = x1; x < x2; x += COM_ROW_BLOCK_SIZE) {
+				const int num = min_ii(x2 - x, COM_ROW_BLOCK_SIZE);
+				this->m_alphaInput->readRow(row, x, y, num);
+				for (i = 0; i < num; i++) {
+					buffer[(offset + x - x1 + i) * 4 + 3] = row[i * COM_NUMBER_OF_CHANNELS];
 				}
 			}
-			if (m_depthInput) {
-				this->m_depthInput->read(depth, x, y, COM_PS_NEAREST);
-				depthbuffer[offset] = depth[0];
-			}
+		}
 
-			offset ++;
-			offset4 += 4;
+		if (this->m_depthInput) {
+			for (x = x1; x < x2; x += COM_ROW_BLOCK_SIZE) {
+				const int num = min_ii(x2 - x, COM_ROW_BLOCK_SIZE);
+				this->m_depthInput->readRow(row, x, y, num);
+				for (i = 0; i < num; i++) {
+					depthbuffer[offset + x - x1 + i] = row[i * COM_NUMBER_OF_CHANNELS];
+				}
+			}
 		}
+
 		if (isBreaked()) {
 			breaked = true;
 		}
-		offset += offsetadd;
-		offset4 += offsetadd4;
 	}
 	updateImage(rect);
 }
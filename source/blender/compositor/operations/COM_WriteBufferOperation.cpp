@@ -25,12 +25,15 @@
 #include <stdio.h>
 #include "COM_OpenCLDevice.h"
 
-WriteBufferOperation::WriteBufferOperation() : NodeOperation()
+#include "BKE_global.h"
+
+WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
 {
-	this->addInputSocket(COM_DT_COLOR);
-	this->m_memoryProxy = new MemoryProxy();
+	this->addInputSocket(datatype);
+	this->m_memoryProxy = new MemoryProxy(datatype);
 	this->m_memoryProxy->setWriteBufferOperation(this);
 	this->m_memoryProxy->setExecutor(NULL);
+	this->m_useRowExecution = true;
 }
 WriteBufferOperation::~WriteBufferOperation()
 {
@@ -49,6 +52,7 @@ void WriteBufferOperation::initExecution()
 {
 	this->m_input = this->getInputOperation(0);
 	this->m_memoryProxy->allocate(this->m_width, this->m_height);
+	this->m_useRowExecution = (G.debug_value != COM_DEBUG_VALUE_PIXEL_EXECUTION);
 }
 
 void WriteBufferOperation::deinitExecution()
@@ -61,6 +65,9 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 {
 	MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
 	float *buffer = memoryBuffer->getBuffer();
+	/* value and vector buffers store less than COM_NUMBER_OF_CHANNELS floats per pixel */
+	const int numChannels = memoryBuffer->getNumberOfChannels();
+	float color[COM_NUMBER_OF_CHANNELS];
 	if (this->m_input->isComplex()) {
 		void *data = this->m_input->initializeTileData(rect);
 		int x1 = rect->xmin;
@@ -71,10 +78,11 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
+			int offset = (y * memoryBuffer->getWidth() + x1) * numChannels;
 			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, data);
-				offset4 += COM_NUMBER_OF_CHANNELS;
+				this->m_input->read(color, x, y, data);
+				memcpy(&(buffer[offset]), color, sizeof(float) * numChannels);
+				offset += numChannels;
 
 			}
 			if (isBreaked()) {
@@ -87,6 +95,34 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 			data = NULL;
 		}
 	}
+	else if (this->m_useRowExecution) {
+		int x1 = rect->xmin;
+		int y1 = rect->ymin;
+		int x2 = rect->xmax;
+		int y2 = rect->ymax;
+
+		int x;
+		int y;
+		bool breaked = false;
+		for (y = y1; y < y2 && (!breaked); y++) {
+			if (numChannels == COM_NUMBER_OF_CHANNELS) {
+				int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
+				this->m_input->readRow(&(buffer[offset4]), x1, y, x2 - x1);
+			}
+			else {
+				/* calculate in blocks and pack them into the buffer */
+				float row[COM_ROW_BLOCK_SIZE * COM_NUMBER_OF_CHANNELS];
+				for (x = x1; x < x2; x += COM_ROW_BLOCK_SIZE) {
+					int num = min(x2 - x, COM_ROW_BLOCK_SIZE);
+					this->m_input->readRow(row, x, y, num);
+					memoryBuffer->writeRow(row, x, y, num);
+				}
+			}
+			if (isBreaked()) {
+				breaked = true;
+			}
+		}
+	}
 	else {
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
@@ -97,10 +133,11 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * COM_NUMBER_OF_CHANNELS;
+			int offset = (y * memoryBuffer->getWidth() + x1) * numChannels;
 			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += COM_NUMBER_OF_CHANNELS;
+				this->m_input->read(color, x, y, COM_PS_NEAREST);
+				memcpy(&(buffer[offset]), color, sizeof(float) * numChannels);
+				offset += numChannels;
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -108,6 +145,7 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 		}
 	}
 	memoryBuffer->setCreatedState();
+	memoryBuffer->releaseArea(rect);
 }
 
 void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device, rcti *rect, unsigned int chunkNumber,
@@ -127,12 +165,9 @@ void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device, rcti *rect,
 	const unsigned int outputBufferWidth = outputBuffer->getWidth();
 	const unsigned int outputBufferHeight = outputBuffer->getHeight();
 
-	const cl_image_format imageFormat = {
-		CL_RGBA,
-		CL_FLOAT
-	};
+	const cl_image_format *imageFormat = OpenCLDevice::determineImageFormat(outputBuffer);
 
-	cl_mem clOutputBuffer = clCreateImage2D(device->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, &imageFormat, outputBufferWidth, outputBufferHeight, 0, outputFloatBuffer, &error);
+	cl_mem clOutputBuffer = clCreateImage2D(device->getContext(), CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, imageFormat, outputBufferWidth, outputBufferHeight, 0, outputFloatBuffer, &error);
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
 	
 	// STEP 2
@@ -156,6 +191,7 @@ void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device, rcti *rect,
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
 	
 	this->getMemoryProxy()->getBuffer()->copyContentFrom(outputBuffer);
+	this->getMemoryProxy()->getBuffer()->releaseArea(outputBuffer->getRect());
 
 	// STEP 4
 	while (clMemToCleanUp->size() > 0) {
@@ -33,8 +33,9 @@
 class WriteBufferOperation : public NodeOperation {
 	MemoryProxy *m_memoryProxy;
 	NodeOperation *m_input;
+	bool m_useRowExecution;
 public:
-	WriteBufferOperation();
+	WriteBufferOperation(DataType datatype);
 	~WriteBufferOperation();
 	int isBufferOperation() { return true; }
 	MemoryProxy *getMemoryProxy() { return this->m_memoryProxy; }
@@ -348,10 +348,12 @@ static int sound_mixdown_exec(bContext *C, wmOperator *op)
 
 	if (split)
 		result = AUD_mixdown_per_channel(scene->sound_scene, SFRA * specs.rate / FPS, (EFRA - SFRA) * specs.rate / FPS,
-		                                 accuracy, filename, specs, container, codec, bitrate);
+		                                 accuracy, filename, specs, container, codec, bitrate,
+		                                 BKE_render_num_threads(&scene->r));
 	else
 		result = AUD_mixdown(scene->sound_scene, SFRA * specs.rate / FPS, (EFRA - SFRA) * specs.rate / FPS,
-		                     accuracy, filename, specs, container, codec, bitrate);
+		                     accuracy, filename, specs, container, codec, bitrate,
+		                     BKE_render_num_threads(&scene->r));
 
 	if (result) {
 		BKE_report(op->reports, RPT_ERROR, result);
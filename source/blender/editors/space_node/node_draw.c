@@ -871,6 +871,18 @@ static void node_draw_basis(const bContext *C, ARegion *ar, SpaceNode *snode, bN
 	         (short)(iconofs - rct->xmin - 18.0f), (short)NODE_DY,
 	         NULL, 0, 0, 0, 0, "");
 
+	/* compositor profiling, time spent on the buffers of the node above the header */
+	if (snode->nodetree && (snode->nodetree->type == NTREE_COMPOSIT) &&
+	    (snode->nodetree->flag & NTREE_COM_PROFILE) && node->exec_time > 0.0f)
+	{
+		char timestr[32];
+		BLI_snprintf(timestr, sizeof(timestr), "%.1f ms", node->exec_time * 1000.0f);
+		uiDefBut(node->block, LABEL, 0, timestr,
+		         (int)(rct->xmin + (NODE_MARGIN_X)), (int)rct->ymax,
+		         (short)(BLI_rctf_size_x(rct) - NODE_MARGIN_X), (short)NODE_DY,
+		         NULL, 0, 0, 0, 0, "");
+	}
+
 	/* body */
 	if (!nodeIsRegistered(node))
 		UI_ThemeColor4(TH_REDALERT);	/* use warning color to indicate undefined types */
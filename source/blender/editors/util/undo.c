@@ -72,6 +72,10 @@
 #include "UI_interface.h"
 #include "UI_resources.h"
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 #include "util_intern.h"
 
 /* ***************** generic undo system ********************* */
@@ -195,6 +199,11 @@ static int ed_undo_step(bContext *C, int step, const char *undoname)
 				BKE_undo_name(C, undoname);
 			else
 				BKE_undo_step(C, step);
+
+#ifdef WITH_COMPOSITOR
+			/* cached compositor buffers are keyed on pointers of the freed data */
+			COM_clearCaches();
+#endif
 				
 			WM_event_add_notifier(C, NC_SCENE | ND_LAYER_CONTENT, CTX_data_scene(C));
 		}
@@ -529,6 +538,9 @@ static int undo_history_exec(bContext *C, wmOperator *op)
 		}
 		else {
 			BKE_undo_number(C, item);
+#ifdef WITH_COMPOSITOR
+			COM_clearCaches();
+#endif
 			WM_event_add_notifier(C, NC_SCENE | ND_LAYER_CONTENT, CTX_data_scene(C));
 		}
 		WM_event_add_notifier(C, NC_WINDOW, NULL);
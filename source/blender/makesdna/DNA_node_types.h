@@ -217,7 +217,7 @@ typedef struct bNode {
 	 * and replacing all uses with per-instance data.
 	 */
 	short preview_xsize, preview_ysize;	/* reserved size of the preview rect */
-	int pad2;
+	float exec_time;		/* compositor profiling: seconds spent on the buffers of this node in the last execution */
 	struct uiBlock *block;	/* runtime during drawing */
 } bNode;
 
@@ -319,6 +319,10 @@ typedef struct bNodeLink {
 #define NTREE_QUALITY_MEDIUM  1
 #define NTREE_QUALITY_LOW     2
 
+#define NTREE_PROXY_NONE      0
+#define NTREE_PROXY_HALF      2
+#define NTREE_PROXY_QUARTER   4
+
 /* tree->chunksize */
 #define NTREE_CHUNCKSIZE_32 32
 #define NTREE_CHUNCKSIZE_64 64
@@ -350,7 +354,7 @@ typedef struct bNodeTree {
 	int update;						/* update flags */
 	short is_updating;				/* flag to prevent reentrant update calls */
 	short done;						/* generic temporary flag for recursion check (DFS/BFS) */
-	int pad2;
+	int memory_limit;				/* compositor buffer memory in megabytes before spilling to disk, 0 for no limit */
 	
 	int nodetype DNA_DEPRECATED;	/* specific node type this tree is used for */
 
@@ -374,7 +378,8 @@ typedef struct bNodeTree {
 	 * in case multiple different editors are used and make context ambiguous.
 	 */
 	bNodeInstanceKey active_viewer_key;
-	int pad;
+	short edit_proxy;				/* resolution divider of the first compositor pass when editing */
+	short pad;
 	
 	/* execution data */
 	/* XXX It would be preferable to completely move this data out of the underlying node tree,
@@ -409,6 +414,7 @@ typedef struct bNodeTree {
 #define NTREE_TWO_PASS				4	/* two pass */
 #define NTREE_COM_GROUPNODE_BUFFER	8	/* use groupnode buffers */
 #define NTREE_VIEWER_BORDER			16	/* use a border for viewer nodes */
+#define NTREE_COM_PROFILE			32	/* show compositor profiling times on the nodes */
 
 /* XXX not nice, but needed as a temporary flags
  * for group updates after library linking.
@@ -405,6 +405,8 @@ typedef struct UserDef {
 	int audiorate;
 	int audioformat;
 	int audiochannels;
+	int audiocachelimit;	/* memory limit of the decoded sound cache in megabytes, 0 for none */
+	int audiocacheflag;
 
 	int scrollback; /* console scrollback limit */
 	int dpi;		/* range 48-128? */
@@ -473,7 +475,7 @@ typedef struct UserDef {
 	float sculpt_paint_overlay_col[3];
 
 	short tweak_threshold;
-	short pad3;
+	short compositor_flag;	/* eUserpref_Compositor_Flag */
 
 	char author[80];	/* author name for file formats supporting it */
 
@@ -628,6 +630,16 @@ typedef enum eUserpref_Translation_Flags {
 	USER_TR_NEWDATANAME		= (1 << 8),
 } eUserpref_Translation_Flags;
 
+/* audiocacheflag */
+typedef enum eUserpref_AudioCache_Flag {
+	USER_AUDIO_CACHE_SPILL	= (1 << 0),
+} eUserpref_AudioCache_Flag;
+
+/* compositor_flag */
+typedef enum eUserpref_Compositor_Flag {
+	USER_COMPOSITOR_DISABLE_CACHE	= (1 << 0),
+} eUserpref_Compositor_Flag;
+
 /* dupflag */
 typedef enum eDupli_ID_Flags {
 	USER_DUP_MESH			= (1 << 0),
@@ -89,6 +89,13 @@ EnumPropertyItem node_quality_items[] = {
 	{0, NULL, 0, NULL, NULL}
 };
 
+EnumPropertyItem node_proxy_items[] = {
+	{NTREE_PROXY_NONE,    "NONE",     0,    "None",     "Calculate the full resolution only"},
+	{NTREE_PROXY_HALF,    "HALF",     0,    "1/2",      "Calculate half of the resolution first"},
+	{NTREE_PROXY_QUARTER, "QUARTER",  0,    "1/4",      "Calculate a quarter of the resolution first"},
+	{0, NULL, 0, NULL, NULL}
+};
+
 EnumPropertyItem node_chunksize_items[] = {
 	{NTREE_CHUNCKSIZE_32,   "32",     0,    "32x32",     "Chunksize of 32x32"},
 	{NTREE_CHUNCKSIZE_64,   "64",     0,    "64x64",     "Chunksize of 64x64"},
@@ -7267,12 +7274,26 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_enum_items(prop, node_quality_items);
 	RNA_def_property_ui_text(prop, "Edit Quality", "Quality when editing");
 
+	prop = RNA_def_property(srna, "edit_proxy", PROP_ENUM, PROP_NONE);
+	RNA_def_property_enum_sdna(prop, NULL, "edit_proxy");
+	RNA_def_property_enum_items(prop, node_proxy_items);
+	RNA_def_property_ui_text(prop, "Edit Proxy", "Resolution of a first pass during editing, the full resolution "
+	                                             "is calculated afterwards when nothing is edited in between");
+
 	prop = RNA_def_property(srna, "chunk_size", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "chunksize");
 	RNA_def_property_enum_items(prop, node_chunksize_items);
 	RNA_def_property_ui_text(prop, "Chunksize", "Max size of a tile (smaller values gives better distribution "
 	                                            "of multiple threads, but more overhead)");
 
+	prop = RNA_def_property(srna, "memory_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "memory_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 1024 * 256, 256, 0);
+	RNA_def_property_ui_text(prop, "Memory Limit", "Memory for the buffers of complex nodes (in megabytes), buffers "
+	                                               "beyond the limit are stored in scratch files in the temporary "
+	                                               "directory (0 for no limit)");
+
 	prop = RNA_def_property(srna, "use_opencl", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_OPENCL);
 	RNA_def_property_ui_text(prop, "OpenCL", "Enable GPU calculations");
@@ -7286,6 +7307,12 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Two Pass", "Use two pass execution during editing: first calculate fast nodes, "
 	                                           "second pass calculate all nodes");
 
+	prop = RNA_def_property(srna, "use_profile", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_PROFILE);
+	RNA_def_property_ui_text(prop, "Profile", "Show the time spent on the buffers of every node in the last "
+	                                          "execution (with --debug-compositor a report is written as well)");
+	RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
+
 	prop = RNA_def_property(srna, "use_viewer_border", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_VIEWER_BORDER);
 	RNA_def_property_ui_text(prop, "Viewer Border", "Use boundaries for viewer nodes and composite backdrop");
@@ -290,6 +290,11 @@ static void rna_UserDef_audio_update(Main *bmain, Scene *UNUSED(scene), PointerR
 	sound_init(bmain);
 }
 
+static void rna_UserDef_audio_cache_update(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *UNUSED(ptr))
+{
+	sound_init_cache();
+}
+
 static void rna_Userdef_memcache_update(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *UNUSED(ptr))
 {
 	MEM_CacheLimiter_set_maximum(((size_t) U.memcachelimit) * 1024 * 1024);
@@ -3549,6 +3554,12 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
 	RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+	prop = RNA_def_property(srna, "use_compositor_cache", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_negative_sdna(prop, NULL, "compositor_flag", USER_COMPOSITOR_DISABLE_CACHE);
+	RNA_def_property_ui_text(prop, "Compositor Cache",
+	                         "Keep the results of slow compositor nodes in the memory cache to reuse them "
+	                         "while editing nodes after them (never used when running in background)");
+
 	prop = RNA_def_property(srna, "frame_server_port", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "frameserverport");
 	RNA_def_property_range(prop, 0, 32727);
@@ -3655,6 +3666,21 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Audio Channels", "Audio channel count");
 	RNA_def_property_update(prop, 0, "rna_UserDef_audio_update");
 
+	prop = RNA_def_property(srna, "audio_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "audiocachelimit");
+	RNA_def_property_range(prop, 0, (sizeof(void *) == 8) ? 1024 * 32 : 1024); /* 32 bit 2 GB, 64 bit 32 GB */
+	RNA_def_property_ui_text(prop, "Audio Cache Limit",
+	                         "Memory limit of cached sounds shared by all scenes, zero keeps them only while used "
+	                         "(in megabytes)");
+	RNA_def_property_update(prop, 0, "rna_UserDef_audio_cache_update");
+
+	prop = RNA_def_property(srna, "use_audio_cache_spill", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "audiocacheflag", USER_AUDIO_CACHE_SPILL);
+	RNA_def_property_ui_text(prop, "Spill Audio Cache",
+	                         "Write cached sounds over the memory limit to the temporary directory, "
+	                         "otherwise only unused sounds are removed and decoded again when used");
+	RNA_def_property_update(prop, 0, "rna_UserDef_audio_cache_update");
+
 	prop = RNA_def_property(srna, "screencast_fps", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "scrcastfps");
 	RNA_def_property_range(prop, 10, 50);
@@ -111,12 +111,48 @@ static void free_cache(bNodeTree *ntree)
 		free_node_cache(ntree, node);
 }
 
+/* the compositor reads the nodes inside groups from the group trees, which are not localized,
+ * so their execution tags are moved to the localized group nodes, see COM_GroupNode */
+static int group_need_exec(bNodeTree *ngroup)
+{
+	bNode *node;
+	
+	for (node = ngroup->nodes.first; node; node = node->next) {
+		if (node->need_exec)
+			return TRUE;
+		if (node->type == NODE_GROUP && node->id && group_need_exec((bNodeTree *)node->id))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void group_clear_need_exec(bNodeTree *ngroup)
+{
+	bNode *node;
+	
+	for (node = ngroup->nodes.first; node; node = node->next) {
+		node->need_exec = 0;
+		if (node->type == NODE_GROUP && node->id)
+			group_clear_need_exec((bNodeTree *)node->id);
+	}
+}
+
 /* local tree then owns all compbufs */
 static void localize(bNodeTree *localtree, bNodeTree *ntree)
 {
 	bNode *node, *node_next;
 	bNodeSocket *sock;
 	
+	/* first tag all group nodes, groups can be used more than once */
+	for (node = ntree->nodes.first; node; node = node->next) {
+		if (node->type == NODE_GROUP && node->id && group_need_exec((bNodeTree *)node->id))
+			node->new_node->need_exec = 1;
+	}
+	for (node = ntree->nodes.first; node; node = node->next) {
+		if (node->type == NODE_GROUP && node->id)
+			group_clear_need_exec((bNodeTree *)node->id);
+	}
+	
 	for (node = ntree->nodes.first; node; node = node->next) {
 		/* ensure new user input gets handled ok */
 		node->need_exec = 0;
@@ -177,6 +213,9 @@ static void local_merge(bNodeTree *localtree, bNodeTree *ntree)
 	
 	for (lnode = localtree->nodes.first; lnode; lnode = lnode->next) {
 		if (ntreeNodeExists(ntree, lnode->new_node)) {
+			/* profiling times are written to the localized nodes */
+			lnode->new_node->exec_time = lnode->exec_time;
+			
 			if (ELEM(lnode->type, CMP_NODE_VIEWER, CMP_NODE_SPLITVIEWER)) {
 				if (lnode->id && (lnode->flag & NODE_DO_OUTPUT)) {
 					/* image_merge does sanity check for pointers */
@@ -300,8 +300,11 @@ static void cmp_node_image_verify_outputs(bNodeTree *ntree, bNode *node)
 static void cmp_node_image_update(bNodeTree *ntree, bNode *node)
 {
 	/* avoid unnecessary updates, only changes to the image/image user data are of interest */
-	if (node->update & NODE_UPDATE_ID)
+	if (node->update & NODE_UPDATE_ID) {
 		cmp_node_image_verify_outputs(ntree, node);
+		/* image was reloaded or changed, results cached after this node are stale */
+		node->need_exec = 1;
+	}
 }
 
 static void node_composit_init_image(bNodeTree *ntree, bNode *node)
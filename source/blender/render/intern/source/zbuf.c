@@ -2894,6 +2894,7 @@ void RE_zbuf_accumulate_vecblur(NodeBlurData *nbd, int xsize, int ysize, float *
 	int y, x, step, maxspeed=nbd->maxspeed, samples= nbd->samples;
 	int tsktsk= 0;
 	static int firsttime= 1;
+	static ThreadMutex jit_mutex= BLI_MUTEX_INITIALIZER;
 	char *rectmove, *dm;
 	
 	zbuf_alloc_span(&zspan, xsize, ysize, 1.0f);
@@ -3057,11 +3058,14 @@ void RE_zbuf_accumulate_vecblur(NodeBlurData *nbd, int xsize, int ysize, float *
 	
 	antialias_tagbuf(xsize, ysize, rectmove);
 	
-	/* has to become static, the init-jit calls a random-seed, screwing up texture noise node */
+	/* has to become static, the init-jit calls a random-seed, screwing up texture noise node.
+	 * the compositor blurs tiles of the same image from multiple threads */
+	BLI_mutex_lock(&jit_mutex);
 	if (firsttime) {
-		firsttime= 0;
 		BLI_jitter_init(jit[0], 256);
+		firsttime= 0;
 	}
+	BLI_mutex_unlock(&jit_mutex);
 	
 	memset(newrect, 0, sizeof(float)*xsize*ysize*4);
 
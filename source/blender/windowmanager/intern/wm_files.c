@@ -112,6 +112,10 @@
 
 #include "GPU_draw.h"
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 #ifdef WITH_PYTHON
 #include "BPY_extern.h"
 #endif
@@ -411,6 +415,10 @@ void WM_file_read(bContext *C, const char *filepath, ReportList *reports)
 		/* confusing this global... */
 		G.relbase_valid = 1;
 		retval = BKE_read_file(C, filepath, reports);
+#ifdef WITH_COMPOSITOR
+		/* cached compositor buffers are keyed on pointers of the freed data */
+		COM_clearCaches();
+#endif
 		/* when loading startup.blend's, we can be left with a blank path */
 		if (G.main->name[0]) {
 			G.save_over = 1;
@@ -575,6 +583,10 @@ int wm_homefile_read(bContext *C, ReportList *UNUSED(reports), short from_memory
 	 * can remove this eventually, only in a 2.53 and older, now its not written */
 	G.fileflags &= ~G_FILE_RELATIVE_REMAP;
 	
+#ifdef WITH_COMPOSITOR
+	COM_clearCaches();
+#endif
+
 	/* check userdef before open window, keymaps etc */
 	wm_init_userdef(C);
 	
@@ -0,0 +1,114 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Times compositing of a 4K frame through a long chain of pixel-wise nodes
+# (mix, math, color conversion, set alpha), once with row execution and once
+# pixel by pixel, see COM_DEBUG_VALUE_PIXEL_EXECUTION.
+#
+# No render layer nodes are used, so only the compositor runs. Both have to
+# give the same result.
+
+# ./blender.bin --background --factory-startup --python source/tests/bl_compositor_benchmark.py
+# ./blender.bin --background --factory-startup --python source/tests/bl_compositor_benchmark.py -- --chain=10 --repeat=3
+
+import os
+import sys
+
+import bpy
+
+sys.path.append(os.path.dirname(__file__))
+from bl_compositor_benchmark_utils import (
+    parse_args,
+    scene_setup,
+    render_time,
+    result_pixels,
+    result_difference,
+)
+
+# must match COM_defines.h
+COM_DEBUG_VALUE_PIXEL_EXECUTION = 17
+
+WIDTH = 3840
+HEIGHT = 2160
+
+# the row functions may be vectorized differently than executePixel
+TOLERANCE = 1e-5
+
+
+def chain_setup(chain):
+    tree, node_image, node_composite = scene_setup(WIDTH, HEIGHT)
+
+    socket = node_image.outputs["Image"]
+
+    # every iteration adds 9 pixel-wise operations
+    for i in range(chain):
+        for blend_type in ('MIX', 'ADD', 'MULTIPLY', 'SUBTRACT'):
+            node = tree.nodes.new('CompositorNodeMixRGB')
+            node.blend_type = blend_type
+            node.inputs[0].default_value = 0.25
+            node.inputs[2].default_value = (0.5, 0.4, 0.3, 1.0)
+            tree.links.new(socket, node.inputs[1])
+            socket = node.outputs[0]
+
+        node_bw = tree.nodes.new('CompositorNodeRGBToBW')
+        tree.links.new(socket, node_bw.inputs[0])
+
+        for operation in ('MULTIPLY', 'ADD', 'MAXIMUM'):
+            node = tree.nodes.new('CompositorNodeMath')
+            node.operation = operation
+            node.inputs[1].default_value = 0.5
+            tree.links.new(node_bw.outputs[0], node.inputs[0])
+            node_bw = node
+
+        node = tree.nodes.new('CompositorNodeSetAlpha')
+        tree.links.new(socket, node.inputs[0])
+        tree.links.new(node_bw.outputs[0], node.inputs[1])
+        socket = node.outputs[0]
+
+    tree.links.new(socket, node_composite.inputs[0])
+
+
+def main():
+    args = parse_args()
+
+    chain = int(args.get("chain", 4))
+    repeat = int(args.get("repeat", 3))
+
+    chain_setup(chain)
+
+    time_row = render_time(0, repeat)
+    pixels_row = result_pixels()
+    time_pixel = render_time(COM_DEBUG_VALUE_PIXEL_EXECUTION, repeat)
+    pixels_pixel = result_pixels()
+
+    difference = result_difference(pixels_row, pixels_pixel)
+
+    print("Compositor benchmark %dx%d, %d operations" % (WIDTH, HEIGHT, chain * 9))
+    print("  pixel execution: %.3fs" % time_pixel)
+    print("  row execution:   %.3fs" % time_row)
+    print("  speedup:         %.2fx" % (time_pixel / time_row))
+    print("  difference:      %g" % difference)
+
+    if difference > TOLERANCE:
+        raise Exception("row execution result differs from pixel execution by %g" % difference)
+
+
+if __name__ == "__main__":
+    main()
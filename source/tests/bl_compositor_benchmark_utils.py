@@ -0,0 +1,112 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Shared by the compositor benchmarks, not a test by itself.
+#
+# Every render has to composite the whole tree again, so the compositor
+# buffer cache is disabled. Running in background disables it as well.
+
+import os
+import tempfile
+import time
+
+import bpy
+
+
+def parse_args():
+    import sys
+
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    return dict(arg.lstrip("-").split("=") for arg in argv)
+
+
+def scene_setup(width, height):
+    """
+    Composite a generated float image, no render layers are used
+    so only the compositor runs.
+    """
+    scene = bpy.context.scene
+    render = scene.render
+
+    render.resolution_x = width
+    render.resolution_y = height
+    render.resolution_percentage = 100
+    render.use_compositing = True
+    render.use_sequencer = False
+
+    # keep the result precision for result_pixels()
+    render.image_settings.file_format = 'OPEN_EXR'
+    render.image_settings.color_depth = '32'
+
+    bpy.context.user_preferences.system.use_compositor_cache = False
+
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    image = bpy.data.images.new("bench", width, height, alpha=True, float_buffer=True)
+    image.generated_type = 'COLOR_GRID'
+
+    node_image = tree.nodes.new('CompositorNodeImage')
+    node_image.image = image
+
+    node_composite = tree.nodes.new('CompositorNodeComposite')
+
+    return tree, node_image, node_composite
+
+
+def render_time(debug_value, repeat):
+    """
+    Best time of repeat renders with bpy.app.debug_value set,
+    the debug value selects the algorithm of some operations.
+    """
+    assert(not bpy.context.user_preferences.system.use_compositor_cache)
+
+    bpy.app.debug_value = debug_value
+
+    times = []
+    for i in range(repeat):
+        t = time.time()
+        bpy.ops.render.render()
+        times.append(time.time() - t)
+
+    bpy.app.debug_value = 0
+    return min(times)
+
+
+def result_pixels(step=97):
+    """
+    Every step'th value of the last render result.
+    """
+    filepath = os.path.join(tempfile.gettempdir(), "bl_compositor_benchmark.exr")
+
+    bpy.data.images["Render Result"].save_render(filepath)
+    image = bpy.data.images.load(filepath)
+    pixels = image.pixels[:][::step]
+
+    bpy.data.images.remove(image)
+    os.remove(filepath)
+
+    return pixels
+
+
+def result_difference(pixels_a, pixels_b):
+    assert(len(pixels_a) == len(pixels_b))
+    return max(abs(a - b) for a, b in zip(pixels_a, pixels_b))
@@ -0,0 +1,116 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Times the bokeh blur and the gaussian blur with bokeh for a range of radii,
+# once with the FFT convolution and once summing the kernel for every pixel,
+# see COM_DEBUG_VALUE_DIRECT_CONVOLUTION. Radii below COM_FFT_CONVOLUTION_MIN_RADIUS
+# always sum the kernel, so both columns are the same there.
+#
+# The results of both are compared: they have to be close, and from the
+# FFT radius on they must not be the same, otherwise both timed the same code.
+#
+# Use this to find the radius where the FFT convolution becomes faster.
+
+# ./blender.bin --background --factory-startup --python source/tests/bl_compositor_convolution_benchmark.py
+# ./blender.bin --background --factory-startup --python source/tests/bl_compositor_convolution_benchmark.py -- --radii=8,16,32,64 --repeat=3
+
+import os
+import sys
+
+import bpy
+
+sys.path.append(os.path.dirname(__file__))
+from bl_compositor_benchmark_utils import (
+    parse_args,
+    scene_setup,
+    render_time,
+    result_pixels,
+    result_difference,
+)
+
+# must match COM_defines.h
+COM_DEBUG_VALUE_DIRECT_CONVOLUTION = 18
+COM_FFT_CONVOLUTION_MIN_RADIUS = 32
+
+WIDTH = 1920
+HEIGHT = 1080
+
+# the FFT convolution rounds differently than the sum, relative to the color grid values
+TOLERANCE = 1e-3
+
+
+def blur_setup(tree, node_image, node_composite, blur_type, radius):
+    for node in list(tree.nodes):
+        if node not in (node_image, node_composite):
+            tree.nodes.remove(node)
+
+    if blur_type == 'BOKEH':
+        node_bokeh_image = tree.nodes.new('CompositorNodeBokehImage')
+        node = tree.nodes.new('CompositorNodeBokehBlur')
+        # size is a percentage of the largest image dimension, the operation
+        # truncates it back to pixels
+        node.inputs["Size"].default_value = (radius + 0.5) * 100.0 / max(WIDTH, HEIGHT)
+        tree.links.new(node_bokeh_image.outputs[0], node.inputs["Bokeh"])
+    else:
+        node = tree.nodes.new('CompositorNodeBlur')
+        node.filter_type = 'GAUSS'
+        node.use_bokeh = True
+        node.size_x = radius
+        node.size_y = radius
+
+    tree.links.new(node_image.outputs["Image"], node.inputs["Image"])
+    tree.links.new(node.outputs[0], node_composite.inputs[0])
+
+
+def main():
+    args = parse_args()
+
+    radii = [int(radius) for radius in args.get("radii", "4,8,16,24,32,48,64,128,256").split(",")]
+    repeat = int(args.get("repeat", 2))
+
+    tree, node_image, node_composite = scene_setup(WIDTH, HEIGHT)
+
+    print("Compositor convolution benchmark %dx%d" % (WIDTH, HEIGHT))
+
+    for blur_type in ('BOKEH', 'GAUSS'):
+        print("  %s blur" % blur_type.lower())
+        print("    radius      sum      fft  speedup  difference")
+
+        for radius in radii:
+            blur_setup(tree, node_image, node_composite, blur_type, radius)
+
+            time_fft = render_time(0, repeat)
+            pixels_fft = result_pixels()
+            time_sum = render_time(COM_DEBUG_VALUE_DIRECT_CONVOLUTION, repeat)
+            pixels_sum = result_pixels()
+
+            difference = result_difference(pixels_fft, pixels_sum)
+
+            print("    %6d %7.3fs %7.3fs %7.2fx  %10.3g" %
+                  (radius, time_sum, time_fft, time_sum / time_fft, difference))
+
+            if difference > TOLERANCE:
+                raise Exception("FFT convolution result differs from the sum by %g" % difference)
+            if radius >= COM_FFT_CONVOLUTION_MIN_RADIUS and difference == 0.0:
+                raise Exception("FFT convolution was not used for radius %d" % radius)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Times the audio mixdown of a timeline with many overlapping sound strips for
+# a range of thread counts, the mixdown reads the strips on scene.render.threads
+# threads. Every mixdown has to be byte for byte the same as the single threaded
+# one, the benchmark fails otherwise.
+#
+# The strips are 44.1kHz and mixed at 48kHz, so they are resampled as well.
+
+# ./blender.bin --background --factory-startup --python source/tests/bl_sound_mixdown_benchmark.py
+# ./blender.bin --background --factory-startup --python source/tests/bl_sound_mixdown_benchmark.py -- --strips=40 --seconds=600 --threads=1,4,16
+
+import math
+import os
+import struct
+import tempfile
+import time
+import wave
+
+import bpy
+
+FPS = 25
+SOURCE_RATE = 44100
+MIX_RATE = 48000
+
+
+def sound_write(filepath, seconds, frequency):
+    samples = int(seconds * SOURCE_RATE)
+    data = struct.pack("<%dh" % samples,
+                       *[int(16000 * math.sin(2.0 * math.pi * frequency * i / SOURCE_RATE)) for i in range(samples)])
+
+    sound = wave.open(filepath, "wb")
+    sound.setnchannels(1)
+    sound.setsampwidth(2)
+    sound.setframerate(SOURCE_RATE)
+    sound.writeframes(data)
+    sound.close()
+
+
+def scene_setup(directory, strips, seconds):
+    scene = bpy.context.scene
+
+    scene.render.fps = FPS
+    scene.render.fps_base = 1.0
+    scene.render.ffmpeg.audio_mixrate = MIX_RATE
+    scene.render.ffmpeg.audio_channels = 'STEREO'
+    scene.frame_start = 1
+    scene.frame_end = seconds * FPS
+
+    sequences = scene.sequence_editor_create().sequences
+
+    # every strip covers half the timeline, so about half of them play at once
+    strip_seconds = seconds / 2.0
+    for i in range(strips):
+        filepath = os.path.join(directory, "strip_%d.wav" % i)
+        sound_write(filepath, strip_seconds, 110.0 + 20.0 * i)
+
+        frame_start = 1 + int(i * strip_seconds * FPS / strips)
+        strip = sequences.new_sound("strip_%d" % i, filepath, 1 + i % 32, frame_start)
+        strip.volume = 1.0 / strips
+        strip.pan = (i % 5 - 2) / 2.0
+        strip.pitch = 1.0 + (i % 3) * 0.05
+
+    return scene
+
+
+def mixdown_time(scene, filepath, threads):
+    scene.render.threads_mode = 'FIXED'
+    scene.render.threads = threads
+
+    t = time.time()
+    bpy.ops.sound.mixdown(filepath=filepath, container='WAV', codec='PCM', format='F32')
+    return time.time() - t
+
+
+def main():
+    import sys
+
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=") for arg in argv)
+
+    strips = int(args.get("strips", 40))
+    seconds = int(args.get("seconds", 300))
+    threads = [int(count) for count in args.get("threads", "1,2,4,8,16,32").split(",")]
+
+    directory = tempfile.mkdtemp()
+    scene = scene_setup(directory, strips, seconds)
+
+    print("Sound mixdown benchmark, %d strips, %d seconds" % (strips, seconds))
+    print("    threads     time  realtime  identical")
+
+    reference = None
+
+    for count in threads:
+        filepath = os.path.join(directory, "mixdown_%d.wav" % count)
+        mixdown = mixdown_time(scene, filepath, count)
+
+        with open(filepath, "rb") as f:
+            data = f.read()
+
+        if reference is None:
+            reference = data
+
+        identical = data == reference
+        print("    %7d %7.3fs %8.1fx  %s" % (count, mixdown, seconds / mixdown, identical))
+
+        if not identical:
+            raise Exception("mixdown with %d threads differs from the one with %d" % (count, threads[0]))
+
+
+if __name__ == "__main__":
+    main()